@@ -89,21 +89,17 @@ void IRAM_ATTR process_GDFT() {
     spectrogram_history_index = 0;  // wrap to index zero at end
   }
   
-  // DEBUG: Check if sample_window has data - DISABLED to reduce serial flooding
-  static uint32_t gdft_debug_counter = 0;
-  gdft_debug_counter++; // Keep counter for other uses
-  /*
-  if (debug_mode && (gdft_debug_counter % 100 == 0)) {
-    float max_sample = 0;
+  // DEBUG: Check if sample_window has data (Logger.h)
+  if (LOG_DEBUG_ENABLED && LOG_EVERY_MS(5000)) {
+    int32_t max_sample = 0;
     for (int i = 0; i < SAMPLE_HISTORY_LENGTH; i++) {
       if (abs(sample_window[i]) > max_sample) {
         max_sample = abs(sample_window[i]);
       }
     }
-    USBSerial.print("GDFT DEBUG: max_sample_window=");
-    USBSerial.println(max_sample);
+    LOG_DEBUG("GDFT DEBUG: max_sample_window=%d", max_sample);
   }
-  */
+  bool log_bins = LOG_DEBUG_ENABLED && LOG_EVERY_MS(5000);  // One frame's loud bins, below
 
   // Run GDFT (Goertzel-based Discrete Fourier Transform) with 64 frequencies
   // Fixed-point code adapted from example here: https://sourceforge.net/p/freetel/code/HEAD/tree/misc/goertzal/goertzal.c
@@ -112,7 +108,15 @@ void IRAM_ATTR process_GDFT() {
   PERF_MONITOR_START();
 #endif
   
+  bool interlaced = quality_gdft_interlaced();  // (quality_governor.h)
+
   for (uint16_t i = 0; i < NUM_FREQS; i++) {  // Run 64 times
+    // Under load, the long-window low bins only update on alternate frames
+    // (half of them each frame) and hold their last magnitudes in between
+    if (interlaced && i < GDFT_INTERLACE_BINS && (i & 1) == interlace_flip) {
+      continue;
+    }
+
     int32_t q0, q1, q2;
     int64_t mult;
     
@@ -155,17 +159,10 @@ void IRAM_ATTR process_GDFT() {
     // Normalizing the magnitude (using pre-computed reciprocal)
     magnitudes_normalized[i] = magnitudes[i] * inv_block_size_half;
     
-    // DEBUG: Show non-zero magnitudes - DISABLED to reduce serial flooding
-    /*
-    if (debug_mode && (gdft_debug_counter % 100 == 1) && normalized_magnitude > 0.1) {
-      USBSerial.print("GDFT: freq[");
-      USBSerial.print(i);
-      USBSerial.print("]=");
-      USBSerial.print(frequencies[i].target_freq);
-      USBSerial.print("Hz, mag=");
-      USBSerial.println(normalized_magnitude);
+    // DEBUG: Show non-zero magnitudes
+    if (log_bins && magnitudes_normalized[i] > 0.1) {
+      LOG_DEBUG("GDFT: freq[%u]=%.1fHz, mag=%.3f", i, frequencies[i].target_freq, magnitudes_normalized[i]);
     }
-    */
 
     if (frequencies[i].target_freq == 440.0) {
       //USBSerial.println(magnitudes_normalized[i]);
@@ -189,16 +186,20 @@ void IRAM_ATTR process_GDFT() {
     noise_iterations++;
     if (noise_iterations >= 256) {  // Calibration complete
       noise_complete = true;
-      USBSerial.println("NOISE CAL COMPLETE");
+      LOG_DEBUG("NOISE CAL COMPLETE");
       
       // SINGLE-CORE OPTIMIZATION: Direct CONFIG write (no mutex needed)
       CONFIG.DC_OFFSET = audio_raw_state.getDCOffsetSum() / 256.0;  // Calculate average DC offset and store it
       
-      save_ambient_noise_calibration();           // Save results to noise_cal.bin
+      seed_noise_floor();                         // Tracking goes on from here (noise_cal.h)
+      save_ambient_noise_calibration();           // Snapshot for the save task (bridge_fs.h)
       save_config();                              // Save config to config.bin
     }
   }
 
+  // Follow the floor through silent frames, it may move noise_samples (noise_cal.h)
+  track_noise_floor(magnitudes_normalized_avg);
+
   // Apply noise reduction data
   for (uint8_t i = 0; i < NUM_FREQS; i += 1) {
     if (noise_complete == true) {
@@ -213,23 +214,6 @@ void IRAM_ATTR process_GDFT() {
   low_pass_array(magnitudes_final, magnitudes_last, NUM_FREQS, SYSTEM_FPS, 1.0 + (10.0 * MOOD_VAL));
   memcpy(magnitudes_last, magnitudes_final, sizeof(float) * NUM_FREQS);
 
-  /*
-  // When enabled, streams magnitudes[] array over Serial
-  if (stream_magnitudes == true) {
-    if (serial_iter >= 2) {  // Don't print every frame
-      serial_iter = 0;
-      USBSerial.print("sbs((magnitudes=");
-      for (uint16_t i = 0; i < NUM_FREQS; i++) {
-        USBSerial.print(uint32_t(magnitudes[i]));
-        if (i < NUM_FREQS - 1) {
-          USBSerial.print(',');
-        }
-      }
-      USBSerial.println("))");
-    }
-  }
-  */
-
   static SQ15x16 goertzel_max_value = 0.0001;
   SQ15x16 max_value = 0.00001;
 
@@ -275,11 +259,10 @@ void IRAM_ATTR process_GDFT() {
   }
 
   // Enhanced periodic Debugging log for AGC floor mechanism
-   if (agc_debug_logging_enabled && (millis() % 5000 == 0)) { // Log roughly every 5 seconds
-       USBSerial.print("DEBUG (AGC): TrackerRaw: "); USBSerial.print(float(min_silent_level_tracker));
-       USBSerial.print(" | FloorRawClamped: "); USBSerial.print(float(dynamic_agc_floor_raw));
-       USBSerial.print(" | FloorScaledClamped: "); USBSerial.print(float(dynamic_agc_floor_scaled));
-       USBSerial.print(" | GoertzelMax: "); USBSerial.println(float(goertzel_max_value));
+   if (agc_debug_logging_enabled && LOG_EVERY_MS(5000)) { // (Logger.h) Every 5 seconds
+       LOG_INFO("DEBUG (AGC): TrackerRaw: %.3f | FloorRawClamped: %.3f | FloorScaledClamped: %.3f | GoertzelMax: %.3f",
+                float(min_silent_level_tracker), float(dynamic_agc_floor_raw), float(dynamic_agc_floor_scaled),
+                float(goertzel_max_value));
    }
   // --> END REPLACED/ENHANCED <--
 
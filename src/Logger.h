@@ -1,223 +1,120 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <Arduino.h>
-#include <stdarg.h>
-#include <string.h>
+/*----------------------------------------
+  Sensory Bridge LOGGER
+  ----------------------------------------*/
+
+// LOG_ERROR / LOG_WARN / LOG_INFO / LOG_DEBUG / LOG_VERBOSE(format, ...)
+// queue a record on the calling core's LogQueue (log_queue.h) and return:
+// no formatting, no USB, no serial_mutex on the caller's side. A low
+// priority task on core 0 formats the records, oldest first across both
+// cores, and prints them one line each under serial_mutex. If a queue is
+// full the record is dropped, and the task reports how many went missing.
+//
+// Levels above LOG_COMPILE_LEVEL compile to nothing. DEBUG and VERBOSE
+// also need debug_mode at runtime. For debug output that would otherwise
+// fire every frame:
+//
+//   if (LOG_DEBUG_ENABLED && LOG_EVERY_MS(5000)) { ... LOG_DEBUG(...); }
+//   LOG_DEBUG_EVERY(5000, "format", ...);
+//
+// Format strings must be literals and %s arguments must outlive the call
+// (see log_queue.h). SQ15x16 values need a float() first.
 
-// Include USB CDC configuration
-#include "usb_cdc_config.h"
+#include <Arduino.h>
+#include "globals.h"
+#include "log_queue.h"
 
-// Define USBSerial for ESP32-S3
-#if defined(ARDUINO_ESP32S3_DEV) && !defined(USBSerial)
-  #define USBSerial Serial
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
 #endif
 
-// Log levels
-typedef enum {
-    LOG_LEVEL_ERROR = 0,
-    LOG_LEVEL_WARN,
-    LOG_LEVEL_INFO,
-    LOG_LEVEL_DEBUG,
-    LOG_LEVEL_VERBOSE
-} LogLevel;
-
-// ANSI color codes
-#define ANSI_COLOR_RED     "\x1b[31m"
-#define ANSI_COLOR_GREEN   "\x1b[32m"
-#define ANSI_COLOR_YELLOW  "\x1b[33m"
-#define ANSI_COLOR_BLUE    "\x1b[34m"
-#define ANSI_COLOR_MAGENTA "\x1b[35m"
-#define ANSI_COLOR_CYAN    "\x1b[36m"
-#define ANSI_COLOR_RESET   "\x1b[0m"
-
-// Helper macros for easier logging
-#define LOG_ERROR(fmt, ...)   Logger::error(fmt, ##__VA_ARGS__)
-#define LOG_WARN(fmt, ...)    Logger::warn(fmt, ##__VA_ARGS__)
-#define LOG_INFO(fmt, ...)    Logger::info(fmt, ##__VA_ARGS__)
-#define LOG_DEBUG(fmt, ...)   Logger::debug(fmt, ##__VA_ARGS__)
-#define LOG_VERBOSE(fmt, ...) Logger::verbose(fmt, ##__VA_ARGS__)
-
-class Logger {
-public:
-    static void begin(LogLevel level = LOG_LEVEL_INFO, bool color = true, bool timestamp = true) {
-        logLevel = level;
-        useColor = color;
-        useTimestamp = timestamp;
-        
-        // Initialize serial port
-        #if defined(ARDUINO_ESP32S3_DEV) && defined(ARDUINO_ARCH_ESP32)
-            // USB CDC is initialized in usb_cdc_init()
-            USBSerial.setDebugOutput(true);
-            #ifdef DEBUG
-                while (!USBSerial) {
-                    delay(10);
-                }
-            #endif
-        #else
-            // Fallback for other platforms
-            Serial.begin(115200);
-            #ifdef DEBUG
-                while (!Serial);
-            #endif
-        #endif
-        
-        LOG_INFO("Logger initialized with level: %d", logLevel);
-    }
-    
-    static void setLogLevel(LogLevel level) {
-        logLevel = level;
-    }
-    
-    static void setColorEnabled(bool enabled) {
-        useColor = enabled;
-    }
-    
-    static void setTimestampEnabled(bool enabled) {
-        useTimestamp = enabled;
-    }
-    
-    // Log methods
-    static void error(const char* format, ...) {
-        va_list args;
-        va_start(args, format);
-        log(LOG_LEVEL_ERROR, "ERROR", ANSI_COLOR_RED, format, args);
-        va_end(args);
-    }
-    
-    static void warn(const char* format, ...) {
-        if (logLevel < LOG_LEVEL_WARN) return;
-        va_list args;
-        va_start(args, format);
-        log(LOG_LEVEL_WARN, "WARN ", ANSI_COLOR_YELLOW, format, args);
-        va_end(args);
-    }
-    
-    static void info(const char* format, ...) {
-        if (logLevel < LOG_LEVEL_INFO) return;
-        va_list args;
-        va_start(args, format);
-        log(LOG_LEVEL_INFO, "INFO ", ANSI_COLOR_GREEN, format, args);
-        va_end(args);
-    }
-    
-    static void debug(const char* format, ...) {
-        if (logLevel < LOG_LEVEL_DEBUG) return;
-        va_list args;
-        va_start(args, format);
-        log(LOG_LEVEL_DEBUG, "DEBUG", ANSI_COLOR_CYAN, format, args);
-        va_end(args);
-    }
-    
-    static void verbose(const char* format, ...) {
-        if (logLevel < LOG_LEVEL_VERBOSE) return;
-        va_list args;
-        va_start(args, format);
-        log(LOG_LEVEL_VERBOSE, "VERB ", ANSI_COLOR_MAGENTA, format, args);
-        va_end(args);
-    }
-    
-    // Performance monitoring
-    static void logPerformance(const char* tag, uint32_t timeMs) {
-        if (logLevel >= LOG_LEVEL_DEBUG) {
-            char buffer[64];
-            snprintf(buffer, sizeof(buffer), "[PERF] %-20s: %5lu ms", tag, timeMs);
-            debug(buffer);
-        }
-    }
-    
-    // Memory usage
-    static void logMemoryUsage() {
-        if (logLevel >= LOG_LEVEL_DEBUG) {
-            debug("Free heap: %d bytes", ESP.getFreeHeap());
-            debug("Min free heap: %d bytes", ESP.getMinFreeHeap());
-            debug("Max alloc heap: %d bytes", ESP.getMaxAllocHeap());
-        }
+#define LOG_QUEUE_RECORDS 64  // Per core
+#define LOG_LINE_LENGTH   256
+
+LogQueue<LOG_QUEUE_RECORDS> log_queues[2];
+TaskHandle_t logger_task = NULL;
+
+template <class... Args>
+inline void log_write(uint8_t level, const char* format, Args... args) {
+  if (level >= LOG_LEVEL_DEBUG && debug_mode == false) {
+    return;
+  }
+  log_push(log_queues[xPortGetCoreID()], level, millis(), format, args...);
+}
+
+#define LOG_AT(level, format, ...) \
+  do { if ((level) <= LOG_COMPILE_LEVEL) { log_write(level, format, ##__VA_ARGS__); } } while (0)
+
+#define LOG_ERROR(format, ...)   LOG_AT(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...)    LOG_AT(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...)    LOG_AT(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_DEBUG(format, ...)   LOG_AT(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_VERBOSE(format, ...) LOG_AT(LOG_LEVEL_VERBOSE, format, ##__VA_ARGS__)
+
+#define LOG_DEBUG_ENABLED (LOG_LEVEL_DEBUG <= LOG_COMPILE_LEVEL && debug_mode)
+
+// True at most once every «interval_ms» for each place it's written
+#define LOG_EVERY_MS(interval_ms) ([]() {      \
+    static uint32_t last_ms = 0;               \
+    uint32_t now_ms = millis();                \
+    if (now_ms - last_ms < (interval_ms)) {    \
+      return false;                            \
+    }                                          \
+    last_ms = now_ms;                          \
+    return true;                               \
+  }())
+
+#define LOG_DEBUG_EVERY(interval_ms, format, ...) \
+  do { if (LOG_DEBUG_ENABLED && LOG_EVERY_MS(interval_ms)) { log_write(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__); } } while (0)
+
+static const char* const log_level_prefixes[] = { "ERROR: ", "WARNING: ", "", "DEBUG: ", "VERBOSE: " };
+
+void logger_print(const char* line) {
+  xSemaphoreTake(serial_mutex, portMAX_DELAY);  // This task waits out a reply or telemetry frame, never the caller
+  USBSerial.println(line);
+  xSemaphoreGive(serial_mutex);
+}
+
+void logger_drain_task(void* arg) {
+  static char line[LOG_LINE_LENGTH];
+  LogRecord pending[2];
+  bool has_pending[2] = { false, false };
+  uint32_t dropped_reported = 0;
+
+  while (true) {
+    for (uint8_t c = 0; c < 2; c++) {
+      if (has_pending[c] == false) {
+        has_pending[c] = log_queues[c].pop(pending[c]);
+      }
     }
-    
-    // Task status
-    static void logTaskStatus() {
-        if (logLevel >= LOG_LEVEL_VERBOSE) {
-            verbose("Task Status:");
-            verbose("  Name       State   Pri  Free   Stack   Core");
-            verbose("  --------- ------- ----- ------- ------- ----");
-            
-            char *pbuffer = (char*)malloc(1024);
-            if (pbuffer) {
-                vTaskList(pbuffer);
-                verbose("%s", pbuffer);
-                free(pbuffer);
-            }
-        }
+    if (has_pending[0] == false && has_pending[1] == false) {
+      uint32_t dropped = log_queues[0].dropped.load() + log_queues[1].dropped.load();
+      if (dropped != dropped_reported) {
+        snprintf(line, sizeof(line), "WARNING: %lu log messages dropped", (unsigned long)(dropped - dropped_reported));
+        logger_print(line);
+        dropped_reported = dropped;
+      }
+      vTaskDelay(pdMS_TO_TICKS(2));
+      continue;
     }
 
-private:
-    static LogLevel logLevel;
-    static bool useColor;
-    static bool useTimestamp;
-    
-    static void log(LogLevel level, const char* tag, const char* color, const char* format, va_list args) {
-        if (level > logLevel) return;
-        
-        char buffer[384];  // Increased buffer size for safety
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        
-        // Get task name if available
-        const char* taskName = "";
-        #ifdef ESP32
-        taskName = pcTaskGetName(NULL);
-        if (taskName == NULL) {
-            taskName = "main";
-        }
-        #endif
-        
-        #if defined(ARDUINO_ESP32S3_DEV) && defined(ARDUINO_ARCH_ESP32)
-            // Use USBSerial for ESP32-S3
-            Stream &output = USBSerial;
-        #else
-            // Fallback to Serial for other platforms
-            Stream &output = Serial;
-        #endif
-            
-            if (useColor) {
-                output.print(color);
-            }
-            
-            if (useTimestamp) {
-                unsigned long ms = millis();
-                output.printf("[%6lu.%03lu] ", ms / 1000, ms % 1000);
-            }
-            
-            output.printf("[%s] [%-10s] %s\n", tag, taskName, buffer);
-            
-            if (useColor) {
-                output.print(ANSI_COLOR_RESET);
-            }
-            
-            output.flush();
-            if (useColor) {
-                Serial.print(color);
-            }
-            
-            if (useTimestamp) {
-                unsigned long ms = millis();
-                Serial.printf("[%6lu.%03lu] ", ms / 1000, ms % 1000);
-            }
-            
-            Serial.printf("[%s] [%-10s] %s\n", tag, taskName, buffer);
-            
-            if (useColor) {
-                Serial.print(ANSI_COLOR_RESET);
-            }
-            
-            Serial.flush();
-        #endif
-    }
-};
+    uint8_t c = (has_pending[0] && (has_pending[1] == false || int32_t(pending[0].time_ms - pending[1].time_ms) <= 0)) ? 0 : 1;
+    const LogRecord& record = pending[c];
+    size_t prefix = strlen(log_level_prefixes[record.level]);
+    memcpy(line, log_level_prefixes[record.level], prefix);
+    log_format(record, line + prefix, sizeof(line) - prefix);
+    logger_print(line);
+    has_pending[c] = false;
+  }
+}
 
-// Initialize static members
-LogLevel Logger::logLevel = LOG_LEVEL_INFO;
-bool Logger::useColor = true;
-bool Logger::useTimestamp = true;
+// Before the other tasks start. Anything logged earlier is dropped.
+void init_logger() {
+  log_queues[0].clear();
+  log_queues[1].clear();
+  xTaskCreatePinnedToCore(logger_drain_task, "logger", 4096, NULL, tskIDLE_PRIORITY + 1, &logger_task, 0);
+}
 
 #endif // LOGGER_H
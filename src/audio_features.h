@@ -0,0 +1,185 @@
+#ifndef AUDIO_FEATURES_H
+#define AUDIO_FEATURES_H
+
+/*----------------------------------------
+  Sensory Bridge AUDIO FEATURES
+  ----------------------------------------*/
+
+// Light modes used to each re-derive the same things from spectrogram_smooth
+// and chromagram_smooth every frame (band sums, SQUARE_ITER contrast curves,
+// chroma color mixes), and the secondary strip did it all over again. These
+// are now computed once per rendered frame, and only when a mode asks for
+// them: require_audio_features() fills in whatever isn't valid yet, and
+// invalidate_audio_features() is called by led_thread whenever the smoothed
+// spectrogram/chromagram are refreshed.
+//
+// The chroma features take SQUARE_ITER and SATURATION from frame_config
+// (globals.h), like the modes that read them, so an edit landing in CONFIG
+// mid-frame can't give one strip curves the other didn't get.
+
+#include <FixedPoints.h>
+#include <FixedPointsCommon.h>
+#include "constants.h"
+#include "globals.h"
+
+enum audio_feature_flags {
+  FEATURE_BANDS         = 1 << 0,  // Low/mid/high band bins and energies
+  FEATURE_CHROMA_CURVED = 1 << 1,  // Chromagram with SQUARE_ITER contrast applied
+  FEATURE_DOMINANT_NOTE = 1 << 2,  // Strongest chromagram bin
+  FEATURE_CHROMA_COLOR  = 1 << 3,  // Sum of the 12 note colors, weighted by curved chroma
+  FEATURE_PEAK          = 1 << 4,  // Loudest spectrogram bin
+  FEATURE_NOVELTY       = 1 << 5,  // Latest spectral novelty (GDFT.h)
+};
+
+#define FEATURE_BAND_WIDTH 20
+
+struct AudioFeatures {
+  SQ15x16 band_bins[3][FEATURE_BAND_WIDTH];  // (bin + bin^2) / 2, bins 0-19, 20-39, 40-59
+  SQ15x16 band_energy[3];                    // Sum of each row of band_bins
+
+  SQ15x16 chroma_curved[12];
+
+  uint8_t dominant_note;
+  SQ15x16 dominant_magnitude;
+
+  CRGB16  chroma_color;           // Sum of hsv(note / 12, SATURATION, curved) for curved > 0.05
+  SQ15x16 chroma_total_magnitude; // Sum of the curved values that went into chroma_color
+
+  uint8_t peak_bin;
+  SQ15x16 peak;
+
+  SQ15x16 novelty;
+
+  uint8_t valid;  // Bitmask of audio_feature_flags computed this frame
+
+  // The frame_config inputs the chroma features were computed with, so one
+  // changed between renders doesn't read stale curves
+  float chroma_square_iter;
+  float chroma_saturation;
+} audio_features;
+
+uint32_t audio_feature_computations = 0;  // Number of feature stages actually run, for debugging
+
+void invalidate_audio_features() {
+  audio_features.valid = 0;
+}
+
+void compute_feature_bands() {
+  for (uint8_t band = 0; band < 3; band++) {
+    SQ15x16 sum = 0.0;
+    for (uint8_t i = 0; i < FEATURE_BAND_WIDTH; i++) {
+      SQ15x16 bin = spectrogram_smooth[band * FEATURE_BAND_WIDTH + i];
+      bin = bin * 0.5 + (bin * bin) * 0.5;
+
+      audio_features.band_bins[band][i] = bin;
+      sum += bin;
+    }
+    audio_features.band_energy[band] = sum;
+  }
+}
+
+void compute_feature_chroma_curved() {
+  uint8_t base_iters = (uint8_t)frame_config.SQUARE_ITER;
+  float fract_iter = frame_config.SQUARE_ITER - base_iters;
+
+  for (uint8_t i = 0; i < 12; i++) {
+    SQ15x16 bin = chromagram_smooth[i];
+    for (uint8_t s = 0; s < base_iters; s++) {
+      bin *= bin;
+    }
+
+    if (fract_iter > 0.01) {
+      SQ15x16 squared = bin * bin;
+      bin = bin * (1.0 - fract_iter) + squared * fract_iter;
+    }
+
+    audio_features.chroma_curved[i] = bin;
+  }
+
+  audio_features.chroma_square_iter = frame_config.SQUARE_ITER;
+}
+
+void compute_feature_dominant_note() {
+  uint8_t best = 0;
+  for (uint8_t i = 1; i < 12; i++) {
+    if (chromagram_smooth[i] > chromagram_smooth[best]) {
+      best = i;
+    }
+  }
+
+  audio_features.dominant_note = best;
+  audio_features.dominant_magnitude = chromagram_smooth[best];
+}
+
+void compute_feature_chroma_color() {
+  CRGB16 sum_color = { 0, 0, 0 };
+  SQ15x16 total_magnitude = 0.0;
+
+  int32_t desat = hsv_desat_q16(frame_config.SATURATION);  // (led_utilities.h)
+  for (uint8_t i = 0; i < 12; i++) {
+    SQ15x16 bright = audio_features.chroma_curved[i];
+    if (bright > 0.05) {
+      CRGB16 note_col = hsv16(uint16_t(i * 65536 / 12), desat, bright);
+      sum_color.r += note_col.r;
+      sum_color.g += note_col.g;
+      sum_color.b += note_col.b;
+      total_magnitude += bright;
+    }
+  }
+
+  audio_features.chroma_color = sum_color;
+  audio_features.chroma_total_magnitude = total_magnitude;
+  audio_features.chroma_saturation = frame_config.SATURATION;
+}
+
+void compute_feature_peak() {
+  uint8_t best = 0;
+  for (uint8_t i = 1; i < NUM_FREQS; i++) {
+    if (spectrogram_smooth[i] > spectrogram_smooth[best]) {
+      best = i;
+    }
+  }
+
+  audio_features.peak_bin = best;
+  audio_features.peak = spectrogram_smooth[best];
+}
+
+void compute_feature_novelty() {
+  int16_t rounded_index = spectral_history_index - 1;
+  while (rounded_index < 0) {
+    rounded_index += SPECTRAL_HISTORY_LENGTH;
+  }
+  audio_features.novelty = novelty_curve[rounded_index];
+}
+
+// Make sure every feature in «flags» is valid for this frame, computing only what's missing
+void require_audio_features(uint8_t flags) {
+  // Chroma features depend on the frame's SQUARE_ITER and SATURATION
+  if ((audio_features.valid & FEATURE_CHROMA_CURVED) && audio_features.chroma_square_iter != frame_config.SQUARE_ITER) {
+    audio_features.valid &= ~(FEATURE_CHROMA_CURVED | FEATURE_CHROMA_COLOR);
+  }
+  if ((audio_features.valid & FEATURE_CHROMA_COLOR) && audio_features.chroma_saturation != frame_config.SATURATION) {
+    audio_features.valid &= ~FEATURE_CHROMA_COLOR;
+  }
+
+  // The color sum is built from the curved chroma
+  if (flags & FEATURE_CHROMA_COLOR) {
+    flags |= FEATURE_CHROMA_CURVED;
+  }
+
+  uint8_t missing = flags & ~audio_features.valid;
+  if (missing == 0) {
+    return;
+  }
+
+  if (missing & FEATURE_BANDS)         { compute_feature_bands();          audio_feature_computations++; }
+  if (missing & FEATURE_CHROMA_CURVED) { compute_feature_chroma_curved();  audio_feature_computations++; }
+  if (missing & FEATURE_DOMINANT_NOTE) { compute_feature_dominant_note();  audio_feature_computations++; }
+  if (missing & FEATURE_CHROMA_COLOR)  { compute_feature_chroma_color();   audio_feature_computations++; }
+  if (missing & FEATURE_PEAK)          { compute_feature_peak();           audio_feature_computations++; }
+  if (missing & FEATURE_NOVELTY)       { compute_feature_novelty();        audio_feature_computations++; }
+
+  audio_features.valid |= missing;
+}
+
+#endif // AUDIO_FEATURES_H
@@ -3,8 +3,287 @@
   ----------------------------------------*/
 
 #include "phase0_filesystem_safe.h"
+#include "config_journal.h"
+#include "save_queue.h"
+#include "noise_floor.h"
 
 extern void reboot(); // system.h
+extern NoiseFloorTracker<NUM_FREQS> noise_floor;   // noise_cal.h
+extern NoiseProfileBank<NUM_FREQS> noise_profiles;  // noise_cal.h
+
+// CONFIG, the noise profile, the presets and the named noise profiles are
+// saved to an append-only journal (config_journal.h): a save appends the
+// fields that changed instead of rewriting a file. Each of the journal's
+// sectors is its own preallocated file, CONFIG_JOURNAL_PATH.0 and on.
+#define CONFIG_JOURNAL_PATH             "/config.jnl"
+#define CONFIG_JOURNAL_SECTOR_BYTES     4096
+#define CONFIG_JOURNAL_SECTORS_PER_BANK 2
+#define CONFIG_JOURNAL_SECTORS          (2 * CONFIG_JOURNAL_SECTORS_PER_BANK)
+
+enum journal_blob_ids {
+  JOURNAL_BLOB_NOISE_PROFILE,
+  JOURNAL_BLOB_PRESETS,
+  JOURNAL_BLOB_NOISE_PROFILES
+};
+
+// What the save task (save_task() below) can be handed
+enum save_kinds {
+  SAVE_CONFIG,
+  SAVE_NOISE_PROFILE,
+  SAVE_PRESETS,
+  SAVE_NOISE_PROFILES,
+  NUM_SAVE_KINDS
+};
+
+const char* save_kind_names[NUM_SAVE_KINDS] = { "CONFIG", "AMBIENT_NOISE PROFILE", "PRESETS", "NOISE PROFILES" };
+const uint8_t save_kind_blobs[NUM_SAVE_KINDS] = { 0, JOURNAL_BLOB_NOISE_PROFILE, JOURNAL_BLOB_PRESETS, JOURNAL_BLOB_NOISE_PROFILES };  // CONFIG isn't a blob
+
+// JournalFlash on top of LittleFS, one file per sector, created erased
+// (0xFF) and kept open. Only erased bytes are ever programmed, so writing
+// them over is the same as programming them.
+//
+// LittleFS is copy-on-write: every flush of a write into the middle of a
+// file copies the blocks from there to the end of it. So a sector is one
+// file of one block, and program() only stages into a RAM copy of the
+// sector. sync() then writes what changed with a single write and flush,
+// once per record. Erasing a sector is one write of the whole file.
+class LittleFsJournalFlash : public JournalFlash {
+ public:
+  bool begin(const char* path, uint32_t sectors) {
+    if (sectors > CONFIG_JOURNAL_SECTORS) {
+      return false;
+    }
+    File single;
+    if (LittleFS.exists(path)) {  // The whole journal in one file, as it used to be
+      single = LittleFS.open(path, "r");
+      if (single.size() != size_t(sectors) * CONFIG_JOURNAL_SECTOR_BYTES) {
+        single.close();
+      }
+    }
+
+    for (uint32_t s = 0; s < sectors; s++) {
+      char name[32];
+      snprintf(name, sizeof(name), "%s.%lu", path, (unsigned long)s);
+      if (single || LittleFS.exists(name) == false) {
+        files[s] = LittleFS.open(name, "w+");
+        if (single) {
+          bool copied = single.seek(s * CONFIG_JOURNAL_SECTOR_BYTES) &&
+                        single.read(stage, CONFIG_JOURNAL_SECTOR_BYTES) == CONFIG_JOURNAL_SECTOR_BYTES;
+          if (copied == false) {
+            memset(stage, 0xFF, CONFIG_JOURNAL_SECTOR_BYTES);
+          }
+        } else {
+          memset(stage, 0xFF, CONFIG_JOURNAL_SECTOR_BYTES);
+        }
+        if (!files[s] || files[s].write(stage, CONFIG_JOURNAL_SECTOR_BYTES) != CONFIG_JOURNAL_SECTOR_BYTES) {
+          return false;
+        }
+        files[s].flush();
+      } else {
+        files[s] = LittleFS.open(name, "r+");
+        if (!files[s] || files[s].size() != CONFIG_JOURNAL_SECTOR_BYTES) {
+          return false;
+        }
+      }
+    }
+    if (single) {
+      single.close();
+    }
+    if (LittleFS.exists(path)) {
+      LittleFS.remove(path);  // Copied over, or not a journal this firmware could read
+    }
+    sector_count = sectors;
+    return true;
+  }
+
+  uint32_t sector_size() const override { return CONFIG_JOURNAL_SECTOR_BYTES; }
+  uint32_t num_sectors() const override { return sector_count; }
+
+  bool read(uint32_t address, void* data, uint32_t length) override {
+    uint8_t* into = (uint8_t*)data;
+    while (length > 0) {
+      uint32_t sector = address / CONFIG_JOURNAL_SECTOR_BYTES;
+      uint32_t offset = address % CONFIG_JOURNAL_SECTOR_BYTES;
+      uint32_t chunk = min(length, CONFIG_JOURNAL_SECTOR_BYTES - offset);
+      if (sector >= sector_count) {
+        return false;
+      }
+      if (sector == staged) {
+        memcpy(into, stage + offset, chunk);
+      } else if (!files[sector].seek(offset) || files[sector].read(into, chunk) != chunk) {
+        return false;
+      }
+      into += chunk;
+      address += chunk;
+      length -= chunk;
+    }
+    return true;
+  }
+
+  bool program(uint32_t address, const void* data, uint32_t length) override {
+    const uint8_t* from = (const uint8_t*)data;
+    while (length > 0) {
+      uint32_t sector = address / CONFIG_JOURNAL_SECTOR_BYTES;
+      uint32_t offset = address % CONFIG_JOURNAL_SECTOR_BYTES;
+      uint32_t chunk = min(length, CONFIG_JOURNAL_SECTOR_BYTES - offset);
+      if (sector >= sector_count || load(sector) == false) {
+        return false;
+      }
+      memcpy(stage + offset, from, chunk);
+      dirty_from = min(dirty_from, offset);
+      dirty_to = max(dirty_to, offset + chunk);
+      from += chunk;
+      address += chunk;
+      length -= chunk;
+    }
+    return true;
+  }
+
+  bool erase(uint32_t sector) override {
+    if (sector >= sector_count || sync() == false) {
+      return false;
+    }
+    staged = sector;
+    memset(stage, 0xFF, CONFIG_JOURNAL_SECTOR_BYTES);
+    if (!files[sector].seek(0) || files[sector].write(stage, CONFIG_JOURNAL_SECTOR_BYTES) != CONFIG_JOURNAL_SECTOR_BYTES) {
+      staged = NONE;
+      return false;
+    }
+    files[sector].flush();
+    return true;
+  }
+
+  bool sync() override {
+    if (dirty_to <= dirty_from) {
+      return true;
+    }
+    File& file = files[staged];
+    uint32_t length = dirty_to - dirty_from;
+    bool ok = file.seek(dirty_from) && file.write(stage + dirty_from, length) == length;
+    file.flush();
+    dirty_from = CONFIG_JOURNAL_SECTOR_BYTES;
+    dirty_to = 0;
+    if (ok == false) {
+      staged = NONE;  // Read it back from the file, not what didn't make it there
+    }
+    return ok;
+  }
+
+ private:
+  static const uint32_t NONE = 0xFFFFFFFF;
+
+  File files[CONFIG_JOURNAL_SECTORS];
+  uint32_t sector_count = 0;
+  uint8_t stage[CONFIG_JOURNAL_SECTOR_BYTES];  // RAM copy of sector «staged»
+  uint32_t staged = NONE;
+  uint32_t dirty_from = CONFIG_JOURNAL_SECTOR_BYTES;  // What program() changed, since the last sync()
+  uint32_t dirty_to = 0;
+
+  // Make «sector» the staged one, syncing the one before
+  bool load(uint32_t sector) {
+    if (sector == staged) {
+      return true;
+    }
+    if (sync() == false) {
+      return false;
+    }
+    staged = NONE;
+    if (!files[sector].seek(0) || files[sector].read(stage, CONFIG_JOURNAL_SECTOR_BYTES) != CONFIG_JOURNAL_SECTOR_BYTES) {
+      return false;
+    }
+    staged = sector;
+    return true;
+  }
+};
+
+LittleFsJournalFlash config_journal_flash;
+ConfigJournal config_journal(config_journal_flash, CONFIG_JOURNAL_SECTORS_PER_BANK);
+float noise_profile_journaled[NUM_FREQS];  // The journal's copy of noise_samples
+PresetBankImage presets_journaled;         // And of preset_bank (presets.h)
+NoiseProfileBank<NUM_FREQS> noise_profiles_journaled;  // And of noise_profiles (noise_cal.h)
+
+// The journal is only written by save_task() once it runs. Before that,
+// init_fs() has it to itself
+SaveQueue<NUM_SAVE_KINDS, SpinLock> save_queue;  // (globals.h)
+SensoryBridge::Config::conf config_posted;
+SensoryBridge::Config::conf config_writing;
+float noise_profile_posted[NUM_FREQS];
+float noise_profile_writing[NUM_FREQS];
+PresetBankImage presets_posted;
+PresetBankImage presets_writing;
+NoiseProfileBank<NUM_FREQS> noise_profiles_posted;
+NoiseProfileBank<NUM_FREQS> noise_profiles_writing;
+
+TaskHandle_t save_task_handle = NULL;
+SemaphoreHandle_t config_journal_mutex = NULL;  // Held by whoever writes the journal, factory_reset() too
+
+const char* journal_mount_names[] = { "MOUNTED", "RECOVERED", "FORMATTED", "FAILED" };
+
+// Snapshot «data» for save_task(), never blocks
+bool post_save(uint8_t kind, const void* data) {
+  if (save_queue.post(kind, data) == false) {
+    return false;
+  }
+  if (save_task_handle != NULL) {
+    xTaskNotifyGive(save_task_handle);
+  }
+  return true;
+}
+
+// Low priority on core 0: writes each snapshot as it comes, the audio and
+// LED paths only ever post_save()
+void save_task(void* arg) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    uint8_t kind;
+    const void* data;
+    while (save_queue.take(kind, data)) {
+      xSemaphoreTake(config_journal_mutex, portMAX_DELAY);
+      uint32_t start_us = micros();
+      bool ok = false;
+      if (kind == SAVE_CONFIG) {
+        ok = config_journal.save_config(*(const SensoryBridge::Config::conf*)data);  // Only the fields that changed, nothing if none did
+      } else if (data != NULL) {
+        ok = config_journal.save_blob(save_kind_blobs[kind], data);
+      } else {
+        ok = config_journal.erase_blob(save_kind_blobs[kind]);
+      }
+      uint32_t took_us = micros() - start_us;
+      xSemaphoreGive(config_journal_mutex);
+      save_queue.done(ok, took_us);
+
+      LOG_DEBUG("SAVED %s: %s (%u us)", save_kind_names[kind], ok ? "SUCCESS" : "FAILED", took_us);
+    }
+  }
+}
+
+// After the journal is mounted
+void init_save_task() {
+  save_queue.add_slot(SAVE_CONFIG, &config_posted, &config_writing, sizeof(config_posted));
+  save_queue.add_slot(SAVE_NOISE_PROFILE, noise_profile_posted, noise_profile_writing, sizeof(noise_profile_posted));
+  save_queue.add_slot(SAVE_PRESETS, &presets_posted, &presets_writing, sizeof(presets_posted));
+  save_queue.add_slot(SAVE_NOISE_PROFILES, &noise_profiles_posted, &noise_profiles_writing, sizeof(noise_profiles_posted));
+  config_journal_mutex = xSemaphoreCreateMutex();
+  xTaskCreatePinnedToCore(save_task, "save", 4096, NULL, tskIDLE_PRIORITY + 1, &save_task_handle, 0);
+}
+
+// Wait up to «timeout_ms» for everything posted to be written, before a
+// reboot. False if it timed out or a write failed
+bool flush_saves(uint32_t timeout_ms = 2000) {
+  if (save_task_handle == NULL) {
+    return true;
+  }
+  uint32_t failed = save_queue.stats().failed;
+  uint32_t start_ms = millis();
+  while (save_queue.idle() == false) {
+    if (millis() - start_ms > timeout_ms) {
+      return false;
+    }
+    vTaskDelay(1);
+  }
+  return save_queue.stats().failed == failed;
+}
 
 void update_config_filename(uint32_t input) {
   snprintf(config_filename, 24, "/CONFIG_%05lu.BIN", input);
@@ -16,25 +295,28 @@ void init_config_defaults() {
   CONFIG_DEFAULTS = CONFIG;
 }
 
-// Restore all defaults defined in globals.h by removing saved data and rebooting
+// Files older firmware saved CONFIG and the noise profile to
+#define LEGACY_NOISE_FILENAME "/noise_cal.bin"
+
+void remove_legacy_config_files() {
+  LittleFS.remove(config_filename);
+  LittleFS.remove(LEGACY_NOISE_FILENAME);
+}
+
+// Restore all defaults defined in globals.h by erasing saved data and rebooting
 void factory_reset() {
   lock_leds();
-  USBSerial.print("Deleting ");
-  USBSerial.print(config_filename);
-  USBSerial.print(": ");
-
-  if (LittleFS.remove(config_filename)) {
-    USBSerial.println("file deleted");
-  } else {
-    USBSerial.println("delete failed");
+  USBSerial.print("Erasing the config journal: ");
+  flush_saves();
+  if (config_journal_mutex != NULL) {
+    xSemaphoreTake(config_journal_mutex, portMAX_DELAY);  // Kept until the reboot, nothing saves after the erase
   }
-
-  USBSerial.print("Deleting noise_cal.bin: ");
-  if (LittleFS.remove("/noise_cal.bin")) {
-    USBSerial.println("file deleted");
+  if (config_journal.format(CONFIG_DEFAULTS)) {
+    USBSerial.println("done");
   } else {
-    USBSerial.println("delete failed");
+    USBSerial.println("erase failed");
   }
+  remove_legacy_config_files();
 
   reboot();
 }
@@ -42,14 +324,12 @@ void factory_reset() {
 // Restore only configuration defaults
 void restore_defaults() {
   lock_leds();
-  USBSerial.print("Deleting ");
-  USBSerial.print(config_filename);
-  USBSerial.print(": ");
-
-  if (LittleFS.remove(config_filename)) {
-    USBSerial.println("file deleted");
+  USBSerial.print("Saving default CONFIG: ");
+  post_save(SAVE_CONFIG, &CONFIG_DEFAULTS);
+  if (flush_saves()) {
+    USBSerial.println("done");
   } else {
-    USBSerial.println("delete failed");
+    USBSerial.println("save failed");
   }
 
   reboot();
@@ -64,35 +344,13 @@ void save_config() {
   config_save_pending = true;
 }
 
-// Actual file write - call this from main loop when safe
+// Hand a snapshot of CONFIG to save_task() - call this from main loop when safe
 void do_config_save() {
   if (!config_save_pending) return;
 
   config_save_pending = false;
-  lock_leds();
-
-  if (debug_mode) {
-    USBSerial.print("SAVING CONFIG: ");
-  }
-
-  // Use SafeFile for atomic write with CRC32 validation
-  auto result = Phase0::Filesystem::SafeFile::write(
-    config_filename,
-    &CONFIG,
-    sizeof(CONFIG)
-  );
-
-  if (!result.ok()) {
-    if (debug_mode) {
-      USBSerial.printf("FAILED - %s\n", result.statusString());
-    }
-  } else {
-    if (debug_mode) {
-      USBSerial.printf("SUCCESS (%zu bytes)\n", result.bytes_processed);
-    }
-  }
-
-  unlock_leds();
+  post_save(SAVE_CONFIG, &CONFIG);
+  LOG_DEBUG("SAVING CONFIG: QUEUED (%u waiting)", save_queue.depth());
 }
 
 // Save configuration to LittleFS after delay
@@ -105,66 +363,187 @@ void save_config_delayed() {
   settings_updated = true;
 }
 
-// Load configuration from LittleFS
+// The first boot with the journal takes CONFIG and the noise profile from
+// the files older firmware saved, and deletes each one it took. Fields were
+// only ever appended to CONFIG, so a shorter file is an older CONFIG and
+// the fields it doesn't have keep their defaults
+void import_legacy_config_files() {
+  uint8_t legacy[sizeof(SensoryBridge::Config::conf)];
+  size_t bytes_read = 0;
+  auto result = Phase0::Filesystem::SafeFile::read(config_filename, legacy, sizeof(legacy), &bytes_read);
+  if (result.ok() && config_from_prefix(CONFIG, legacy, bytes_read) != 0) {
+    if (config_journal.save_config(CONFIG)) {
+      LittleFS.remove(config_filename);
+    }
+  }
+
+  float noise_float[NUM_FREQS];
+  result = Phase0::Filesystem::SafeFile::read(LEGACY_NOISE_FILENAME, noise_float, sizeof(noise_float), &bytes_read);
+  if (result.ok() && bytes_read == sizeof(noise_float)) {
+    if (config_journal.save_blob(JOURNAL_BLOB_NOISE_PROFILE, noise_float)) {
+      LittleFS.remove(LEGACY_NOISE_FILENAME);
+    }
+  }
+}
+
+// Replay the journal into CONFIG (and the journal's copy of the noise profile)
 void load_config() {
-  lock_leds();
   if (debug_mode) {
     USBSerial.print("LOADING CONFIG: ");
   }
 
-  size_t bytes_read = 0;
-  auto result = Phase0::Filesystem::SafeFile::read(
-    config_filename,
-    &CONFIG,
-    sizeof(CONFIG),
-    &bytes_read
-  );
-
-  if (!result.ok()) {
+  config_journal.add_blob(JOURNAL_BLOB_NOISE_PROFILE, noise_profile_journaled, sizeof(noise_profile_journaled));
+  config_journal.add_blob(JOURNAL_BLOB_PRESETS, &presets_journaled, sizeof(presets_journaled));
+  config_journal.add_blob(JOURNAL_BLOB_NOISE_PROFILES, &noise_profiles_journaled, sizeof(noise_profiles_journaled));
+  if (config_journal_flash.begin(CONFIG_JOURNAL_PATH, CONFIG_JOURNAL_SECTORS) == false) {
     if (debug_mode) {
-      USBSerial.printf("FAILED - %s\n", result.statusString());
-      USBSerial.println("Using default CONFIG values...");
+      USBSerial.println("FAILED - can't open " CONFIG_JOURNAL_PATH ", using default CONFIG values...");
     }
-    // Initialize with defaults when file doesn't exist or is corrupt
-    init_config_defaults();
-    save_config();  // Create the file with defaults
-    unlock_leds();
     return;
   }
 
-  if (debug_mode) {
-    USBSerial.printf("SUCCESS (%zu bytes)\n", bytes_read);
+  // Replays up to the first record that fails its CRC, CONFIG keeps its defaults for anything not saved
+  JournalMountResult result = config_journal.mount(CONFIG);
+  if (result == JOURNAL_FORMATTED) {
+    import_legacy_config_files();
   }
 
-  unlock_leds();
-}
-
-// Save noise calibration to LittleFS
-void save_ambient_noise_calibration() {
-  lock_leds();
   if (debug_mode) {
-    USBSerial.print("SAVING AMBIENT_NOISE PROFILE... ");
+    USBSerial.printf("%s (%lu records, %lu/%lu bytes)\n", journal_mount_names[result],
+                     config_journal.stats().replayed, config_journal.used(), config_journal.capacity());
   }
+}
 
+// Hand a snapshot of the noise calibration to save_task(), safe from the audio frame
+void save_ambient_noise_calibration() {
   // Convert noise samples to float array for saving
   float noise_float[NUM_FREQS];
   for (uint16_t i = 0; i < NUM_FREQS; i++) {
     noise_float[i] = float(noise_samples[i]);
   }
+  post_save(SAVE_NOISE_PROFILE, noise_float);
+  LOG_DEBUG("SAVING AMBIENT_NOISE PROFILE... QUEUED");
+}
+
+// Load noise calibration from what load_config() replayed
+void load_ambient_noise_calibration() {
+  if (debug_mode) {
+    USBSerial.print("LOADING AMBIENT_NOISE PROFILE... ");
+  }
+
+  if (config_journal.has_blob(JOURNAL_BLOB_NOISE_PROFILE) == false) {
+    if (debug_mode) {
+      USBSerial.println("NONE SAVED");
+    }
+    return;
+  }
+
+  // Convert back to SQ15x16 format
+  for (uint16_t i = 0; i < NUM_FREQS; i++) {
+    noise_samples[i] = SQ15x16(noise_profile_journaled[i]);
+  }
+  noise_floor.load(noise_profile_journaled);  // Tracking goes on from the saved floor
+
+  if (debug_mode) {
+    USBSerial.println("SUCCESS");
+  }
+}
+
+// The preset bank from what load_config() replayed, or the built-in themes
+void load_presets() {
+  if (config_journal.has_blob(JOURNAL_BLOB_PRESETS) && preset_bank.load(presets_journaled)) {
+    return;
+  }
+  load_builtin_presets();  // (presets.h)
+}
+
+// Hand a snapshot of the whole preset bank to save_task()
+bool save_presets() {
+  return post_save(SAVE_PRESETS, &preset_bank.image);
+}
+
+// The named noise profiles from what load_config() replayed, none if they
+// were saved for another number of bins
+void load_noise_profiles() {
+  if (config_journal.has_blob(JOURNAL_BLOB_NOISE_PROFILES) && noise_profiles_journaled.bins == NUM_FREQS) {
+    noise_profiles = noise_profiles_journaled;
+    return;
+  }
+  noise_profiles.clear();
+}
+
+// Hand a snapshot of all the noise profiles to save_task()
+bool save_noise_profiles() {
+  return post_save(SAVE_NOISE_PROFILES, &noise_profiles);
+}
+
+// Forget the saved noise calibration, noise_samples keeps it until reboot.
+// The erase is queued like a save
+bool delete_ambient_noise_calibration() {
+  return post_save(SAVE_NOISE_PROFILE, NULL);
+}
+
+void print_config_journal_status() {
+  const JournalStats& stats = config_journal.stats();
+  USBSerial.print("sbs((journal_bank=");
+  USBSerial.print(config_journal.mounted() ? config_journal.bank() : -1);
+  USBSerial.print(",used=");
+  USBSerial.print(config_journal.used());
+  USBSerial.print(",capacity=");
+  USBSerial.print(config_journal.capacity());
+  USBSerial.print(",records=");
+  USBSerial.print(stats.records);
+  USBSerial.print(",bytes=");
+  USBSerial.print(stats.bytes);
+  USBSerial.print(",compactions=");
+  USBSerial.print(stats.compactions);
+  USBSerial.print(",erases=");
+  USBSerial.print(stats.erases);
+  USBSerial.print(",replayed=");
+  USBSerial.print(stats.replayed);
+  USBSerial.print(",failures=");
+  USBSerial.print(stats.failures);
+  USBSerial.println("))");
+}
+
+void print_save_queue_status() {
+  const SaveQueueStats& stats = save_queue.stats();
+  USBSerial.print("sbs((save_queue=");
+  USBSerial.print(save_queue.depth());
+  USBSerial.print(",max_queue=");
+  USBSerial.print(stats.max_depth);
+  USBSerial.print(",posted=");
+  USBSerial.print(stats.posted);
+  USBSerial.print(",coalesced=");
+  USBSerial.print(stats.coalesced);
+  USBSerial.print(",written=");
+  USBSerial.print(stats.written);
+  USBSerial.print(",failed=");
+  USBSerial.print(stats.failed);
+  USBSerial.print(",save_us=");
+  USBSerial.print(stats.last_us);
+  USBSerial.print(",save_max_us=");
+  USBSerial.print(stats.max_us);
+  USBSerial.println("))");
+}
+
+// Save the pixel map layout (pixel_map.h) to LittleFS
+void save_pixel_layout() {
+  lock_leds();
+  if (debug_mode) {
+    USBSerial.print("SAVING PIXEL LAYOUT... ");
+  }
 
-  // Use SafeFile for atomic write with CRC32 validation
   auto result = Phase0::Filesystem::SafeFile::write(
-    "/noise_cal.bin",
-    noise_float,
-    sizeof(noise_float)
+    "/pixel_map.bin",
+    pixel_layout_text,
+    sizeof(pixel_layout_text)
   );
 
-  if (!result.ok()) {
-    if (debug_mode) {
+  if (debug_mode) {
+    if (!result.ok()) {
       USBSerial.printf("FAILED - %s\n", result.statusString());
-    }
-  } else {
-    if (debug_mode) {
+    } else {
       USBSerial.println("SUCCESS");
     }
   }
@@ -172,25 +551,23 @@ void save_ambient_noise_calibration() {
   unlock_leds();
 }
 
-// Load noise calibration from LittleFS
-void load_ambient_noise_calibration() {
+// Load the pixel map layout, leaving it empty (the default wiring) if there isn't one
+void load_pixel_layout() {
   lock_leds();
   if (debug_mode) {
-    USBSerial.print("LOADING AMBIENT_NOISE PROFILE... ");
+    USBSerial.print("LOADING PIXEL LAYOUT... ");
   }
 
-  // Load into float array first
-  float noise_float[NUM_FREQS];
   size_t bytes_read = 0;
-
   auto result = Phase0::Filesystem::SafeFile::read(
-    "/noise_cal.bin",
-    noise_float,
-    sizeof(noise_float),
+    "/pixel_map.bin",
+    pixel_layout_text,
+    sizeof(pixel_layout_text),
     &bytes_read
   );
 
   if (!result.ok()) {
+    pixel_layout_text[0] = '\0';
     if (debug_mode) {
       USBSerial.printf("FAILED - %s\n", result.statusString());
     }
@@ -198,11 +575,7 @@ void load_ambient_noise_calibration() {
     return;
   }
 
-  // Convert back to SQ15x16 format
-  for (uint16_t i = 0; i < NUM_FREQS; i++) {
-    noise_samples[i] = SQ15x16(noise_float[i]);
-  }
-
+  pixel_layout_text[sizeof(pixel_layout_text) - 1] = '\0';
   if (debug_mode) {
     USBSerial.println("SUCCESS");
   }
@@ -225,7 +598,12 @@ void init_fs() {
     USBSerial.println("Using defaults only (no persistence)");
   } else {
     USBSerial.println("SUCCESS");
+    load_config();
+    load_ambient_noise_calibration();
   }
+  load_presets();
+  load_noise_profiles();
+  init_save_task();
 
   unlock_leds();
 }
@@ -76,7 +76,7 @@ void check_buttons(uint32_t t_now) {
 
       if (press_duration <= 250 && skip_click == false) {
         if (mode_transition_queued == false) {
-          mode_transition_queued = true; // See run_transition_fade() in led_utilities.h
+          mode_transition_queued = true; // See begin_mode_transition() in mode_transition.h
           mode_destination = -1;
 
           save_config_delayed();
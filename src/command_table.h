@@ -0,0 +1,163 @@
+#ifndef COMMAND_TABLE_H
+#define COMMAND_TABLE_H
+
+/*----------------------------------------
+  Sensory Bridge COMMAND TABLE
+  ----------------------------------------*/
+
+// Finds a serial command by name in one probe. build_command_index() runs
+// at compile time over the command table (serial_menu.h) and returns a
+// perfect hash of its names: every name lands in a slot of its own, so a
+// lookup is one FNV-1a hash of the incoming name, one table read and one
+// strncmp() to make sure it really is that command.
+//
+// The hash is two levels ("hash and displace"): a name's hash picks a
+// bucket, and each bucket gets the first seed that moves all of its names
+// into slots nobody else has taken yet. Buckets are placed largest first.
+// Two rows with the same name can never be separated, build() reports it
+// by leaving «complete» false, which the table static_asserts on.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// FNV-1a over the first «length» characters
+constexpr uint32_t command_hash(const char* name, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= uint8_t(name[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+constexpr size_t command_name_length(const char* name) {
+  size_t length = 0;
+  while (name[length] != '\0') {
+    length++;
+  }
+  return length;
+}
+
+// Spreads «hash» differently for every seed
+constexpr uint32_t command_mix(uint32_t hash, uint8_t seed) {
+  uint32_t x = hash + uint32_t(seed) * 0x9E3779B9u;
+  x ^= x >> 16;
+  x *= 0x85EBCA6Bu;
+  x ^= x >> 13;
+  return x;
+}
+
+constexpr uint16_t command_pow2(size_t at_least) {
+  uint16_t size = 1;
+  while (size < at_least) {
+    size <<= 1;
+  }
+  return size;
+}
+
+template <size_t N>
+struct CommandIndex {
+  static_assert(N > 0 && N < 255, "CommandIndex stores entry numbers in a byte");
+
+  static constexpr uint16_t BUCKETS = command_pow2((N + 1) / 2);  // ~2 names each
+  static constexpr uint16_t SLOTS = command_pow2(N * 2);          // Under half full
+
+  uint8_t seeds[BUCKETS];
+  uint8_t slots[SLOTS];  // Entry number + 1, 0 when free
+  bool complete;
+
+  constexpr uint16_t slot_of(uint32_t hash) const {
+    return command_mix(hash, seeds[hash & (BUCKETS - 1)]) & (SLOTS - 1);
+  }
+
+  // The entry called «name» (the first «length» characters of it), NULL if none is
+  template <class Entry>
+  const Entry* find(const Entry* entries, const char* name, size_t length) const {
+    uint8_t number = slots[slot_of(command_hash(name, length))];
+    if (number == 0) {
+      return NULL;
+    }
+    const Entry* entry = &entries[number - 1];
+    if (strncmp(entry->name, name, length) != 0 || entry->name[length] != '\0') {
+      return NULL;
+    }
+    return entry;
+  }
+};
+
+// «entries» needs a «name» member, nothing else is looked at
+template <class Entry, size_t N>
+constexpr CommandIndex<N> build_command_index(const Entry (&entries)[N]) {
+  typedef CommandIndex<N> Index;
+  Index index = {};
+
+  uint32_t hashes[N] = {};
+  uint16_t bucket_sizes[Index::BUCKETS] = {};
+  for (size_t i = 0; i < N; i++) {
+    hashes[i] = command_hash(entries[i].name, command_name_length(entries[i].name));
+    bucket_sizes[hashes[i] & (Index::BUCKETS - 1)]++;
+  }
+
+  // Largest buckets first, while most slots are still free
+  uint16_t order[Index::BUCKETS] = {};
+  for (uint16_t b = 0; b < Index::BUCKETS; b++) {
+    order[b] = b;
+  }
+  for (uint16_t a = 0; a < Index::BUCKETS; a++) {
+    for (uint16_t b = a + 1; b < Index::BUCKETS; b++) {
+      if (bucket_sizes[order[b]] > bucket_sizes[order[a]]) {
+        uint16_t swap = order[a];
+        order[a] = order[b];
+        order[b] = swap;
+      }
+    }
+  }
+
+  for (uint16_t o = 0; o < Index::BUCKETS; o++) {
+    uint16_t bucket = order[o];
+    if (bucket_sizes[bucket] == 0) {
+      break;
+    }
+
+    bool placed = false;
+    for (uint16_t seed = 0; seed < 256 && placed == false; seed++) {
+      uint16_t taken[N] = {};
+      uint16_t num_taken = 0;
+      bool fits = true;
+      for (size_t i = 0; i < N && fits; i++) {
+        if ((hashes[i] & (Index::BUCKETS - 1)) != bucket) {
+          continue;
+        }
+        uint16_t slot = command_mix(hashes[i], uint8_t(seed)) & (Index::SLOTS - 1);
+        fits = (index.slots[slot] == 0);
+        for (uint16_t t = 0; t < num_taken && fits; t++) {
+          fits = (taken[t] != slot);
+        }
+        taken[num_taken++] = slot;
+      }
+      if (fits == false) {
+        continue;
+      }
+
+      index.seeds[bucket] = uint8_t(seed);
+      for (size_t i = 0; i < N; i++) {
+        if ((hashes[i] & (Index::BUCKETS - 1)) == bucket) {
+          index.slots[command_mix(hashes[i], uint8_t(seed)) & (Index::SLOTS - 1)] = uint8_t(i + 1);
+        }
+      }
+      placed = true;
+    }
+
+    if (placed == false) {
+      return index;  // Incomplete: duplicate names, or a bucket no seed can place
+    }
+  }
+
+  index.complete = true;
+  return index;
+}
+
+#endif // COMMAND_TABLE_H
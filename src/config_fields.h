@@ -0,0 +1,311 @@
+#ifndef CONFIG_FIELDS_H
+#define CONFIG_FIELDS_H
+
+/*----------------------------------------
+  Sensory Bridge CONFIG FIELDS
+  ----------------------------------------*/
+
+// The CONFIG struct, and a table of its fields so code can work on them
+// one at a time. Each field has an ID (CFG_LED_COUNT...), and a set of
+// fields is a ConfigMask with one bit per ID. config_diff() reports which
+// fields differ between two configs, and config_copy_fields() copies just
+// those. A batch of serial edits uses these to apply only what it changed
+// (config_transaction.h).
+//
+// IDs are positions in this firmware only. What's saved (config_journal.h,
+// preset_bank.h) names a field by its key instead, a hash of its name, as
+// entries of a key, a size and the value. config_pack() writes those and
+// config_unpack() reads them back, taking each field that still exists
+// with the same size and skipping the rest. So fields can be added,
+// removed or moved without losing the others.
+//
+// A new CONFIG field gets a line in CONFIG_FIELD_LIST as well, in the
+// same order. config_fields_cover_struct() fails the build if a field was
+// skipped.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace SensoryBridge {
+namespace Config {
+
+struct conf {
+  // Synced values
+  float   PHOTONS;
+  float   CHROMA;
+  float   MOOD;
+  uint8_t LIGHTSHOW_MODE;
+  bool    MIRROR_ENABLED;
+
+  // Private values
+  uint32_t SAMPLE_RATE;
+  uint8_t  NOTE_OFFSET;
+  uint8_t  SQUARE_ITER;
+  uint8_t  LED_TYPE;
+  uint16_t LED_COUNT;
+  uint16_t LED_COLOR_ORDER;
+  bool     LED_INTERPOLATION;
+  uint16_t SAMPLES_PER_CHUNK;
+  float    SENSITIVITY;
+  bool     BOOT_ANIMATION;
+  uint32_t SWEET_SPOT_MIN_LEVEL;
+  uint32_t SWEET_SPOT_MAX_LEVEL;
+  int32_t  DC_OFFSET;
+  uint8_t  CHROMAGRAM_RANGE;
+  bool     STANDBY_DIMMING;
+  bool     REVERSE_ORDER;
+  uint32_t MAX_CURRENT_MA;
+  bool     TEMPORAL_DITHERING;
+  bool     AUTO_COLOR_SHIFT;
+  float    INCANDESCENT_FILTER;
+  bool     INCANDESCENT_MODE;
+  float    BULB_OPACITY;
+  float    SATURATION;
+  float    PRISM_COUNT;
+  bool     BASE_COAT;
+  float    VU_LEVEL_FLOOR;
+  uint8_t  RENDER_MODE;
+  uint16_t MODE_FADE_MS;
+};
+
+// Defaults will be defined outside namespace
+
+} // namespace Config
+} // namespace SensoryBridge
+
+#define CONFIG_FIELD_LIST(X) \
+  X(PHOTONS)                 \
+  X(CHROMA)                  \
+  X(MOOD)                    \
+  X(LIGHTSHOW_MODE)          \
+  X(MIRROR_ENABLED)          \
+  X(SAMPLE_RATE)             \
+  X(NOTE_OFFSET)             \
+  X(SQUARE_ITER)             \
+  X(LED_TYPE)                \
+  X(LED_COUNT)               \
+  X(LED_COLOR_ORDER)         \
+  X(LED_INTERPOLATION)       \
+  X(SAMPLES_PER_CHUNK)       \
+  X(SENSITIVITY)             \
+  X(BOOT_ANIMATION)          \
+  X(SWEET_SPOT_MIN_LEVEL)    \
+  X(SWEET_SPOT_MAX_LEVEL)    \
+  X(DC_OFFSET)               \
+  X(CHROMAGRAM_RANGE)        \
+  X(STANDBY_DIMMING)         \
+  X(REVERSE_ORDER)           \
+  X(MAX_CURRENT_MA)          \
+  X(TEMPORAL_DITHERING)      \
+  X(AUTO_COLOR_SHIFT)        \
+  X(INCANDESCENT_FILTER)     \
+  X(INCANDESCENT_MODE)       \
+  X(BULB_OPACITY)            \
+  X(SATURATION)              \
+  X(PRISM_COUNT)             \
+  X(BASE_COAT)               \
+  X(VU_LEVEL_FLOOR)          \
+  X(RENDER_MODE)             \
+  X(MODE_FADE_MS)
+
+enum ConfigField : uint8_t {
+#define CONFIG_FIELD_ID(name) CFG_##name,
+  CONFIG_FIELD_LIST(CONFIG_FIELD_ID)
+#undef CONFIG_FIELD_ID
+  NUM_CONFIG_FIELDS
+};
+
+typedef uint64_t ConfigMask;
+static_assert(NUM_CONFIG_FIELDS <= 64, "ConfigMask has one bit per CONFIG field");
+
+#define CONFIG_MASK(name) (ConfigMask(1) << CFG_##name)
+#define CONFIG_MASK_ALL   ((NUM_CONFIG_FIELDS == 64) ? ~ConfigMask(0) : (ConfigMask(1) << NUM_CONFIG_FIELDS) - 1)
+
+struct ConfigFieldInfo {
+  const char* name;
+  uint16_t offset;
+  uint8_t size;
+  uint16_t key;  // What it's saved as
+};
+
+// FNV-1a of the name, folded to 16 bits
+constexpr uint16_t config_key(const char* name) {
+  uint32_t hash = 2166136261u;
+  for (; *name != '\0'; name++) {
+    hash = (hash ^ uint8_t(*name)) * 16777619u;
+  }
+  return uint16_t(hash ^ (hash >> 16));
+}
+
+constexpr ConfigFieldInfo config_fields[NUM_CONFIG_FIELDS] = {
+#define CONFIG_FIELD_INFO(name) \
+  { #name, offsetof(SensoryBridge::Config::conf, name), sizeof(SensoryBridge::Config::conf::name), config_key(#name) },
+  CONFIG_FIELD_LIST(CONFIG_FIELD_INFO)
+#undef CONFIG_FIELD_INFO
+};
+
+// Fields in struct order, nothing left out bigger than the padding between them
+constexpr bool config_fields_cover_struct() {
+  size_t end = 0;
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    if (config_fields[f].offset < end || config_fields[f].offset - end >= config_fields[f].size) {
+      return false;
+    }
+    end = config_fields[f].offset + config_fields[f].size;
+  }
+  return sizeof(SensoryBridge::Config::conf) - end < alignof(SensoryBridge::Config::conf);
+}
+static_assert(config_fields_cover_struct(), "CONFIG_FIELD_LIST is missing a CONFIG field, or is out of order");
+
+constexpr bool config_keys_unique() {
+  for (uint8_t a = 0; a < NUM_CONFIG_FIELDS; a++) {
+    for (uint8_t b = a + 1; b < NUM_CONFIG_FIELDS; b++) {
+      if (config_fields[a].key == config_fields[b].key) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+static_assert(config_keys_unique(), "Two CONFIG field names hash to the same key, rename one");
+
+// Changes whenever a field is added, removed, moved or resized
+constexpr uint32_t config_layout_hash() {
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    for (const char* c = config_fields[f].name; *c != '\0'; c++) {
+      hash = (hash ^ uint8_t(*c)) * 16777619u;
+    }
+    hash = (hash ^ config_fields[f].offset) * 16777619u;
+    hash = (hash ^ config_fields[f].size) * 16777619u;
+  }
+  return hash;
+}
+
+inline const void* config_field_ptr(const SensoryBridge::Config::conf& config, uint8_t field) {
+  return (const uint8_t*)&config + config_fields[field].offset;
+}
+
+inline void* config_field_ptr(SensoryBridge::Config::conf& config, uint8_t field) {
+  return (uint8_t*)&config + config_fields[field].offset;
+}
+
+// The field «address» points into within «config», NUM_CONFIG_FIELDS if none
+inline uint8_t config_field_at(const SensoryBridge::Config::conf& config, const void* address) {
+  const uint8_t* at = (const uint8_t*)address;
+  const uint8_t* base = (const uint8_t*)&config;
+  if (at < base || at >= base + sizeof(config)) {
+    return NUM_CONFIG_FIELDS;
+  }
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    if (size_t(at - base) == config_fields[f].offset) {
+      return f;
+    }
+  }
+  return NUM_CONFIG_FIELDS;
+}
+
+// Fields whose value differs between «a» and «b», of those in «mask»
+inline ConfigMask config_diff(const SensoryBridge::Config::conf& a, const SensoryBridge::Config::conf& b,
+                              ConfigMask mask = CONFIG_MASK_ALL) {
+  ConfigMask changed = 0;
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    if ((mask & (ConfigMask(1) << f)) == 0) {
+      continue;
+    }
+    if (memcmp(config_field_ptr(a, f), config_field_ptr(b, f), config_fields[f].size) != 0) {
+      changed |= ConfigMask(1) << f;
+    }
+  }
+  return changed;
+}
+
+// Copy the fields in «mask» from «from» to «to», each with one store where it fits
+inline void config_copy_fields(SensoryBridge::Config::conf& to, const SensoryBridge::Config::conf& from, ConfigMask mask) {
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    if (mask & (ConfigMask(1) << f)) {
+      memcpy(config_field_ptr(to, f), config_field_ptr(from, f), config_fields[f].size);
+    }
+  }
+}
+
+// Take the fields that lie whole inside the first «size» bytes of «image»,
+// a CONFIG saved by an older firmware when fields were only ever appended.
+// The rest of «config» is left as it is. The fields taken
+inline ConfigMask config_from_prefix(SensoryBridge::Config::conf& config, const void* image, size_t size) {
+  ConfigMask taken = 0;
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    if (config_fields[f].offset + config_fields[f].size > size) {
+      break;
+    }
+    memcpy(config_field_ptr(config, f), (const uint8_t*)image + config_fields[f].offset, config_fields[f].size);
+    taken |= ConfigMask(1) << f;
+  }
+  return taken;
+}
+
+// Saved entries: key (little endian), size, then «size» bytes of value
+#define CONFIG_ENTRY_HEADER 3
+#define CONFIG_PACKED_MAX   (NUM_CONFIG_FIELDS * CONFIG_ENTRY_HEADER + sizeof(SensoryBridge::Config::conf))
+
+// The field an entry header names, NUM_CONFIG_FIELDS if this firmware has
+// none by that key and size
+inline uint8_t config_entry_field(const uint8_t* entry) {
+  uint16_t key = entry[0] | (uint16_t(entry[1]) << 8);
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    if (config_fields[f].key == key) {
+      return (config_fields[f].size == entry[2]) ? f : uint8_t(NUM_CONFIG_FIELDS);
+    }
+  }
+  return uint8_t(NUM_CONFIG_FIELDS);
+}
+
+// Entries for the fields of «config» in «mask», into «out» (up to
+// CONFIG_PACKED_MAX bytes). The bytes written
+inline uint16_t config_pack(const SensoryBridge::Config::conf& config, ConfigMask mask, uint8_t* out) {
+  uint16_t length = 0;
+  for (uint8_t f = 0; f < NUM_CONFIG_FIELDS; f++) {
+    if (mask & (ConfigMask(1) << f)) {
+      out[length++] = uint8_t(config_fields[f].key);
+      out[length++] = uint8_t(config_fields[f].key >> 8);
+      out[length++] = config_fields[f].size;
+      memcpy(out + length, config_field_ptr(config, f), config_fields[f].size);
+      length += config_fields[f].size;
+    }
+  }
+  return length;
+}
+
+// Read entries back into «config». Entries for fields this firmware
+// doesn't have, or has at another size, are skipped. The fields taken
+inline ConfigMask config_unpack(SensoryBridge::Config::conf& config, const uint8_t* in, uint16_t length) {
+  ConfigMask taken = 0;
+  uint16_t at = 0;
+  while (at + CONFIG_ENTRY_HEADER <= length) {
+    const uint8_t* entry = in + at;
+    at += CONFIG_ENTRY_HEADER;
+    if (at + entry[2] > length) {
+      break;
+    }
+    uint8_t f = config_entry_field(entry);
+    if (f < NUM_CONFIG_FIELDS) {
+      memcpy(config_field_ptr(config, f), in + at, entry[2]);
+      taken |= ConfigMask(1) << f;
+    }
+    at += entry[2];
+  }
+  return taken;
+}
+
+inline uint8_t config_mask_count(ConfigMask mask) {
+  uint8_t count = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    count++;
+  }
+  return count;
+}
+
+#endif // CONFIG_FIELDS_H
@@ -0,0 +1,446 @@
+#ifndef CONFIG_JOURNAL_H
+#define CONFIG_JOURNAL_H
+
+/*----------------------------------------
+  Sensory Bridge CONFIG JOURNAL
+  ----------------------------------------*/
+
+// Saves CONFIG (and a few blobs, like the noise profile) as an append-only
+// log, instead of rewriting whole files. A save appends one record holding
+// just the fields that changed since the last one: each field's key, size
+// and new value (config_pack(), config_fields.h), usually a dozen bytes.
+//
+// The log lives in flash split into two banks. Only one bank is active at a
+// time. When the active bank is full, compaction erases the other bank,
+// writes a snapshot of every field and blob into it, and programs that
+// bank's header last. Until that header is written, the old bank is still
+// the newest valid one. Each compaction erases one bank, so the wear is
+// spread over both.
+//
+// At boot, mount() finds the newest bank whose header checks out and
+// replays its records in order, stopping at the first one whose CRC
+// doesn't match. Power lost during a save therefore loses at most that
+// save: a record is all there or not at all. A torn record leaves
+// programmed bytes where the next append would go, so mount() compacts
+// right away after finding one. Fields are found by key, so after an
+// update that added, removed or moved CONFIG fields (config_layout_hash()
+// differs) the fields that still exist are replayed, new ones keep their
+// defaults, and mount() compacts into the new layout.
+//
+// JournalFlash is the flash underneath. It behaves like NOR flash: erase
+// sets a whole sector to 0xFF, and program only ever clears bits. A
+// backend may hold programs back until sync(), which the journal calls
+// once per record, and before and after a compaction's header. The device
+// keeps it in LittleFS files and writes each record with one flush
+// (bridge_fs.h).
+// test/mocks/mock_journal_flash.h can cut the power in the middle of any
+// program or erase.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config_fields.h"
+#include "crc32.h"
+
+#define JOURNAL_MAGIC     0x4C4E524A  // "JRNL"
+#define JOURNAL_MAX_BLOBS 4
+
+class JournalFlash {
+ public:
+  virtual ~JournalFlash() {}
+
+  virtual uint32_t sector_size() const = 0;
+  virtual uint32_t num_sectors() const = 0;
+
+  virtual bool read(uint32_t address, void* data, uint32_t length) = 0;
+
+  // Only clears bits, the bytes are expected to be erased already
+  virtual bool program(uint32_t address, const void* data, uint32_t length) = 0;
+
+  // Sets the whole sector back to 0xFF
+  virtual bool erase(uint32_t sector) = 0;
+
+  // Make everything programmed so far durable. For flash that programs
+  // straight through there's nothing to do
+  virtual bool sync() { return true; }
+};
+
+enum JournalRecordKind : uint8_t {
+  JOURNAL_FIELDS = 1,      // Field entries, config_pack()
+  JOURNAL_BLOB = 2,        // A registered blob, whole
+  JOURNAL_BLOB_ERASE = 3,  // A registered blob, deleted
+};
+
+struct JournalBankHeader {
+  uint32_t magic;
+  uint32_t sequence;  // Newer bank has the higher one
+  uint32_t layout;    // config_layout_hash() of the firmware that wrote it, another one compacts
+  uint32_t crc;
+};
+
+struct JournalRecordHeader {
+  uint8_t kind;
+  uint8_t id;       // Blob ID, unused by JOURNAL_FIELDS
+  uint16_t length;  // Payload bytes, the record is padded to 4 and ends in a CRC
+};
+
+enum JournalMountResult {
+  JOURNAL_MOUNTED,    // Replayed cleanly
+  JOURNAL_RECOVERED,  // Replayed up to a torn record or another layout, then compacted
+  JOURNAL_FORMATTED,  // Nothing valid found, started over from what was passed in
+  JOURNAL_FAILED      // Flash errors, nothing is saved
+};
+
+struct JournalStats {
+  uint32_t records;      // Appended since boot
+  uint32_t bytes;        // Programmed since boot, compactions included
+  uint32_t compactions;
+  uint32_t erases;       // Sectors
+  uint32_t replayed;     // Records read back by mount()
+  uint32_t failures;     // Flash operations that reported an error
+};
+
+struct JournalBlob {
+  uint8_t id;
+  void* data;  // The journal's copy, what's on flash
+  uint16_t size;
+  bool present;
+};
+
+class ConfigJournal {
+ public:
+  ConfigJournal(JournalFlash& flash_, uint16_t sectors_per_bank)
+      : flash(flash_), bank_sectors(sectors_per_bank), active(NO_BANK), sequence(0), head(0),
+        num_blobs(0), saved(), blobs(), journal_stats() {}
+
+  // Before mount(). «data» is the journal's own copy: save_blob() copies
+  // into it and mount() replays into it
+  bool add_blob(uint8_t id, void* data, uint16_t size) {
+    if (num_blobs >= JOURNAL_MAX_BLOBS || size == 0 || record_size(size) > bank_bytes() / 2) {
+      return false;
+    }
+    blobs[num_blobs++] = { id, data, size, false };
+    return true;
+  }
+
+  // «config» holds the defaults going in, and what was saved coming out
+  JournalMountResult mount(SensoryBridge::Config::conf& config) {
+    saved = config;
+    active = NO_BANK;
+    if (bank_bytes() == 0 || flash.num_sectors() < 2u * bank_sectors) {
+      return JOURNAL_FAILED;
+    }
+
+    JournalBankHeader headers[2];
+    bool valid[2] = { read_bank_header(0, headers[0]), read_bank_header(1, headers[1]) };
+    int8_t newest = -1;
+    if (valid[0] && valid[1]) {
+      newest = (int32_t(headers[1].sequence - headers[0].sequence) > 0) ? 1 : 0;
+    } else if (valid[0] || valid[1]) {
+      newest = valid[0] ? 0 : 1;
+    }
+
+    if (newest < 0) {
+      return compact() ? JOURNAL_FORMATTED : JOURNAL_FAILED;
+    }
+
+    active = newest;
+    sequence = headers[newest].sequence;
+    bool same_layout = (headers[newest].layout == config_layout_hash());
+    bool clean = replay();
+    config = saved;
+
+    if (clean && same_layout) {
+      return JOURNAL_MOUNTED;
+    }
+    return compact() ? JOURNAL_RECOVERED : JOURNAL_FAILED;
+  }
+
+  // Append the fields of «config» that differ from what was last saved
+  bool save_config(const SensoryBridge::Config::conf& config) {
+    ConfigMask changed = config_diff(config, saved);
+    if (changed == 0) {
+      return active != NO_BANK;
+    }
+    config_copy_fields(saved, config, changed);
+    uint16_t length = pack_fields(changed);
+    return append(JOURNAL_FIELDS, 0, scratch, length);
+  }
+
+  bool save_blob(uint8_t id, const void* data) {
+    JournalBlob* blob = find_blob(id);
+    if (blob == NULL) {
+      return false;
+    }
+    if (blob->present && memcmp(blob->data, data, blob->size) == 0) {
+      return active != NO_BANK;
+    }
+    memcpy(blob->data, data, blob->size);
+    blob->present = true;
+    return append(JOURNAL_BLOB, id, blob->data, blob->size);
+  }
+
+  bool erase_blob(uint8_t id) {
+    JournalBlob* blob = find_blob(id);
+    if (blob == NULL) {
+      return false;
+    }
+    if (blob->present == false) {
+      return active != NO_BANK;
+    }
+    blob->present = false;
+    return append(JOURNAL_BLOB_ERASE, id, NULL, 0);
+  }
+
+  // Whether mount() or save_blob() left a copy of blob «id» in the journal
+  bool has_blob(uint8_t id) const {
+    for (uint8_t b = 0; b < num_blobs; b++) {
+      if (blobs[b].id == id) {
+        return blobs[b].present;
+      }
+    }
+    return false;
+  }
+
+  // Start over with «config» and no blobs (factory reset)
+  bool format(const SensoryBridge::Config::conf& config) {
+    saved = config;
+    for (uint8_t b = 0; b < num_blobs; b++) {
+      blobs[b].present = false;
+    }
+    return compact();
+  }
+
+  // Move the newest copy of everything into the other bank now
+  bool compact() {
+    uint32_t snapshot = sizeof(JournalBankHeader) + record_size(pack_fields(CONFIG_MASK_ALL));
+    for (uint8_t b = 0; b < num_blobs; b++) {
+      snapshot += blobs[b].present ? record_size(blobs[b].size) : 0;
+    }
+    if (snapshot > bank_bytes()) {
+      return false;
+    }
+
+    uint8_t target = (active == 0) ? 1 : 0;
+    uint32_t base = bank_base(target);
+
+    for (uint32_t s = 0; s < bank_sectors; s++) {
+      if (flash.erase(target * bank_sectors + s) == false) {
+        return failed();
+      }
+      journal_stats.erases++;
+    }
+
+    uint32_t at = base + sizeof(JournalBankHeader);
+    uint16_t length = pack_fields(CONFIG_MASK_ALL);
+    if (write_record(at, JOURNAL_FIELDS, 0, scratch, length) == false) {
+      return false;
+    }
+    at += record_size(length);
+    for (uint8_t b = 0; b < num_blobs; b++) {
+      if (blobs[b].present) {
+        if (write_record(at, JOURNAL_BLOB, blobs[b].id, blobs[b].data, blobs[b].size) == false) {
+          return false;
+        }
+        at += record_size(blobs[b].size);
+      }
+    }
+    if (flash.sync() == false) {
+      return failed();
+    }
+
+    // The header goes last, until it's there the other bank is still the newest
+    JournalBankHeader header = { JOURNAL_MAGIC, sequence + 1, config_layout_hash(), 0 };
+    header.crc = crc32(&header, offsetof(JournalBankHeader, crc));
+    if (flash.program(base, &header, sizeof(header)) == false || flash.sync() == false) {
+      return failed();
+    }
+    journal_stats.bytes += sizeof(header);
+    journal_stats.compactions++;
+
+    active = target;
+    sequence = header.sequence;
+    head = at;
+    return true;
+  }
+
+  bool mounted() const { return active != NO_BANK; }
+  uint8_t bank() const { return active; }
+  uint32_t used() const { return (active == NO_BANK) ? 0 : head - bank_base(active); }
+  uint32_t capacity() const { return bank_bytes(); }
+  const JournalStats& stats() const { return journal_stats; }
+
+  // Bytes a record with a «length» byte payload takes in the log
+  static uint32_t record_size(uint32_t length) {
+    return sizeof(JournalRecordHeader) + ((length + 3) & ~3u) + sizeof(uint32_t);
+  }
+
+ private:
+  static const uint8_t NO_BANK = 0xFF;
+
+  JournalFlash& flash;
+  uint16_t bank_sectors;
+  uint8_t active;
+  uint32_t sequence;
+  uint32_t head;  // Where the next record goes, in the active bank
+  uint8_t num_blobs;
+
+  SensoryBridge::Config::conf saved;  // CONFIG as the journal has it
+  JournalBlob blobs[JOURNAL_MAX_BLOBS];
+  JournalStats journal_stats;
+  uint8_t scratch[CONFIG_PACKED_MAX];
+
+  uint32_t bank_bytes() const { return uint32_t(bank_sectors) * flash.sector_size(); }
+  uint32_t bank_base(uint8_t bank) const { return bank * bank_bytes(); }
+
+  bool failed() {
+    journal_stats.failures++;
+    return false;
+  }
+
+  JournalBlob* find_blob(uint8_t id) {
+    for (uint8_t b = 0; b < num_blobs; b++) {
+      if (blobs[b].id == id) {
+        return &blobs[b];
+      }
+    }
+    return NULL;
+  }
+
+  // Entries for the fields in «mask», from «saved» into «scratch»
+  uint16_t pack_fields(ConfigMask mask) {
+    return config_pack(saved, mask, scratch);
+  }
+
+  // The entries of the fields record at «at» into «saved», straight from
+  // flash: one saved by a newer firmware can be longer than «scratch»
+  bool replay_fields(uint32_t at, uint16_t length) {
+    uint32_t end = at + length;
+    while (at + CONFIG_ENTRY_HEADER <= end) {
+      uint8_t entry[CONFIG_ENTRY_HEADER];
+      if (flash.read(at, entry, sizeof(entry)) == false) {
+        return failed();
+      }
+      at += sizeof(entry);
+      if (at + entry[2] > end) {
+        break;
+      }
+      uint8_t f = config_entry_field(entry);
+      if (f < NUM_CONFIG_FIELDS && flash.read(at, config_field_ptr(saved, f), entry[2]) == false) {
+        return failed();
+      }
+      at += entry[2];
+    }
+    return true;
+  }
+
+  bool read_bank_header(uint8_t bank, JournalBankHeader& header) {
+    if (flash.read(bank_base(bank), &header, sizeof(header)) == false) {
+      return failed();
+    }
+    return header.magic == JOURNAL_MAGIC && header.crc == crc32(&header, offsetof(JournalBankHeader, crc));
+  }
+
+  // Header, payload and CRC, in that order. Power lost part way leaves a
+  // record whose CRC doesn't match, which replay() stops at
+  bool write_record(uint32_t at, uint8_t kind, uint8_t id, const void* payload, uint16_t length) {
+    JournalRecordHeader header = { kind, id, length };
+    uint32_t crc = crc32_update(CRC32_INIT, &header, sizeof(header));
+    crc = crc32_final(crc32_update(crc, payload, length));
+
+    if (flash.program(at, &header, sizeof(header)) == false) {
+      return failed();
+    }
+    if (length > 0 && flash.program(at + sizeof(header), payload, length) == false) {
+      return failed();
+    }
+    if (flash.program(at + record_size(length) - sizeof(crc), &crc, sizeof(crc)) == false) {
+      return failed();
+    }
+    journal_stats.bytes += sizeof(header) + length + sizeof(crc);
+    return true;
+  }
+
+  bool append(uint8_t kind, uint8_t id, const void* payload, uint16_t length) {
+    if (active == NO_BANK) {
+      return compact();  // The snapshot has this change in it already
+    }
+    if (head + record_size(length) > bank_base(active) + bank_bytes()) {
+      return compact();
+    }
+    bool written = write_record(head, kind, id, payload, length) && (flash.sync() || failed());
+    if (written == false) {
+      active = NO_BANK;  // Don't append after a record that may be half there
+      return false;
+    }
+    head += record_size(length);
+    journal_stats.records++;
+    return true;
+  }
+
+  // Apply the active bank's records to «saved» and the blobs, in order.
+  // False if it stopped at a torn record rather than erased flash
+  bool replay() {
+    uint32_t end = bank_base(active) + bank_bytes();
+    head = bank_base(active) + sizeof(JournalBankHeader);
+
+    while (head + record_size(0) <= end) {
+      JournalRecordHeader header;
+      if (flash.read(head, &header, sizeof(header)) == false) {
+        return failed();
+      }
+      if (header.kind == 0xFF && header.id == 0xFF && header.length == 0xFFFF) {
+        return true;  // Erased, the end of the log
+      }
+      if (head + record_size(header.length) > end) {
+        return false;
+      }
+
+      // CRC over the payload a piece at a time. The payload is applied
+      // only once the whole record has checked out
+      uint32_t crc = crc32_update(CRC32_INIT, &header, sizeof(header));
+      uint8_t staging[64];
+      for (uint16_t done = 0; done < header.length;) {
+        uint16_t chunk = header.length - done;
+        if (chunk > sizeof(staging)) {
+          chunk = sizeof(staging);
+        }
+        if (flash.read(head + sizeof(header) + done, staging, chunk) == false) {
+          return failed();
+        }
+        crc = crc32_update(crc, staging, chunk);
+        done += chunk;
+      }
+      uint32_t stored;
+      if (flash.read(head + record_size(header.length) - sizeof(stored), &stored, sizeof(stored)) == false) {
+        return failed();
+      }
+      if (stored != crc32_final(crc)) {
+        return false;
+      }
+
+      JournalBlob* blob = find_blob(header.id);
+      if (header.kind == JOURNAL_FIELDS) {
+        if (replay_fields(head + sizeof(header), header.length) == false) {
+          return false;
+        }
+      } else if (header.kind == JOURNAL_BLOB && blob != NULL && header.length == blob->size) {
+        if (flash.read(head + sizeof(header), blob->data, blob->size) == false) {
+          return failed();
+        }
+        blob->present = true;
+      } else if (header.kind == JOURNAL_BLOB_ERASE && blob != NULL) {
+        blob->present = false;
+      }
+
+      head += record_size(header.length);
+      journal_stats.replayed++;
+    }
+    return true;
+  }
+};
+
+#endif // CONFIG_JOURNAL_H
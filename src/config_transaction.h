@@ -0,0 +1,190 @@
+#ifndef CONFIG_TRANSACTION_H
+#define CONFIG_TRANSACTION_H
+
+/*----------------------------------------
+  Sensory Bridge CONFIG TRANSACTION
+  ----------------------------------------*/
+
+// Batches serial setting changes. "begin" opens a transaction. Setters
+// then write config_shadow instead of CONFIG, and save nothing. "commit"
+// checks the shadow as a whole (validate_config()) and hands over only the
+// fields the batch changed. led_thread copies them into CONFIG at the top
+// of its next frame, where begin_mode_transition() picks up mode changes,
+// so a frame sees all of the batch or none of it. "abort" drops the batch.
+//
+// The edits' side effects are merged: each apply hook runs once, and
+// CONFIG is saved once. CONFIG_TRANSACTION_MAX_HOOKS has room for every
+// distinct hook in the command table (static_assert in serial_menu.h); a
+// batch that still gathers more is refused at commit rather than
+// committed without some of them. If any edit only takes effect at boot, commit
+// applies the batch right away instead, saves it, and reboots once.
+//
+// Fields the batch didn't touch aren't copied, so knob and encoder moves
+// made while it was open survive the commit.
+
+#include <atomic>
+#include "globals.h"
+#include "config_fields.h"
+
+#define CONFIG_TRANSACTION_MAX_HOOKS 8  // Distinct apply hooks one batch can gather
+
+enum ConfigCommitResult {
+  CONFIG_COMMIT_QUEUED,    // led_thread applies it next frame
+  CONFIG_COMMIT_REBOOT,    // Applied to CONFIG now, caller saves and reboots
+  CONFIG_COMMIT_EMPTY,     // Nothing changed
+  CONFIG_COMMIT_INVALID,   // validate_config() refused it, still open
+  CONFIG_COMMIT_BUSY,      // The last commit hasn't been applied yet, still open
+  CONFIG_COMMIT_NOT_OPEN
+};
+
+struct ConfigCommit {
+  SensoryBridge::Config::conf values;
+  ConfigMask changed;
+  bool save_now;  // save_config() rather than save_config_delayed()
+  uint8_t num_hooks;
+  void (*hooks[CONFIG_TRANSACTION_MAX_HOOKS])();
+};
+
+// Serial side (core 0)
+bool config_transaction_open = false;
+SensoryBridge::Config::conf config_shadow;  // Where edits go while open
+SensoryBridge::Config::conf config_base;    // CONFIG as it was at "begin"
+ConfigCommit config_staged;                 // Side effects gathered so far
+bool config_staged_reboot = false;
+bool config_staged_overflow = false;        // An apply hook didn't fit config_staged.hooks
+
+// Handed to led_thread
+ConfigCommit config_commit;
+std::atomic<bool> config_commit_queued(false);
+uint32_t config_commits_applied = 0;
+
+// Where CONFIG edits go right now
+SensoryBridge::Config::conf& staged_config() {
+  return config_transaction_open ? config_shadow : CONFIG;
+}
+
+void begin_config_transaction() {
+  config_shadow = CONFIG;
+  config_base = CONFIG;
+  config_staged.num_hooks = 0;
+  config_staged.save_now = false;
+  config_staged_reboot = false;
+  config_staged_overflow = false;
+  config_transaction_open = true;
+}
+
+void abort_config_transaction() {
+  config_transaction_open = false;
+}
+
+// Merge one staged edit's side effects into the batch. False if its hook
+// didn't fit, which fails the commit
+bool stage_config_effects(bool save_now, bool reboot, void (*hook)()) {
+  config_staged.save_now |= save_now;
+  config_staged_reboot |= reboot;
+  if (hook == NULL) {
+    return true;
+  }
+  for (uint8_t i = 0; i < config_staged.num_hooks; i++) {
+    if (config_staged.hooks[i] == hook) {
+      return true;
+    }
+  }
+  if (config_staged.num_hooks >= CONFIG_TRANSACTION_MAX_HOOKS) {
+    config_staged_overflow = true;
+    return false;
+  }
+  config_staged.hooks[config_staged.num_hooks++] = hook;
+  return true;
+}
+
+// Checks across fields the setters can't make one at a time, NULL if
+// «config» is fine. Only the checks on a field in «changed» run, so a
+// batch isn't refused over something it didn't touch
+const char* validate_config(const SensoryBridge::Config::conf& config, ConfigMask changed) {
+  if ((changed & (CONFIG_MASK(SWEET_SPOT_MIN_LEVEL) | CONFIG_MASK(SWEET_SPOT_MAX_LEVEL))) &&
+      config.SWEET_SPOT_MIN_LEVEL >= config.SWEET_SPOT_MAX_LEVEL) {
+    return "sweet_spot_min must be below sweet_spot_max";
+  }
+  if ((changed & CONFIG_MASK(SAMPLES_PER_CHUNK)) && config.SAMPLES_PER_CHUNK == 0) {
+    return "samples_per_chunk can't be 0";
+  }
+  if ((changed & CONFIG_MASK(CHROMAGRAM_RANGE)) && config.CHROMAGRAM_RANGE == 0) {
+    return "chromagram_range can't be 0";
+  }
+  return NULL;
+}
+
+// Fields the open transaction has changed so far
+ConfigMask staged_config_fields() {
+  return config_transaction_open ? config_diff(config_shadow, config_base) : 0;
+}
+
+ConfigCommitResult commit_config_transaction(const char** reason) {
+  if (config_transaction_open == false) {
+    return CONFIG_COMMIT_NOT_OPEN;
+  }
+  ConfigMask changed = config_diff(config_shadow, config_base);
+  if (changed == 0) {
+    config_transaction_open = false;
+    return CONFIG_COMMIT_EMPTY;
+  }
+  if (config_staged_overflow) {
+    *reason = "the batch has more apply hooks than CONFIG_TRANSACTION_MAX_HOOKS, abort it";
+    return CONFIG_COMMIT_INVALID;
+  }
+  *reason = validate_config(config_shadow, changed);
+  if (*reason != NULL) {
+    return CONFIG_COMMIT_INVALID;
+  }
+
+  if (config_staged_reboot) {
+    config_copy_fields(CONFIG, config_shadow, changed);
+    config_transaction_open = false;
+    return CONFIG_COMMIT_REBOOT;  // Hooks and all run again at boot
+  }
+
+  if (config_commit_queued.load(std::memory_order_acquire)) {
+    return CONFIG_COMMIT_BUSY;
+  }
+  config_commit = config_staged;
+  config_commit.values = config_shadow;
+  config_commit.changed = changed;
+  config_commit_queued.store(true, std::memory_order_release);
+  config_transaction_open = false;
+  return CONFIG_COMMIT_QUEUED;
+}
+
+// led_thread, at the top of each frame
+void apply_config_commit() {
+  if (config_commit_queued.load(std::memory_order_acquire) == false) {
+    return;
+  }
+  config_copy_fields(CONFIG, config_commit.values, config_commit.changed);
+  for (uint8_t i = 0; i < config_commit.num_hooks; i++) {
+    config_commit.hooks[i]();
+  }
+  if (config_commit.save_now) {
+    save_config();  // (bridge_fs.h)
+  } else {
+    save_config_delayed();
+  }
+  config_commits_applied++;
+  config_commit_queued.store(false, std::memory_order_release);
+}
+
+void print_config_transaction_status() {
+  USBSerial.print("sbs((transaction=");
+  USBSerial.print(config_transaction_open ? "open" : "closed");
+  USBSerial.print(",staged=");
+  USBSerial.print(config_mask_count(staged_config_fields()));
+  USBSerial.print(",reboot=");
+  USBSerial.print((config_transaction_open && config_staged_reboot) ? 1 : 0);
+  USBSerial.print(",pending=");
+  USBSerial.print(config_commit_queued.load() ? 1 : 0);
+  USBSerial.print(",applied=");
+  USBSerial.print(config_commits_applied);
+  USBSerial.println("))");
+}
+
+#endif // CONFIG_TRANSACTION_H
@@ -10,8 +10,13 @@
 #define DEFAULT_SAMPLE_RATE 16000
 #define SAMPLE_HISTORY_LENGTH 4096
 
-// Don't change this unless you're willing to do a lot of other work on the code :/
+// Fixed render resolution of the compatibility render mode, and the
+// resolution all of the modes were originally designed around
 #define NATIVE_RESOLUTION 160
+
+// Runtime render resolution bounds (render_resolution, globals.h)
+#define MIN_RENDER_RESOLUTION 32
+#define MAX_RENDER_RESOLUTION 1000
 #define NUM_FREQS 96
 #define NUM_ZONES 2
 
@@ -31,6 +36,15 @@ enum lightshow_modes {
   NUM_MODES  // used to know the length of this list if it changes in the future
 };
 
+// How the render resolution is chosen at boot (CONFIG.RENDER_MODE)
+enum render_modes {
+  RENDER_MODE_COMPAT,  // Always render at NATIVE_RESOLUTION and lerp to the strip
+  RENDER_MODE_NATIVE,  // Render at CONFIG.LED_COUNT, no scaling
+  RENDER_MODE_HALF,    // Render at CONFIG.LED_COUNT / 2 and upscale 2x
+
+  NUM_RENDER_MODES
+};
+
 #define I2S_PORT I2S_NUM_0
 
 #define SPECTRAL_HISTORY_LENGTH 5
@@ -0,0 +1,129 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+/*----------------------------------------
+  Sensory Bridge CRC32
+  ----------------------------------------*/
+
+// The standard reflected CRC-32 (polynomial 0xEDB88320, zlib's), the one
+// CRC in the firmware: the config journal, SafeFile headers and crash
+// dumps all use it.
+//
+// crc32_update() continues a running CRC, so a record or a stream can be
+// checked in pieces without copying it together first: start from
+// CRC32_INIT, update with each piece, finish with crc32_final(). crc32()
+// does all three for one buffer.
+//
+// Updates go 8 bytes at a time (slice-by-8): eight 256-entry tables, 8 KB
+// built at compile time, so they're const data in flash rather than RAM.
+// The byte at a time and bit at a time versions give the same CRC and are
+// kept for the tests and the benchmark (test/host/crc32_test.cpp).
+// Defining CRC32_USE_ROM on the ESP32 hands updates to the CRC routine in
+// the chip's ROM instead.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(CRC32_USE_ROM) && defined(ESP_PLATFORM)
+#include "esp_rom_crc.h"
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "crc32.h reads 32-bit words little-endian"
+#endif
+
+#define CRC32_POLYNOMIAL 0xEDB88320
+#define CRC32_INIT       0xFFFFFFFF
+
+struct Crc32Tables {
+  uint32_t entries[8][256];  // [k][b]: the CRC of byte b followed by k zero bytes
+};
+
+constexpr Crc32Tables build_crc32_tables() {
+  Crc32Tables tables = {};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? CRC32_POLYNOMIAL : 0);
+    }
+    tables.entries[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    for (uint8_t k = 1; k < 8; k++) {
+      uint32_t previous = tables.entries[k - 1][i];
+      tables.entries[k][i] = (previous >> 8) ^ tables.entries[0][previous & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr Crc32Tables crc32_tables = build_crc32_tables();
+
+// Reference, one bit at a time and no table
+inline uint32_t crc32_update_bitwise(uint32_t crc, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= bytes[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0 - (crc & 1)));
+    }
+  }
+  return crc;
+}
+
+// One byte at a time, from the first table
+inline uint32_t crc32_update_bytes(uint32_t crc, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    crc = (crc >> 8) ^ crc32_tables.entries[0][(crc ^ bytes[i]) & 0xFF];
+  }
+  return crc;
+}
+
+// Eight bytes at a time: the CRC folds into the first word, then each of
+// the eight bytes is looked up in the table for its distance from the end
+inline uint32_t crc32_update_slice8(uint32_t crc, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  const uint32_t (*t)[256] = crc32_tables.entries;
+  while (length >= 8) {
+    uint32_t one;
+    uint32_t two;
+    memcpy(&one, bytes, 4);  // Any alignment
+    memcpy(&two, bytes + 4, 4);
+    one ^= crc;
+    crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+          t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+    bytes += 8;
+    length -= 8;
+  }
+  return crc32_update_bytes(crc, bytes, length);
+}
+
+#if defined(CRC32_USE_ROM) && defined(ESP_PLATFORM)
+// The ROM takes and returns finished CRCs, the running value here isn't inverted
+inline uint32_t crc32_update_rom(uint32_t crc, const void* data, size_t length) {
+  return ~esp_rom_crc32_le(~crc, (const uint8_t*)data, uint32_t(length));
+}
+#endif
+
+inline uint32_t crc32_update(uint32_t crc, const void* data, size_t length) {
+#if defined(CRC32_USE_ROM) && defined(ESP_PLATFORM)
+  return crc32_update_rom(crc, data, length);
+#else
+  return crc32_update_slice8(crc, data, length);
+#endif
+}
+
+inline uint32_t crc32_final(uint32_t crc) {
+  return ~crc;
+}
+
+// CRC of one buffer
+inline uint32_t crc32(const void* data, size_t length) {
+  return crc32_final(crc32_update(CRC32_INIT, data, length));
+}
+
+#endif // CRC32_H
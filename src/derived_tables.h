@@ -0,0 +1,103 @@
+#ifndef DERIVED_TABLES_H
+#define DERIVED_TABLES_H
+
+/*----------------------------------------
+  Sensory Bridge DERIVED TABLES
+  ----------------------------------------*/
+
+// Lookup tables built from CONFIG (goertzel constants, the pixel map...)
+// and when to rebuild them. Each table names the CONFIG fields it reads
+// as a ConfigMask. A table that also reads something outside CONFIG
+// (PALETTE_INDEX) gives a key() that changes whenever that does.
+//
+// The thread that reads a set of tables owns one DerivedTables for them,
+// and calls refresh() at the top of each of its frames. refresh() diffs
+// CONFIG against what it saw last time, over just the fields its tables
+// read. A table is rebuilt if one of its fields changed, its key changed,
+// or invalidate() was called for it. It is rebuilt once, however many of
+// its fields a commit changed. Nothing else needs to remember to rebuild
+// it, and the render path no longer checks every frame (or every pixel)
+// whether it's current.
+//
+// Each table keeps a build count and how long its builds took.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config_fields.h"
+
+struct DerivedTable {
+  const char* name;
+  ConfigMask inputs;     // CONFIG fields it's built from
+  uint32_t (*key)();     // Inputs from outside CONFIG, NULL if none
+  void (*build)();
+};
+
+struct DerivedTableStats {
+  uint32_t builds;
+  uint32_t last_us;
+  uint32_t max_us;
+  uint32_t total_us;
+};
+
+template <size_t N>
+struct DerivedTables {
+  const DerivedTable* tables;
+  uint32_t (*clock_us)();
+
+  ConfigMask inputs;                   // Every field any of the tables reads
+  SensoryBridge::Config::conf seen;    // Those fields, as of the last refresh()
+  uint32_t keys[N];
+  std::atomic<bool> invalid[N];
+  DerivedTableStats stats[N];
+
+  DerivedTables(const DerivedTable (&list)[N], uint32_t (*clock)()) : tables(list), clock_us(clock), inputs(0), seen(), keys(), stats() {
+    for (size_t t = 0; t < N; t++) {
+      inputs |= list[t].inputs;
+      invalid[t].store(true, std::memory_order_relaxed);  // Nothing is built yet
+    }
+  }
+
+  // Rebuild «table» on the next refresh(), from any thread
+  void invalidate(uint8_t table) {
+    invalid[table].store(true, std::memory_order_relaxed);
+  }
+
+  // Owning thread only. Rebuilds what's stale against «config», returns how many
+  uint8_t refresh(const SensoryBridge::Config::conf& config) {
+    ConfigMask changed = config_diff(config, seen, inputs);
+    config_copy_fields(seen, config, changed);  // Before building, so a change during a build isn't missed
+
+    uint8_t rebuilt = 0;
+    for (size_t t = 0; t < N; t++) {
+      bool stale = invalid[t].exchange(false, std::memory_order_relaxed);
+      stale |= (changed & tables[t].inputs) != 0;
+      if (tables[t].key != NULL) {
+        uint32_t key = tables[t].key();
+        stale |= (key != keys[t]);
+        keys[t] = key;
+      }
+      if (stale == false) {
+        continue;
+      }
+
+      uint32_t start_us = clock_us();
+      tables[t].build();
+      uint32_t took_us = clock_us() - start_us;
+
+      stats[t].builds++;
+      stats[t].last_us = took_us;
+      stats[t].total_us += took_us;
+      if (took_us > stats[t].max_us) {
+        stats[t].max_us = took_us;
+      }
+      rebuilt++;
+    }
+    return rebuilt;
+  }
+};
+
+#endif // DERIVED_TABLES_H
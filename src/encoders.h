@@ -310,16 +310,24 @@ void check_encoders(uint32_t t_now) {
                     }
                 } else {
                     // Mode change logic remains integer based
-                    if (!secondaryMode) CONFIG.LIGHTSHOW_MODE = (CONFIG.LIGHTSHOW_MODE + 1) % NUM_MODES;
-                    else SECONDARY_LIGHTSHOW_MODE = (SECONDARY_LIGHTSHOW_MODE + 1) % NUM_MODES;
+                    uint8_t next_mode;
+                    if (!secondaryMode) {
+                        // Primary mode changes cross-fade, see begin_mode_transition() in mode_transition.h
+                        next_mode = (CONFIG.LIGHTSHOW_MODE + 1) % NUM_MODES;
+                        mode_destination = next_mode;
+                        mode_transition_queued = true;
+                    } else {
+                        SECONDARY_LIGHTSHOW_MODE = (SECONDARY_LIGHTSHOW_MODE + 1) % NUM_MODES;
+                        next_mode = SECONDARY_LIGHTSHOW_MODE;
+                    }
                     settings_updated = true;
                     if(debug_mode){
                         USBSerial.print("[DBG E3] Short Press | New Light Mode: ");
-                        USBSerial.println(secondaryMode ? SECONDARY_LIGHTSHOW_MODE : CONFIG.LIGHTSHOW_MODE);
+                        USBSerial.println(next_mode);
                     }
                     // ALWAYS log mode changes for debugging
                     USBSerial.printf("MODE CHANGE: New mode index=%d (Expected: SNAPWAVE=%d, SNAPWAVE_DEBUG=%d)\n", 
-                                    CONFIG.LIGHTSHOW_MODE, LIGHT_MODE_SNAPWAVE, LIGHT_MODE_SNAPWAVE_DEBUG);
+                                    next_mode, LIGHT_MODE_SNAPWAVE, LIGHT_MODE_SNAPWAVE_DEBUG);
                 }
                 last_button_press_time = t_now;
             }
@@ -440,6 +448,22 @@ void check_encoders(uint32_t t_now) {
         }
     }
 
+    // Encoder 7's button: the next preset in the bank (presets.h), switched at the top of the next LED frame
+    static bool encoder7_button_last_state = false;
+    bool encoder7_button_state = rotate8.getKeyPressed(7);
+    if (encoder7_button_state && !encoder7_button_last_state) {
+        uint8_t next_preset = preset_bank.next(preset_bank.active());
+        if (preset_bank.request(next_preset)) {
+            activity_detected = true;
+            g_last_active_encoder = 7;
+            if (debug_mode) {
+                USBSerial.print("[DBG E7] Preset: ");
+                USBSerial.println(preset_bank.name(next_preset));
+            }
+        }
+    }
+    encoder7_button_last_state = encoder7_button_state;
+
     if (activity_detected) {
         g_last_encoder_activity_time = t_now;
         next_save_time = t_now + 3000;
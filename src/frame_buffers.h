@@ -0,0 +1,131 @@
+#ifndef FRAME_BUFFERS_H
+#define FRAME_BUFFERS_H
+
+/*----------------------------------------
+  Sensory Bridge FRAME BUFFERS
+  ----------------------------------------*/
+
+// Trail modes (bloom, snapwave) used to keep their state by copying whole
+// frames: seed leds_16 from the trail buffer, render, copy back. The
+// secondary strip copied the primary frame aside and back around its own
+// render on top of that, six or more 12-byte-per-pixel copies a frame.
+//
+// Now leds_16 is just a pointer to whatever holds the frame so far:
+//
+//   Canvases  - one writable frame per render (primary, the outgoing mode
+//               of a cross-fade, secondary). frame_canvas is the current one.
+//   Trails    - each trail mode's last output (primary, incoming mode of a
+//               cross-fade, secondary), plus one shared spare.
+//
+// A trail mode calls frame_trail_begin(), which points leds_16 at the spare
+// and returns its last output to read from, and frame_trail_commit(), which
+// swaps the two, so what it drew becomes next frame's history without a
+// copy. leds_16 then still points at that history: passes that read each
+// pixel once and write it back (prism, bulb cover, cross-fade, brightness)
+// read through frame_write_source() and write into the canvas, which is
+// where leds_16 points afterwards. Anything that has to work in place calls
+// frame_make_writable() first, the one copy left, and only when aliased.
+//
+// All buffers live in the render arena (carve_render_buffers(), led_utilities.h).
+
+#include <Arduino.h>
+#include "globals.h"
+
+extern void scale_led_buffer(const CRGB16* src, uint16_t src_count, CRGB16* dst, uint16_t dst_count);  // led_utilities.h
+
+enum FrameCanvas {
+  CANVAS_PRIMARY,
+  CANVAS_OUTGOING,   // Outgoing mode during a cross-fade (mode_transition.h)
+  CANVAS_SECONDARY,  // Secondary strip, read by show_leds() as leds_16_secondary
+  NUM_FRAME_CANVASES
+};
+
+enum FrameTrail {
+  TRAIL_PRIMARY,
+  TRAIL_INCOMING,    // Incoming mode during a cross-fade
+  TRAIL_SECONDARY,
+  NUM_FRAME_TRAILS
+};
+
+CRGB16* frame_canvases[NUM_FRAME_CANVASES];
+CRGB16* frame_trails[NUM_FRAME_TRAILS];  // Each trail mode's last output
+CRGB16* frame_trail_spare;               // Next output of whichever trail mode renders now
+CRGB16* frame_canvas;                    // Writable frame behind leds_16 for this render
+
+// Where leds_16 points, to come back to after rendering somewhere else
+struct FrameTarget {
+  CRGB16* leds;
+  CRGB16* canvas;
+};
+
+// Render into «canvas» from here on
+void frame_begin(FrameCanvas canvas) {
+  frame_canvas = frame_canvases[canvas];
+  leds_16 = frame_canvas;
+}
+
+FrameTarget frame_save() {
+  FrameTarget target = { leds_16, frame_canvas };
+  return target;
+}
+
+void frame_restore(FrameTarget target) {
+  leds_16 = target.leds;
+  frame_canvas = target.canvas;
+}
+
+// Point leds_16 at a blank buffer for «trail»'s mode and return its last output
+CRGB16* frame_trail_begin(FrameTrail trail) {
+  leds_16 = frame_trail_spare;
+  return frame_trails[trail];
+}
+
+// What was drawn since frame_trail_begin() becomes «trail»'s history.
+// leds_16 keeps pointing at it, read-only until frame_write_source().
+void frame_trail_commit(FrameTrail trail) {
+  frame_trail_spare = frame_trails[trail];
+  frame_trails[trail] = leds_16;
+}
+
+// For passes that read each pixel before writing it: returns the frame to
+// read, and leds_16 is the canvas to write (the same buffer unless aliased)
+CRGB16* frame_write_source() {
+  CRGB16* source = leds_16;
+  leds_16 = frame_canvas;
+  return source;
+}
+
+// For passes that only work in place: make sure leds_16 isn't a trail's history
+void frame_make_writable() {
+  if (leds_16 != frame_canvas) {
+    memcpy(frame_canvas, leds_16, sizeof(CRGB16) * render_resolution);
+    leds_16 = frame_canvas;
+  }
+}
+
+void frame_trail_swap(FrameTrail a, FrameTrail b) {
+  CRGB16* trail = frame_trails[a];
+  frame_trails[a] = frame_trails[b];
+  frame_trails[b] = trail;
+}
+
+void frame_trail_clear(FrameTrail trail) {
+  memset(frame_trails[trail], 0, sizeof(CRGB16) * render_capacity);
+}
+
+// Stretch every canvas and trail from «from» pixels to «to» (resolution
+// changes), so a cross-fade dropping to half resolution and back keeps
+// both modes' trails. Goes through the spare, which the next trail
+// render overwrites anyway
+void frame_buffers_resample(uint16_t from, uint16_t to) {
+  for (uint8_t c = 0; c < NUM_FRAME_CANVASES; c++) {
+    scale_led_buffer(frame_canvases[c], from, frame_trail_spare, to);
+    memcpy(frame_canvases[c], frame_trail_spare, sizeof(CRGB16) * to);
+  }
+  for (uint8_t t = 0; t < NUM_FRAME_TRAILS; t++) {
+    scale_led_buffer(frame_trails[t], from, frame_trail_spare, to);
+    memcpy(frame_trails[t], frame_trail_spare, sizeof(CRGB16) * to);
+  }
+}
+
+#endif // FRAME_BUFFERS_H
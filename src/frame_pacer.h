@@ -0,0 +1,239 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+/*----------------------------------------
+  Sensory Bridge FRAME PACER
+  ----------------------------------------*/
+
+// led_thread used to render flat out with a vTaskDelay(1) between frames,
+// which gave uneven intervals, frames the strip couldn't even display yet,
+// and random phase against the audio frames. Now each frame has a target
+// show() time one period after the previous target. The renderer sleeps
+// until a window before that deadline opens, then waits (also asleep) for
+// the audio thread to signal a fresh GDFT frame, and starts rendering as
+// soon as one arrives or the render deadline is reached.
+//
+//   last show()                              next show() target
+//       |<---------------- period ---------------->|
+//       |        sleep        | wait for audio |render|
+
+#include <Arduino.h>
+#include "globals.h"
+
+#define FRAME_PACER_DEFAULT_FPS 120
+#define FRAME_PACER_MIN_FPS     10
+#define FRAME_PACER_SLEEP_SLICE_US 4000  // Long sleeps check frame_pacer_wake() this often
+
+// WS2812: 24 bits at 1.25us each, then a >280us latch before the next frame
+#define WS2812_US_PER_PIXEL 30
+#define WS2812_LATCH_US     300
+
+struct FramePacerStats {
+  uint32_t frames;
+  uint32_t missed_deadlines;  // show() finished after its target time
+  uint32_t audio_aligned;     // Frames started by a fresh audio frame
+  uint32_t audio_timeouts;    // Frames started by the deadline, without new audio
+  uint32_t resyncs;           // Fell more than a period behind and restarted the schedule
+
+  uint32_t interval_min_us;   // Between consecutive show() completions, since last print
+  uint32_t interval_max_us;
+  float interval_avg_us;
+  float interval_jitter_us;   // Smoothed |interval - period|
+
+  float render_avg_us;        // Render + show() time
+  float render_peak_us;       // Decaying peak, used to place the render deadline
+} frame_pacer_stats;
+
+uint16_t frame_pacer_target_fps = FRAME_PACER_DEFAULT_FPS;
+
+uint32_t frame_pacer_target_us = 0;     // When the next show() should complete
+uint32_t frame_pacer_last_show_us = 0;  // When the last show() actually completed
+uint32_t frame_pacer_render_start_us = 0;
+bool frame_pacer_slept = false;
+volatile bool frame_pacer_wake_pending = false;
+
+// Time the strip needs to accept a frame, no point rendering faster than this
+uint32_t led_transfer_time_us() {
+  uint16_t pixels = CONFIG.LED_COUNT;
+  if (ENABLE_SECONDARY_LEDS && SECONDARY_LED_COUNT > pixels) {
+    pixels = SECONDARY_LED_COUNT;
+  }
+  return uint32_t(pixels) * WS2812_US_PER_PIXEL + WS2812_LATCH_US;
+}
+
+uint32_t frame_pacer_period_us() {
+  uint32_t period = 1000000 / frame_pacer_target_fps;
+  uint32_t transfer = led_transfer_time_us();
+  if (period < transfer) {
+    period = transfer;
+  }
+  return period;
+}
+
+void set_frame_pacer_target_fps(uint16_t fps) {
+  if (fps < FRAME_PACER_MIN_FPS) {
+    fps = FRAME_PACER_MIN_FPS;
+  }
+  frame_pacer_target_fps = fps;
+  frame_pacer_target_us = 0;  // Resync on the next frame
+}
+
+void reset_frame_pacer_intervals() {
+  frame_pacer_stats.interval_min_us = 0;
+  frame_pacer_stats.interval_max_us = 0;
+}
+
+// Called by the audio thread (core 0) each time a new GDFT frame is ready
+void frame_pacer_audio_frame_ready() {
+  if (led_task != NULL) {
+    xTaskNotifyGive(led_task);
+  }
+}
+
+// Cut a long sleep short and start the next frame now, e.g. when the
+// target FPS goes back up (idle_tier.h). Safe to call from core 0.
+void frame_pacer_wake() {
+  frame_pacer_wake_pending = true;
+  frame_pacer_audio_frame_ready();
+}
+
+// Sleep the calling task for «us» microseconds, at tick resolution, in
+// slices so frame_pacer_wake() can interrupt it
+static void frame_pacer_sleep_us(int32_t us) {
+  while (us >= 1000 && frame_pacer_wake_pending == false) {
+    int32_t slice = (us > FRAME_PACER_SLEEP_SLICE_US) ? FRAME_PACER_SLEEP_SLICE_US : us;
+    TickType_t ticks = (slice / 1000) / portTICK_PERIOD_MS;
+    if (ticks == 0) {
+      break;
+    }
+    vTaskDelay(ticks);
+    frame_pacer_slept = true;
+    us -= slice;
+  }
+}
+
+// Called by led_thread before rendering a frame, returns when it's time to start
+void frame_pacer_wait() {
+  uint32_t period = frame_pacer_period_us();
+  uint32_t t_now = micros();
+  frame_pacer_slept = false;
+
+  if (frame_pacer_target_us == 0) {
+    frame_pacer_target_us = t_now + period;
+  }
+
+  // The render has to start early enough to finish by the target
+  uint32_t render_budget = uint32_t(frame_pacer_stats.render_peak_us);
+  if (render_budget > period) {
+    render_budget = period;
+  }
+  uint32_t render_deadline = frame_pacer_target_us - render_budget;
+
+  // Audio arriving in the last half period before the deadline is picked
+  // up right away, anything before that waits for the window to open
+  uint32_t window_open = render_deadline - period / 2;
+  int32_t until_open = int32_t(window_open - t_now);
+  if (until_open > 0) {
+    frame_pacer_sleep_us(until_open);
+  }
+
+  int32_t until_deadline = int32_t(render_deadline - micros());
+  TickType_t wait_ticks = 0;
+  if (until_deadline > 0) {
+    wait_ticks = (until_deadline / 1000) / portTICK_PERIOD_MS;
+  }
+
+  if (frame_pacer_wake_pending) {  // Render right away and restart the schedule from here
+    frame_pacer_wake_pending = false;
+    frame_pacer_target_us = micros() + frame_pacer_period_us();
+    wait_ticks = 0;
+  }
+
+  if (ulTaskNotifyTake(pdTRUE, wait_ticks) > 0) {
+    frame_pacer_stats.audio_aligned++;
+  } else {
+    frame_pacer_stats.audio_timeouts++;
+  }
+  if (wait_ticks > 0) {
+    frame_pacer_slept = true;
+  }
+
+  // Running behind, still give the idle task and lower priorities a tick
+  if (frame_pacer_slept == false) {
+    vTaskDelay(1);
+  }
+
+  frame_pacer_render_start_us = micros();
+}
+
+// Called by led_thread right after show_leds() returns
+void frame_pacer_show_done() {
+  uint32_t t_now = micros();
+  uint32_t period = frame_pacer_period_us();
+
+  float render_us = t_now - frame_pacer_render_start_us;
+  frame_pacer_stats.render_avg_us = frame_pacer_stats.render_avg_us * 0.95 + render_us * 0.05;
+  frame_pacer_stats.render_peak_us *= 0.99;
+  if (render_us > frame_pacer_stats.render_peak_us) {
+    frame_pacer_stats.render_peak_us = render_us;
+  }
+
+  if (frame_pacer_last_show_us != 0) {
+    uint32_t interval = t_now - frame_pacer_last_show_us;
+    if (frame_pacer_stats.interval_min_us == 0 || interval < frame_pacer_stats.interval_min_us) { frame_pacer_stats.interval_min_us = interval; }
+    if (interval > frame_pacer_stats.interval_max_us) { frame_pacer_stats.interval_max_us = interval; }
+    frame_pacer_stats.interval_avg_us = frame_pacer_stats.interval_avg_us * 0.95 + interval * 0.05;
+
+    float error = abs(int32_t(interval - period));
+    frame_pacer_stats.interval_jitter_us = frame_pacer_stats.interval_jitter_us * 0.95 + error * 0.05;
+  }
+  frame_pacer_last_show_us = t_now;
+  frame_pacer_stats.frames++;
+
+  if (frame_pacer_target_us != 0) {
+    int32_t late_us = int32_t(t_now - frame_pacer_target_us);
+    if (late_us > 0) {
+      frame_pacer_stats.missed_deadlines++;
+    }
+
+    if (late_us > int32_t(period)) {
+      // Don't try to catch up on frames that are already lost
+      frame_pacer_target_us = t_now + period;
+      frame_pacer_stats.resyncs++;
+    } else {
+      frame_pacer_target_us += period;
+    }
+  }
+}
+
+void print_frame_pacer_stats() {
+  USBSerial.print("sbs((pacer_fps=");
+  USBSerial.print(frame_pacer_target_fps);
+  USBSerial.print(",period_us=");
+  USBSerial.print(frame_pacer_period_us());
+  USBSerial.print(",frames=");
+  USBSerial.print(frame_pacer_stats.frames);
+  USBSerial.print(",missed=");
+  USBSerial.print(frame_pacer_stats.missed_deadlines);
+  USBSerial.print(",resyncs=");
+  USBSerial.print(frame_pacer_stats.resyncs);
+  USBSerial.print(",audio_aligned=");
+  USBSerial.print(frame_pacer_stats.audio_aligned);
+  USBSerial.print(",audio_timeouts=");
+  USBSerial.print(frame_pacer_stats.audio_timeouts);
+  USBSerial.print(",interval_avg_us=");
+  USBSerial.print(uint32_t(frame_pacer_stats.interval_avg_us));
+  USBSerial.print(",interval_min_us=");
+  USBSerial.print(frame_pacer_stats.interval_min_us);
+  USBSerial.print(",interval_max_us=");
+  USBSerial.print(frame_pacer_stats.interval_max_us);
+  USBSerial.print(",jitter_us=");
+  USBSerial.print(uint32_t(frame_pacer_stats.interval_jitter_us));
+  USBSerial.print(",render_us=");
+  USBSerial.print(uint32_t(frame_pacer_stats.render_avg_us));
+  USBSerial.println("))");
+
+  reset_frame_pacer_intervals();
+}
+
+#endif // FRAME_PACER_H
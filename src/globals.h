@@ -11,6 +11,9 @@
 #include <Ticker.h>
 #include <FirmwareMSC.h>
 #include "constants.h"
+#include "pixel_map.h"
+#include "procedural.h"
+#include "config_fields.h"
 
 // CRITICAL: Mutex for controlling access to the thread-unsafe USBSerial port.
 // Prevents garbled debug output from interleaved task printing.
@@ -34,50 +37,7 @@ enum SweetSpotState {
 // ------------------------------------------------------------
 // Configuration structure ------------------------------------
 
-namespace SensoryBridge {
-namespace Config {
-
-struct conf {  
-  // Synced values
-  float   PHOTONS;
-  float   CHROMA;
-  float   MOOD;
-  uint8_t LIGHTSHOW_MODE;
-  bool    MIRROR_ENABLED;
-
-  // Private values
-  uint32_t SAMPLE_RATE;
-  uint8_t  NOTE_OFFSET;
-  uint8_t  SQUARE_ITER;
-  uint8_t  LED_TYPE;
-  uint16_t LED_COUNT;
-  uint16_t LED_COLOR_ORDER;
-  bool     LED_INTERPOLATION;
-  uint16_t SAMPLES_PER_CHUNK;
-  float    SENSITIVITY;
-  bool     BOOT_ANIMATION;
-  uint32_t SWEET_SPOT_MIN_LEVEL;
-  uint32_t SWEET_SPOT_MAX_LEVEL;
-  int32_t  DC_OFFSET;
-  uint8_t  CHROMAGRAM_RANGE;
-  bool     STANDBY_DIMMING;
-  bool     REVERSE_ORDER;
-  uint32_t MAX_CURRENT_MA;
-  bool     TEMPORAL_DITHERING;
-  bool     AUTO_COLOR_SHIFT;
-  float    INCANDESCENT_FILTER;
-  bool     INCANDESCENT_MODE;
-  float    BULB_OPACITY;
-  float    SATURATION;
-  float    PRISM_COUNT;
-  bool     BASE_COAT;
-  float    VU_LEVEL_FLOOR;
-};
-
-// Defaults will be defined outside namespace
-
-} // namespace Config
-} // namespace SensoryBridge
+// SensoryBridge::Config::conf and its field table live in config_fields.h
 
 // Keep CONFIG as global variable but use namespaced type
 SensoryBridge::Config::conf CONFIG = {
@@ -115,10 +75,23 @@ SensoryBridge::Config::conf CONFIG = {
   0.0f,                // PRISM_COUNT - disable multi-pass prism by default (prevents white-out)
   false,               // BASE_COAT
   0.00,                // VU_LEVEL_FLOOR
+  RENDER_MODE_NATIVE,  // RENDER_MODE - draw directly at LED_COUNT
+  600,                 // MODE_FADE_MS - cross-fade between modes, 0 = cut
 };
 
 SensoryBridge::Config::conf CONFIG_DEFAULTS;
 
+// CONFIG values as of the start of the LED frame (cache_frame_config(),
+// lightshow_modes.h), what the modes and audio_features.h render with
+struct cached_config {
+  float PHOTONS;
+  float CHROMA;
+  float MOOD;
+  uint8_t LIGHTSHOW_MODE;
+  float SQUARE_ITER;
+  float SATURATION;
+} frame_config;
+
 char mode_names[NUM_MODES*32] = { 0 };
 
 // ------------------------------------------------------------
@@ -219,6 +192,7 @@ float   raw_rms_global = 0.0;
 
 float sweet_spot_state = 0;
 float sweet_spot_state_follower = 0;
+bool  silent_chunk = false;  // This chunk alone is under the silence threshold, sweet_spot_state holds for longer
 float sweet_spot_min_temp = 0;
 
 // ------------------------------------------------------------
@@ -242,23 +216,48 @@ CRGB leds_aux [160];
 CRGB leds_fade[160];
 */
 
-CRGB16  leds_16[160];
-CRGB16  leds_16_prev[160];
-CRGB16  leds_16_prev_secondary[160]; // Buffer for secondary bloom state
-CRGB16  leds_16_fx[160];
-// CRGB16  leds_16_fx_2[160]; // Removed to save DRAM
-CRGB16  leds_16_temp[160];
-CRGB16  leds_16_ui[160];
+// All render-resolution buffers are carved out of one arena allocated at
+// boot for render_capacity pixels (init_render_buffers(), led_utilities.h).
+// Everything drawing into them loops to render_resolution, which can drop
+// below render_base_resolution at runtime (quality_governor.h) but never
+// exceeds render_capacity.
+uint16_t render_resolution      = NATIVE_RESOLUTION;  // Pixels drawn this frame
+uint16_t render_base_resolution = NATIVE_RESOLUTION;  // Chosen at boot from CONFIG.RENDER_MODE
+uint16_t render_capacity        = NATIVE_RESOLUTION;  // Pixels each arena buffer can hold
+
+CRGB16* leds_16;                // Frame being rendered, a canvas or a trail (frame_buffers.h)
+CRGB16* leds_16_fx;
+CRGB16* leds_16_temp;
+CRGB16* leds_16_ui;
+CRGB16* leds_16_xfade;          // Outgoing mode's frame during a cross-fade (mode_transition.h)
 
 // Add state variables for waveform mode instances
 CRGB16  waveform_last_color_primary = {0,0,0};
 CRGB16  waveform_last_color_secondary = {0,0,0};
 
-SQ15x16 ui_mask[160];
+SQ15x16* ui_mask;
+
+// Quantum Collapse fields (lightshow_modes.h)
+SQ15x16* qc_wave_probabilities;
+uint32_t* qc_wave_phase;   // QC_WAVE_PHASE_TURNS turns per 2^32
+SQ15x16* qc_fluid_velocity;
+SQ15x16* qc_scratch;
+
+// Kaleidoscope noise coordinates and per-frame noise rows (lightshow_modes.h)
+uint32_t* kaleido_noise_x;
+int16_t* kaleido_noise_rows;
+
+ProcRng mode_rng = { 0x9E3779B9 };  // Seeded from esp_random() in init_system()
 SQ15x16 ui_mask_height = 0.0;
 
 CRGB16 *leds_scaled;
 CRGB *leds_out;
+CRGB *leds_out_front;  // What FastLED actually transmits, see led_output.h
+
+// Wiring of the primary outputs (pixel_map.h), built by init_pixel_map()
+uint16_t* pixel_map;  // leds_scaled index -> leds_out index, LED_COUNT entries
+PixelLayout pixel_layout;
+char pixel_layout_text[PIXEL_MAP_LAYOUT_LEN] = "";  // Empty: one strip, or two halves for LED_NEOPIXEL_X2
 
 SQ15x16 hue_shift = 0.0; // Used in auto color cycling
 
@@ -268,6 +267,14 @@ bool led_thread_halt = false;
 
 TaskHandle_t led_task;
 
+// Lock for the state the pure headers share between tasks (save_queue.h,
+// preset_bank.h), held only for a short copy
+struct SpinLock {
+  portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+  void lock() { portENTER_CRITICAL(&mux); }
+  void unlock() { portEXIT_CRITICAL(&mux); }
+};
+
 // --- Encoder Globals ---
 uint32_t g_last_encoder_activity_time = 0; // Defined here, declared extern in encoders.h
 uint8_t g_last_active_encoder = 255;     // Defined here, declared extern in encoders.h
@@ -311,6 +318,7 @@ bool     settings_updated = false;
 
 char    command_buf[128] = {0};
 uint8_t command_buf_index = 0;
+bool    command_ready = false;  // A full line is buffered, waiting for serial_mutex
 
 bool stream_audio = false;
 bool stream_fps = false;
@@ -440,9 +448,10 @@ void unlock_leds(){
 }
 
 // New buffers for secondary LED strip
-CRGB16  leds_16_secondary[160];        // Main buffer for secondary strip
+CRGB16* leds_16_secondary;             // Secondary strip's canvas (frame_buffers.h)
 CRGB16 *leds_scaled_secondary;         // For scaling to actual LED count
 CRGB *leds_out_secondary;              // Final output buffer
+CRGB *leds_out_secondary_front;        // Transmitted copy of leds_out_secondary (led_output.h)
 
 // Secondary strip configuration
 const uint8_t SECONDARY_LED_DATA_PIN = LED_CLOCK_PIN;  // Use board LED clock pin for secondary strip
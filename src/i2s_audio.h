@@ -6,6 +6,8 @@
 #include "audio_raw_state.h"
 #include "audio_processed_state.h"
 #include "globals.h" // for AGC_GAIN
+#include "latency_probe.h"
+#include "telemetry.h"
 
 // Phase 2A: Access to AudioRawState instance for migration
 extern SensoryBridge::Audio::AudioRawState audio_raw_state;
@@ -62,12 +64,10 @@ void acquire_sample_chunk(uint32_t t_now) {
   // Phase 2A: Replace i2s_samples_raw with AudioRawState buffer
   // Use finite timeout to prevent indefinite blocking (10ms should be more than enough for 8ms of audio)
   i2s_read(I2S_PORT, audio_raw_state.getRawSamples(), CONFIG.SAMPLES_PER_CHUNK * sizeof(int32_t), &bytes_read, pdMS_TO_TICKS(10));
+  latency_chunk_captured();  // (latency_probe.h)
 
-  if (audio_debug_logging_enabled && (t_now % 5000 == 0)) {
-    USBSerial.print("DEBUG: Bytes read from I2S: ");
-    USBSerial.print(bytes_read);
-    USBSerial.print(" Max raw value: ");
-    USBSerial.println(max_waveform_val_raw);
+  if (audio_debug_logging_enabled && LOG_EVERY_MS(5000)) {  // (Logger.h) Queued, printed off this thread
+    LOG_INFO("DEBUG: Bytes read from I2S: %u Max raw value: %.1f", unsigned(bytes_read), max_waveform_val_raw);
   }
 
   max_waveform_val = 0.0;
@@ -124,16 +124,7 @@ void acquire_sample_chunk(uint32_t t_now) {
   float raw_rms_frame = sqrtf(raw_sum_sq / CONFIG.SAMPLES_PER_CHUNK);
   raw_rms_global = raw_rms_frame;
 
-  if (stream_audio) {
-    USBSerial.print("sbs((audio=");
-    for (uint16_t i = 0; i < CONFIG.SAMPLES_PER_CHUNK; i++) {
-      USBSerial.print(waveform[i]);
-      if (i < CONFIG.SAMPLES_PER_CHUNK - 1) {
-        USBSerial.print(',');
-      }
-    }
-    USBSerial.println("))");
-  }
+  telemetry_stream_audio();  // (telemetry.h)
 
   if (!noise_complete) {
     // Calculate DC offset from raw sample, not processed waveform
@@ -146,6 +137,7 @@ void acquire_sample_chunk(uint32_t t_now) {
     audio_raw_state.getDCOffsetSum() += (raw_for_dc >> 2);
     #endif
     silent_scale = 1.0;  // Force LEDs on during calibration
+    silent_chunk = false;
 
     if (noise_iterations >= 64 && noise_iterations <= 192) {            // sample in the middle of noise cal
       if (max_waveform_val_raw * 1.10 > CONFIG.SWEET_SPOT_MIN_LEVEL) {  // Sweet Spot Min threshold should be the silence level + 15%
@@ -195,7 +187,8 @@ void acquire_sample_chunk(uint32_t t_now) {
     int8_t potential_next_state = sweet_spot_state; // Assume current state initially
 
     // *** Use the SMOOTHED value for state decision ***
-    if (max_waveform_val_raw_smooth <= threshold_silence) { // Use pre-calculated threshold
+    silent_chunk = (max_waveform_val_raw_smooth <= threshold_silence);  // No hysteresis, for the noise floor (noise_cal.h)
+    if (silent_chunk) {
         potential_next_state = -1;
     } else if (max_waveform_val_raw_smooth >= CONFIG.SWEET_SPOT_MAX_LEVEL) {
         potential_next_state = 1;
@@ -219,30 +212,24 @@ void acquire_sample_chunk(uint32_t t_now) {
                      if (agc_delta > 50.0) {
                          min_silent_level_tracker = SQ15x16(AGC_FLOOR_INITIAL_RESET);
                         if (audio_debug_logging_enabled) {
-                             USBSerial.print("DEBUG: AGC Floor Tracker Reset (deadband met): raw_val=");
-                             USBSerial.print(max_waveform_val_raw);
-                             USBSerial.print(" threshold=");
-                             USBSerial.println(threshold_silence); // Use pre-calculated threshold
+                             LOG_INFO("DEBUG: AGC Floor Tracker Reset (deadband met): raw_val=%.1f threshold=%.1f",
+                                      max_waveform_val_raw, threshold_silence); // Use pre-calculated threshold
                          }
                      } else {
                         if (audio_debug_logging_enabled) {
-                             USBSerial.print("DEBUG: AGC Floor Tracker not reset due to deadband, delta=");
-                             USBSerial.println(agc_delta);
+                             LOG_INFO("DEBUG: AGC Floor Tracker not reset due to deadband, delta=%.1f", agc_delta);
                          }
                      }
                 }
 
                if (audio_debug_logging_enabled) {
-                    USBSerial.println("DEBUG: Entered silent state (Hysteresis Passed)");
-                    USBSerial.print("  max_waveform_val_raw: "); USBSerial.print(max_waveform_val_raw);
-                    USBSerial.print("  MIN_LEVEL threshold: "); USBSerial.println(threshold_silence); // Use pre-calculated threshold
+                    LOG_INFO("DEBUG: Entered silent state (Hysteresis Passed)  max_waveform_val_raw: %.1f  MIN_LEVEL threshold: %.1f",
+                             max_waveform_val_raw, threshold_silence); // Use pre-calculated threshold
                 }
             } else {
                if (audio_debug_logging_enabled) {
-                   USBSerial.print("DEBUG: Entered ");
-                   USBSerial.print(sweet_spot_state == 1 ? "loud" : "normal");
-                   USBSerial.print(" state (Hysteresis Passed), delta=");
-                   USBSerial.println(max_waveform_val_raw - threshold_silence); // Use pre-calculated threshold
+                   LOG_INFO("DEBUG: Entered %s state (Hysteresis Passed), delta=%.1f", sweet_spot_state == 1 ? "loud" : "normal",
+                            max_waveform_val_raw - threshold_silence); // Use pre-calculated threshold
                 }
             }
         }
@@ -256,8 +243,8 @@ void acquire_sample_chunk(uint32_t t_now) {
             min_silent_level_tracker += SQ15x16(AGC_FLOOR_RECOVERY_RATE);
             min_silent_level_tracker = fmin_fixed(min_silent_level_tracker, SQ15x16(AGC_FLOOR_INITIAL_RESET));
         }
-        if (audio_debug_logging_enabled && (t_now % 1000 == 0)) {
-             USBSerial.print("DEBUG (Silence): AGC Floor Tracker Value: "); USBSerial.println(float(min_silent_level_tracker));
+        if (audio_debug_logging_enabled && LOG_EVERY_MS(1000)) {
+             LOG_INFO("DEBUG (Silence): AGC Floor Tracker Value: %.3f", float(min_silent_level_tracker));
          }
     }
 
@@ -266,16 +253,17 @@ void acquire_sample_chunk(uint32_t t_now) {
 
     if (loud_sound_detected) {
         if (audio_debug_logging_enabled && silence) {
-             USBSerial.println("DEBUG: Silence broken by loud sound");
+             LOG_INFO("DEBUG: Silence broken by loud sound");
         }
         silence = false;
         silence_temp = false;
         silence_switched = t_now;
+        idle_tier_wake();  // (idle_tier.h) Back to full rate before this frame's GDFT
     } else if (sweet_spot_state == -1) {
          silence_temp = true;
          if (t_now - silence_switched >= 10000) {
             if (audio_debug_logging_enabled && !silence) {
-                USBSerial.println("DEBUG: Extended silence detected (10s)");
+                LOG_INFO("DEBUG: Extended silence detected (10s)");
             }
             silence = true;
          }
@@ -284,13 +272,9 @@ void acquire_sample_chunk(uint32_t t_now) {
         silence_temp = false;
     }
 
-    if (audio_debug_logging_enabled && (t_now % 10000 == 0)) {
-      USBSerial.print("DEBUG: silent_scale=");
-      USBSerial.print(float(silent_scale));
-      USBSerial.print(" silence=");
-      USBSerial.print(silence ? "true" : "false");
-      USBSerial.print(" sweet_spot_state=");
-      USBSerial.println(sweet_spot_state);
+    if (audio_debug_logging_enabled && LOG_EVERY_MS(10000)) {
+      LOG_INFO("DEBUG: silent_scale=%.2f silence=%s sweet_spot_state=%d", float(silent_scale), silence ? "true" : "false",
+               int(sweet_spot_state));
     }
 
     if (CONFIG.STANDBY_DIMMING) {
@@ -317,10 +301,9 @@ void acquire_sample_chunk(uint32_t t_now) {
 
     sweet_spot_state_last = sweet_spot_state;
 
-    if (audio_debug_logging_enabled && (t_now % 2000 == 0)) {
-        USBSerial.print("DEBUG (State): sweet_spot_state="); USBSerial.print(sweet_spot_state);
-        USBSerial.print(" | max_waveform_val_raw="); USBSerial.print(max_waveform_val_raw);
-        USBSerial.print(" | silence_threshold="); USBSerial.println(threshold_silence); // Use pre-calculated threshold
+    if (audio_debug_logging_enabled && LOG_EVERY_MS(2000)) {
+        LOG_INFO("DEBUG (State): sweet_spot_state=%d | max_waveform_val_raw=%.1f | silence_threshold=%.1f",
+                 int(sweet_spot_state), max_waveform_val_raw, threshold_silence); // Use pre-calculated threshold
     }
   }
 }
@@ -0,0 +1,162 @@
+#ifndef IDLE_TIER_H
+#define IDLE_TIER_H
+
+/*----------------------------------------
+  Sensory Bridge IDLE TIER
+  ----------------------------------------*/
+
+// Once the room has been silent long enough for standby dimming to fade
+// the LEDs out, there is nothing worth rendering at 120 FPS. The idle tier
+// drops the frame pacer to IDLE_LED_FPS and runs the GDFT (and novelty) on
+// only one audio frame in IDLE_GDFT_DIVIDER. Sample capture keeps running
+// every frame, so the loud sound check in acquire_sample_chunk() still
+// sees everything, and calls idle_tier_wake() to put both back to full
+// rate before that same frame's GDFT runs.
+//
+// Savings are tallied as they happen and reported with "idle" or on every
+// tier change as "sbs((idle=...))".
+
+#include <Arduino.h>
+#include "globals.h"
+#include "frame_pacer.h"
+#include "led_output.h"
+
+#define IDLE_ENTER_MS      3000   // Dimmed out for this long before idling
+#define IDLE_SCALE_LIMIT   0.01   // silent_scale below this counts as dimmed out
+#define IDLE_LED_FPS       15
+#define IDLE_GDFT_DIVIDER  4      // Run the GDFT on 1 of every N audio frames
+
+volatile bool idle_active = false;
+uint32_t idle_dimmed_since = 0;     // millis() when silent_scale dropped under the limit, 0 = not dimmed
+uint32_t idle_entered_at = 0;
+uint16_t idle_saved_led_fps = FRAME_PACER_DEFAULT_FPS;  // Target to restore on wake
+uint8_t idle_gdft_phase = 0;
+
+struct IdleTierStats {
+  uint32_t entries;
+  uint32_t idle_ms;             // Completed idle periods
+  uint32_t gdft_skipped;        // Audio frames that skipped the GDFT
+  float    gdft_avg_us;         // Cost of one GDFT pass, measured while awake
+  float    gdft_saved_us;
+  float    led_render_saved_us; // Render time of the frames the lower FPS didn't draw
+} idle_stats;
+
+bool idle_report_pending = false;
+
+// Core 0, called from acquire_sample_chunk() whenever loud_sound_detected fires
+void idle_tier_wake() {
+  idle_dimmed_since = 0;
+  if (idle_active == false) {
+    return;
+  }
+
+  idle_active = false;
+  idle_stats.idle_ms += millis() - idle_entered_at;
+  set_frame_pacer_target_fps(idle_saved_led_fps);
+  frame_pacer_wake();  // (frame_pacer.h) Don't sleep out the rest of an idle period
+  idle_report_pending = true;
+}
+
+// Core 0, once per audio frame after acquire_sample_chunk()
+void update_idle_tier(uint32_t t_now) {
+  bool dimmed_out = silence && (silent_scale < IDLE_SCALE_LIMIT);
+
+  if (dimmed_out == false) {
+    idle_tier_wake();
+    return;
+  }
+
+  if (idle_dimmed_since == 0) {
+    idle_dimmed_since = t_now;
+  }
+
+  if (idle_active == false && t_now - idle_dimmed_since >= IDLE_ENTER_MS) {
+    idle_active = true;
+    idle_entered_at = t_now;
+    idle_stats.entries++;
+    idle_saved_led_fps = frame_pacer_target_fps;
+    set_frame_pacer_target_fps(IDLE_LED_FPS);
+    idle_report_pending = true;
+  }
+}
+
+// Core 0, true if this audio frame should run the GDFT
+bool idle_tier_run_gdft() {
+  if (idle_active == false) {
+    return true;
+  }
+
+  if (++idle_gdft_phase >= IDLE_GDFT_DIVIDER) {
+    idle_gdft_phase = 0;
+    return true;
+  }
+
+  idle_stats.gdft_skipped++;
+  idle_stats.gdft_saved_us += idle_stats.gdft_avg_us;
+  return false;
+}
+
+// Core 0, GDFT time of a full-rate frame
+void idle_tier_report_gdft(uint32_t gdft_us) {
+  if (idle_active == false) {
+    idle_stats.gdft_avg_us = idle_stats.gdft_avg_us * 0.95 + gdft_us * 0.05;
+  }
+}
+
+// Core 1, once per LED frame with that frame's render time
+void idle_tier_report_led_frame(uint32_t render_us) {
+  if (idle_active && frame_pacer_target_fps < idle_saved_led_fps) {
+    // Each idle frame stands in for this many full-rate frames
+    float skipped_frames = float(idle_saved_led_fps) / frame_pacer_target_fps - 1.0;
+    idle_stats.led_render_saved_us += render_us * skipped_frames;
+  }
+}
+
+void print_idle_status() {
+  uint32_t idle_ms = idle_stats.idle_ms;
+  if (idle_active) {
+    idle_ms += millis() - idle_entered_at;
+  }
+
+  // Share of each core's time handed back, over the whole uptime
+  float uptime_us = float(esp_timer_get_time());
+  float audio_saved_pct = uptime_us > 0 ? idle_stats.gdft_saved_us / uptime_us * 100.0 : 0.0;
+  float led_saved_pct = uptime_us > 0 ? idle_stats.led_render_saved_us / uptime_us * 100.0 : 0.0;
+
+  // Every skipped transmission is a frame the strip's data line stayed quiet for
+  uint32_t tx_skipped = led_output.skipped();
+  uint32_t tx_saved_ms = uint32_t((uint64_t(tx_skipped) * led_transfer_time_us()) / 1000);
+
+  USBSerial.print("sbs((idle=");
+  USBSerial.print(idle_active);
+  USBSerial.print(",entries=");
+  USBSerial.print(idle_stats.entries);
+  USBSerial.print(",idle_ms=");
+  USBSerial.print(idle_ms);
+  USBSerial.print(",led_fps_target=");
+  USBSerial.print(frame_pacer_target_fps);
+  USBSerial.print(",tx_sent=");
+  USBSerial.print(led_output.frames());
+  USBSerial.print(",tx_skipped=");
+  USBSerial.print(tx_skipped);
+  USBSerial.print(",tx_saved_ms=");
+  USBSerial.print(tx_saved_ms);
+  USBSerial.print(",gdft_skipped=");
+  USBSerial.print(idle_stats.gdft_skipped);
+  USBSerial.print(",audio_cpu_saved_pct=");
+  USBSerial.print(audio_saved_pct, 2);
+  USBSerial.print(",led_cpu_saved_pct=");
+  USBSerial.print(led_saved_pct, 2);
+  USBSerial.println("))");
+}
+
+// Core 1, after the frame is shown. Never blocks on the serial port.
+void update_idle_report() {
+  if (idle_report_pending && xSemaphoreTake(serial_mutex, 0) == pdTRUE) {
+    print_idle_status();
+    xSemaphoreGive(serial_mutex);
+    idle_report_pending = false;
+  }
+}
+
+#endif // IDLE_TIER_H
@@ -0,0 +1,79 @@
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+/*----------------------------------------
+  Sensory Bridge LATENCY PROBE
+  ----------------------------------------*/
+
+// Device side of latency_trace.h: where each stamp is taken and who owns
+// which piece of state.
+//
+//   latency_chunk_captured()  acquire_sample_chunk(), right after i2s_read()
+//   latency_chunk_analyzed()  audio thread, after the GDFT and novelty
+//   latency_frame_begin()     led_thread, when it takes the spectrum
+//   latency_frame_stamp()     led_thread, after render and after quantize
+//   (led_output.h)            led_tx task, around FastLED.show(), records
+//
+// i2s_read() returning is as close to DMA completion as the legacy I2S
+// driver lets us see. The audio thread normally blocks in it, so the two
+// match, but a chunk that sat in the DMA queue while the thread was late
+// is stamped late by that much.
+//
+// Queried with "latency", cleared with "latency_reset", and reported by
+// the regression suite's audio-to-light test.
+
+#include <Arduino.h>
+#include "globals.h"
+#include "latency_trace.h"
+
+LatencyChunkSlot latency_chunks;  // Written by the audio thread
+LatencyStats latency_stats;       // Written by the led_tx task (led_output.h)
+
+uint32_t latency_capture_us = 0;  // Audio thread: stamp of the chunk being analyzed
+
+LatencyFrame latency_frame;       // led_thread: frame being rendered
+uint32_t latency_last_chunk = 0;  // led_thread: chunk the previous frame traced
+
+// Audio thread, as soon as the chunk is in
+void latency_chunk_captured() {
+  latency_capture_us = micros();
+}
+
+// Audio thread, once the chunk's spectrum is ready for led_thread
+void latency_chunk_analyzed() {
+  latency_publish_chunk(latency_chunks, latency_capture_us, micros());
+}
+
+// led_thread, as it picks up the newest spectrum
+void latency_frame_begin() {
+  latency_begin_frame(latency_frame, latency_chunks, latency_last_chunk, micros());
+}
+
+void latency_frame_stamp(LatencyStamp stamp) {
+  latency_stamp(latency_frame, stamp, micros());
+}
+
+void print_latency_stats() {
+  for (uint8_t s = 0; s < NUM_LATENCY_STAGES; s++) {
+    const LatencyHistogram& h = latency_stats.stages[s];
+    USBSerial.print("sbs((latency=");
+    USBSerial.print(latency_stage_names[s]);
+    USBSerial.print(",samples=");
+    USBSerial.print(latency_hist_count(h));
+    USBSerial.print(",p50_us=");
+    USBSerial.print(latency_hist_percentile(h, 50));
+    USBSerial.print(",p95_us=");
+    USBSerial.print(latency_hist_percentile(h, 95));
+    USBSerial.print(",p99_us=");
+    USBSerial.print(latency_hist_percentile(h, 99));
+    USBSerial.print(",max_us=");
+    USBSerial.print(latency_hist_max(h));
+    USBSerial.println("))");
+  }
+}
+
+void reset_latency_stats() {
+  latency_stats.reset_requested = true;  // The led_tx task clears them before its next record
+}
+
+#endif // LATENCY_PROBE_H
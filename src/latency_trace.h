@@ -0,0 +1,234 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+/*----------------------------------------
+  Sensory Bridge LATENCY TRACE
+  ----------------------------------------*/
+
+// Audio-to-photon latency, measured rather than estimated from the two
+// frame rates. Each audio chunk gets a timestamp when i2s_read() hands it
+// over, and the frame that first shows it carries that stamp through the
+// rest of the pipeline:
+//
+//   CAPTURE -> GDFT -> HANDOFF -> RENDER -> QUANTIZE -> TX_START -> TX_END
+//   audio thread     | led_thread                    | led_tx task
+//
+// The audio thread publishes (chunk, CAPTURE, GDFT) through a seqlock
+// slot, so led_thread never reads a half-written pair. A frame that picks
+// up the same chunk as the one before it (the pacer ran out of time
+// waiting for audio) isn't traced, it would only count the same audio
+// twice. The transmitter records each finished frame into one rolling
+// histogram per stage plus one end to end.
+//
+// Histograms are log-linear: exact below 16us, then 8 buckets per octave
+// (within 12.5%), up to 16s. Each keeps two windows of LATENCY_WINDOW
+// samples and reports both, so the numbers cover the last 2k-4k frames
+// and old spikes age out.
+//
+// Nothing in here depends on Arduino, test/host builds it as is. The
+// device side (micros(), globals, serial output) is latency_probe.h.
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+#define LATENCY_EXACT_US   16    // Below this every microsecond has its own bucket
+#define LATENCY_SUB_BUCKETS 8    // Buckets per octave above that
+#define LATENCY_MAX_OCTAVE 24    // Everything from 2^24us (16s) up lands in the last bucket
+#define LATENCY_BUCKETS    (LATENCY_EXACT_US + (LATENCY_MAX_OCTAVE - 4) * LATENCY_SUB_BUCKETS)
+#define LATENCY_WINDOW     2048  // Samples per histogram window
+
+// Where a frame is in the pipeline, in order
+enum LatencyStamp {
+  STAMP_CAPTURE,   // i2s_read() returned the chunk (audio thread)
+  STAMP_GDFT,      // GDFT and novelty done, spectrum published
+  STAMP_HANDOFF,   // led_thread picked the spectrum up
+  STAMP_RENDER,    // Modes and effects done
+  STAMP_QUANTIZE,  // Brightness, UI, scaling and dithering done
+  STAMP_TX_START,  // Transmitter started on the frame
+  STAMP_TX_END,    // Last bit on the wire
+  NUM_LATENCY_STAMPS
+};
+
+// What gets a histogram: the gap before each stamp, then end to end
+enum LatencyStage {
+  LATENCY_GDFT,      // CAPTURE -> GDFT
+  LATENCY_HANDOFF,   // GDFT -> HANDOFF, waiting for led_thread
+  LATENCY_RENDER,    // HANDOFF -> RENDER
+  LATENCY_QUANTIZE,  // RENDER -> QUANTIZE
+  LATENCY_TX_QUEUE,  // QUANTIZE -> TX_START, waiting for the previous transfer
+  LATENCY_TX,        // TX_START -> TX_END
+  LATENCY_TOTAL,     // CAPTURE -> TX_END
+  NUM_LATENCY_STAGES
+};
+
+static const char* const latency_stage_names[NUM_LATENCY_STAGES] = {
+  "gdft", "handoff", "render", "quantize", "tx_queue", "tx", "total"
+};
+
+struct LatencyFrame {
+  uint32_t chunk;  // Audio chunk number, 0 = not traced
+  uint32_t at[NUM_LATENCY_STAMPS];
+};
+
+// Histograms ---------------------------------------------------------------
+
+struct LatencyHistogram {
+  uint16_t counts[2][LATENCY_BUCKETS];
+  uint16_t samples[2];
+  uint32_t max_us[2];
+  uint8_t current;  // Window being filled, the other one is the previous window
+};
+
+inline uint16_t latency_bucket(uint32_t us) {
+  if (us < LATENCY_EXACT_US) {
+    return us;
+  }
+  uint8_t octave = 31 - __builtin_clz(us);  // >= 4
+  if (octave >= LATENCY_MAX_OCTAVE) {
+    return LATENCY_BUCKETS - 1;
+  }
+  uint32_t top = us >> (octave - 3);  // 8..15
+  return LATENCY_EXACT_US + (octave - 4) * LATENCY_SUB_BUCKETS + (top - LATENCY_SUB_BUCKETS);
+}
+
+// Largest value that lands in «bucket»
+inline uint32_t latency_bucket_top(uint16_t bucket) {
+  if (bucket < LATENCY_EXACT_US) {
+    return bucket;
+  }
+  uint8_t octave = 4 + (bucket - LATENCY_EXACT_US) / LATENCY_SUB_BUCKETS;
+  uint32_t top = LATENCY_SUB_BUCKETS + (bucket - LATENCY_EXACT_US) % LATENCY_SUB_BUCKETS;
+  return ((top + 1) << (octave - 3)) - 1;
+}
+
+inline void latency_hist_reset(LatencyHistogram& h) {
+  memset(&h, 0, sizeof(h));
+}
+
+inline void latency_hist_add(LatencyHistogram& h, uint32_t us) {
+  if (h.samples[h.current] >= LATENCY_WINDOW) {  // Window full, the older one makes room
+    h.current ^= 1;
+    memset(h.counts[h.current], 0, sizeof(h.counts[h.current]));
+    h.samples[h.current] = 0;
+    h.max_us[h.current] = 0;
+  }
+  h.counts[h.current][latency_bucket(us)]++;
+  h.samples[h.current]++;
+  if (us > h.max_us[h.current]) {
+    h.max_us[h.current] = us;
+  }
+}
+
+inline uint32_t latency_hist_count(const LatencyHistogram& h) {
+  return uint32_t(h.samples[0]) + h.samples[1];
+}
+
+inline uint32_t latency_hist_max(const LatencyHistogram& h) {
+  return (h.max_us[0] > h.max_us[1]) ? h.max_us[0] : h.max_us[1];
+}
+
+// «percent» (0-100) of samples are at or below the returned value, rounded
+// up to the bucket's top but never past the largest sample seen
+inline uint32_t latency_hist_percentile(const LatencyHistogram& h, uint8_t percent) {
+  uint32_t total = latency_hist_count(h);
+  if (total == 0) {
+    return 0;
+  }
+  uint32_t rank = (total * percent + 99) / 100;  // 1-based
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint32_t seen = 0;
+  for (uint16_t b = 0; b < LATENCY_BUCKETS; b++) {
+    seen += uint32_t(h.counts[0][b]) + h.counts[1][b];
+    if (seen >= rank) {
+      uint32_t top = latency_bucket_top(b);
+      uint32_t max_us = latency_hist_max(h);
+      return (top < max_us) ? top : max_us;
+    }
+  }
+  return latency_hist_max(h);
+}
+
+// Audio thread -> led_thread -------------------------------------------------
+
+// One writer (audio thread), any number of readers. Readers retry while a
+// write is in progress instead of taking a lock the writer would wait on.
+struct LatencyChunkSlot {
+  std::atomic<uint32_t> sequence;  // Odd while being written, chunk number = sequence / 2
+  std::atomic<uint32_t> capture_us;
+  std::atomic<uint32_t> gdft_us;
+};
+
+inline void latency_publish_chunk(LatencyChunkSlot& slot, uint32_t capture_us, uint32_t gdft_us) {
+  uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.capture_us.store(capture_us, std::memory_order_relaxed);
+  slot.gdft_us.store(gdft_us, std::memory_order_relaxed);
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Start tracing «frame» from the newest published chunk, unless «last_chunk»
+// (the one the previous frame traced) is still the newest
+inline bool latency_begin_frame(LatencyFrame& frame, LatencyChunkSlot& slot, uint32_t& last_chunk, uint32_t now_us) {
+  uint32_t before, after, capture_us, gdft_us;
+  do {
+    before = slot.sequence.load(std::memory_order_acquire);
+    capture_us = slot.capture_us.load(std::memory_order_relaxed);
+    gdft_us = slot.gdft_us.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = slot.sequence.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+
+  uint32_t chunk = before / 2;
+  if (chunk == 0 || chunk == last_chunk) {
+    frame.chunk = 0;
+    return false;
+  }
+  last_chunk = chunk;
+
+  frame.chunk = chunk;
+  frame.at[STAMP_CAPTURE] = capture_us;
+  frame.at[STAMP_GDFT] = gdft_us;
+  frame.at[STAMP_HANDOFF] = now_us;
+  return true;
+}
+
+inline void latency_stamp(LatencyFrame& frame, LatencyStamp stamp, uint32_t now_us) {
+  if (frame.chunk != 0) {
+    frame.at[stamp] = now_us;
+  }
+}
+
+// Stats ----------------------------------------------------------------------
+
+struct LatencyStats {
+  LatencyHistogram stages[NUM_LATENCY_STAGES];
+  uint32_t frames;          // Traced frames recorded since the last reset
+  volatile bool reset_requested;  // Set by readers, honoured by the recorder
+};
+
+// Add a finished frame (all stamps set) to «stats», from the one task that records
+inline void latency_record(LatencyStats& stats, const LatencyFrame& frame) {
+  if (stats.reset_requested) {
+    for (uint8_t s = 0; s < NUM_LATENCY_STAGES; s++) {
+      latency_hist_reset(stats.stages[s]);
+    }
+    stats.frames = 0;
+    stats.reset_requested = false;
+  }
+  if (frame.chunk == 0) {
+    return;
+  }
+
+  for (uint8_t s = 0; s < LATENCY_TOTAL; s++) {
+    latency_hist_add(stats.stages[s], frame.at[s + 1] - frame.at[s]);
+  }
+  latency_hist_add(stats.stages[LATENCY_TOTAL], frame.at[STAMP_TX_END] - frame.at[STAMP_CAPTURE]);
+  stats.frames++;
+}
+
+#endif // LATENCY_TRACE_H
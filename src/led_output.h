@@ -0,0 +1,94 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+/*----------------------------------------
+  Sensory Bridge LED OUTPUT (FastLED)
+  ----------------------------------------*/
+
+// Device side of led_output_driver.h. FastLED's controllers are bound to
+// the front buffers (leds_out_front, leds_out_secondary_front) and a small
+// task on core 1 runs FastLED.show() for each presented frame. On the S3
+// the RMT driver spends the transfer blocked on its own semaphore, so
+// led_thread gets the CPU back to render the next frame in the meantime.
+//
+// The same task stamps and records the traced frame it's sending
+// (latency_probe.h), handed over in start_transfer().
+
+#include <FastLED.h>
+#include "globals.h"
+#include "led_output_driver.h"
+#include "latency_probe.h"
+#include "trace_recorder.h"
+
+class FastLedTaskTransmitter : public LedTransmitter {
+ public:
+  void begin() {
+    done = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(task_entry, "led_tx", 4096, this, tskIDLE_PRIORITY + 2, &task, 1);
+  }
+
+  void start_transfer() override {
+    // The previous transfer is done (LedOutputDriver waited), so in_flight is free
+    in_flight = latency_frame;
+    latency_frame.chunk = 0;  // Keepalives and repeats of this frame aren't traced again
+    xTaskNotifyGive(task);
+  }
+
+  void wait_transfer_done() override {
+    xSemaphoreTake(done, portMAX_DELAY);
+  }
+
+  uint32_t last_transfer_us = 0;
+
+ private:
+  static void task_entry(void* arg) {
+    FastLedTaskTransmitter* self = (FastLedTaskTransmitter*)arg;
+    while (true) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+      TRACE_BEGIN(SPAN_TX);  // (trace_recorder.h)
+      uint32_t t_start = micros();
+      FastLED.show();
+      uint32_t t_end = micros();
+      TRACE_END(SPAN_TX);
+      self->last_transfer_us = t_end - t_start;
+
+      latency_stamp(self->in_flight, STAMP_TX_START, t_start);  // (latency_trace.h)
+      latency_stamp(self->in_flight, STAMP_TX_END, t_end);
+      latency_record(latency_stats, self->in_flight);
+
+      xSemaphoreGive(self->done);  // Completion notification for wait_transfer_done()
+    }
+  }
+
+  TaskHandle_t task = NULL;
+  SemaphoreHandle_t done = NULL;
+  LatencyFrame in_flight = {};
+};
+
+LedOutputDriver led_output;
+FastLedTaskTransmitter fastled_transmitter;
+
+// Called at the end of init_leds(), once the primary buffers exist
+void init_led_output() {
+  led_output.add_plane(leds_out, leds_out_front, sizeof(CRGB) * CONFIG.LED_COUNT);
+
+  fastled_transmitter.begin();
+  led_output.set_transmitter(&fastled_transmitter);
+
+  USBSerial.print("INIT_LED_OUTPUT: ");
+  USBSerial.println(SB_PASS);
+}
+
+// Called by init_secondary_leds()
+void add_secondary_led_output() {
+  led_output.flush();
+  led_output.add_plane(leds_out_secondary, leds_out_secondary_front, sizeof(CRGB) * SECONDARY_LED_COUNT);
+}
+
+// Make sure the strip is idle before calling FastLED directly
+void flush_led_output() {
+  led_output.flush();
+}
+
+#endif // LED_OUTPUT_H
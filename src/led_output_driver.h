@@ -0,0 +1,128 @@
+#ifndef LED_OUTPUT_DRIVER_H
+#define LED_OUTPUT_DRIVER_H
+
+/*----------------------------------------
+  Sensory Bridge LED OUTPUT DRIVER
+  ----------------------------------------*/
+
+// Double-buffered hand-off between the renderer and whatever clocks bits
+// out to the strip. The renderer always draws into the "back" buffer of
+// each plane (leds_out / leds_out_secondary). present() waits for the
+// previous transfer to finish, copies back -> front (the buffer the
+// transmitter reads from), starts the next transfer and returns right
+// away, so frame N+1 renders while frame N is still on the wire.
+//
+// present_if_changed() first compares each back buffer with the front copy
+// already on the strip and skips the transfer when nothing changed, which
+// covers black frames during silence and static modes. The front buffers
+// are only ever read by the transmitter, so the compare doesn't have to
+// wait for a transfer in flight.
+//
+// Nothing in here depends on Arduino or FreeRTOS: the transmitter owns the
+// completion signal, which lets test/host run this same driver against a
+// mock transmitter (test/mocks/mock_led_transmitter.h).
+
+#include <stdint.h>
+#include <string.h>
+
+#define LED_OUTPUT_MAX_PLANES 4
+#define LED_OUTPUT_KEEPALIVE_FRAMES 120  // Resend an unchanged frame this often anyway
+
+class LedTransmitter {
+ public:
+  virtual ~LedTransmitter() {}
+
+  // Start sending the front buffers, must return without waiting for the wire
+  virtual void start_transfer() = 0;
+
+  // Block until the last start_transfer() has completed
+  virtual void wait_transfer_done() = 0;
+};
+
+struct LedOutputPlane {
+  uint8_t* back;   // Written by the renderer
+  uint8_t* front;  // Read by the transmitter
+  uint32_t bytes;
+};
+
+class LedOutputDriver {
+ public:
+  LedOutputDriver() : transmitter(nullptr), num_planes(0), transfer_pending(false), frames_presented(0),
+                      frames_skipped(0), unchanged_run(0) {}
+
+  void set_transmitter(LedTransmitter* tx) {
+    flush();
+    transmitter = tx;
+  }
+
+  bool add_plane(void* back, void* front, uint32_t bytes) {
+    if (num_planes >= LED_OUTPUT_MAX_PLANES) {
+      return false;
+    }
+    planes[num_planes].back = (uint8_t*)back;
+    planes[num_planes].front = (uint8_t*)front;
+    planes[num_planes].bytes = bytes;
+    num_planes++;
+    return true;
+  }
+
+  // Hand the finished back buffers to the transmitter
+  void present() {
+    if (transmitter == nullptr) {
+      return;
+    }
+
+    flush();  // Front buffers are still on the wire until this returns
+
+    for (uint8_t i = 0; i < num_planes; i++) {
+      memcpy(planes[i].front, planes[i].back, planes[i].bytes);
+    }
+
+    transfer_pending = true;
+    transmitter->start_transfer();
+    frames_presented++;
+  }
+
+  // present(), unless every back buffer matches what's already on the strip.
+  // Returns false when the transfer was skipped.
+  bool present_if_changed() {
+    if (frames_presented > 0 && unchanged_run < LED_OUTPUT_KEEPALIVE_FRAMES) {
+      bool changed = false;
+      for (uint8_t i = 0; i < num_planes && !changed; i++) {
+        changed = memcmp(planes[i].front, planes[i].back, planes[i].bytes) != 0;
+      }
+      if (!changed) {
+        unchanged_run++;
+        frames_skipped++;
+        return false;
+      }
+    }
+
+    unchanged_run = 0;
+    present();
+    return true;
+  }
+
+  // Wait for any transfer in flight, i.e. before touching the hardware directly
+  void flush() {
+    if (transfer_pending) {
+      transmitter->wait_transfer_done();
+      transfer_pending = false;
+    }
+  }
+
+  bool busy() const { return transfer_pending; }
+  uint32_t frames() const { return frames_presented; }
+  uint32_t skipped() const { return frames_skipped; }
+
+ private:
+  LedTransmitter* transmitter;
+  LedOutputPlane planes[LED_OUTPUT_MAX_PLANES];
+  uint8_t num_planes;
+  bool transfer_pending;
+  uint32_t frames_presented;
+  uint32_t frames_skipped;
+  uint16_t unchanged_run;
+};
+
+#endif // LED_OUTPUT_DRIVER_H
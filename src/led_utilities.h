@@ -9,6 +9,12 @@
 #include "globals.h" // Assuming globals contains necessary definitions
 #include "constants.h" // Assuming constants contains necessary definitions
 #include "Palettes.h"  // Added for gradient palettes
+#include "frame_buffers.h"  // Canvases and trail buffers behind leds_16
+#include "prism_fold.h"     // Box spans and the per-pass fold behind the prism effect
+#include "latency_probe.h"  // Pipeline stage timestamps
+#include "trace_recorder.h"  // Pipeline stage spans
+#include "Logger.h"          // Deferred, rate-limited debug output
+#include "derived_tables.h"  // Lookup tables rebuilt when the CONFIG fields they read change
 
 extern bool color_shift_debug_logging_enabled;
 
@@ -22,11 +28,16 @@ void show_secondary_leds();
 void init_secondary_leds();
 void quantize_color_secondary(bool temporal_dither);
 
+// Forward declarations for the render arena (defined after the prism maps it also holds)
+void init_render_buffers();
+
 // Forward declarations for internal functions needed before their implementations
 CRGB16 adjust_hue_and_saturation(CRGB16 color, SQ15x16 hue, SQ15x16 saturation);
-void init_gamma_lut();
 extern uint8_t gamma_lut[256];
 
+// Forward declaration for the LED thread's derived tables (defined at the bottom, after what they build)
+uint8_t refresh_led_tables();
+
 enum blending_modes {
   BLEND_MIX,
   BLEND_ADD,
@@ -77,14 +88,82 @@ CRGB16 desaturate(CRGB16 input_color, SQ15x16 amount) {
   return output;
 }
 
+// Fixed-point HSV -> RGB --------------------------------------------------
+// Matches FastLED's default "rainbow" hue wheel (what CHSV -> CRGB gave us),
+// but works on a 16-bit hue and SQ15x16 directly instead of round-tripping
+// through 8-bit CHSV/CRGB. The wheel is 8 linear sections of 8192 hue steps,
+// each channel being (base + slope * frac) out of the table below, so there
+// are no per-section branches. Values are Q16 (65536 = 1.0).
+#define HSV_Q16(x) int32_t(((x) * 65536L + 127) / 255)
+
+static const int32_t hsv_rainbow_sections[8][6] = {
+  // r base,         r slope,          g base,        g slope,           b base,        b slope
+  { HSV_Q16(255),   -HSV_Q16(85),     0,             HSV_Q16(85),       0,             0             },  // red -> orange
+  { HSV_Q16(171),   0,                HSV_Q16(85),   HSV_Q16(85),       0,             0             },  // orange -> yellow
+  { HSV_Q16(171),   -HSV_Q16(170),    HSV_Q16(170),  HSV_Q16(85),       0,             0             },  // yellow -> green
+  { 0,              0,                HSV_Q16(255),  -HSV_Q16(255),     0,             HSV_Q16(255)  },  // green -> aqua
+  { 0,              0,                HSV_Q16(171),  -HSV_Q16(170),     HSV_Q16(85),   HSV_Q16(170)  },  // aqua -> blue
+  { 0,              HSV_Q16(85),      0,             0,                 HSV_Q16(255),  -HSV_Q16(85)  },  // blue -> purple
+  { HSV_Q16(85),    HSV_Q16(85),      0,             0,                 HSV_Q16(171),  -HSV_Q16(85)  },  // purple -> pink
+  { HSV_Q16(170),   HSV_Q16(85),      0,             0,                 HSV_Q16(85),   -HSV_Q16(85)  },  // pink -> red
+};
+
+// The fractional bits of an SQ15x16 are already a 16-bit hue, and taking
+// them wraps negative and >1.0 hues for free (no while loops needed)
+inline uint16_t hue_to_u16(SQ15x16 h) {
+  return uint16_t(h.getInternal() & 0xFFFF);
+}
+
+// Saturation applied the way FastLED does it: a (1-s)^2 white floor
+inline int32_t hsv_desat_q16(SQ15x16 s) {
+  int32_t s16 = s.getInternal();
+  s16 = (s16 < 0) ? 0 : ((s16 > 65536) ? 65536 : s16);
+  int32_t inv = 65536 - s16;
+  return (inv * inv) >> 16;
+}
+
+inline CRGB16 hsv16(uint16_t hue16, int32_t desat, SQ15x16 v) {
+  const int32_t* k = hsv_rainbow_sections[hue16 >> 13];
+  int32_t frac = hue16 & 0x1FFF;  // 13-bit position within the section
+
+  int32_t r = k[0] + ((k[1] * frac) >> 13);
+  int32_t g = k[2] + ((k[3] * frac) >> 13);
+  int32_t b = k[4] + ((k[5] * frac) >> 13);
+
+  int32_t sat_scale = 65536 - desat;
+  r = ((r * int64_t(sat_scale)) >> 16) + desat;
+  g = ((g * int64_t(sat_scale)) >> 16) + desat;
+  b = ((b * int64_t(sat_scale)) >> 16) + desat;
+
+  CRGB16 col = {
+    SQ15x16::fromInternal(r) * v,
+    SQ15x16::fromInternal(g) * v,
+    SQ15x16::fromInternal(b) * v
+  };
+  return col;
+}
+
 CRGB16 hsv(SQ15x16 h, SQ15x16 s, SQ15x16 v) {
+  return hsv16(hue_to_u16(h), hsv_desat_q16(s), v);
+}
+
+// Whole-array version: one saturation for the batch, hue and value per pixel
+void hsv_batch(CRGB16* out, const SQ15x16* h, SQ15x16 s, const SQ15x16* v, uint16_t count) {
+  int32_t desat = hsv_desat_q16(s);
+  for (uint16_t i = 0; i < count; i++) {
+    out[i] = hsv16(hue_to_u16(h[i]), desat, v[i]);
+  }
+}
+
+// The old FastLED round-trip, kept around as the reference for the
+// accuracy check in the performance regression suite
+CRGB16 hsv_reference(SQ15x16 h, SQ15x16 s, SQ15x16 v) {
   while (h > 1.0) { h -= 1.0; }
   while (h < 0.0) { h += 1.0; }
 
   CRGB base_color = CHSV(uint8_t(h * 255.0), uint8_t(s * 255.0), 255);
 
   CRGB16 col = { base_color.r / 255.0, base_color.g / 255.0, base_color.b / 255.0 };
-  //col = desaturate(col, SQ15x16(1.0) - s);
 
   col.r *= v;
   col.g *= v;
@@ -99,7 +178,7 @@ CRGB16 hsv(SQ15x16 h, SQ15x16 s, SQ15x16 v) {
 static const SQ15x16 knee_softness = SQ15x16(1.0); // tweakable
 
 void clip_led_values(CRGB16* buffer) { // accept buffer pointer
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     // Floor at 0
     if (buffer[i].r < 0.0) buffer[i].r = 0.0;
     if (buffer[i].g < 0.0) buffer[i].g = 0.0;
@@ -181,7 +260,7 @@ void run_sweet_spot() {
 // Returns the linear interpolation of a floating point index in a CRGB array
 // index is in the range of 0.0-1.0
 CRGB lerp_led_NEW(float index, CRGB* led_array) {
-  const uint16_t NUM_LEDS_NATIVE = NATIVE_RESOLUTION - 1;  // count from zero
+  const uint16_t NUM_LEDS_NATIVE = render_resolution - 1;  // count from zero
   uint32_t index_fp = (uint32_t)(index * (float)NUM_LEDS_NATIVE * 256.0f);
 
   if (index_fp > (NUM_LEDS_NATIVE << 8)) {
@@ -201,7 +280,7 @@ CRGB lerp_led_NEW(float index, CRGB* led_array) {
 }
 
 // Returns the linear interpolation of a floating point index in a CRGB16 array
-// index is in the range of 0.0 - float(NATIVE_RESOLUTION)
+// index is in the range of 0.0 - float(render_resolution)
 CRGB16 lerp_led_16(SQ15x16 index, CRGB16* led_array) {
   int32_t index_whole = index.getInteger();
   SQ15x16 index_fract = index - (SQ15x16)index_whole;
@@ -240,33 +319,85 @@ void apply_brightness() {
 
   SQ15x16 brightness = MASTER_BRIGHTNESS * (CONFIG.PHOTONS * CONFIG.PHOTONS) * silent_scale * hdr_boost;
   
-  if (debug_mode && (millis() % 5000 == 0)) {
-    USBSerial.print("DEBUG: Brightness components - MASTER_BRIGHTNESS: ");
-    USBSerial.print(MASTER_BRIGHTNESS);
-    USBSerial.print(" PHOTONS: ");
-    USBSerial.print(CONFIG.PHOTONS);
-    USBSerial.print(" PHOTONS²: ");
-    USBSerial.print(CONFIG.PHOTONS * CONFIG.PHOTONS);
-    USBSerial.print(" silent_scale: ");
-    USBSerial.print(float(silent_scale));
-    USBSerial.print(" Final brightness (SQ15x16): ");
-    USBSerial.print(float(brightness));
-    USBSerial.print(" Final brightness (raw): ");
-    USBSerial.println(brightness.getInteger());
-  }
-
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    leds_16[i].r *= brightness;
-    leds_16[i].g *= brightness;
-    leds_16[i].b *= brightness;
+  LOG_DEBUG_EVERY(5000, "Brightness components - MASTER_BRIGHTNESS: %.2f PHOTONS: %.2f PHOTONS²: %.2f silent_scale: %.2f Final brightness (SQ15x16): %.2f Final brightness (raw): %d",
+                  MASTER_BRIGHTNESS, CONFIG.PHOTONS, CONFIG.PHOTONS * CONFIG.PHOTONS, silent_scale, float(brightness), brightness.getInteger());  // (Logger.h)
+
+  CRGB16* source = frame_write_source();  // (frame_buffers.h) Detaches leds_16 from a trail mode's history
+  for (uint16_t i = 0; i < render_resolution; i++) {
+    leds_16[i].r = source[i].r * brightness;
+    leds_16[i].g = source[i].g * brightness;
+    leds_16[i].b = source[i].b * brightness;
   }
 
   clip_led_values(leds_16);
 }
 
+// Pixel map (pixel_map.h) -------------------------------------------------
+
+// Data pins the configured LED_TYPE drives
+uint8_t led_type_outputs() {
+  return (CONFIG.LED_TYPE == LED_NEOPIXEL_X2) ? 2 : 1;
+}
+
+// What an empty layout means: one strip per data pin, split evenly
+void default_pixel_layout(char* text, size_t length) {
+  if (led_type_outputs() == 2) {
+    snprintf(text, length, "%u/%u", CONFIG.LED_COUNT / 2, CONFIG.LED_COUNT - CONFIG.LED_COUNT / 2);
+  } else {
+    snprintf(text, length, "%u", CONFIG.LED_COUNT);
+  }
+}
+
+// Check «text» against the current LED_COUNT and LED_TYPE without applying it
+uint8_t validate_pixel_layout(const char* text, PixelLayout& layout) {
+  uint8_t error = parse_pixel_layout(text, CONFIG.LED_COUNT, layout);
+  if (error == PIXEL_MAP_OK && layout.num_outputs > led_type_outputs()) {
+    error = PIXEL_MAP_TOO_MANY_OUTPUTS;
+  }
+  return error;
+}
+
+// Built by refresh_led_tables() when LED_COUNT or REVERSE_ORDER change
+void rebuild_pixel_map() {
+  build_pixel_map(pixel_layout, CONFIG.LED_COUNT, CONFIG.REVERSE_ORDER, CONFIG.LED_COUNT, pixel_map);
+}
+
+// Called by init_leds() before the outputs are bound, they follow pixel_layout.
+// The map itself is built by the refresh_led_tables() that follows.
+void init_pixel_map() {
+  load_pixel_layout();  // (bridge_fs.h)
+
+  char text[PIXEL_MAP_LAYOUT_LEN];
+  if (pixel_layout_text[0] == '\0') {
+    default_pixel_layout(text, sizeof(text));
+  } else {
+    strncpy(text, pixel_layout_text, sizeof(text));
+  }
+
+  uint8_t error = validate_pixel_layout(text, pixel_layout);
+  if (error != PIXEL_MAP_OK) {
+    USBSerial.print("WARNING: Pixel layout \"");
+    USBSerial.print(text);
+    USBSerial.print("\" rejected (");
+    USBSerial.print(pixel_map_error_names[error]);
+    USBSerial.println("), using the default wiring");
+
+    default_pixel_layout(text, sizeof(text));
+    validate_pixel_layout(text, pixel_layout);
+  }
+
+  USBSerial.print("INIT_PIXEL_MAP: ");
+  USBSerial.print(text);
+  USBSerial.print(" (");
+  USBSerial.print(pixel_layout.num_outputs);
+  USBSerial.print(" outputs, ");
+  USBSerial.print(pixel_layout.num_segments);
+  USBSerial.println(" segments)");
+}
+
+// Every store in here goes through pixel_map, which also takes care of
+// REVERSE_ORDER, so leds_out comes out in wire order
 void quantize_color(bool temporal_dithering) {
-  // Ensure gamma LUT ready
-  init_gamma_lut();
   if (temporal_dithering) {
     dither_step++;
     if (dither_step >= 8) {  // Updated for 8-frame dithering
@@ -282,12 +413,14 @@ void quantize_color(bool temporal_dithering) {
     noise_origin_b += 1;
 
     for (uint16_t i = 0; i < CONFIG.LED_COUNT; i += 1) {
+      uint16_t p = pixel_map[i];
+
       // Skip dithering on near-black pixels to avoid sparkle
       SQ15x16 max_chan = leds_scaled[i].r;
       if (leds_scaled[i].g > max_chan) max_chan = leds_scaled[i].g;
       if (leds_scaled[i].b > max_chan) max_chan = leds_scaled[i].b;
       if (max_chan < SQ15x16(0.003)) {
-        leds_out[i].r = leds_out[i].g = leds_out[i].b = 0;
+        leds_out[p].r = leds_out[p].g = leds_out[p].b = 0;
         continue;
       }
       // RED #####################################################
@@ -299,7 +432,7 @@ void quantize_color(bool temporal_dithering) {
         whole_r += SQ15x16(1);
       }
 
-      leds_out[i].r = gamma_lut[whole_r.getInteger()];
+      leds_out[p].r = gamma_lut[whole_r.getInteger()];
 
       // GREEN ###################################################
       SQ15x16 decimal_g = leds_scaled[i].g * SQ15x16(254);
@@ -310,7 +443,7 @@ void quantize_color(bool temporal_dithering) {
         whole_g += SQ15x16(1);
       }
 
-      leds_out[i].g = gamma_lut[whole_g.getInteger()];
+      leds_out[p].g = gamma_lut[whole_g.getInteger()];
 
       // BLUE ####################################################
       SQ15x16 decimal_b = leds_scaled[i].b * SQ15x16(254);
@@ -321,20 +454,22 @@ void quantize_color(bool temporal_dithering) {
         whole_b += SQ15x16(1);
       }
 
-      leds_out[i].b = gamma_lut[whole_b.getInteger()];
+      leds_out[p].b = gamma_lut[whole_b.getInteger()];
     }
   } else {
     for (uint16_t i = 0; i < CONFIG.LED_COUNT; i += 1) {
+      uint16_t p = pixel_map[i];
+
       SQ15x16 max_chan = leds_scaled[i].r;
       if (leds_scaled[i].g > max_chan) max_chan = leds_scaled[i].g;
       if (leds_scaled[i].b > max_chan) max_chan = leds_scaled[i].b;
       if (max_chan < SQ15x16(0.003)) {
-        leds_out[i].r = leds_out[i].g = leds_out[i].b = 0;
+        leds_out[p].r = leds_out[p].g = leds_out[p].b = 0;
         continue;
       }
-      leds_out[i].r = gamma_lut[ uint8_t(leds_scaled[i].r * 255) ];
-      leds_out[i].g = gamma_lut[ uint8_t(leds_scaled[i].g * 255) ];
-      leds_out[i].b = gamma_lut[ uint8_t(leds_scaled[i].b * 255) ];
+      leds_out[p].r = gamma_lut[ uint8_t(leds_scaled[i].r * 255) ];
+      leds_out[p].g = gamma_lut[ uint8_t(leds_scaled[i].g * 255) ];
+      leds_out[p].b = gamma_lut[ uint8_t(leds_scaled[i].b * 255) ];
     }
   }
 }
@@ -343,7 +478,7 @@ void apply_incandescent_filter() {
   SQ15x16 mix = CONFIG.INCANDESCENT_FILTER;
   SQ15x16 inv_mix = 1.0 - mix;
 
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     SQ15x16 filtered_r = leds_16[i].r * incandescent_lookup.r;
     SQ15x16 filtered_g = leds_16[i].g * incandescent_lookup.g;
     SQ15x16 filtered_b = leds_16[i].b * incandescent_lookup.b;
@@ -388,8 +523,8 @@ void draw_line(CRGB16* layer, SQ15x16 x1, SQ15x16 x2, CRGB16 color, SQ15x16 alph
     lighten = false;
   }
 
-  x1 *= (SQ15x16)(NATIVE_RESOLUTION - 1);
-  x2 *= (SQ15x16)(NATIVE_RESOLUTION - 1);
+  x1 *= (SQ15x16)(render_resolution - 1);
+  x2 *= (SQ15x16)(render_resolution - 1);
 
   if (x1 > x2) {  // Ensure x1 <= x2
     SQ15x16 temp = x1;
@@ -401,7 +536,7 @@ void draw_line(CRGB16* layer, SQ15x16 x1, SQ15x16 x2, CRGB16 color, SQ15x16 alph
   SQ15x16 ix2 = ceilFixed(x2);
 
   // start pixel
-  if (ix1 >= 0 && ix1 < NATIVE_RESOLUTION) {
+  if (ix1 >= 0 && ix1 < render_resolution) {
     SQ15x16 coverage = 1.0 - (x1 - ix1);
     SQ15x16 mix = alpha * coverage;
 
@@ -417,7 +552,7 @@ void draw_line(CRGB16* layer, SQ15x16 x1, SQ15x16 x2, CRGB16 color, SQ15x16 alph
   }
 
   // end pixel
-  if (ix2 >= 0 && ix2 < NATIVE_RESOLUTION) {
+  if (ix2 >= 0 && ix2 < render_resolution) {
     SQ15x16 coverage = x2 - floorFixed(x2);
     SQ15x16 mix = alpha * coverage;
 
@@ -434,7 +569,7 @@ void draw_line(CRGB16* layer, SQ15x16 x1, SQ15x16 x2, CRGB16 color, SQ15x16 alph
 
   // pixels in between
   for (SQ15x16 i = ix1 + 1; i < ix2; i++) {
-    if (i >= 0 && i < NATIVE_RESOLUTION) {
+    if (i >= 0 && i < render_resolution) {
       layer[i.getInteger()].r += color.r * alpha;
       layer[i.getInteger()].g += color.g * alpha;
       layer[i.getInteger()].b += color.b * alpha;
@@ -485,7 +620,7 @@ void render_photons_graph() {
 
   //draw_line(leds_16_ui, 0.0, 0.5, background, 1.0);
 
-  memset(leds_16_ui, 0, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memset(leds_16_ui, 0, sizeof(CRGB16) * render_resolution);
 
   for (uint8_t i = 0; i < ticks; i++) {
     SQ15x16 prog = i / float(ticks);
@@ -507,10 +642,10 @@ void render_photons_graph() {
 }
 
 void render_chroma_graph() {
-  memset(leds_16_ui, 0, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memset(leds_16_ui, 0, sizeof(CRGB16) * render_resolution);
 
-  SQ15x16 half_height = NATIVE_RESOLUTION >> 1;
-  SQ15x16 quarter_height = NATIVE_RESOLUTION >> 2;
+  SQ15x16 half_height = render_resolution >> 1;
+  SQ15x16 quarter_height = render_resolution >> 2;
 
   if (chromatic_mode == false) {
     for (SQ15x16 i = 5; i < half_height - 5; i++) {
@@ -559,7 +694,7 @@ void render_mood_graph() {
 
   //draw_line(leds_16_ui, 0.0, 0.5, background, 1.0);
 
-  memset(leds_16_ui, 0, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memset(leds_16_ui, 0, sizeof(CRGB16) * render_resolution);
 
   static float radians = 0.0;
   radians -= 0.02;
@@ -596,8 +731,8 @@ void transition_ui_mask_to_height(SQ15x16 target_height) {
     ui_mask_height = 1.0;
   }
 
-  memset(ui_mask, 0, sizeof(SQ15x16) * NATIVE_RESOLUTION);
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION * ui_mask_height; i++) {
+  memset(ui_mask, 0, sizeof(SQ15x16) * render_resolution);
+  for (uint16_t i = 0; i < render_resolution * ui_mask_height; i++) {
     ui_mask[i] = SQ15x16(1.0);
   }
 }
@@ -606,7 +741,7 @@ void render_noise_cal() {
   // Noise cal UI
   float noise_cal_progress = (float)noise_iterations / 256.0f; // Ensure float division
 
-  uint16_t half_res = NATIVE_RESOLUTION >> 1;
+  uint16_t half_res = render_resolution >> 1;
   uint16_t prog_led_index = half_res * noise_cal_progress;
   float max_val = 0.0;
   for (uint16_t i = 0; i < NUM_FREQS; i++) {
@@ -663,7 +798,7 @@ void render_ui() {
   }
 
   if (ui_mask_height > 0.005 || noise_complete == false) {
-    for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    for (uint16_t i = 0; i < render_resolution; i++) {
       SQ15x16 mix = ui_mask[i];
       SQ15x16 mix_inv = SQ15x16(1.0) - mix;
 
@@ -676,58 +811,51 @@ void render_ui() {
   }
 }
 
-struct LerpParams {
-    int32_t index_left;
-    int32_t index_right;
-    SQ15x16 mix_left;
-    SQ15x16 mix_right;
-};
-LerpParams* led_lerp_params = NULL;
-bool lerp_params_initialized = false;
-
-void init_lerp_params() {
-    if (CONFIG.LED_COUNT != NATIVE_RESOLUTION && !lerp_params_initialized) {
-        if (led_lerp_params) delete[] led_lerp_params;
-        led_lerp_params = new LerpParams[CONFIG.LED_COUNT];
-        
-        for (uint16_t i = 0; i < CONFIG.LED_COUNT; i++) {
-            SQ15x16 prog = SQ15x16(i) / SQ15x16(CONFIG.LED_COUNT);
-            SQ15x16 index = prog * SQ15x16(NATIVE_RESOLUTION);
-            
-            led_lerp_params[i].index_left = index.getInteger();
-            led_lerp_params[i].index_right = led_lerp_params[i].index_left + 1;
-            SQ15x16 index_fract = index - SQ15x16(led_lerp_params[i].index_left);
-            led_lerp_params[i].mix_left = SQ15x16(1.0) - index_fract;
-            led_lerp_params[i].mix_right = index_fract;
-        }
-        lerp_params_initialized = true;
+// Resample «src» onto «dst» with linear interpolation. Renders at the strip's
+// own resolution (RENDER_MODE_NATIVE) skip straight to a memcpy, and the
+// exact 2x of RENDER_MODE_HALF only needs shifts and adds.
+void scale_led_buffer(const CRGB16* src, uint16_t src_count, CRGB16* dst, uint16_t dst_count) {
+  if (src_count == dst_count) {
+    memcpy(dst, src, sizeof(CRGB16) * dst_count);
+    return;
+  }
+
+  if (dst_count == src_count * 2) {
+    for (uint16_t i = 0; i < src_count; i++) {
+      const CRGB16& a = src[i];
+      const CRGB16& b = src[(i + 1 < src_count) ? i + 1 : i];
+
+      dst[(i << 1) + 0] = a;
+      dst[(i << 1) + 1].r = SQ15x16::fromInternal((a.r.getInternal() + b.r.getInternal()) >> 1);
+      dst[(i << 1) + 1].g = SQ15x16::fromInternal((a.g.getInternal() + b.g.getInternal()) >> 1);
+      dst[(i << 1) + 1].b = SQ15x16::fromInternal((a.b.getInternal() + b.b.getInternal()) >> 1);
     }
-}
+    return;
+  }
+
+  // Q16 source index, stepped instead of divided per pixel
+  uint32_t step = (uint32_t(src_count) << 16) / dst_count;
+  uint32_t index = 0;
+  for (uint16_t i = 0; i < dst_count; i++) {
+    uint16_t index_left = index >> 16;
+    uint16_t index_right = (index_left + 1 < src_count) ? index_left + 1 : index_left;
+    SQ15x16 mix_right = SQ15x16::fromInternal(index & 0xFFFF);
+    SQ15x16 mix_left = SQ15x16(1.0) - mix_right;
+
+    dst[i].r = src[index_left].r * mix_left + src[index_right].r * mix_right;
+    dst[i].g = src[index_left].g * mix_left + src[index_right].g * mix_right;
+    dst[i].b = src[index_left].b * mix_left + src[index_right].b * mix_right;
 
+    index += step;
+  }
+}
 
 void scale_to_strip() {
     if (!leds_scaled) {
         return;
     }
-    
-    if (CONFIG.LED_COUNT == NATIVE_RESOLUTION) {
-        memcpy(leds_scaled, leds_16, sizeof(CRGB16)*NATIVE_RESOLUTION);
-    } else {
-        if (!lerp_params_initialized) {
-            init_lerp_params();
-        }
-        
-        for (uint16_t i = 0; i < CONFIG.LED_COUNT; i++) {
-            int32_t index_left = led_lerp_params[i].index_left;
-            int32_t index_right = led_lerp_params[i].index_right;
-            SQ15x16 mix_left = led_lerp_params[i].mix_left;
-            SQ15x16 mix_right = led_lerp_params[i].mix_right;
-            
-            leds_scaled[i].r = leds_16[index_left].r * mix_left + leds_16[index_right].r * mix_right;
-            leds_scaled[i].g = leds_16[index_left].g * mix_left + leds_16[index_right].g * mix_right;
-            leds_scaled[i].b = leds_16[index_left].b * mix_left + leds_16[index_right].b * mix_right;
-        }
-    }
+
+    scale_led_buffer(leds_16, render_resolution, leds_scaled, CONFIG.LED_COUNT);
 }
 
 void show_leds() {
@@ -784,15 +912,14 @@ void show_leds() {
     show_secondary_leds();
   }
   
-  quantize_color(CONFIG.TEMPORAL_DITHERING);
-
-  if (CONFIG.REVERSE_ORDER == true) {
-    reverse_leds(leds_out, CONFIG.LED_COUNT);
-  }
+  TRACE_BEGIN(SPAN_QUANTIZE);  // (trace_recorder.h)
+  quantize_color(CONFIG.TEMPORAL_DITHERING && quality_allows_dithering());  // (quality_governor.h)
+  TRACE_END(SPAN_QUANTIZE);
+  latency_frame_stamp(STAMP_QUANTIZE);  // (latency_probe.h)
 
-  if (debug_mode && (millis() % 10000 == 0)) {
+  if (LOG_DEBUG_ENABLED && LOG_EVERY_MS(10000)) {  // (Logger.h)
     bool has_light = false;
-    uint16_t first_nonzero = NATIVE_RESOLUTION;
+    uint16_t first_nonzero = render_resolution;
     uint16_t last_nonzero = 0;
     
     for (uint16_t i = 0; i < CONFIG.LED_COUNT; i++) {
@@ -803,40 +930,26 @@ void show_leds() {
       }
     }
     
-    USBSerial.print("DEBUG: LED Output - HasLight: ");
-    USBSerial.print(has_light ? "YES" : "NO");
     if (has_light) {
-      USBSerial.print(" Range: ");
-      USBSerial.print(first_nonzero);
-      USBSerial.print("-");
-      USBSerial.print(last_nonzero);
-      USBSerial.print(" (");
-      USBSerial.print(last_nonzero - first_nonzero + 1);
-      USBSerial.print(" LEDs)");
+      LOG_DEBUG("LED Output - HasLight: YES Range: %u-%u (%u LEDs)", first_nonzero, last_nonzero, last_nonzero - first_nonzero + 1);
+    } else {
+      LOG_DEBUG("LED Output - HasLight: NO");
     }
-    USBSerial.println();
   }
 
   FastLED.setDither(false);
-  FastLED.show(); // This will update both LED strips
-
-  // Add inside show_leds() function, just before FastLED.show()
-  if (debug_mode && (millis() % 5000 == 0)) {
-    USBSerial.print("DEBUG: Using modes - Primary: ");
-    USBSerial.print(CONFIG.LIGHTSHOW_MODE);
-    USBSerial.print(" (");
-    USBSerial.print(mode_names + (CONFIG.LIGHTSHOW_MODE * 32));
-    USBSerial.print(")");
-    
+  TRACE_BEGIN(SPAN_PRESENT);
+  led_output.present_if_changed();  // (led_output.h) Queues both strips for transmission and returns, unless nothing changed
+  TRACE_END(SPAN_PRESENT);
+
+  if (LOG_DEBUG_ENABLED && LOG_EVERY_MS(5000)) {
     if (ENABLE_SECONDARY_LEDS) {
-      USBSerial.print(", Secondary: ");
-      USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
-      USBSerial.print(" (");
-      USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
-      USBSerial.print(")");
+      LOG_DEBUG("Using modes - Primary: %u (%s), Secondary: %u (%s)",
+                CONFIG.LIGHTSHOW_MODE, mode_names + (CONFIG.LIGHTSHOW_MODE * 32),
+                SECONDARY_LIGHTSHOW_MODE, mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
+    } else {
+      LOG_DEBUG("Using modes - Primary: %u (%s)", CONFIG.LIGHTSHOW_MODE, mode_names + (CONFIG.LIGHTSHOW_MODE * 32));
     }
-    
-    USBSerial.println();
   }
 }
 
@@ -850,10 +963,12 @@ void init_leds() {
   }
 
   leds_scaled = new CRGB16[CONFIG.LED_COUNT];
-  leds_out = new CRGB[CONFIG.LED_COUNT];
+  leds_out = new CRGB[CONFIG.LED_COUNT + 1];  // +1: sink for unmapped pixels (pixel_map.h)
+  leds_out_front = new CRGB[CONFIG.LED_COUNT];
+  pixel_map = new uint16_t[CONFIG.LED_COUNT];
   
   // TACTICAL FIX: Check allocation success
-  if (leds_scaled == nullptr || leds_out == nullptr) {
+  if (leds_scaled == nullptr || leds_out == nullptr || leds_out_front == nullptr || pixel_map == nullptr) {
     USBSerial.println("ERROR: Failed to allocate LED buffers!");
     ESP.restart();
   }
@@ -875,39 +990,52 @@ void init_leds() {
     }
   }
   
-  // Initialize the lerp parameters for scale_to_strip optimization
-  init_lerp_params();
+  // Render buffers are sized from the strip, so this has to follow the LED_COUNT check above
+  init_render_buffers();
+  init_pixel_map();
+  refresh_led_tables();  // Pixel map, gamma and palette LUTs, before anything is shown
+
+  // Output boundaries on the wire, from the pixel layout
+  uint16_t out_1_start = pixel_layout.output_start[0];
+  uint16_t out_1_count = pixel_layout.output_count[0];
+  uint16_t out_2_start = pixel_layout.output_start[1];
+  uint16_t out_2_count = pixel_layout.output_count[1];
+  if (pixel_layout.num_outputs < 2) {  // Single output layout on two pins, split evenly as before
+    out_1_count = CONFIG.LED_COUNT / 2;
+    out_2_start = out_1_count;
+    out_2_count = CONFIG.LED_COUNT - out_1_count;
+  }
 
   if (CONFIG.LED_TYPE == LED_NEOPIXEL) {
     if (CONFIG.LED_COLOR_ORDER == RGB) {
-      FastLED.addLeds<WS2812B, LED_DATA_PIN, RGB>(leds_out, CONFIG.LED_COUNT);
+      FastLED.addLeds<WS2812B, LED_DATA_PIN, RGB>(leds_out_front, CONFIG.LED_COUNT);
     } else if (CONFIG.LED_COLOR_ORDER == GRB) {
-      FastLED.addLeds<WS2812B, LED_DATA_PIN, GRB>(leds_out, CONFIG.LED_COUNT);
+      FastLED.addLeds<WS2812B, LED_DATA_PIN, GRB>(leds_out_front, CONFIG.LED_COUNT);
     } else if (CONFIG.LED_COLOR_ORDER == BGR) {
-      FastLED.addLeds<WS2812B, LED_DATA_PIN, BGR>(leds_out, CONFIG.LED_COUNT);
+      FastLED.addLeds<WS2812B, LED_DATA_PIN, BGR>(leds_out_front, CONFIG.LED_COUNT);
     }
   }
 
   else if (CONFIG.LED_TYPE == LED_NEOPIXEL_X2) {
     if (CONFIG.LED_COLOR_ORDER == RGB) {
-      FastLED.addLeds< WS2812B, LED_DATA_PIN_1,  RGB >(leds_out, 0, CONFIG.LED_COUNT / 2);
-      FastLED.addLeds< WS2812B, LED_DATA_PIN_2, RGB >(leds_out, CONFIG.LED_COUNT / 2, CONFIG.LED_COUNT / 2);
+      FastLED.addLeds< WS2812B, LED_DATA_PIN_1, RGB >(leds_out_front, out_1_start, out_1_count);
+      FastLED.addLeds< WS2812B, LED_DATA_PIN_2, RGB >(leds_out_front, out_2_start, out_2_count);
     } else if (CONFIG.LED_COLOR_ORDER == GRB) {
-      FastLED.addLeds< WS2812B, LED_DATA_PIN_1,  GRB >(leds_out, 0, CONFIG.LED_COUNT / 2);
-      FastLED.addLeds< WS2812B, LED_DATA_PIN_2, GRB >(leds_out, CONFIG.LED_COUNT / 2, CONFIG.LED_COUNT / 2);
+      FastLED.addLeds< WS2812B, LED_DATA_PIN_1, GRB >(leds_out_front, out_1_start, out_1_count);
+      FastLED.addLeds< WS2812B, LED_DATA_PIN_2, GRB >(leds_out_front, out_2_start, out_2_count);
     } else if (CONFIG.LED_COLOR_ORDER == BGR) {
-      FastLED.addLeds< WS2812B, LED_DATA_PIN_1,  BGR >(leds_out, 0, CONFIG.LED_COUNT / 2);
-      FastLED.addLeds< WS2812B, LED_DATA_PIN_2, BGR >(leds_out, CONFIG.LED_COUNT / 2, CONFIG.LED_COUNT / 2);
+      FastLED.addLeds< WS2812B, LED_DATA_PIN_1, BGR >(leds_out_front, out_1_start, out_1_count);
+      FastLED.addLeds< WS2812B, LED_DATA_PIN_2, BGR >(leds_out_front, out_2_start, out_2_count);
     }
   }
 
   else if (CONFIG.LED_TYPE == LED_DOTSTAR) {
     if (CONFIG.LED_COLOR_ORDER == RGB) {
-      FastLED.addLeds<DOTSTAR, LED_DATA_PIN, LED_CLOCK_PIN, RGB>(leds_out, CONFIG.LED_COUNT);
+      FastLED.addLeds<DOTSTAR, LED_DATA_PIN, LED_CLOCK_PIN, RGB>(leds_out_front, CONFIG.LED_COUNT);
     } else if (CONFIG.LED_COLOR_ORDER == GRB) {
-      FastLED.addLeds<DOTSTAR, LED_DATA_PIN, LED_CLOCK_PIN, GRB>(leds_out, CONFIG.LED_COUNT);
+      FastLED.addLeds<DOTSTAR, LED_DATA_PIN, LED_CLOCK_PIN, GRB>(leds_out_front, CONFIG.LED_COUNT);
     } else if (CONFIG.LED_COLOR_ORDER == BGR) {
-      FastLED.addLeds<DOTSTAR, LED_DATA_PIN, LED_CLOCK_PIN, BGR>(leds_out, CONFIG.LED_COUNT);
+      FastLED.addLeds<DOTSTAR, LED_DATA_PIN, LED_CLOCK_PIN, BGR>(leds_out_front, CONFIG.LED_COUNT);
     }
   }
 
@@ -915,10 +1043,14 @@ void init_leds() {
 
   for (uint16_t x = 0; x < CONFIG.LED_COUNT; x++) {
     leds_out[x] = CRGB(0, 0, 0);
+    leds_out_front[x] = CRGB(0, 0, 0);
   }
+  leds_out[CONFIG.LED_COUNT] = CRGB(0, 0, 0);
   FastLED.show();  // Just show the LEDs directly during init instead of calling show_leds()
   delay(100); // Give FastLED time to initialize on S3
 
+  init_led_output();  // (led_output.h) Every show_leds() after this is asynchronous
+
   leds_started = true;
 
   USBSerial.print("INIT_LEDS: ");
@@ -927,29 +1059,30 @@ void init_leds() {
 
 void blocking_flash(CRGB16 col) {
   led_thread_halt = true;
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     leds_16[i] = { 0, 0, 0 };
   }
 
   const uint8_t flash_times = 2;
+  uint16_t margin = (render_resolution * 3) / 10;  // 48 of 160
   for (uint8_t f = 0; f < flash_times; f++) {
-    for (uint8_t i = 0 + 48; i < NATIVE_RESOLUTION - 48; i++) {
+    for (uint16_t i = margin; i < render_resolution - margin; i++) {
       leds_16[i] = col;
     }
     show_leds();
-    FastLED.delay(150);
+    delay(150);  // Not FastLED.delay(), only the led_tx task may call show() (led_output.h)
 
-    for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    for (uint16_t i = 0; i < render_resolution; i++) {
       leds_16[i] = { 0, 0, 0 };
     }
     show_leds();
-    FastLED.delay(150);
+    delay(150);
   }
   led_thread_halt = false;
 }
 
 void clear_all_led_buffers() {
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     leds_16[i] = { 0, 0, 0 };
     leds_16_temp[i] = { 0, 0, 0 };
     leds_16_fx[i] = { 0, 0, 0 };
@@ -962,20 +1095,20 @@ void clear_all_led_buffers() {
 }
 
 void scale_image_to_half(CRGB16* led_array) {
-  for (uint16_t i = 0; i < (NATIVE_RESOLUTION >> 1); i++) {
+  for (uint16_t i = 0; i < (render_resolution >> 1); i++) {
     leds_16_temp[i].r = led_array[i << 1].r * SQ15x16(0.5) + led_array[(i << 1) + 1].r * SQ15x16(0.5);
     leds_16_temp[i].g = led_array[i << 1].g * SQ15x16(0.5) + led_array[(i << 1) + 1].g * SQ15x16(0.5);
     leds_16_temp[i].b = led_array[i << 1].b * SQ15x16(0.5) + led_array[(i << 1) + 1].b * SQ15x16(0.5);
     // Clear the second half of the temp buffer
-    leds_16_temp[(NATIVE_RESOLUTION >> 1) + i] = { 0, 0, 0 };
+    leds_16_temp[(render_resolution >> 1) + i] = { 0, 0, 0 };
   }
 
-  memcpy(led_array, leds_16_temp, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memcpy(led_array, leds_16_temp, sizeof(CRGB16) * render_resolution);
 }
 
 void unmirror() {
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {  // Interpolation
-    SQ15x16 index = (NATIVE_RESOLUTION >> 1) + (i / 2.0);
+  for (uint16_t i = 0; i < render_resolution; i++) {  // Interpolation
+    SQ15x16 index = (render_resolution >> 1) + (i / 2.0);
 
     int32_t index_whole = index.getInteger();
     SQ15x16 index_fract = index - (SQ15x16)index_whole;
@@ -994,30 +1127,27 @@ void unmirror() {
     leds_16_temp[i] = out_col;
   }
 
-  memcpy(leds_16, leds_16_temp, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memcpy(leds_16, leds_16_temp, sizeof(CRGB16) * render_resolution);
 }
 
 void shift_leds_up(CRGB16* led_array, uint16_t offset) {
-  memcpy(leds_16_temp, led_array, sizeof(CRGB16) * NATIVE_RESOLUTION);
-  memcpy(led_array + offset, leds_16_temp, (NATIVE_RESOLUTION - offset) * sizeof(CRGB16));
+  memcpy(leds_16_temp, led_array, sizeof(CRGB16) * render_resolution);
+  memcpy(led_array + offset, leds_16_temp, (render_resolution - offset) * sizeof(CRGB16));
   memset(led_array, 0, offset * sizeof(CRGB16));
 }
 
 void shift_leds_down(CRGB* led_array, uint16_t offset) {
-  memcpy(led_array, led_array + offset, (NATIVE_RESOLUTION - offset) * sizeof(CRGB));
-  memset(led_array + (NATIVE_RESOLUTION - offset), 0, offset * sizeof(CRGB));
+  memcpy(led_array, led_array + offset, (render_resolution - offset) * sizeof(CRGB));
+  memset(led_array + (render_resolution - offset), 0, offset * sizeof(CRGB));
 }
 
 void mirror_image_downwards(CRGB16* led_array) {
-  uint16_t half_res = NATIVE_RESOLUTION >> 1;
+  uint16_t half_res = render_resolution >> 1;
   for (uint16_t i = 0; i < half_res; i++) { // Loop up to half resolution
-    // Copy the pixel from the second half
-    leds_16_temp[half_res + i] = led_array[half_res + i];
-    // Mirror it to the first half (e.g., index 159 mirrors to 0, 158 to 1, etc.)
-    leds_16_temp[half_res - 1 - i] = led_array[half_res + i];
+    // Mirror the second half onto the first (e.g., index 159 mirrors to 0, 158 to 1, etc.)
+    // Only the first half is written, so this is safe in place
+    led_array[half_res - 1 - i] = led_array[half_res + i];
   }
-
-  memcpy(led_array, leds_16_temp, sizeof(CRGB16) * NATIVE_RESOLUTION);
 }
 
 void intro_animation() {
@@ -1041,8 +1171,8 @@ void intro_animation() {
     #endif
 
     float pos = (cos(progress * 5) + 1) / 2.0;
-    float pos_whole = pos * NATIVE_RESOLUTION;
-    for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    float pos_whole = pos * render_resolution;
+    for (uint16_t i = 0; i < render_resolution; i++) {
       float delta = fabs(pos_whole - i);
       if (delta > 5.0) {
         delta = 5.0;
@@ -1109,8 +1239,8 @@ void intro_animation() {
       particles[p].phase += particles[p].speed;
 
       float pos = (sin(particles[p].phase * 5) + 1) / 2.0;
-      float pos_whole = pos * NATIVE_RESOLUTION;
-      for (uint8_t pix = 0; pix < NATIVE_RESOLUTION; pix++) {
+      float pos_whole = pos * render_resolution;
+      for (uint16_t pix = 0; pix < render_resolution; pix++) {
         float delta = fabs(pos_whole - pix);
         if (delta > 10.0) {
           delta = 10.0;
@@ -1127,7 +1257,7 @@ void intro_animation() {
       }
     }
     show_leds();
-    FastLED.delay(1);
+    delay(1);
   }
   MASTER_BRIGHTNESS = 0.0;
   #ifndef ARDUINO_ESP32S3_DEV
@@ -1137,6 +1267,8 @@ void intro_animation() {
   #endif
 }
 
+// Fade to black and back for noise calibration. Mode changes cross-fade
+// instead, see mode_transition.h.
 void run_transition_fade() {
   if (MASTER_BRIGHTNESS > 0.0) {
     MASTER_BRIGHTNESS -= 0.02;
@@ -1145,19 +1277,6 @@ void run_transition_fade() {
       MASTER_BRIGHTNESS = 0.0;
     }
   } else {
-    if (mode_transition_queued == true) {  // If transition for MODE button press
-      mode_transition_queued = false;
-      if (mode_destination == -1) {  // Triggered via button
-        CONFIG.LIGHTSHOW_MODE++;
-        if (CONFIG.LIGHTSHOW_MODE >= NUM_MODES) {
-          CONFIG.LIGHTSHOW_MODE = 0;
-        }
-      } else {  // Triggered via Serial
-        CONFIG.LIGHTSHOW_MODE = mode_destination;
-        mode_destination = -1;
-      }
-    }
-
     if (noise_transition_queued == true) {  // If transition for NOISE button press
       noise_transition_queued = false;
       // start noise cal
@@ -1172,8 +1291,8 @@ void run_transition_fade() {
 
 /*
 void distort_exponential() {
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    float prog = i / float(NATIVE_RESOLUTION - 1);
+  for (uint16_t i = 0; i < render_resolution; i++) {
+    float prog = i / float(render_resolution - 1);
     float prog_distorted = prog * prog;
     leds_fx[i] = lerp_led_NEW(prog_distorted, leds);
   }
@@ -1181,8 +1300,8 @@ void distort_exponential() {
 }
 
 void distort_logarithmic() {
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    float prog = i / float(NATIVE_RESOLUTION - 1);
+  for (uint16_t i = 0; i < render_resolution; i++) {
+    float prog = i / float(render_resolution - 1);
     float prog_distorted = sqrt(prog);
     leds_fx[i] = lerp_led_NEW(prog_distorted, leds);
   }
@@ -1190,7 +1309,7 @@ void distort_logarithmic() {
 }
 
 void increase_saturation(uint8_t amount) {
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     CHSV hsv = rgb2hsv_approximate(leds[i]);
     hsv.s = qadd8(hsv.s, amount);
     leds[i] = hsv;
@@ -1200,14 +1319,14 @@ void increase_saturation(uint8_t amount) {
 void fade_top_half(bool shifted = false) {
   int16_t shift = 0;
   if (shifted == true) {
-    shift -= (NATIVE_RESOLUTION >> 1); // Use half resolution
+    shift -= (render_resolution >> 1); // Use half resolution
   }
-  for (uint8_t i = 0; i < (NATIVE_RESOLUTION >> 1); i++) {
-    float fade = i / float(NATIVE_RESOLUTION >> 1);
+  for (uint16_t i = 0; i < (render_resolution >> 1); i++) {
+    float fade = i / float(render_resolution >> 1);
 
-    leds[(NATIVE_RESOLUTION - 1 - i) + shift].r *= fade;
-    leds[(NATIVE_RESOLUTION - 1 - i) + shift].g *= fade;
-    leds[(NATIVE_RESOLUTION - 1 - i) + shift].b *= fade;
+    leds[(render_resolution - 1 - i) + shift].r *= fade;
+    leds[(render_resolution - 1 - i) + shift].g *= fade;
+    leds[(render_resolution - 1 - i) + shift].b *= fade;
   }
 }
 */
@@ -1257,7 +1376,7 @@ uint8_t apply_contrast(uint8_t value, uint8_t intensity) {
 
 /*
 void force_incandescent_output() {
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     uint8_t max_val = 0;
     if (leds[i].r > max_val) { max_val = leds[i].r; }
     if (leds[i].g > max_val) { max_val = leds[i].g; }
@@ -1273,20 +1392,21 @@ void force_incandescent_output() {
 
 void render_bulb_cover() {
   SQ15x16 cover[4] = { 0.25, 1.00, 0.25, 0.00 };
+  CRGB16* source = frame_write_source();  // (frame_buffers.h)
 
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     CRGB16 covered_color = {
-      leds_16[i].r * cover[i % 4],
-      leds_16[i].g * cover[i % 4],
-      leds_16[i].b * cover[i % 4],
+      source[i].r * cover[i % 4],
+      source[i].g * cover[i % 4],
+      source[i].b * cover[i % 4],
     };
 
     SQ15x16 bulb_opacity = CONFIG.BULB_OPACITY;
     SQ15x16 bulb_opacity_inv = 1.0 - bulb_opacity;
 
-    leds_16[i].r = leds_16[i].r * bulb_opacity_inv + covered_color.r * bulb_opacity;
-    leds_16[i].g = leds_16[i].g * bulb_opacity_inv + covered_color.g * bulb_opacity;
-    leds_16[i].b = leds_16[i].b * bulb_opacity_inv + covered_color.b * bulb_opacity;
+    leds_16[i].r = source[i].r * bulb_opacity_inv + covered_color.r * bulb_opacity;
+    leds_16[i].g = source[i].g * bulb_opacity_inv + covered_color.g * bulb_opacity;
+    leds_16[i].b = source[i].b * bulb_opacity_inv + covered_color.b * bulb_opacity;
   }
 }
 
@@ -1308,19 +1428,19 @@ CRGB force_hue(CRGB input, uint8_t hue) {
 
 void blend_buffers(CRGB16* output_array, CRGB16* input_a, CRGB16* input_b, uint8_t blend_mode, SQ15x16 mix) {
   if (blend_mode == BLEND_MIX) {
-    for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    for (uint16_t i = 0; i < render_resolution; i++) {
       output_array[i].r = input_a[i].r * (1.0 - mix) + input_b[i].r * (mix);
       output_array[i].g = input_a[i].g * (1.0 - mix) + input_b[i].g * (mix);
       output_array[i].b = input_a[i].b * (1.0 - mix) + input_b[i].b * (mix);
     }
   } else if (blend_mode == BLEND_ADD) {
-    for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    for (uint16_t i = 0; i < render_resolution; i++) {
       output_array[i].r = input_a[i].r + (input_b[i].r * mix);
       output_array[i].g = input_a[i].g + (input_b[i].g * mix);
       output_array[i].b = input_a[i].b + (input_b[i].b * mix);
     }
   } else if (blend_mode == BLEND_MULTIPLY) {
-    for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    for (uint16_t i = 0; i < render_resolution; i++) {
       output_array[i].r = input_a[i].r * input_b[i].r;
       output_array[i].g = input_a[i].g * input_b[i].g;
       output_array[i].b = input_a[i].b * input_b[i].b;
@@ -1328,76 +1448,322 @@ void blend_buffers(CRGB16* output_array, CRGB16* input_a, CRGB16* input_b, uint8
   }
 }
 
+// Prism ----------------------------------------------------------------------
+// Each prism pass used to be: copy the frame, scale it to half, shift it up,
+// mirror it downwards, recolor every pixel and add it back. Geometrically
+// that fold is always the same linear map P (prism_fold.h). Applying it k
+// times is a box average over a contiguous run of 2^k pixels, so each fold
+// depth is just a precomputed start index into a prefix sum.
+//
+// The recolor is a 3x3 matrix: a hue rotation about the gray axis followed
+// by a saturation scale towards gray. All of these commute with each other
+// and with P, so N passes of (I + opacity * M_i * P) expand into one
+// polynomial sum(C_k * P^k) whose C_k are built once per frame, and the
+// whole effect becomes a single pass over the output buffer.
+//
+// How deep the fold stays a single box depends on the resolution (5 levels
+// at 160, 1 at 150), so the maps are rebuilt whenever render_resolution
+// changes. Passes deeper than that start from the deepest box and fold one
+// pass at a time, one more trip over the frame each.
+
+#define PRISM_MAX_LEVEL 6
+
+// Each render_capacity (+1 for the sums) long, carved from the render arena
+static uint16_t* prism_span_start[PRISM_MAX_LEVEL + 1];
+static int32_t* prism_sum_r;
+static int32_t* prism_sum_g;
+static int32_t* prism_sum_b;
+static int32_t* prism_fold_r;  // Passes past prism_levels, folded from here
+static int32_t* prism_fold_g;
+static int32_t* prism_fold_b;
+static uint16_t prism_maps_resolution = 0;
+static uint8_t prism_levels = 0;  // Deepest level that is still one contiguous box
+
+void init_prism_maps() {
+  if (prism_maps_resolution == render_resolution) return;
+  prism_levels = prism_build_spans(prism_span_start, PRISM_MAX_LEVEL, render_resolution);  // (prism_fold.h)
+  prism_maps_resolution = render_resolution;
+}
+
+struct ColorMatrix {
+  float m[3][3];
+};
+
+static void color_matrix_identity(ColorMatrix& out) {
+  for (uint8_t r = 0; r < 3; r++) {
+    for (uint8_t c = 0; c < 3; c++) {
+      out.m[r][c] = (r == c) ? 1.0 : 0.0;
+    }
+  }
+}
+
+// out += scale * (a * b)
+static void color_matrix_mul_add(ColorMatrix& out, const ColorMatrix& a, const ColorMatrix& b, float scale) {
+  for (uint8_t r = 0; r < 3; r++) {
+    for (uint8_t c = 0; c < 3; c++) {
+      float sum = 0.0;
+      for (uint8_t i = 0; i < 3; i++) {
+        sum += a.m[r][i] * b.m[i][c];
+      }
+      out.m[r][c] += scale * sum;
+    }
+  }
+}
+
+// Rotate hue by «turns» around the gray axis, then scale saturation:
+// M = G + s * (R - G), G being the projection onto gray (all 1/3)
+void prism_color_matrix(ColorMatrix& out, float turns, float saturation) {
+  float angle = turns * 2.0 * PI;
+  float c = cos(angle);
+  float s = sin(angle) * 0.57735027;  // sin / sqrt(3)
+  float g = 1.0 / 3.0;
+
+  float diag = saturation * (c + (1.0 - c) * g - g) + g;
+  float off_pos = saturation * ((1.0 - c) * g + s - g) + g;
+  float off_neg = saturation * ((1.0 - c) * g - s - g) + g;
+
+  out.m[0][0] = diag;    out.m[0][1] = off_neg; out.m[0][2] = off_pos;
+  out.m[1][0] = off_pos; out.m[1][1] = diag;    out.m[1][2] = off_neg;
+  out.m[2][0] = off_neg; out.m[2][1] = off_pos; out.m[2][2] = diag;
+}
+
 void apply_prism_effect(float iterations, SQ15x16 opacity) {
-  // Handle the whole number part of iterations
+  init_prism_maps();
+
   uint8_t whole_iterations = (uint8_t)iterations;
-  
-  // Store original values that we need to preserve
-  SQ15x16 original_hue_position = hue_position;
-  
-  // Apply full iterations
-  for (uint8_t i = 0; i < whole_iterations; i++) {
-    memcpy(leds_16_fx, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  float fractional_part = iterations - whole_iterations;
+  uint8_t passes = whole_iterations + (fractional_part > 0.01 ? 1 : 0);
+  if (passes == 0) return;
 
-    scale_image_to_half(leds_16_fx);
-    shift_leds_up(leds_16_fx, (NATIVE_RESOLUTION >> 1));
-    mirror_image_downwards(leds_16_fx);
-    
-    // Apply color shift to this prism iteration
-    // Each successive prism gets a slight hue shift
-    float hue_shift = (i * 0.05); // 5% hue shift per prism
-    
-    // Apply the hue shift to the prism
-    for (uint8_t j = 0; j < NATIVE_RESOLUTION; j++) {
-      // Only shift colors if there's actual color data
-      if (leds_16_fx[j].r > 0 || leds_16_fx[j].g > 0 || leds_16_fx[j].b > 0) {
-        leds_16_fx[j] = adjust_hue_and_saturation(
-          leds_16_fx[j], 
-          fmod_fixed(hue_position + hue_shift, 1.0), 
-          CONFIG.SATURATION
-        );
-      }
+  // Expand prod(I + a_i * M_i * P) into sum(C_k * P^k), k = 0..passes
+  static ColorMatrix coeffs[12];
+  if (passes > 11) passes = 11;
+
+  color_matrix_identity(coeffs[0]);
+  for (uint8_t k = 1; k <= passes; k++) {
+    memset(&coeffs[k], 0, sizeof(ColorMatrix));
+  }
+
+  for (uint8_t i = 0; i < passes; i++) {
+    float alpha = float(opacity);
+    if (i == whole_iterations) {
+      alpha *= fractional_part;
     }
 
-    // memcpy(leds_16_fx_2, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION); // No longer needed
-    blend_buffers(leds_16, leds_16, leds_16_fx, BLEND_ADD, opacity); // Blend original (leds_16) with processed (leds_16_fx)
+    ColorMatrix pass_matrix;
+    prism_color_matrix(pass_matrix, i * 0.05, float(CONFIG.SATURATION));  // 5% hue shift per prism
+
+    for (uint8_t k = i + 1; k >= 1; k--) {
+      color_matrix_mul_add(coeffs[k], pass_matrix, coeffs[k - 1], alpha);
+    }
   }
-  
-  // Handle the fractional part if any
-  float fractional_part = iterations - whole_iterations;
-  if (fractional_part > 0.01) { // Only process if the fractional part is significant
-    memcpy(leds_16_fx, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
 
-    scale_image_to_half(leds_16_fx);
-    shift_leds_up(leds_16_fx, (NATIVE_RESOLUTION >> 1));
-    mirror_image_downwards(leds_16_fx);
-    
-    // Apply color shift to the fractional prism as well
-    float hue_shift = (whole_iterations * 0.05);
-    
-    // Apply the hue shift to the prism
-    for (uint8_t j = 0; j < NATIVE_RESOLUTION; j++) {
-      // Only shift colors if there's actual color data
-      if (leds_16_fx[j].r > 0 || leds_16_fx[j].g > 0 || leds_16_fx[j].b > 0) {
-        leds_16_fx[j] = adjust_hue_and_saturation(
-          leds_16_fx[j], 
-          fmod_fixed(hue_position + hue_shift, 1.0), 
-          CONFIG.SATURATION
-        );
+  static SQ15x16 c_fixed[12][3][3];
+  for (uint8_t k = 1; k <= passes; k++) {
+    for (uint8_t r = 0; r < 3; r++) {
+      for (uint8_t c = 0; c < 3; c++) {
+        c_fixed[k][r][c] = SQ15x16(coeffs[k].m[r][c]);
       }
     }
+  }
 
-    // memcpy(leds_16_fx_2, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION); // No longer needed
-    // Apply the effect with reduced opacity based on the fractional part
-    blend_buffers(leds_16, leds_16, leds_16_fx, BLEND_ADD, opacity * fractional_part); // Blend original (leds_16) with processed (leds_16_fx)
+  // Prefix sums of the source frame, so any fold depth is an O(1) box average
+  CRGB16* source = frame_write_source();  // (frame_buffers.h)
+  int32_t* sum_r = prism_sum_r;
+  int32_t* sum_g = prism_sum_g;
+  int32_t* sum_b = prism_sum_b;
+  sum_r[0] = sum_g[0] = sum_b[0] = 0;
+  for (uint16_t i = 0; i < render_resolution; i++) {
+    sum_r[i + 1] = sum_r[i] + source[i].r.getInternal();
+    sum_g[i + 1] = sum_g[i] + source[i].g.getInternal();
+    sum_b[i + 1] = sum_b[i] + source[i].b.getInternal();
+  }
+
+  uint8_t box_passes = (passes < prism_levels) ? passes : prism_levels;
+  for (uint16_t j = 0; j < render_resolution; j++) {
+    CRGB16 out = source[j];
+
+    for (uint8_t k = 1; k <= box_passes; k++) {
+      uint16_t start = prism_span_start[k][j];
+      SQ15x16 r = SQ15x16::fromInternal(prism_box(sum_r, start, k));
+      SQ15x16 g = SQ15x16::fromInternal(prism_box(sum_g, start, k));
+      SQ15x16 b = SQ15x16::fromInternal(prism_box(sum_b, start, k));
+
+      out.r += c_fixed[k][0][0] * r + c_fixed[k][0][1] * g + c_fixed[k][0][2] * b;
+      out.g += c_fixed[k][1][0] * r + c_fixed[k][1][1] * g + c_fixed[k][1][2] * b;
+      out.b += c_fixed[k][2][0] * r + c_fixed[k][2][1] * g + c_fixed[k][2][2] * b;
+    }
+
+    leds_16[j] = out;
+  }
+
+  if (passes <= prism_levels) {
+    return;
+  }
+
+  // Past one box: the deepest box for every pixel, then one fold per pass.
+  // The prefix sums are done with after the first, they take the next depth
+  int32_t* depth[3] = { prism_fold_r, prism_fold_g, prism_fold_b };
+  int32_t* next[3] = { sum_r, sum_g, sum_b };
+  for (uint16_t j = 0; j < render_resolution; j++) {
+    uint16_t start = prism_span_start[prism_levels][j];
+    depth[0][j] = prism_box(sum_r, start, prism_levels);
+    depth[1][j] = prism_box(sum_g, start, prism_levels);
+    depth[2][j] = prism_box(sum_b, start, prism_levels);
+  }
+
+  for (uint8_t k = prism_levels + 1; k <= passes; k++) {
+    for (uint8_t c = 0; c < 3; c++) {
+      prism_fold(depth[c], next[c], render_resolution);  // (prism_fold.h)
+      int32_t* folded = next[c];
+      next[c] = depth[c];
+      depth[c] = folded;
+    }
+
+    for (uint16_t j = 0; j < render_resolution; j++) {
+      SQ15x16 r = SQ15x16::fromInternal(depth[0][j]);
+      SQ15x16 g = SQ15x16::fromInternal(depth[1][j]);
+      SQ15x16 b = SQ15x16::fromInternal(depth[2][j]);
+
+      leds_16[j].r += c_fixed[k][0][0] * r + c_fixed[k][0][1] * g + c_fixed[k][0][2] * b;
+      leds_16[j].g += c_fixed[k][1][0] * r + c_fixed[k][1][1] * g + c_fixed[k][1][2] * b;
+      leds_16[j].b += c_fixed[k][2][0] * r + c_fixed[k][2][1] * g + c_fixed[k][2][2] * b;
+    }
   }
-  
-  // Restore the original values to prevent side effects
-  hue_position = original_hue_position;
 }
 
 void clear_leds() {
-  memset(leds_16, 0, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memset(leds_16, 0, sizeof(CRGB16) * render_resolution);
+}
+
+// Render arena ---------------------------------------------------------------
+// Every buffer that scales with the render resolution lives in one block
+// allocated once at boot for render_capacity pixels. Nothing is allocated
+// or freed after that, lowering the resolution at runtime only uses less
+// of each buffer.
+
+static uint8_t* render_arena = NULL;
+static size_t render_arena_bytes = 0;
+
+static void* render_arena_take(uint8_t* base, size_t& offset, size_t bytes) {
+  void* ptr = (base != NULL) ? (void*)(base + offset) : NULL;
+  offset += (bytes + 3) & ~size_t(3);  // Keep everything 4-byte aligned
+  return ptr;
+}
+
+// Lay out all render buffers from «base» and return the bytes used (base == NULL only measures)
+static size_t carve_render_buffers(uint8_t* base, uint16_t capacity) {
+  size_t offset = 0;
+
+  for (uint8_t c = 0; c < NUM_FRAME_CANVASES; c++) {
+    frame_canvases[c]    = (CRGB16*)render_arena_take(base, offset, sizeof(CRGB16) * capacity);
+  }
+  for (uint8_t t = 0; t < NUM_FRAME_TRAILS; t++) {
+    frame_trails[t]      = (CRGB16*)render_arena_take(base, offset, sizeof(CRGB16) * capacity);
+  }
+  frame_trail_spare      = (CRGB16*)render_arena_take(base, offset, sizeof(CRGB16) * capacity);
+  leds_16_fx             = (CRGB16*)render_arena_take(base, offset, sizeof(CRGB16) * capacity);
+  leds_16_temp           = (CRGB16*)render_arena_take(base, offset, sizeof(CRGB16) * capacity);
+  leds_16_ui             = (CRGB16*)render_arena_take(base, offset, sizeof(CRGB16) * capacity);
+
+  frame_begin(CANVAS_PRIMARY);  // (frame_buffers.h)
+  leds_16_secondary      = frame_canvases[CANVAS_SECONDARY];
+
+  ui_mask                = (SQ15x16*)render_arena_take(base, offset, sizeof(SQ15x16) * capacity);
+  qc_wave_probabilities  = (SQ15x16*)render_arena_take(base, offset, sizeof(SQ15x16) * capacity);
+  qc_wave_phase          = (uint32_t*)render_arena_take(base, offset, sizeof(uint32_t) * capacity);
+  qc_fluid_velocity      = (SQ15x16*)render_arena_take(base, offset, sizeof(SQ15x16) * capacity);
+  qc_scratch             = (SQ15x16*)render_arena_take(base, offset, sizeof(SQ15x16) * capacity);
+  kaleido_noise_x        = (uint32_t*)render_arena_take(base, offset, sizeof(uint32_t) * (capacity / 2));
+  kaleido_noise_rows     = (int16_t*)render_arena_take(base, offset, sizeof(int16_t) * 3 * (capacity / 2));
+
+  for (uint8_t k = 0; k <= PRISM_MAX_LEVEL; k++) {
+    prism_span_start[k]  = (uint16_t*)render_arena_take(base, offset, sizeof(uint16_t) * capacity);
+  }
+  prism_sum_r            = (int32_t*)render_arena_take(base, offset, sizeof(int32_t) * (capacity + 1));
+  prism_sum_g            = (int32_t*)render_arena_take(base, offset, sizeof(int32_t) * (capacity + 1));
+  prism_sum_b            = (int32_t*)render_arena_take(base, offset, sizeof(int32_t) * (capacity + 1));
+  prism_fold_r           = (int32_t*)render_arena_take(base, offset, sizeof(int32_t) * capacity);
+  prism_fold_g           = (int32_t*)render_arena_take(base, offset, sizeof(int32_t) * capacity);
+  prism_fold_b           = (int32_t*)render_arena_take(base, offset, sizeof(int32_t) * capacity);
+
+  return offset;
+}
+
+// Render resolution for a render mode on a strip of «led_count» pixels
+uint16_t resolve_render_resolution(uint8_t render_mode, uint16_t led_count) {
+  uint16_t resolution = NATIVE_RESOLUTION;
+  if (render_mode == RENDER_MODE_NATIVE) {
+    resolution = led_count;
+  } else if (render_mode == RENDER_MODE_HALF) {
+    resolution = led_count >> 1;
+  }
+
+  if (resolution < MIN_RENDER_RESOLUTION) { resolution = MIN_RENDER_RESOLUTION; }
+  if (resolution > MAX_RENDER_RESOLUTION) { resolution = MAX_RENDER_RESOLUTION; }
+
+  return resolution & ~1;  // Mirroring and the prism fold work on two halves
+}
+
+void init_render_buffers() {
+  if (CONFIG.RENDER_MODE >= NUM_RENDER_MODES) {
+    CONFIG.RENDER_MODE = RENDER_MODE_NATIVE;
+  }
+
+  render_base_resolution = resolve_render_resolution(CONFIG.RENDER_MODE, CONFIG.LED_COUNT);
+  render_capacity = render_base_resolution;
+
+  render_arena_bytes = carve_render_buffers(NULL, render_capacity);
+  render_arena = (uint8_t*)heap_caps_malloc(render_arena_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (render_arena == NULL) {
+    render_arena = (uint8_t*)heap_caps_malloc(render_arena_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  }
+
+  // Long strips may not fit, fall back to the fixed 160 pixel render
+  if (render_arena == NULL && render_capacity > NATIVE_RESOLUTION) {
+    USBSerial.println("WARNING: Not enough memory to render at LED_COUNT, using compatibility render mode");
+    render_base_resolution = NATIVE_RESOLUTION;
+    render_capacity = NATIVE_RESOLUTION;
+    render_arena_bytes = carve_render_buffers(NULL, render_capacity);
+    render_arena = (uint8_t*)heap_caps_malloc(render_arena_bytes, MALLOC_CAP_8BIT);
+  }
+
+  if (render_arena == NULL) {
+    USBSerial.println("ERROR: Failed to allocate render buffers!");
+    ESP.restart();
+  }
+
+  memset(render_arena, 0, render_arena_bytes);
+  carve_render_buffers(render_arena, render_capacity);
+  render_resolution = render_base_resolution;
+  prism_maps_resolution = 0;
+
+  USBSerial.print("INIT_RENDER_BUFFERS: ");
+  USBSerial.print(render_resolution);
+  USBSerial.print(" px, ");
+  USBSerial.print(render_arena_bytes);
+  USBSerial.println(" bytes");
+}
+
+// Change the resolution modes draw at, within render_capacity. Only call
+// from led_thread between frames: canvases and trails are stretched to
+// the new resolution, the effect scratch buffers are cleared.
+void set_render_resolution(uint16_t resolution) {
+  if (resolution > render_capacity) { resolution = render_capacity; }
+  if (resolution < MIN_RENDER_RESOLUTION) { resolution = MIN_RENDER_RESOLUTION; }
+  resolution &= ~1;
+
+  if (resolution == render_resolution) {
+    return;
+  }
+
+  frame_buffers_resample(render_resolution, resolution);  // (frame_buffers.h)
+  render_resolution = resolution;
+
+  size_t frame_bytes = sizeof(CRGB16) * render_capacity;
+  memset(leds_16_fx, 0, frame_bytes);
+  memset(leds_16_temp, 0, frame_bytes);
+  memset(leds_16_ui, 0, frame_bytes);
 }
 
 void process_color_shift() {
@@ -1569,6 +1935,84 @@ void draw_sprite(CRGB16 dest[], CRGB16 sprite[], uint32_t dest_length, uint32_t
   }
 }
 
+// Two-tap filter for shift_sprite(), «tap_*» in Q16
+static inline SQ15x16 sprite_taps(SQ15x16 left, SQ15x16 right, int32_t tap_left, int32_t tap_right) {
+  return SQ15x16::fromInternal((int64_t(left.getInternal()) * tap_left + int64_t(right.getInternal()) * tap_right) >> 16);
+}
+
+// dest[j] of shift_sprite() where either tap may fall off the end of «src»
+static inline CRGB16 sprite_edge_pixel(const CRGB16 src[], int32_t length, int32_t from, int32_t tap_left, int32_t tap_right) {
+  CRGB16 zero = { 0.0, 0.0, 0.0 };
+  CRGB16 left = (from >= 0 && from < length) ? src[from] : zero;
+  CRGB16 right = (from - 1 >= 0 && from - 1 < length) ? src[from - 1] : zero;
+  CRGB16 out = {
+    sprite_taps(left.r, right.r, tap_left, tap_right),
+    sprite_taps(left.g, right.g, tap_left, tap_right),
+    sprite_taps(left.b, right.b, tap_left, tap_right),
+  };
+  return out;
+}
+
+// Decay-and-shift: «src» moved by «position» pixels (fractional, either
+// direction) and scaled by «alpha», written over all of «dest». The same
+// picture as clearing «dest» and draw_sprite()ing «src» onto it, but both
+// taps are worked out once for the offset, the interior runs without bounds
+// checks, and no clear pass is needed. «dest» may be «src»: pixels are
+// visited in the order that never reads one already written.
+void shift_sprite(CRGB16 dest[], const CRGB16 src[], uint16_t length, float position, SQ15x16 alpha) {
+  int32_t whole = (int32_t)floorf(position);
+  SQ15x16 mix_right = position - whole;
+  int32_t tap_left = ((SQ15x16(1.0) - mix_right) * alpha).getInternal();
+  int32_t tap_right = (mix_right * alpha).getInternal();
+
+  // dest[j] = src[j - whole] * tap_left + src[j - whole - 1] * tap_right,
+  // both in range for j = lo..hi
+  int32_t lo = whole + 1;
+  int32_t hi = (int32_t)length - 1 + whole;
+  if (lo < 0) { lo = 0; }
+  if (hi > (int32_t)length - 1) { hi = (int32_t)length - 1; }
+
+  if (lo > hi) {  // Shifted (almost) entirely off the strip, the edge loops cover it all
+    if (whole >= 0) { lo = hi + 1; } else { hi = lo - 1; }
+  }
+
+  if (whole >= 0) {  // Moving up: walk down, reads are at or below the write
+    for (int32_t j = (int32_t)length - 1; j > hi; j--) {
+      dest[j] = sprite_edge_pixel(src, length, j - whole, tap_left, tap_right);
+    }
+    for (int32_t j = hi; j >= lo; j--) {
+      const CRGB16& left = src[j - whole];
+      const CRGB16& right = src[j - whole - 1];
+      CRGB16 out = {
+        sprite_taps(left.r, right.r, tap_left, tap_right),
+        sprite_taps(left.g, right.g, tap_left, tap_right),
+        sprite_taps(left.b, right.b, tap_left, tap_right),
+      };
+      dest[j] = out;
+    }
+    for (int32_t j = lo - 1; j >= 0; j--) {
+      dest[j] = sprite_edge_pixel(src, length, j - whole, tap_left, tap_right);
+    }
+  } else {  // Moving down: walk up, reads are at or above the write
+    for (int32_t j = 0; j < lo; j++) {
+      dest[j] = sprite_edge_pixel(src, length, j - whole, tap_left, tap_right);
+    }
+    for (int32_t j = lo; j <= hi; j++) {
+      const CRGB16& left = src[j - whole];
+      const CRGB16& right = src[j - whole - 1];
+      CRGB16 out = {
+        sprite_taps(left.r, right.r, tap_left, tap_right),
+        sprite_taps(left.g, right.g, tap_left, tap_right),
+        sprite_taps(left.b, right.b, tap_left, tap_right),
+      };
+      dest[j] = out;
+    }
+    for (int32_t j = hi + 1; j < length; j++) {
+      dest[j] = sprite_edge_pixel(src, length, j - whole, tap_left, tap_right);
+    }
+  }
+}
+
 CRGB16 force_saturation_16(CRGB16 rgb, SQ15x16 saturation) {
   // Convert RGB to HSV
   SQ15x16 max_val = fmax_fixed(rgb.r, fmax_fixed(rgb.g, rgb.b));
@@ -1706,41 +2150,31 @@ CRGB16 adjust_hue_and_saturation(CRGB16 color, SQ15x16 hue, SQ15x16 saturation)
 void init_secondary_leds() {
   leds_scaled_secondary = new CRGB16[SECONDARY_LED_COUNT];
   leds_out_secondary = new CRGB[SECONDARY_LED_COUNT];
+  leds_out_secondary_front = new CRGB[SECONDARY_LED_COUNT];
 
   // Use constants for FastLED template arguments
-  FastLED.addLeds<WS2812B, SECONDARY_LED_DATA_PIN, GRB>(leds_out_secondary, SECONDARY_LED_COUNT);
+  FastLED.addLeds<WS2812B, SECONDARY_LED_DATA_PIN, GRB>(leds_out_secondary_front, SECONDARY_LED_COUNT);
   
   for (uint16_t x = 0; x < SECONDARY_LED_COUNT; x++) {
     leds_out_secondary[x] = CRGB(0, 0, 0);
+    leds_out_secondary_front[x] = CRGB(0, 0, 0);
   }
+
+  add_secondary_led_output();  // (led_output.h)
   
   USBSerial.print("INIT_SECONDARY_LEDS: ");
   USBSerial.println(SB_PASS);
 }
 
 void scale_to_secondary_strip() {
-  if (SECONDARY_LED_COUNT == NATIVE_RESOLUTION) {
-    memcpy(leds_scaled_secondary, leds_16_secondary, sizeof(CRGB16) * NATIVE_RESOLUTION);
-  } else {
-    for (SQ15x16 i = 0; i < SECONDARY_LED_COUNT; i++) {
-      SQ15x16 prog = i / SQ15x16(SECONDARY_LED_COUNT);
-      leds_scaled_secondary[i.getInteger()] = lerp_led_16(prog * SQ15x16(NATIVE_RESOLUTION), leds_16_secondary);
-    }
-  }
+  scale_led_buffer(leds_16_secondary, render_resolution, leds_scaled_secondary, SECONDARY_LED_COUNT);
 }
 
 void apply_brightness_secondary() {
   // Apply the same silence scaling used for the primary LEDs
   float bright_val = SECONDARY_PHOTONS * SECONDARY_PHOTONS * silent_scale;
   
-  if (debug_mode && (millis() % 5000 == 0)) {
-    USBSerial.print("DEBUG: Secondary brightness = ");
-    USBSerial.print(SECONDARY_PHOTONS);
-    USBSerial.print("² × silent_scale(");
-    USBSerial.print(silent_scale);
-    USBSerial.print(") = ");
-    USBSerial.println(bright_val);
-  }
+  LOG_DEBUG_EVERY(5000, "Secondary brightness = %.2f² × silent_scale(%.2f) = %.2f", SECONDARY_PHOTONS, silent_scale, bright_val);
   
   for (uint16_t i = 0; i < SECONDARY_LED_COUNT; i++) {
     leds_scaled_secondary[i].r *= bright_val;
@@ -1783,7 +2217,7 @@ void show_secondary_leds() {
     }
   } else {
     // If filter is off, just quantize directly
-    quantize_color_secondary(CONFIG.TEMPORAL_DITHERING);
+    quantize_color_secondary(CONFIG.TEMPORAL_DITHERING && quality_allows_dithering());
   }
   
   // If filter was applied, quantize *after* filtering (using the calculated leds_out_secondary)
@@ -1818,7 +2252,7 @@ void show_secondary_leds() {
 void apply_enhanced_visuals() {
   // Only apply if there's actual visual data
   bool has_content = false;
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     if (leds_16[i].r > 0.01 || leds_16[i].g > 0.01 || leds_16[i].b > 0.01) {
       has_content = true;
       break;
@@ -1828,13 +2262,13 @@ void apply_enhanced_visuals() {
   if (!has_content) return;
   
   // Store original content
-  memcpy(leds_16_fx, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memcpy(leds_16_fx, leds_16, sizeof(CRGB16) * render_resolution);
   
   // 1. Add subtle bloom/glow effect based on audio_vu_level
   float bloom_intensity = 0.15 + float(audio_vu_level) * 0.2;
   
   // Create a blurred version in leds_16_temp
-  for (uint16_t i = 1; i < NATIVE_RESOLUTION-1; i++) {
+  for (uint16_t i = 1; i < render_resolution-1; i++) {
     // Simple 3-pixel box blur
     leds_16_temp[i].r = (leds_16_fx[i-1].r + leds_16_fx[i].r + leds_16_fx[i+1].r) / 3.0;
     leds_16_temp[i].g = (leds_16_fx[i-1].g + leds_16_fx[i].g + leds_16_fx[i+1].g) / 3.0;
@@ -1843,10 +2277,10 @@ void apply_enhanced_visuals() {
   
   // Edge pixels
   leds_16_temp[0] = leds_16_temp[1];
-  leds_16_temp[NATIVE_RESOLUTION-1] = leds_16_temp[NATIVE_RESOLUTION-2];
+  leds_16_temp[render_resolution-1] = leds_16_temp[render_resolution-2];
   
   // Mix original and bloom
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
     leds_16[i].r = leds_16_fx[i].r + leds_16_temp[i].r * bloom_intensity;
     leds_16[i].g = leds_16_fx[i].g + leds_16_temp[i].g * bloom_intensity;
     leds_16[i].b = leds_16_fx[i].b + leds_16_temp[i].b * bloom_intensity;
@@ -1856,8 +2290,8 @@ void apply_enhanced_visuals() {
   static float wave_position = 0.0;
   wave_position += 0.03; // Speed of wave
   
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    float position = float(i) / NATIVE_RESOLUTION;
+  for (uint16_t i = 0; i < render_resolution; i++) {
+    float position = float(i) / render_resolution;
     float wave = sin(wave_position + position * 6.28) * 0.5 + 0.5;
     
     // Apply subtle wave effect only where there's actual color
@@ -1875,7 +2309,7 @@ void apply_enhanced_visuals() {
     float enhancement = (float(audio_vu_level) / float(audio_vu_level_average) - 1.0) * 0.4;
     if (enhancement > 0.25) enhancement = 0.25;
     
-    for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    for (uint16_t i = 0; i < render_resolution; i++) {
       if (leds_16[i].r > 0.05 || leds_16[i].g > 0.05 || leds_16[i].b > 0.05) {
         // Find dominant color and enhance it
         if (leds_16[i].r > leds_16[i].g && leds_16[i].r > leds_16[i].b) {
@@ -1928,13 +2362,15 @@ void quantize_color_secondary(bool temporal_dither) {
   }
 }
 
-// Palette LUT cache (256 entries)
+// Palette LUT cache (256 entries), built by refresh_led_tables() when PALETTE_INDEX changes
 static CRGB16 palette_lut[256];
-static uint8_t palette_lut_index_cached = 255; // invalid
 
-static void update_palette_lut(uint8_t idx){
-  palette_lut_index_cached = idx;
-  CRGBPalette16 curPal( gGradientPalettes[idx] );
+static uint32_t palette_lut_key() {
+  return PALETTE_INDEX % gGradientPaletteCount;
+}
+
+static void update_palette_lut(){
+  CRGBPalette16 curPal( gGradientPalettes[palette_lut_key()] );
   for(uint16_t i=0;i<256;i++){
     CRGB col = ColorFromPalette(curPal, i, 255, LINEARBLEND);
     palette_lut[i] = { col.r / 255.0, col.g / 255.0, col.b / 255.0 };
@@ -1942,19 +2378,13 @@ static void update_palette_lut(uint8_t idx){
 }
 
 CRGB16 get_mode_color(SQ15x16 hue, SQ15x16 saturation, SQ15x16 value) {
-  while (hue > SQ15x16(1.0)) hue -= SQ15x16(1.0);
-  while (hue < SQ15x16(0.0)) hue += SQ15x16(1.0);
+  uint16_t hue16 = hue_to_u16(hue);  // wraps into [0, 1)
 
   if (!PALETTE_MODE_ENABLED) {
-    return hsv(hue, saturation, value);
+    return hsv16(hue16, hsv_desat_q16(saturation), value);
   }
 
-  uint8_t palIdx = PALETTE_INDEX % gGradientPaletteCount;
-  if(palIdx != palette_lut_index_cached){
-    update_palette_lut(palIdx);
-  }
-
-  uint8_t colorIdx = uint8_t((float)hue * 255.0f); // 0-255
+  uint8_t colorIdx = hue16 >> 8; // 0-255
   CRGB16 result = palette_lut[colorIdx];
 
   // Apply brightness (value)
@@ -1970,17 +2400,40 @@ CRGB16 get_mode_color(SQ15x16 hue, SQ15x16 saturation, SQ15x16 value) {
 }
 
 // Gamma correction LUT (gamma = 2.2 -----------------------------------------
-static bool gamma_lut_initialized = false;
 uint8_t gamma_lut[256];
 void init_gamma_lut() {
-  if (gamma_lut_initialized) return;
   for (int i = 0; i < 256; i++) {
     float v = i / 255.0f;
     float corrected = powf(v, 1.0f / 2.2f);
     gamma_lut[i] = uint8_t(corrected * 255.0f + 0.5f);
   }
-  gamma_lut_initialized = true;
 }
 // ---------------------------------------------------------------------------
 
+// Derived tables (derived_tables.h) ------------------------------------------
+
+enum led_table_ids {
+  LED_TABLE_PIXEL_MAP,
+  LED_TABLE_GAMMA,
+  LED_TABLE_PALETTE,
+  NUM_LED_TABLES
+};
+
+static uint32_t derived_clock_us() {
+  return micros();
+}
+
+const DerivedTable led_table_list[NUM_LED_TABLES] = {
+  { "pixel_map", CONFIG_MASK(LED_COUNT) | CONFIG_MASK(REVERSE_ORDER), NULL,             rebuild_pixel_map  },
+  { "gamma_lut", 0,                                                   NULL,             init_gamma_lut     },
+  { "palette",   0,                                                   palette_lut_key,  update_palette_lut },
+};
+
+DerivedTables<NUM_LED_TABLES> led_tables(led_table_list, derived_clock_us);
+
+// led_thread, at the top of each frame (and init_leds(), before the thread runs)
+uint8_t refresh_led_tables() {
+  return led_tables.refresh(CONFIG);
+}
+
 #endif // LED_UTILITIES_H
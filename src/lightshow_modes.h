@@ -3,18 +3,9 @@
 #include <FixedPoints.h>
 #include "constants.h"
 #include "globals.h"
+#include "frame_buffers.h"
 // #include "led_utilities.h" // Removed to prevent multiple definition errors
 
-// Cached CONFIG values for the current frame
-struct cached_config {
-  float PHOTONS;
-  float CHROMA;
-  float MOOD;
-  uint8_t LIGHTSHOW_MODE;
-  float SQUARE_ITER;
-  float SATURATION;
-} frame_config;
-
 extern bool snapwave_debug_logging_enabled;
 extern bool snapwave_color_debug_logging_enabled;
 extern bool color_shift_debug_logging_enabled;
@@ -54,32 +45,20 @@ void get_smooth_spectrogram() {
   }
 }
 
+// The frame's note color mix (audio_features.h), computed once however many
+// modes ask, clipped to 8 bits
 CRGB calc_chromagram_color() {
-  CRGB sum_color = CRGB(0, 0, 0);
-  for (uint8_t i = 0; i < 12; i++) {
-    float prog = i / 12.0;
-
-    float bright = note_chromagram[i];
-    for (uint8_t s = 0; s < frame_config.SQUARE_ITER + 1; s++) {
-      bright *= bright;
-    }
-    bright *= 0.5;
-
-    if (bright > 1.0) {
-      bright = 1.0;
-    }
-
-    if (chromatic_mode == true) {
-      CRGB out_col = CHSV(uint8_t(prog * 255), uint8_t(frame_config.SATURATION * 255), uint8_t(bright * 255));
-      sum_color += out_col;
-    }
-  }
-
   if (chromatic_mode == false) {
-    sum_color = force_saturation(sum_color, uint8_t(frame_config.SATURATION * 255));
+    return CRGB(0, 0, 0);
   }
 
-  return sum_color;
+  require_audio_features(FEATURE_CHROMA_COLOR);
+  CRGB16 sum_color = audio_features.chroma_color;
+  if (sum_color.r > 1.0) sum_color.r = 1.0;
+  if (sum_color.g > 1.0) sum_color.g = 1.0;
+  if (sum_color.b > 1.0) sum_color.b = 1.0;
+
+  return CRGB(uint8_t(sum_color.r * 255), uint8_t(sum_color.g * 255), uint8_t(sum_color.b * 255));
 }
 
 void avg_bins(uint8_t low_bin, uint8_t high_bin) {
@@ -98,9 +77,9 @@ void test_mode() {
 // Default mode!
 void light_mode_gdft() {
   // Calculate frequency data for the first half of the strip
-  for (uint16_t i = 0; i < (NATIVE_RESOLUTION / 2); i++) {
-    // Map the 64 frequency bins across the first half (NATIVE_RESOLUTION / 2 LEDs)
-    SQ15x16 freq_prog = (SQ15x16)i / (SQ15x16)(NATIVE_RESOLUTION / 2);
+  for (uint16_t i = 0; i < (render_resolution / 2); i++) {
+    // Map the 64 frequency bins across the first half (render_resolution / 2 LEDs)
+    SQ15x16 freq_prog = (SQ15x16)i / (SQ15x16)(render_resolution / 2);
     SQ15x16 freq_index_f = freq_prog * (NUM_FREQS - 1);
     uint16_t freq_index_i = freq_index_f.getInteger();
     SQ15x16 freq_fract = freq_index_f - freq_index_i;
@@ -132,7 +111,7 @@ void light_mode_gdft() {
     }
 
     SQ15x16 led_hue;
-    SQ15x16 prog = (SQ15x16)i / (SQ15x16)(NATIVE_RESOLUTION / 2); // Use LED position for hue progression
+    SQ15x16 prog = (SQ15x16)i / (SQ15x16)(render_resolution / 2); // Use LED position for hue progression
     if (chromatic_mode == true) {
       // Interpolate note colors across the half-strip based on frequency index
        SQ15x16 color_prog = (SQ15x16)(freq_index_i % 12) / 12.0;
@@ -152,11 +131,11 @@ void light_mode_gdft() {
     }
 
     // Place calculated color in the second half of the buffer initially
-    leds_16[i + (NATIVE_RESOLUTION / 2)] = hsv(led_hue + bin * SQ15x16(0.050), frame_config.SATURATION, bin);
+    leds_16[i + (render_resolution / 2)] = hsv(led_hue + bin * SQ15x16(0.050), frame_config.SATURATION, bin);
   }
 
   // Clear the first half before mirroring
-  memset(leds_16, 0, sizeof(CRGB16) * (NATIVE_RESOLUTION / 2));
+  memset(leds_16, 0, sizeof(CRGB16) * (render_resolution / 2));
 
   // No shift needed, just mirror the calculated second half to the first half
   mirror_image_downwards(leds_16);  // (led_utilities.h) Mirror downwards
@@ -164,8 +143,8 @@ void light_mode_gdft() {
 
 /*
 void light_mode_gdft_chromagram() {
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    float prog = i / float(NATIVE_RESOLUTION);
+  for (uint16_t i = 0; i < render_resolution; i++) {
+    float prog = i / float(render_resolution);
 
     float bin = interpolate(prog, note_chromagram, 12) * 1.25;
     if (bin > 1.0) { bin = 1.0; };
@@ -211,16 +190,16 @@ void light_mode_bloom(bool fast_scroll) {
     //sum_color = force_saturation(sum_color, 255 * CONFIG.SATURATION);
 
     if (fast_scroll == true) {  // Fast mode scrolls two LEDs at a time
-      for (uint8_t i = 0; i < NATIVE_RESOLUTION - 2; i++) {
-        leds_fx[(NATIVE_RESOLUTION - 1) - i] = leds_last[(NATIVE_RESOLUTION - 1) - i - 2];
+      for (uint16_t i = 0; i < render_resolution - 2; i++) {
+        leds_fx[(render_resolution - 1) - i] = leds_last[(render_resolution - 1) - i - 2];
       }
 
       leds_fx[0] = sum_color;  // New information goes here
       leds_fx[1] = sum_color;  // New information goes here
 
     } else {  // Slow mode only scrolls one LED at a time
-      for (uint8_t i = 0; i < NATIVE_RESOLUTION - 1; i++) {
-        leds_fx[(NATIVE_RESOLUTION - 1) - i] = leds_last[(NATIVE_RESOLUTION - 1) - i - 1];
+      for (uint16_t i = 0; i < render_resolution - 1; i++) {
+        leds_fx[(render_resolution - 1) - i] = leds_last[(render_resolution - 1) - i - 1];
       }
 
       leds_fx[0] = sum_color;  // New information goes here
@@ -297,23 +276,17 @@ void light_mode_kaleidoscope() {
   static SQ15x16 brightness_mid = 0.0;
   static SQ15x16 brightness_high = 0.0;
 
-  SQ15x16 sum_low = 0.0;
-  SQ15x16 sum_mid = 0.0;
-  SQ15x16 sum_high = 0.0;
-
-  // Consolidate brightness calculation
-  for (uint8_t i = 0; i < 20; i++) { // Assuming NUM_FREQS is 64, split into 3 bands
-    SQ15x16 bin_low = spectrogram_smooth[i]; // 0-19
-    SQ15x16 bin_mid = spectrogram_smooth[20 + i]; // 20-39
-    SQ15x16 bin_high = spectrogram_smooth[40 + i]; // 40-59 (adjust range if NUM_FREQS changes)
+  require_audio_features(FEATURE_BANDS);  // (audio_features.h)
 
-    bin_low = bin_low * 0.5 + (bin_low * bin_low) * 0.5;
-    bin_mid = bin_mid * 0.5 + (bin_mid * bin_mid) * 0.5;
-    bin_high = bin_high * 0.5 + (bin_high * bin_high) * 0.5;
+  SQ15x16 sum_low = audio_features.band_energy[0];
+  SQ15x16 sum_mid = audio_features.band_energy[1];
+  SQ15x16 sum_high = audio_features.band_energy[2];
 
-    sum_low += bin_low;
-    sum_mid += bin_mid;
-    sum_high += bin_high;
+  // Consolidate brightness calculation
+  for (uint8_t i = 0; i < FEATURE_BAND_WIDTH; i++) {
+    SQ15x16 bin_low = audio_features.band_bins[0][i];  // 0-19
+    SQ15x16 bin_mid = audio_features.band_bins[1][i];  // 20-39
+    SQ15x16 bin_high = audio_features.band_bins[2][i]; // 40-59
 
     if (bin_low > brightness_low) brightness_low += fabs_fixed(bin_low - brightness_low) * 0.1;
     if (bin_mid > brightness_mid) brightness_mid += fabs_fixed(bin_mid - brightness_mid) * 0.1;
@@ -336,29 +309,44 @@ void light_mode_kaleidoscope() {
   pos_g += (float)shift_g;
   pos_b += (float)shift_b;
 
-  // Loop through the first half of the strip
-  for (uint16_t i = 0; i < (NATIVE_RESOLUTION / 2); i++) {
-    uint32_t y_pos_r = pos_r;
-    uint32_t y_pos_g = pos_g;
-    uint32_t y_pos_b = pos_b;
-
-    // Scale noise coordinate space based on position in the half-strip
-    uint32_t i_mapped = i + 18; // Keep offset? Maybe adjust
-    SQ15x16 noise_coord_scale = 2.0; // Affects density of noise pattern
-    uint32_t i_scaled = uint32_t(((SQ15x16)i_mapped * (SQ15x16)i_mapped * (SQ15x16)i_mapped) * noise_coord_scale);
-
+  // The noise repeats every 256 cells (2^24 in 16.16), wrap there before
+  // the floats lose precision
+  if (pos_r >= 16777216.0f) { pos_r -= 16777216.0f; }
+  if (pos_g >= 16777216.0f) { pos_g -= 16777216.0f; }
+  if (pos_b >= 16777216.0f) { pos_b -= 16777216.0f; }
+
+  uint16_t half = render_resolution / 2;
+
+  // Noise coordinates get denser along the half-strip, (i + 18)^3. They
+  // only depend on the resolution, so they're built once, not per frame.
+  static uint16_t noise_x_resolution = 0;
+  if (noise_x_resolution != render_resolution) {
+    for (uint16_t i = 0; i < half; i++) {
+      uint32_t i_mapped = i + 18;
+      kaleido_noise_x[i] = i_mapped * i_mapped * i_mapped;
+    }
+    noise_x_resolution = render_resolution;
+  }
 
-    SQ15x16 r_val = inoise16(i_scaled * 0.5 + y_pos_r) / 65536.0;
-    SQ15x16 g_val = inoise16(i_scaled * 1.0 + y_pos_g) / 65536.0;
-    SQ15x16 b_val = inoise16(i_scaled * 1.5 + y_pos_b) / 65536.0;
+  // One noise row per channel, each channel stretched 1x, 2x and 3x (procedural.h)
+  int16_t* noise_r = kaleido_noise_rows;
+  int16_t* noise_g = noise_r + half;
+  int16_t* noise_b = noise_g + half;
+  noise1_row_at(noise_r, kaleido_noise_x, 1, uint32_t(pos_r), half);
+  noise1_row_at(noise_g, kaleido_noise_x, 2, uint32_t(pos_g), half);
+  noise1_row_at(noise_b, kaleido_noise_x, 3, uint32_t(pos_b), half);
 
-    if (r_val > 1.0) { r_val = 1.0; };
-    if (g_val > 1.0) { g_val = 1.0; };
-    if (b_val > 1.0) { b_val = 1.0; };
+  // Handle fractional contrast values
+  uint8_t base_iters = (uint8_t)CONFIG.SQUARE_ITER;
+  SQ15x16 fract_iter = CONFIG.SQUARE_ITER - base_iters;
+  SQ15x16 desat_amount = 0.1 + (0.9 - 0.9*CONFIG.SATURATION);
 
-    // Handle fractional contrast values
-    uint8_t base_iters = (uint8_t)CONFIG.SQUARE_ITER;
-    float fract_iter = CONFIG.SQUARE_ITER - base_iters;
+  // Loop through the first half of the strip
+  for (uint16_t i = 0; i < half; i++) {
+    // Signed Q15 noise to 0.0 - 1.0
+    SQ15x16 r_val = SQ15x16::fromInternal(int32_t(noise_r[i]) + 32768);
+    SQ15x16 g_val = SQ15x16::fromInternal(int32_t(noise_g[i]) + 32768);
+    SQ15x16 b_val = SQ15x16::fromInternal(int32_t(noise_b[i]) + 32768);
 
     // Apply full iterations
     for (uint8_t s = 0; s < base_iters; s++) {
@@ -368,14 +356,14 @@ void light_mode_kaleidoscope() {
     }
 
     // Apply fractional iteration if needed
-    if (fract_iter > 0.01) {
+    if (fract_iter > SQ15x16(0.01)) {
       SQ15x16 r_squared = r_val * r_val;
       SQ15x16 g_squared = g_val * g_val;
       SQ15x16 b_squared = b_val * b_val;
 
-      r_val = r_val * (1.0 - fract_iter) + r_squared * fract_iter;
-      g_val = g_val * (1.0 - fract_iter) + g_squared * fract_iter;
-      b_val = b_val * (1.0 - fract_iter) + b_squared * fract_iter;
+      r_val = r_val * (SQ15x16(1.0) - fract_iter) + r_squared * fract_iter;
+      g_val = g_val * (SQ15x16(1.0) - fract_iter) + g_squared * fract_iter;
+      b_val = b_val * (SQ15x16(1.0) - fract_iter) + b_squared * fract_iter;
     }
 
     r_val = apply_contrast_fixed(r_val, 0.1);
@@ -384,8 +372,8 @@ void light_mode_kaleidoscope() {
 
     SQ15x16 prog = 1.0;
     // Fade brightness towards the start of the half-strip
-    if (i < (NATIVE_RESOLUTION / 4)) { // Fade over first quarter
-      prog = (SQ15x16)i / (SQ15x16)(NATIVE_RESOLUTION / 4 -1);
+    if (i < (render_resolution / 4)) { // Fade over first quarter
+      prog = (SQ15x16)i / (SQ15x16)(render_resolution / 4 -1);
       prog *= prog; // Quadratic fade
     }
 
@@ -395,7 +383,7 @@ void light_mode_kaleidoscope() {
     b_val *= prog * brightness_high;
 
     CRGB16 col = { r_val, g_val, b_val };
-    col = desaturate(col, 0.1 + (0.9 - 0.9*CONFIG.SATURATION));
+    col = desaturate(col, desat_amount);
 
     if (chromatic_mode == false) {
       SQ15x16 brightness = 0.0;
@@ -404,7 +392,7 @@ void light_mode_kaleidoscope() {
       if(b_val > brightness){ brightness = b_val; }
 
       // Hue progression based on position in the half-strip
-      SQ15x16 hue_prog = (SQ15x16)i / (SQ15x16)(NATIVE_RESOLUTION / 2 -1);
+      SQ15x16 hue_prog = (SQ15x16)i / (SQ15x16)(render_resolution / 2 -1);
       // Use CONFIG.CHROMA directly
       SQ15x16 led_hue = CONFIG.CHROMA + hue_position + ((sqrt(float(brightness)) * SQ15x16(0.05)) + (hue_prog * SQ15x16(0.10)) * hue_shifting_mix);
       col = hsv(led_hue, CONFIG.SATURATION, brightness);
@@ -412,14 +400,14 @@ void light_mode_kaleidoscope() {
 
     // Write to the first half and mirror to the second half
     leds_16[i] = { col.r, col.g, col.b };
-    leds_16[NATIVE_RESOLUTION - 1 - i] = leds_16[i];
+    leds_16[render_resolution - 1 - i] = leds_16[i];
   }
 }
 
 void light_mode_chromagram_gradient() {
   // Loop through the second half of the strip
-  for (uint16_t i = 0; i < (NATIVE_RESOLUTION / 2); i++) {
-    SQ15x16 prog = (SQ15x16)i / (SQ15x16)(NATIVE_RESOLUTION / 2 -1); // Progress across the half strip
+  for (uint16_t i = 0; i < (render_resolution / 2); i++) {
+    SQ15x16 prog = (SQ15x16)i / (SQ15x16)(render_resolution / 2 -1); // Progress across the half strip
     SQ15x16 note_magnitude = interpolate(prog, chromagram_smooth, 12) * 0.9 + 0.1;
 
     // Handle fractional contrast values
@@ -464,16 +452,16 @@ void light_mode_chromagram_gradient() {
     CRGB16 col = hsv(led_hue, CONFIG.SATURATION, note_magnitude * note_magnitude);
 
     // Write to the second half of the strip
-    leds_16[(NATIVE_RESOLUTION / 2) + i] = col;
+    leds_16[(render_resolution / 2) + i] = col;
     // Mirror to the first half of the strip
-    leds_16[(NATIVE_RESOLUTION / 2) - 1 - i] = col;
+    leds_16[(render_resolution / 2) - 1 - i] = col;
   }
 }
 
 void light_mode_chromagram_dots() {
   // static SQ15x16 chromagram_last[12]; // Removed static buffer
 
-  memset(leds_16, 0, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memset(leds_16, 0, sizeof(CRGB16) * render_resolution);
   //dim_display(0.9);
 
   // low_pass_array_fixed(chromagram_smooth, chromagram_last, 12, LED_FPS, float(mood_scale(3.5, 1.5))); // Removed low-pass call
@@ -503,29 +491,20 @@ void light_mode_chromagram_dots() {
   }
 }
 
-void light_mode_bloom(CRGB16* leds_prev_buffer) { // Accept previous buffer as argument
-  // Clear output
-  memset(leds_16, 0, sizeof(CRGB16) * NATIVE_RESOLUTION);
-
-  // Draw previous frame shifted with mood scaling
-  // Use the provided buffer instead of the global one
-  draw_sprite(leds_16, leds_prev_buffer, NATIVE_RESOLUTION, NATIVE_RESOLUTION, 0.250 + 1.750 * CONFIG.MOOD, 0.99);
+void light_mode_bloom(FrameTrail trail) { // Primary, incoming or secondary trails (frame_buffers.h)
+  // Previous frame shifted up with mood scaling and decayed, over the whole output (led_utilities.h)
+  CRGB16* leds_prev_buffer = frame_trail_begin(trail);
+  shift_sprite(leds_16, leds_prev_buffer, render_resolution, 0.250 + 1.750 * CONFIG.MOOD, 0.99);
   
-  // DEBUG: Check chromagram values - DISABLED to reduce serial flooding
-  static uint32_t bloom_debug_counter = 0;
-  bloom_debug_counter++; // Keep counter for other uses
-  /*
-  if (debug_mode && (bloom_debug_counter++ % 100 == 0)) {
+  // DEBUG: Check chromagram values, and below what color we insert (Logger.h)
+  bool log_bloom = LOG_DEBUG_ENABLED && LOG_EVERY_MS(5000);
+  if (log_bloom) {
     float total_chromagram = 0;
     for (int i = 0; i < 12; i++) {
       total_chromagram += float(chromagram_smooth[i]);
     }
-    USBSerial.print("BLOOM DEBUG: total_chromagram=");
-    USBSerial.print(total_chromagram);
-    USBSerial.print(" hue_position=");
-    USBSerial.println(float(hue_position));
+    LOG_DEBUG("BLOOM DEBUG: total_chromagram=%.3f hue_position=%.3f", total_chromagram, float(hue_position));
   }
-  */
 
   //-------------------------------------------------------
   // Calculate new color input based on chromagram
@@ -535,19 +514,11 @@ void light_mode_bloom(CRGB16* leds_prev_buffer) { // Accept previous buffer as a
   // Mix colors from strongest chromagram bins
   SQ15x16 total_magnitude = 0.0;
   
+  require_audio_features(FEATURE_CHROMA_CURVED);  // (audio_features.h)
+
   for (uint8_t i = 0; i < 12; i++) {
-    SQ15x16 bin = chromagram_smooth[i];
-    // Apply contrast iterations (integer part)
-    for(uint8_t iter = 0; iter < (uint8_t)CONFIG.SQUARE_ITER; ++iter) {
-        bin *= bin;
-    }
-    // Apply fractional contrast iteration
-    float fract_iter = CONFIG.SQUARE_ITER - floor(CONFIG.SQUARE_ITER);
-    if (fract_iter > 0.01) {
-        SQ15x16 squared = bin * bin;
-        bin = bin * (1.0 - fract_iter) + squared * fract_iter;
-    }
-    
+    SQ15x16 bin = audio_features.chroma_curved[i];
+
     // Only add colors from bins above threshold
     if (bin > 0.05) {
       float prog = i / 12.0;
@@ -595,20 +566,11 @@ void light_mode_bloom(CRGB16* leds_prev_buffer) { // Accept previous buffer as a
     temp_col_rgb = force_hue(temp_col_rgb, 255*float(led_hue));
   }
   
-  // DEBUG: Check what color we're inserting - DISABLED to reduce serial flooding
-  /*
-  if (debug_mode && (bloom_debug_counter % 100 == 1)) {
-    USBSerial.print("BLOOM COLOR: chromatic_mode=");
-    USBSerial.print(chromatic_mode);
-    USBSerial.print(" RGB=(");
-    USBSerial.print(temp_col_rgb.r);
-    USBSerial.print(",");
-    USBSerial.print(temp_col_rgb.g);
-    USBSerial.print(",");
-    USBSerial.print(temp_col_rgb.b);
-    USBSerial.println(")");
+  // DEBUG: Check what color we're inserting
+  if (log_bloom) {
+    LOG_DEBUG("BLOOM COLOR: chromatic_mode=%d RGB=(%u,%u,%u)", chromatic_mode ? 1 : 0,
+              unsigned(temp_col_rgb.r), unsigned(temp_col_rgb.g), unsigned(temp_col_rgb.b));
   }
-  */
 
   CRGB16 final_insert_color = { temp_col_rgb.r / 255.0, temp_col_rgb.g / 255.0, temp_col_rgb.b / 255.0 };
   
@@ -618,42 +580,68 @@ void light_mode_bloom(CRGB16* leds_prev_buffer) { // Accept previous buffer as a
   final_insert_color.b *= frame_config.PHOTONS;
 
   // Insert the new color at the center of the strip
-  uint16_t center_idx1 = (NATIVE_RESOLUTION / 2) - 1;
-  uint16_t center_idx2 = NATIVE_RESOLUTION / 2;
+  uint16_t center_idx1 = (render_resolution / 2) - 1;
+  uint16_t center_idx2 = render_resolution / 2;
   leds_16[center_idx1] = final_insert_color;
   leds_16[center_idx2] = final_insert_color; // Insert in two center pixels for symmetry
 
   //-------------------------------------------------------
 
-  // Copy current frame to the provided previous frame buffer
-  memcpy(leds_prev_buffer, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  // The unfaded frame is next frame's sprite
+  frame_trail_commit(trail);
+
+  // Fade towards the ends of the strip and mirror downwards, in one pass
+  // from the trail into the canvas. The mirror overwrites the whole lower
+  // half, left end fade included, so only the upper half is read.
+  CRGB16* trail_frame = frame_write_source();
+  uint16_t half_res = render_resolution >> 1;
+  uint16_t fade_width = render_resolution / 4; // Fade over the outer quarters
+  for (uint16_t i = 0; i < half_res; i++) {
+    uint16_t from_end = half_res - 1 - i;
+    CRGB16 col = trail_frame[half_res + i];
+
+    if (from_end < fade_width) {
+      float prog = (float)from_end / (fade_width - 1);
+      SQ15x16 fade_amount = SQ15x16(prog * prog); // Quadratic fade, ensure SQ15x16
+      col.r *= fade_amount;
+      col.g *= fade_amount;
+      col.b *= fade_amount;
+    }
 
-  // Apply fade towards the ends of the strip (adjust fade range if needed)
-  uint16_t fade_width = NATIVE_RESOLUTION / 4; // Fade over the outer quarters
-  for(uint16_t i = 0; i < fade_width; i++) {
-    float prog = (float)i / (fade_width - 1);
-    SQ15x16 fade_amount = SQ15x16(prog * prog); // Quadratic fade, ensure SQ15x16
+    leds_16[half_res + i] = col;
+    leds_16[half_res - 1 - i] = col;
+  }
+}
 
-    // Fade right end
-    leds_16[NATIVE_RESOLUTION - 1 - i].r *= fade_amount;
-    leds_16[NATIVE_RESOLUTION - 1 - i].g *= fade_amount;
-    leds_16[NATIVE_RESOLUTION - 1 - i].b *= fade_amount;
+// sin() of a procedural.h phase, as SQ15x16
+static inline SQ15x16 sin_lut(uint32_t phase) {
+  return SQ15x16::fromInternal(proc_sin(phase));
+}
 
-    // Fade left end
-    leds_16[i].r *= fade_amount;
-    leds_16[i].g *= fade_amount;
-    leds_16[i].b *= fade_amount;
-  }
+// 0.0 - 1.0 from the modes' xorshift RNG, as SQ15x16
+static inline SQ15x16 random_fixed() {
+  return SQ15x16::fromInternal(proc_rand_q16(mode_rng));
+}
 
-  // Mirroring is implicitly handled by the structure? Or apply explicitly if needed.
-  // If the sprite shift + center insert doesn't create symmetry, uncomment:
-   mirror_image_downwards(leds_16); // Re-enabled mirroring
+// exp(-x) through the procedural.h LUT
+static inline SQ15x16 exp_neg_fixed(SQ15x16 x) {
+  return SQ15x16::fromInternal(proc_exp_neg(x.getInternal()));
+}
+
+// qc_wave_phase wraps every QC_WAVE_PHASE_TURNS turns rather than every
+// turn, so its 0.5x and 0.3x harmonics are whole multiples of the raw value
+// (5x and 3x) and don't jump when it wraps.
+#define QC_WAVE_PHASE_TURNS 10
+
+static inline uint32_t qc_wave_phase_step(SQ15x16 radians) {
+  return uint32_t((int64_t(radians.getInternal()) * 68356528) >> 16);  // 2^32 / 20pi
 }
 
 // Add at the end of the file, after the last light mode function but before any closing braces
 void light_mode_quantum_collapse() {
-  static SQ15x16 wave_probabilities[NATIVE_RESOLUTION];
-  static bool initialized = false;
+  // Per-LED state lives in the render arena (led_utilities.h), sized for the boot resolution
+  SQ15x16* wave_probabilities = qc_wave_probabilities;
+  static uint16_t state_resolution = 0;  // render_resolution the per-LED state was built for, 0 before the first frame
   static uint32_t last_collapse_time = 0;
   static uint16_t particle_positions[12] = {0}; 
   static SQ15x16 particle_velocities[12] = {0};
@@ -665,65 +653,78 @@ void light_mode_quantum_collapse() {
   static SQ15x16 triad_hues[3];
   static SQ15x16 field_energy_f = SQ15x16(0.5);
   static SQ15x16 speed_mult_fixed = SQ15x16(1.0);
-  static SQ15x16 wave_phase[NATIVE_RESOLUTION] = {0};  // For organic wave variation
-  static SQ15x16 fluid_velocity[NATIVE_RESOLUTION] = {0}; // For fluid-like motion
+  uint32_t* wave_phase = qc_wave_phase;  // For organic wave variation
+  SQ15x16* fluid_velocity = qc_fluid_velocity; // For fluid-like motion
   static SQ15x16 audio_impact = SQ15x16(0); // Audio impact tracker
   static SQ15x16 audio_pulse = SQ15x16(0); // Audio pulse effect
   static SQ15x16 prev_energy_level = SQ15x16(0); // For detecting energy changes
   static SQ15x16 beat_strength = SQ15x16(0); // For beat response
   
-  // Initialize on first run
-  if (!initialized) {
-    // Set up triadic colour scheme based on current chroma value
-    // Use CONFIG.CHROMA directly for initialization
-    triad_hues[0] = CONFIG.CHROMA;
-    triad_hues[1] = CONFIG.CHROMA + SQ15x16(0.333);
-    triad_hues[2] = CONFIG.CHROMA + SQ15x16(0.667);
-    
+  // Initialize on first run, and the per-LED state again whenever the render
+  // resolution changes (quality_governor.h, mode_transition.h) so it never
+  // reads pixels past what was filled in
+  if (state_resolution != render_resolution) {
     // Initialize with variable patterns
-    for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-      float position = (float)i / NATIVE_RESOLUTION;
+    for (uint16_t i = 0; i < render_resolution; i++) {
+      float position = (float)i / render_resolution;
       // Multiple overlapping waves with varied phases for organic look
       wave_probabilities[i] = SQ15x16(0.2) + 
-                              SQ15x16(0.15) * sin(position * 6.28 * 2 + random_float() * 0.5) + 
-                              SQ15x16(0.15) * sin(position * 6.28 * 3.5 + random_float() * 0.7);
+                              SQ15x16(0.15) * sin_lut(proc_phase(position * 6.28 * 2 + proc_rand_float(mode_rng) * 0.5)) + 
+                              SQ15x16(0.15) * sin_lut(proc_phase(position * 6.28 * 3.5 + proc_rand_float(mode_rng) * 0.7));
       
       // Initialize wave phase with random offsets for natural variation
-      wave_phase[i] = SQ15x16(random_float() * 6.28);
+      wave_phase[i] = proc_rand(mode_rng);
       
       // Initialize fluid velocities with slight variations
-      fluid_velocity[i] = SQ15x16(random_float() * 0.01 - 0.005);
+      fluid_velocity[i] = random_fixed() * SQ15x16(0.01) - SQ15x16(0.005);
       
       if (wave_probabilities[i] > SQ15x16(1.0)) wave_probabilities[i] = SQ15x16(1.0);
       if (wave_probabilities[i] < SQ15x16(0.0)) wave_probabilities[i] = SQ15x16(0.0);
     }
+
+    // Particles keep going, at the same place along the strip
+    if (state_resolution != 0) {
+      for (uint8_t i = 0; i < 12; i++) {
+        particle_positions[i] = uint32_t(particle_positions[i]) * render_resolution / state_resolution;
+      }
+    }
+  }
+
+  if (state_resolution == 0) {
+    // Set up triadic colour scheme based on current chroma value
+    // Use CONFIG.CHROMA directly for initialization
+    triad_hues[0] = CONFIG.CHROMA;
+    triad_hues[1] = CONFIG.CHROMA + SQ15x16(0.333);
+    triad_hues[2] = CONFIG.CHROMA + SQ15x16(0.667);
     
     // Initialize particles with more varied properties
     for (uint8_t i = 0; i < 12; i++) {
       // More varied spacing and positioning
-      float spacing_variety = NATIVE_RESOLUTION / (12.0 + random_float() * 4.0 - 2.0);
-      particle_positions[i] = spacing_variety * i + random(15) - 7;
+      float spacing_variety = render_resolution / (12.0 + proc_rand_float(mode_rng) * 4.0 - 2.0);
+      int32_t start_pos = int32_t(spacing_variety * i) + int32_t(proc_rand_below(mode_rng, 15)) - 7;
       
       // Ensure valid range
-      if (particle_positions[i] >= NATIVE_RESOLUTION) 
-        particle_positions[i] = NATIVE_RESOLUTION - 1;
-      if (particle_positions[i] < 0) 
-        particle_positions[i] = 0;
+      if (start_pos >= render_resolution) 
+        start_pos = render_resolution - 1;
+      if (start_pos < 0) 
+        start_pos = 0;
+      particle_positions[i] = start_pos;
       
       // More natural velocity distribution - some fast, some slow, some nearly still
-      float speed_factor = pow(random_float(), 2) * 3.0 + 0.5; // Non-linear distribution
-      particle_velocities[i] = SQ15x16((random_float() - 0.45) * 1.2 * speed_factor);
+      float r = proc_rand_float(mode_rng);
+      float speed_factor = r * r * 3.0 + 0.5; // Non-linear distribution
+      particle_velocities[i] = SQ15x16((proc_rand_float(mode_rng) - 0.45) * 1.2 * speed_factor);
       
       // Varied energy levels
-      particle_energies[i] = SQ15x16(0.3 + pow(random_float(), 1.5) * 0.7);
+      r = proc_rand_float(mode_rng);
+      particle_energies[i] = SQ15x16(0.3 + r * sqrtf(r) * 0.7);
       
       // Color variation with triadic scheme
-      float hue_variety = random_float() * 0.12 - 0.06; // Greater color variation
-      particle_hues[i] = triad_hues[i % 3] + SQ15x16(hue_variety);
+      SQ15x16 hue_variety = random_fixed() * SQ15x16(0.12) - SQ15x16(0.06); // Greater color variation
+      particle_hues[i] = triad_hues[i % 3] + hue_variety;
     }
-    
-    initialized = true;
   }
+  state_resolution = render_resolution;
   
   // Update triadic colours to follow auto color shift if enabled
   // This ensures colors evolve with the global color system
@@ -766,7 +767,7 @@ void light_mode_quantum_collapse() {
   
   // Audio pulse decays with oscillation (more organic)
   if (audio_pulse > SQ15x16(0.01)) {
-    audio_pulse = audio_pulse * SQ15x16(0.9) + SQ15x16(sin(float(audio_pulse) * 3.14)) * SQ15x16(0.1);
+    audio_pulse = audio_pulse * SQ15x16(0.9) + sin_lut(proc_phase(float(audio_pulse) * 3.14f)) * SQ15x16(0.1);
   } else {
     audio_pulse = SQ15x16(0);
   }
@@ -796,12 +797,12 @@ void light_mode_quantum_collapse() {
   }
   
   // Animation phase advances with organic variation based on energy
-  float energy_variation = float(field_energy) * 0.06 * (0.8 + sin(animation_phase * 0.7) * 0.2);
+  float energy_variation = float(field_energy) * 0.06 * (0.8 + float(sin_lut(proc_phase(animation_phase * 0.7f))) * 0.2);
   animation_phase += (0.01 + energy_variation) * float(speed_mult_fixed); 
-  field_flow += (0.005 + float(field_energy) * 0.015 * (0.9 + cos(animation_phase * 0.3) * 0.1)) * float(speed_mult_fixed);
+  field_flow += (0.005 + float(field_energy) * 0.015 * (0.9 + float(sin_lut(proc_phase(animation_phase * 0.3f) + PROC_PHASE_QUARTER)) * 0.1)) * float(speed_mult_fixed);
   
   // Clear LED buffer
-  memset(leds_16, 0, sizeof(CRGB16) * NATIVE_RESOLUTION);
+  memset(leds_16, 0, sizeof(CRGB16) * render_resolution);
   
   // Detect major beats for collapse events
   bool collapse_triggered = audio_vu_level > audio_vu_level_average * SQ15x16(1.3) && 
@@ -817,18 +818,18 @@ void light_mode_quantum_collapse() {
     uint16_t collapse_center;
     
     // Base probability on existing wave state and audio
-    float total_prob = 0;
-    for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-      total_prob += float(wave_probabilities[i]);
+    SQ15x16 total_prob = 0;
+    for (uint16_t i = 0; i < render_resolution; i++) {
+      total_prob += wave_probabilities[i];
     }
     
     // Weighted probability selection for more natural collapses
-    float random_prob = random_float() * total_prob;
-    float prob_sum = 0;
-    collapse_center = NATIVE_RESOLUTION / 2; // Default center
+    SQ15x16 random_prob = random_fixed() * total_prob;
+    SQ15x16 prob_sum = 0;
+    collapse_center = render_resolution / 2; // Default center
     
-    for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-      prob_sum += float(wave_probabilities[i]);
+    for (uint16_t i = 0; i < render_resolution; i++) {
+      prob_sum += wave_probabilities[i];
       if (prob_sum >= random_prob) {
         collapse_center = i;
         break;
@@ -836,70 +837,76 @@ void light_mode_quantum_collapse() {
     }
     
     // Audio-reactive collapse with more organic distribution
-    float audio_intensity = 0.5 + float(audio_vu_level) * 0.5;
+    SQ15x16 audio_intensity = SQ15x16(0.5) + audio_vu_level * SQ15x16(0.5);
     // Width varies with SQUARE_ITER for visible control
     float collapse_width = 0.3 - float(CONFIG.SQUARE_ITER) * 0.05;
     if (collapse_width < 0.1) collapse_width = 0.1;
+
+    // Distance in collapse widths is distance * inv_width, falloff is exp(-d^2 * 8 * intensity)
+    int32_t inv_width = int32_t(65536.0f / (render_resolution * collapse_width));
+    SQ15x16 falloff_k = SQ15x16(8.0) * audio_intensity;
+    SQ15x16 push = SQ15x16(0.005) * audio_energy;
     
     // Non-uniform collapse pattern for more organic feel
-    for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-      // Non-linear distance calculation for more natural falloff
-      float raw_distance = fabs(float(i) - float(collapse_center));
-      float scaled_distance = pow(raw_distance / (NATIVE_RESOLUTION * collapse_width), 1.2);
+    for (uint16_t i = 0; i < render_resolution; i++) {
+      // Past 4 widths the falloff is zero anyway
+      int32_t raw_distance = abs(int32_t(i) - int32_t(collapse_center));
+      int32_t scaled_raw = raw_distance * inv_width;
+      if (scaled_raw > (4 << 16)) scaled_raw = (4 << 16);
+      SQ15x16 scaled_distance = SQ15x16::fromInternal(scaled_raw);
       
       // Varied collapse probability with audio influence
-      float collapse_probability = exp(-scaled_distance * scaled_distance * 8.0 * audio_intensity);
+      SQ15x16 collapse_probability = exp_neg_fixed(scaled_distance * scaled_distance * falloff_k);
       
       // Add randomness for natural look
-      if (random_float() < collapse_probability) {
+      if (random_fixed() < collapse_probability) {
         // Collapsed regions with natural variance
-        wave_probabilities[i] = SQ15x16(0.7 + random_float() * 0.3);
+        wave_probabilities[i] = SQ15x16(0.7) + random_fixed() * SQ15x16(0.3);
         
         // Reset wave phase for dynamic restart
-        wave_phase[i] = SQ15x16(random_float() * 6.28);
+        wave_phase[i] = proc_rand(mode_rng);
         
         // Reset fluid velocity with burst in collapse direction
-        float direction = (i < collapse_center) ? -1.0 : 1.0;
-        fluid_velocity[i] = SQ15x16(direction * (0.01 + random_float() * 0.02) * float(audio_energy));
+        SQ15x16 burst = (SQ15x16(0.01) + random_fixed() * SQ15x16(0.02)) * audio_energy;
+        fluid_velocity[i] = (i < collapse_center) ? -burst : burst;
       } else {
-        // Reduce probability with natural falloff
-        float reduction = 0.8 - 0.6 * pow(scaled_distance, 0.8);
-        if (reduction < 0.2) reduction = 0.2;
+        // Reduce probability with natural falloff, 0.8 - 0.6 * d^0.8 (procedural.h LUT), 0.2 from d = 1 on
+        SQ15x16 reduction = SQ15x16(0.8) - SQ15x16(0.6) * SQ15x16::fromInternal(proc_pow_0_8(scaled_raw));
         
         // Apply with slight randomness
-        wave_probabilities[i] *= SQ15x16(reduction * (0.95 + random_float() * 0.1));
+        wave_probabilities[i] *= reduction * (SQ15x16(0.95) + random_fixed() * SQ15x16(0.1));
         
         // Small fluid velocity impact
-        fluid_velocity[i] += SQ15x16((i < collapse_center ? -0.005 : 0.005) * float(audio_energy));
+        fluid_velocity[i] += (i < collapse_center) ? -push : push;
       }
     }
     
     // Energize particles with more physical behavior
     for (uint8_t i = 0; i < 6; i++) {
-      uint8_t particle_idx = random(12);
+      uint8_t particle_idx = proc_rand_below(mode_rng, 12);
       
       // Position with natural spread from center
-      int spread = NATIVE_RESOLUTION / (20 - random(8)); // Variable spread
-      int16_t new_pos = collapse_center + random(spread*2) - spread;
+      int spread = render_resolution / (20 - proc_rand_below(mode_rng, 8)); // Variable spread
+      int16_t new_pos = collapse_center + int(proc_rand_below(mode_rng, spread*2)) - spread;
       
       // Ensure bounds
       if (new_pos < 0) new_pos = 0;
-      if (new_pos >= NATIVE_RESOLUTION) new_pos = NATIVE_RESOLUTION - 1;
+      if (new_pos >= render_resolution) new_pos = render_resolution - 1;
       
       particle_positions[particle_idx] = new_pos;
       
       // More organic velocity based on position from center
       float dir = (new_pos < collapse_center) ? -1.0 : 1.0;
       // Log scale for more natural distribution
-      float speed_variety = pow(0.5 + random_float() * 0.5, 0.7) * 3.0;
+      float speed_variety = pow(0.5 + proc_rand_float(mode_rng) * 0.5, 0.7) * 3.0;
       particle_velocities[particle_idx] = SQ15x16(dir * speed_variety) * audio_energy;
       
       // Energy varies with audio level
-      particle_energies[particle_idx] = SQ15x16(0.6 + float(audio_vu_level) * 0.4 + random_float() * 0.2);
+      particle_energies[particle_idx] = SQ15x16(0.6) + audio_vu_level * SQ15x16(0.4) + random_fixed() * SQ15x16(0.2);
       
       // Color with slight shift and audio influence
       particle_hues[particle_idx] = triad_hues[particle_idx % 3] + 
-                                   SQ15x16(random_float() * 0.1 - 0.05) + 
+                                   random_fixed() * SQ15x16(0.1) - SQ15x16(0.05) + 
                                    audio_vu_level * SQ15x16(0.05);
     }
     
@@ -913,99 +920,122 @@ void light_mode_quantum_collapse() {
   else if (small_collapse) {
     // Choose mini-collapse center near particles for natural focal points
     uint16_t small_collapse_center;
-    if (random_float() < 0.7 && float(audio_vu_level) > 0.2) {
+    if (random_fixed() < SQ15x16(0.7) && audio_vu_level > SQ15x16(0.2)) {
       // Bias toward existing particles
-      small_collapse_center = particle_positions[random(12)];
+      small_collapse_center = particle_positions[proc_rand_below(mode_rng, 12)];
     } else {
-      small_collapse_center = random(NATIVE_RESOLUTION);
+      small_collapse_center = proc_rand_below(mode_rng, render_resolution);
     }
     
     // Audio-reactive radius with organic variation
-    int radius = 5 + int(float(audio_vu_level) * (8.0 + random_float() * 4.0));
+    int radius = 5 + int(float(audio_vu_level) * (8.0 + proc_rand_float(mode_rng) * 4.0));
     if (radius > 25) radius = 25;
+
+    int32_t inv_radius = 65536 / radius;
+    SQ15x16 strength_scale = SQ15x16(0.3) * audio_energy;
     
     // Non-uniform collapse for natural look
     for (int16_t i = -radius; i <= radius; i++) {
       int16_t pos = small_collapse_center + i;
-      if (pos >= 0 && pos < NATIVE_RESOLUTION) {
-        // Non-linear distance for more organic falloff
-        float distance = pow(fabs(float(i)) / radius, 1.2);
-        float collapse_strength = exp(-distance * distance * 4) * 0.3 * float(audio_energy);
+      if (pos >= 0 && pos < render_resolution) {
+        // Gaussian falloff over the radius
+        SQ15x16 distance = SQ15x16::fromInternal(abs(i) * inv_radius);
+        SQ15x16 collapse_strength = exp_neg_fixed(distance * distance * SQ15x16(4)) * strength_scale;
         
         // Add randomness for natural look
-        collapse_strength *= 0.9 + random_float() * 0.2;
+        collapse_strength *= SQ15x16(0.9) + random_fixed() * SQ15x16(0.2);
         
         // Apply to wave with fluid mechanics
-        wave_probabilities[pos] += SQ15x16(collapse_strength);
+        wave_probabilities[pos] += collapse_strength;
         if (wave_probabilities[pos] > SQ15x16(1.0)) wave_probabilities[pos] = SQ15x16(1.0);
         
         // Update fluid velocity with impact
-        fluid_velocity[pos] += SQ15x16((random_float() - 0.5) * collapse_strength * 0.02);
+        fluid_velocity[pos] += (random_fixed() - SQ15x16(0.5)) * collapse_strength * SQ15x16(0.02);
       }
     }
     
     // Physical particle behavior
     for (uint8_t i = 0; i < 2; i++) {
-      uint8_t particle_idx = random(12);
+      uint8_t particle_idx = proc_rand_below(mode_rng, 12);
       
       // Realistic physics - momentum conservation with energy loss
-      particle_velocities[particle_idx] *= SQ15x16(-0.85 - random_float() * 0.1); 
+      particle_velocities[particle_idx] *= SQ15x16(-0.85) - random_fixed() * SQ15x16(0.1); 
       
       // Small energy boost with randomness
-      particle_energies[particle_idx] += SQ15x16(0.15 + random_float() * 0.1);
+      particle_energies[particle_idx] += SQ15x16(0.15) + random_fixed() * SQ15x16(0.1);
       if (particle_energies[particle_idx] > SQ15x16(1.0)) particle_energies[particle_idx] = SQ15x16(1.0);
     }
     
     // Small energy boost with audio reaction
-    field_energy += SQ15x16(0.05 + float(audio_vu_level) * 0.08);
+    field_energy += SQ15x16(0.05) + audio_vu_level * SQ15x16(0.08);
     if (field_energy > SQ15x16(2.0)) field_energy = SQ15x16(2.0);
   }
   
   // Continuous fluid wave motion in the probability field
   // Audio-reactive amplitude with organic variation
-  float wave_amplitude = 0.02 + float(audio_vu_level) * 0.08 + float(audio_pulse) * 0.05;
+  SQ15x16 wave_amplitude = SQ15x16(0.02) + audio_vu_level * SQ15x16(0.08) + audio_pulse * SQ15x16(0.05);
   
   // Update fluid simulation
-  SQ15x16 fluid_diffusion = SQ15x16(0.03 + float(CONFIG.MOOD) * 0.02); // Diffusion rate
-  SQ15x16 temp_fluid[NATIVE_RESOLUTION];
+  SQ15x16 fluid_diffusion = SQ15x16(0.03) + CONFIG.MOOD * SQ15x16(0.02); // Diffusion rate
+  SQ15x16 fluid_keep = SQ15x16(1.0) - fluid_diffusion * SQ15x16(2.0);
+  SQ15x16* temp_fluid = qc_scratch;
   
   // Copy fluid velocities for update
-  memcpy(temp_fluid, fluid_velocity, sizeof(SQ15x16) * NATIVE_RESOLUTION);
+  memcpy(temp_fluid, fluid_velocity, sizeof(SQ15x16) * render_resolution);
   
   // Update fluid velocities with diffusion for organic flow
-  for (uint16_t i = 1; i < NATIVE_RESOLUTION-1; i++) {
-    fluid_velocity[i] = temp_fluid[i] * SQ15x16(1.0 - 2.0 * float(fluid_diffusion)) + 
+  for (uint16_t i = 1; i < render_resolution-1; i++) {
+    fluid_velocity[i] = temp_fluid[i] * fluid_keep + 
                        (temp_fluid[i-1] + temp_fluid[i+1]) * fluid_diffusion;
                        
     // Natural velocity decay (fluid friction)
     fluid_velocity[i] *= SQ15x16(0.99);
   }
+
+  // Three harmonics plus the beat bloom, each stepping its phase along the
+  // strip (position * k radians) instead of calling sin() per pixel
+  uint32_t wave_step = qc_wave_phase_step(SQ15x16(0.1) * speed_mult_fixed * (SQ15x16(0.5) + field_energy * SQ15x16(0.5)));
+  uint32_t harmonic_1 = proc_phase(animation_phase * 1.5f);
+  uint32_t harmonic_2 = proc_phase(animation_phase * 3.0f);
+  uint32_t harmonic_3 = proc_phase(animation_phase * 0.7f);
+  uint32_t bloom_phase = proc_phase(animation_phase * 5.0f);
+  uint32_t harmonic_1_step = proc_phase(8.0f / render_resolution);
+  uint32_t harmonic_2_step = proc_phase(15.0f / render_resolution);
+  uint32_t harmonic_3_step = proc_phase(5.0f / render_resolution);
+  uint32_t bloom_step = proc_phase(30.0f / render_resolution);
+
+  SQ15x16 amplitude_1 = wave_amplitude * SQ15x16(0.6);
+  SQ15x16 amplitude_2 = wave_amplitude * SQ15x16(0.3);
+  SQ15x16 amplitude_3 = wave_amplitude * SQ15x16(0.4);
+  bool pulsing = audio_pulse > SQ15x16(0.01);
+  SQ15x16 pulse_amplitude = audio_pulse * SQ15x16(0.03);
   
   // Apply wave updates with fluid transport
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    float position = (float)i / NATIVE_RESOLUTION;
-    
+  for (uint16_t i = 0; i < render_resolution; i++) {
     // Advance wave phase with fluid velocity
-    wave_phase[i] += SQ15x16(0.1 * float(speed_mult_fixed) * (0.5 + float(field_energy) * 0.5)) + fluid_velocity[i];
+    wave_phase[i] += wave_step + qc_wave_phase_step(fluid_velocity[i]);
+    uint32_t phase = wave_phase[i];
     
     // Create complex wave patterns with multiple harmonics
-    SQ15x16 wave_add = SQ15x16(
-      sin(position * 8.0 + animation_phase * 1.5 + float(wave_phase[i])) * wave_amplitude * 0.6 +
-      sin(position * 15.0 + animation_phase * 3.0 - float(wave_phase[i]) * 0.5) * wave_amplitude * 0.3 +
-      sin(position * 5.0 + animation_phase * 0.7 + float(wave_phase[i]) * 0.3) * wave_amplitude * 0.4
-    );
+    SQ15x16 wave_add = sin_lut(harmonic_1 + phase * QC_WAVE_PHASE_TURNS) * amplitude_1 +
+                       sin_lut(harmonic_2 - phase * (QC_WAVE_PHASE_TURNS / 2)) * amplitude_2 +
+                       sin_lut(harmonic_3 + phase * (QC_WAVE_PHASE_TURNS * 3 / 10)) * amplitude_3;
     
     // Audio pulse adds bloom on beats
-    if (audio_pulse > SQ15x16(0.01)) {
-      wave_add += audio_pulse * SQ15x16(sin(position * 30.0 + animation_phase * 5.0) * 0.03);
+    if (pulsing) {
+      wave_add += sin_lut(bloom_phase) * pulse_amplitude;
     }
+
+    harmonic_1 += harmonic_1_step;
+    harmonic_2 += harmonic_2_step;
+    harmonic_3 += harmonic_3_step;
+    bloom_phase += bloom_step;
     
     // Apply to wave field with transport
     int idx = i;
-    float transport = float(fluid_velocity[i]) * 10.0;
-    if (transport > 0) {
-      idx = (i + 1 < NATIVE_RESOLUTION) ? i + 1 : i;
-    } else if (transport < 0) {
+    if (fluid_velocity[i] > SQ15x16(0)) {
+      idx = (i + 1 < render_resolution) ? i + 1 : i;
+    } else if (fluid_velocity[i] < SQ15x16(0)) {
       idx = (i > 0) ? i - 1 : i;
     }
     
@@ -1026,18 +1056,26 @@ void light_mode_quantum_collapse() {
   if (base_diffusion > max_diffusion) base_diffusion = max_diffusion;
   
   // Fluid flow changes with organic variation
-  float flow_angle = field_flow + sin(animation_phase * 0.3) * 0.5;
-  SQ15x16 flow_direction = SQ15x16(sin(flow_angle)) * SQ15x16(0.3);
+  float flow_angle = field_flow + float(sin_lut(proc_phase(animation_phase * 0.3f))) * 0.5;
+  SQ15x16 flow_direction = sin_lut(proc_phase(flow_angle)) * SQ15x16(0.3);
+
+  // Energy-based decay with audio influence
+  SQ15x16 decay_rate = SQ15x16(0.995) + (field_energy * SQ15x16(0.003)) + (audio_impact * SQ15x16(0.001));
+  if (decay_rate > SQ15x16(0.999)) decay_rate = SQ15x16(0.999);
   
   // Safe copy for diffusion
-  SQ15x16 temp_field[NATIVE_RESOLUTION];
-  memcpy(temp_field, wave_probabilities, sizeof(SQ15x16) * NATIVE_RESOLUTION);
+  SQ15x16* temp_field = qc_scratch;
+  memcpy(temp_field, wave_probabilities, sizeof(SQ15x16) * render_resolution);
+
+  // One turn of diffusion variation across the strip
+  uint32_t diffusion_step = proc_phase(6.28f / render_resolution);
+  uint32_t diffusion_phase = proc_phase(animation_phase) + diffusion_step;
   
   // Apply diffusion with organic asymmetry
-  for (uint16_t i = 1; i < NATIVE_RESOLUTION-1; i++) {
+  for (uint16_t i = 1; i < render_resolution-1; i++) {
     // Dynamic diffusion rate for non-uniform flow
-    float pos_factor = 1.0 + sin(float(i) / NATIVE_RESOLUTION * 6.28 + animation_phase) * 0.2;
-    SQ15x16 local_diffusion = base_diffusion * SQ15x16(pos_factor);
+    SQ15x16 local_diffusion = base_diffusion * (SQ15x16(1.0) + sin_lut(diffusion_phase) * SQ15x16(0.2));
+    diffusion_phase += diffusion_step;
     
     // Asymmetric diffusion with fluid direction
     SQ15x16 left_mix = local_diffusion + flow_direction + fluid_velocity[i] * SQ15x16(2.0);
@@ -1057,10 +1095,6 @@ void light_mode_quantum_collapse() {
                            temp_field[i-1] * left_mix + 
                            temp_field[i+1] * right_mix;
     
-    // Energy-based decay with audio influence
-    SQ15x16 decay_rate = SQ15x16(0.995) + (field_energy * SQ15x16(0.003)) + (audio_impact * SQ15x16(0.001));
-    if (decay_rate > SQ15x16(0.999)) decay_rate = SQ15x16(0.999);
-    
     wave_probabilities[i] *= decay_rate;
   }
   
@@ -1073,7 +1107,7 @@ void light_mode_quantum_collapse() {
     SQ15x16 energy_delta = energy_target - particle_energies[i];
     if (energy_delta > SQ15x16(0)) {
       // Faster recovery when far from target (organic)
-      particle_energies[i] += energy_delta * SQ15x16(0.05 + float(energy_delta) * 0.2);
+      particle_energies[i] += energy_delta * (SQ15x16(0.05) + energy_delta * SQ15x16(0.2));
     } else {
       // Slow decay when above target
       particle_energies[i] += energy_delta * SQ15x16(0.02);
@@ -1102,7 +1136,7 @@ void light_mode_quantum_collapse() {
     int delta_pos = (particle_velocities[i] * speed_mod).getInteger();
     
     // Limit maximum speed for stability with organic cap
-    float speed_limit = 15.0 * (0.8 + 0.4 * random_float());
+    int speed_limit = 12 + proc_rand_below(mode_rng, 7);  // 15 * (0.8 - 1.2)
     if (delta_pos > speed_limit) delta_pos = speed_limit;
     if (delta_pos < -speed_limit) delta_pos = -speed_limit;
     
@@ -1110,23 +1144,23 @@ void light_mode_quantum_collapse() {
     int32_t new_pos = particle_positions[i] + delta_pos;
     
     // Realistic boundary physics with energy preservation
-    if (new_pos >= NATIVE_RESOLUTION) {
+    if (new_pos >= render_resolution) {
       // Bounce with energy loss and slight randomization
-      particle_positions[i] = NATIVE_RESOLUTION - 1;
+      particle_positions[i] = render_resolution - 1;
       
       // Vary bounce coefficient for more natural feel
-      float bounce_factor = -0.8 - random_float() * 0.15;
-      particle_velocities[i] *= SQ15x16(bounce_factor);
+      SQ15x16 bounce_factor = SQ15x16(-0.8) - random_fixed() * SQ15x16(0.15);
+      particle_velocities[i] *= bounce_factor;
       
       // Energy loss on collision with slight randomization
-      particle_energies[i] *= SQ15x16(0.85 + random_float() * 0.1);
+      particle_energies[i] *= SQ15x16(0.85) + random_fixed() * SQ15x16(0.1);
     } else if (new_pos < 0) {
       // Bounce off other wall with similar physics
       particle_positions[i] = 0;
       
-      float bounce_factor = -0.8 - random_float() * 0.15;
-      particle_velocities[i] *= SQ15x16(bounce_factor);
-      particle_energies[i] *= SQ15x16(0.85 + random_float() * 0.1);
+      SQ15x16 bounce_factor = SQ15x16(-0.8) - random_fixed() * SQ15x16(0.15);
+      particle_velocities[i] *= bounce_factor;
+      particle_energies[i] *= SQ15x16(0.85) + random_fixed() * SQ15x16(0.1);
     } else {
       // Normal movement
       particle_positions[i] = new_pos;
@@ -1137,7 +1171,7 @@ void light_mode_quantum_collapse() {
     
     // Force influence from probability field with natural physics
     SQ15x16 field_gradient = SQ15x16(0);
-    if (pos > 2 && pos < NATIVE_RESOLUTION-3) {
+    if (pos > 2 && pos < render_resolution-3) {
       // Wider gradient sampling for smoother motion
       field_gradient = (wave_probabilities[pos+3] - wave_probabilities[pos-3]) * SQ15x16(0.3);
     }
@@ -1150,11 +1184,9 @@ void light_mode_quantum_collapse() {
     particle_velocities[i] += acceleration;
     
     // Add oscillation with natural harmonics and phase variance
-    float phase_offset = i * 0.7 + sin(i * 0.3) * 2.0;
-    particle_velocities[i] += SQ15x16(
-      sin(animation_phase * (0.3 + (i % 4) * 0.2) + phase_offset) * 0.03 * 
-      (0.8 + float(particle_energies[i]) * 0.4)
-    ) * speed_mult_fixed;
+    float phase_offset = i * 0.7 + float(sin_lut(proc_phase(i * 0.3f))) * 2.0;
+    particle_velocities[i] += sin_lut(proc_phase(animation_phase * (0.3 + (i % 4) * 0.2) + phase_offset)) * SQ15x16(0.03) * 
+                              (SQ15x16(0.8) + particle_energies[i] * SQ15x16(0.4)) * speed_mult_fixed;
     
     // Natural velocity bounds with energy consideration
     SQ15x16 max_velocity = (SQ15x16(0.4) + particle_energies[i] * SQ15x16(1.1)) * speed_mult_fixed;
@@ -1177,22 +1209,24 @@ void light_mode_quantum_collapse() {
     if (wave_probabilities[pos] > SQ15x16(1.0)) wave_probabilities[pos] = SQ15x16(1.0);
     
     // Audio-reactive trail width
-    float trail_intensity = float(particle_energies[i]) * (1.0 + float(audio_vu_level) * 0.5);
-    uint8_t trail_width = 1 + (SQ15x16(trail_intensity) * SQ15x16(4)).getInteger();
+    SQ15x16 trail_intensity = particle_energies[i] * (SQ15x16(1.0) + audio_vu_level * SQ15x16(0.5));
+    uint8_t trail_width = 1 + (trail_intensity * SQ15x16(4)).getInteger();
     if (trail_width > 6) trail_width = 6;
+
+    // Falloff is exp(-j^2 / width^2 * shape), audio affects trail shape
+    SQ15x16 trail_k = (SQ15x16(2.0) + audio_vu_level * SQ15x16(2.0)) / SQ15x16(trail_width * trail_width);
     
     // Create organic trail with Gaussian-like distribution
     for (int8_t j = -trail_width; j <= trail_width; j++) {
       if (j == 0) continue; // Skip center
       
       int16_t trail_pos = pos + j;
-      if (trail_pos >= 0 && trail_pos < NATIVE_RESOLUTION) {
+      if (trail_pos >= 0 && trail_pos < render_resolution) {
         // Non-linear falloff for more natural look
-        float falloff_factor = 2.0 + float(audio_vu_level) * 2.0; // Audio affects trail shape
-        float falloff = exp(-(j*j) / (float)(trail_width*trail_width) * falloff_factor);
+        SQ15x16 falloff = exp_neg_fixed(trail_k * SQ15x16(j * j));
         
         // Add trail with audio influence
-        SQ15x16 trail_value = trail_strength * SQ15x16(falloff) * SQ15x16(0.5);
+        SQ15x16 trail_value = trail_strength * falloff * SQ15x16(0.5);
         wave_probabilities[trail_pos] += trail_value;
         
         // Add fluid velocity influence
@@ -1203,82 +1237,102 @@ void light_mode_quantum_collapse() {
       }
     }
   }
+
+  // Contrast settings, same for every pixel
+  uint8_t square_iters = (uint8_t)CONFIG.SQUARE_ITER;
+  SQ15x16 fract_iter = CONFIG.SQUARE_ITER - floor(CONFIG.SQUARE_ITER);
+  bool fract_contrast = fract_iter > SQ15x16(0.01);
+
+  SQ15x16 brightness_scale = SQ15x16(0.4) + CONFIG.PHOTONS * SQ15x16(0.6);
+  SQ15x16 wave_factor = SQ15x16(0.15) + SQ15x16(0.1) * audio_vu_level;
+  SQ15x16 saturation_audio = SQ15x16(0.9) + audio_vu_level * SQ15x16(0.2);
+  SQ15x16 hue_shift_amount = audio_vu_level * SQ15x16(0.02);
+
+  // Colour zones are fractions of the strip in 0.32 fixed point (one turn
+  // of a phase), so fmod(x, 1.0) is just a wrapping multiply
+  const uint32_t ZONE_BLEND_LOW  = 644245094u;   // 0.15
+  const uint32_t ZONE_BLEND_HIGH = 3650722202u;  // 0.85
+  uint32_t zone_step = uint32_t((uint64_t(1) << 32) / render_resolution);
+  uint32_t zone = uint32_t(int64_t(animation_phase * 0.02f * 4294967296.0f)); // Slowly shifting zones
+  uint32_t variance_phase = proc_phase(animation_phase);
+  uint32_t hue_shift_phase = proc_phase(animation_phase * 0.5f);
+  uint32_t hue_shift_step = proc_phase(0.03f);
+  uint32_t modulation_phase = proc_phase(animation_phase * 2.5f);
+  uint32_t modulation_step = proc_phase(0.15f);
   
   // Render final visualization with triadic color scheme
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    // Position-based color zones with flow
-    float zone_progress = (float)i / NATIVE_RESOLUTION;
-    zone_progress = fmod(zone_progress + animation_phase * 0.02, 1.0); // Slowly shifting zones
-    
+  for (uint16_t i = 0; i < render_resolution; i++) {
     // Dynamic color zones based on thirds
-    uint8_t hue_idx = (int)(zone_progress * 3) % 3;
+    uint8_t hue_idx = (uint64_t(zone) * 3) >> 32;
     
     // Base hue from triadic scheme with position blending
     SQ15x16 field_hue = triad_hues[hue_idx];
     
     // Organic color gradients between zones
-    float zone_pos = fmod(zone_progress * 3.0, 1.0);
-    if (zone_pos > 0.85 || zone_pos < 0.15) {
+    uint32_t zone_pos = zone * 3;
+    if (zone_pos > ZONE_BLEND_HIGH || zone_pos < ZONE_BLEND_LOW) {
       // Blend between zones for smoother transition
       uint8_t next_idx = (hue_idx + 1) % 3;
-      float blend = zone_pos > 0.5 ? (zone_pos - 0.85) * 6.67 : (0.15 - zone_pos) * 6.67;
-      field_hue = triad_hues[hue_idx] * SQ15x16(1.0 - blend) + triad_hues[next_idx] * SQ15x16(blend);
+      uint32_t blend_raw = (zone_pos > 0x80000000u) ? (zone_pos - ZONE_BLEND_HIGH) : (ZONE_BLEND_LOW - zone_pos);
+      SQ15x16 blend = SQ15x16::fromInternal(blend_raw >> 16) * SQ15x16(6.67);
+      field_hue = triad_hues[hue_idx] * (SQ15x16(1.0) - blend) + triad_hues[next_idx] * blend;
     }
     
     // Add small organic variance
-    SQ15x16 position_variance = SQ15x16(sin(zone_progress * 6.28 + animation_phase) * 0.03);
-    field_hue += position_variance;
+    field_hue += sin_lut(zone + variance_phase) * SQ15x16(0.03);
     
     // Audio-reactive color shift (subtle)
-    field_hue += audio_vu_level * SQ15x16(0.02) * SQ15x16(sin(animation_phase * 0.5 + i * 0.03));
+    field_hue += hue_shift_amount * sin_lut(hue_shift_phase);
     
     // Keep hue in valid range
     if (field_hue > SQ15x16(1.0)) field_hue -= SQ15x16(1.0);
     if (field_hue < SQ15x16(0.0)) field_hue += SQ15x16(1.0);
     
     // Dynamic brightness with organic curves
-    SQ15x16 brightness = wave_probabilities[i] * (SQ15x16(0.4) + CONFIG.PHOTONS * SQ15x16(0.6));
+    SQ15x16 brightness = wave_probabilities[i] * brightness_scale;
     
     // Audio-reactive brightness boost
     brightness += audio_vu_level * SQ15x16(0.2) * brightness;
     
     // Beat pulse brightening
-    if (audio_pulse > SQ15x16(0.01)) {
+    if (pulsing) {
       brightness += audio_pulse * SQ15x16(0.3) * brightness;
     }
     
     // Apply contrast with organic feel
-    for (uint8_t s = 0; s < (uint8_t)CONFIG.SQUARE_ITER; s++) {
+    for (uint8_t s = 0; s < square_iters; s++) {
       brightness = brightness * brightness;
     }
     
     // Apply fractional contrast for smoother control
-    float fract_iter = CONFIG.SQUARE_ITER - floor(CONFIG.SQUARE_ITER);
-    if (fract_iter > 0.01) {
+    if (fract_contrast) {
       SQ15x16 squared = brightness * brightness;
-      brightness = brightness * SQ15x16(1.0 - fract_iter) + squared * fract_iter;
+      brightness = brightness * (SQ15x16(1.0) - fract_iter) + squared * fract_iter;
     }
     
     // Organic wave modulation for added dimensionality
-    float wave_factor = 0.15 + 0.1 * float(audio_vu_level);
-    brightness *= SQ15x16(1.0 - wave_factor) + 
-                 SQ15x16(wave_factor) * sin(i * 0.15 + animation_phase * 2.5 + float(wave_phase[i]));
+    brightness *= SQ15x16(1.0) - wave_factor + 
+                 wave_factor * sin_lut(modulation_phase + wave_phase[i] * QC_WAVE_PHASE_TURNS);
     
     // Dynamic saturation
     SQ15x16 saturation = CONFIG.SATURATION;
     
     // Desaturate very bright and dark regions for natural look
     if (wave_probabilities[i] > SQ15x16(0.85)) {
-      saturation *= SQ15x16(1.0 - (float(wave_probabilities[i]) - 0.85) * 2.0 * 0.3);
+      saturation *= SQ15x16(1.0) - (wave_probabilities[i] - SQ15x16(0.85)) * SQ15x16(0.6);
     } else if (wave_probabilities[i] < SQ15x16(0.1)) {
-      saturation *= SQ15x16(0.7 + float(wave_probabilities[i]) * 3.0);
+      saturation *= SQ15x16(0.7) + wave_probabilities[i] * SQ15x16(3.0);
     }
     
     // Audio affects saturation slightly
-    saturation *= SQ15x16(0.9 + float(audio_vu_level) * 0.2);
+    saturation *= saturation_audio;
     
     // Create final LED color
     leds_16[i] = get_mode_color(field_hue, saturation, brightness);
+
+    zone += zone_step;
+    hue_shift_phase += hue_shift_step;
+    modulation_phase += modulation_step;
   }
   
   // Render particles with bloom physics
@@ -1286,10 +1340,10 @@ void light_mode_quantum_collapse() {
     uint16_t pos = particle_positions[i];
     
     // Only render if in valid range
-    if (pos < NATIVE_RESOLUTION) {
+    if (pos < render_resolution) {
       // Audio-reactive pulse with unique frequency
-      float pulse_freq = 2.0 + i * 0.4 + sin(i * 0.7) * 0.5;
-      SQ15x16 pulse = SQ15x16(0.7) + SQ15x16(0.3) * sin(animation_phase * pulse_freq + i * 0.7);
+      float pulse_freq = 2.0 + i * 0.4 + float(sin_lut(proc_phase(i * 0.7f))) * 0.5;
+      SQ15x16 pulse = SQ15x16(0.7) + SQ15x16(0.3) * sin_lut(proc_phase(animation_phase * pulse_freq + i * 0.7f));
       
       // Audio boosts pulse
       pulse += audio_pulse * SQ15x16(0.4);
@@ -1303,8 +1357,7 @@ void light_mode_quantum_collapse() {
       SQ15x16 particle_hue = triad_hues[hue_idx];
       
       // Audio and energy affect hue slightly
-      float hue_shift = sin(animation_phase * 0.7 + i * 0.5) * 0.03 * float(audio_vu_level);
-      particle_hue += SQ15x16(hue_shift);
+      particle_hue += sin_lut(proc_phase(animation_phase * 0.7f + i * 0.5f)) * SQ15x16(0.03) * audio_vu_level;
       
       // Normalize hue
       if (particle_hue > SQ15x16(1.0)) particle_hue -= SQ15x16(1.0);
@@ -1331,26 +1384,25 @@ void light_mode_quantum_collapse() {
       leds_16[pos].b = fmax_fixed(leds_16[pos].b, particle_color.b * intensity);
       
       // Dynamic bloom radius with energy and audio
-      float bloom_size = 2.0 + float(particle_energies[i]) * 4.0 + float(audio_pulse) * 3.0;
-      int bloom_radius = bloom_size;
+      SQ15x16 bloom_size = SQ15x16(2.0) + particle_energies[i] * SQ15x16(4.0) + audio_pulse * SQ15x16(3.0);
+      int bloom_radius = bloom_size.getInteger();
       if (bloom_radius > 8) bloom_radius = 8;
+
+      // Falloff is exp(-(j / size)^2 * curve), audio affects bloom shape
+      SQ15x16 bloom_curve = SQ15x16(2.5) + audio_vu_level * SQ15x16(2.0);
+      SQ15x16 bloom_k = bloom_curve / (bloom_size * bloom_size);
+
+      // Energy affects bloom intensity, audio boosts it
+      SQ15x16 bloom_intensity = SQ15x16(0.8) + particle_energies[i] * SQ15x16(1.2) + audio_pulse * SQ15x16(1.5);
       
       // Create bloom with organic falloff
       for (int8_t j = -bloom_radius; j <= bloom_radius; j++) {
         if (j == 0) continue; // Skip center
         
         int16_t bloom_pos = pos + j;
-        if (bloom_pos >= 0 && bloom_pos < NATIVE_RESOLUTION) {
+        if (bloom_pos >= 0 && bloom_pos < render_resolution) {
           // Non-linear falloff for more natural glow
-          float distance = abs(j) / bloom_size;
-          float bloom_curve = 2.5 + float(audio_vu_level) * 2.0; // Audio affects bloom shape
-          SQ15x16 falloff = SQ15x16(exp(-distance * distance * bloom_curve)) * pulse;
-          
-          // Energy affects bloom intensity
-          SQ15x16 bloom_intensity = SQ15x16(0.8) + particle_energies[i] * SQ15x16(1.2);
-          
-          // Audio boosts bloom
-          bloom_intensity += audio_pulse * SQ15x16(1.5);
+          SQ15x16 falloff = exp_neg_fixed(bloom_k * SQ15x16(j * j)) * pulse;
           
           // Add bloom to existing color
           leds_16[bloom_pos].r += particle_color.r * falloff * bloom_intensity;
@@ -1363,12 +1415,12 @@ void light_mode_quantum_collapse() {
       }
       
       // Occasional energy bursts for added interest
-      if (random(100) < 3 + int(float(audio_vu_level) * 10)) {
+      if (int(proc_rand_below(mode_rng, 100)) < 3 + int(float(audio_vu_level) * 10)) {
         // Create burst with random spread
-        int burst_count = 2 + random(3);
+        int burst_count = 2 + proc_rand_below(mode_rng, 3);
         for (int b = 0; b < burst_count; b++) {
-          int burst_pos = pos + random(21) - 10;
-          if (burst_pos >= 0 && burst_pos < NATIVE_RESOLUTION) {
+          int burst_pos = pos + int(proc_rand_below(mode_rng, 21)) - 10;
+          if (burst_pos >= 0 && burst_pos < render_resolution) {
             // Energy and audio affect burst intensity
             SQ15x16 burst_intensity = SQ15x16(0.3) + particle_energies[i] * SQ15x16(0.7) + audio_vu_level * SQ15x16(0.5);
             
@@ -1378,7 +1430,7 @@ void light_mode_quantum_collapse() {
             leds_16[burst_pos].b += particle_color.b * burst_intensity * SQ15x16(0.4);
             
             // Add fluid impulse
-            fluid_velocity[burst_pos] += SQ15x16((random_float() - 0.5) * 0.02) * audio_energy;
+            fluid_velocity[burst_pos] += (random_fixed() - SQ15x16(0.5)) * SQ15x16(0.02) * audio_energy;
           }
         }
       }
@@ -1404,20 +1456,12 @@ void light_mode_waveform(CRGB16* leds_previous, CRGB16& last_color) { // New sig
   CRGB16 current_sum_color = {0,0,0};
   SQ15x16 total_magnitude = 0.0;
   
+  require_audio_features(FEATURE_CHROMA_CURVED);  // (audio_features.h)
+
   for (uint8_t c = 0; c < 12; c++) {
     float prog = c / 12.0f;
-    float bin = float(chromagram_smooth[c]);
+    float bright = float(audio_features.chroma_curved[c]);
 
-    float bright = bin;
-    for (uint8_t s = 0; s < int(CONFIG.SQUARE_ITER); s++) {
-      bright *= bright;
-    }
-    float fract_iter = CONFIG.SQUARE_ITER - floor(CONFIG.SQUARE_ITER);
-    if (fract_iter > 0.01) {
-      float squared = bright * bright;
-      bright = bright * (1.0f - fract_iter) + squared * fract_iter;
-    }
-    
     // Only add colors from bins above threshold for better color clarity
     if (bright > 0.05) {
       CRGB16 note_col = get_mode_color(SQ15x16(prog), CONFIG.SATURATION, SQ15x16(bright));
@@ -1451,19 +1495,14 @@ void light_mode_waveform(CRGB16* leds_previous, CRGB16& last_color) { // New sig
   // Use the chromagram color mix for the waveform
   last_color = current_sum_color;
 
-  if (snapwave_color_debug_logging_enabled) {
-    static uint32_t last_color_debug = 0;
-    uint32_t now_ms = millis();
-    if (now_ms - last_color_debug > 2000) {
-      USBSerial.printf("SNAPWAVE COLOR DEBUG | chromatic=%d | saturation=%.2f | r=%.3f g=%.3f b=%.3f | total_mag=%.3f\n",
-                       chromatic_mode ? 1 : 0,
-                       float(frame_config.SATURATION),
-                       float(last_color.r),
-                       float(last_color.g),
-                       float(last_color.b),
-                       float(total_magnitude));
-      last_color_debug = now_ms;
-    }
+  if (snapwave_color_debug_logging_enabled && LOG_EVERY_MS(2000)) {  // (Logger.h)
+    LOG_INFO("SNAPWAVE COLOR DEBUG | chromatic=%d | saturation=%.2f | r=%.3f g=%.3f b=%.3f | total_mag=%.3f",
+             chromatic_mode ? 1 : 0,
+             float(frame_config.SATURATION),
+             float(last_color.r),
+             float(last_color.g),
+             float(last_color.b),
+             float(total_magnitude));
   }
   // --- End Color Calculation ---
 
@@ -1476,7 +1515,7 @@ void light_mode_waveform(CRGB16* leds_previous, CRGB16& last_color) { // New sig
   SQ15x16 dynamic_fade_amount = 1.0 - (max_fade_reduction * abs_amp);
 
   // Apply the dynamic fade TO THE GLOBAL leds_16 buffer
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (uint16_t i = 0; i < render_resolution; i++) {
       leds_16[i].r *= dynamic_fade_amount;
       leds_16[i].g *= dynamic_fade_amount;
       leds_16[i].b *= dynamic_fade_amount;
@@ -1501,11 +1540,11 @@ void light_mode_waveform(CRGB16* leds_previous, CRGB16& last_color) { // New sig
   
   if (amp > 1.0f) amp = 1.0f;
   else if (amp < -1.0f) amp = -1.0f;
-  int center = NATIVE_RESOLUTION / 2;
-  float pos_f = center + amp * (NATIVE_RESOLUTION / 2.0f); 
+  int center = render_resolution / 2;
+  float pos_f = center + amp * (render_resolution / 2.0f); 
   int pos = int(pos_f + (pos_f >= 0 ? 0.5 : -0.5));
   if (pos < 0) pos = 0;
-  if (pos >= NATIVE_RESOLUTION) pos = NATIVE_RESOLUTION - 1;
+  if (pos >= render_resolution) pos = render_resolution - 1;
   
   // Set the new dot with the calculated & smoothed 'last_color'
   leds_16[pos] = last_color; // Draw onto the global leds_16 buffer
@@ -1515,14 +1554,11 @@ void light_mode_waveform(CRGB16* leds_previous, CRGB16& last_color) { // New sig
   }
 }
 
-void light_mode_snapwave() {
+void light_mode_snapwave(FrameTrail trail) { // Primary, incoming or secondary trails (frame_buffers.h)
   // DEBUG: Verify correct function is being called
-  if (snapwave_debug_logging_enabled) {
-    static uint32_t call_count = 0;
-    if (call_count++ % 60 == 0) {  // Log every second at 60fps
-      USBSerial.printf("SNAPWAVE DEBUG: Original executing! Mode index=%d, Expected=%d\n",
-                       CONFIG.LIGHTSHOW_MODE, LIGHT_MODE_SNAPWAVE);
-    }
+  if (snapwave_debug_logging_enabled && LOG_EVERY_MS(1000)) {  // (Logger.h)
+    LOG_INFO("SNAPWAVE DEBUG: Original executing! Mode index=%d, Expected=%d",
+             int(CONFIG.LIGHTSHOW_MODE), int(LIGHT_MODE_SNAPWAVE));
   }
 
   static float waveform_peak_scaled_last = 0.0f;
@@ -1533,33 +1569,11 @@ void light_mode_snapwave() {
   waveform_peak_scaled_last = float(smoothed_peak_fixed);
 
   // --- Color Calculation from Chromagram ---
-  CRGB16 current_sum_color = {0, 0, 0};
-  SQ15x16 total_magnitude = 0.0;
-
-  for (uint8_t c = 0; c < 12; c++) {
-    float prog = c / 12.0f;
-    float bin = float(chromagram_smooth[c]);
-
-    float bright = bin;
-    for (uint8_t s = 0; s < int(frame_config.SQUARE_ITER); s++) {
-      bright *= bright;
-    }
-    float fract_iter = frame_config.SQUARE_ITER - floor(frame_config.SQUARE_ITER);
-    if (fract_iter > 0.01) {
-      float squared = bright * bright;
-      bright = bright * (1.0f - fract_iter) + squared * fract_iter;
-    }
-
-    // Only add colors from bins above threshold for better color clarity
-    if (bright > 0.05) {
-      // ORIGINAL SNAPWAVE COLOR PATH: use pure HSV, not palette/get_mode_color
-      CRGB16 note_col = hsv(SQ15x16(prog), frame_config.SATURATION, SQ15x16(bright));
-      current_sum_color.r += note_col.r;
-      current_sum_color.g += note_col.g;
-      current_sum_color.b += note_col.b;
-      total_magnitude += bright;
-    }
-  }
+  // ORIGINAL SNAPWAVE COLOR PATH: pure HSV of the curved chroma bins above 0.05,
+  // not palette/get_mode_color (audio_features.h)
+  require_audio_features(FEATURE_CHROMA_COLOR);
+  CRGB16 current_sum_color = audio_features.chroma_color;
+  SQ15x16 total_magnitude = audio_features.chroma_total_magnitude;
 
   if (chromatic_mode == true && total_magnitude > 0.01) {
     // Normalize by total magnitude to get pure color, then scale by brightness
@@ -1591,16 +1605,16 @@ void light_mode_snapwave() {
   float max_fade_reduction = 0.10;
   SQ15x16 dynamic_fade_amount = 1.0 - (max_fade_reduction * abs_amp);
 
-  // Apply the dynamic fade
-  for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
-    leds_16[i].r *= dynamic_fade_amount;
-    leds_16[i].g *= dynamic_fade_amount;
-    leds_16[i].b *= dynamic_fade_amount;
+  // Apply the dynamic fade to last frame's trails while shifting them up one LED
+  CRGB16* trails = frame_trail_begin(trail);
+  leds_16[0] = { 0, 0, 0 };
+  for (uint16_t i = 1; i < render_resolution; i++) {
+    leds_16[i].r = trails[i - 1].r * dynamic_fade_amount;
+    leds_16[i].g = trails[i - 1].g * dynamic_fade_amount;
+    leds_16[i].b = trails[i - 1].b * dynamic_fade_amount;
   }
 
   // --- Waveform Display ---
-  shift_leds_up(leds_16, 1);
-
   // Use smoothed peak instead of raw peak
   float amp = waveform_peak_scaled_last;
 
@@ -1635,11 +1649,11 @@ void light_mode_snapwave() {
   if (amp > 1.0f) amp = 1.0f;
   else if (amp < -1.0f) amp = -1.0f;
 
-  int center = NATIVE_RESOLUTION / 2;
-  float pos_f = center + amp * (NATIVE_RESOLUTION / 2.0f);
+  int center = render_resolution / 2;
+  float pos_f = center + amp * (render_resolution / 2.0f);
   int pos = int(pos_f + (pos_f >= 0 ? 0.5 : -0.5));
   if (pos < 0) pos = 0;
-  if (pos >= NATIVE_RESOLUTION) pos = NATIVE_RESOLUTION - 1;
+  if (pos >= render_resolution) pos = render_resolution - 1;
 
   // Set the new dot with the calculated color
   leds_16[pos] = last_color;
@@ -1647,16 +1661,16 @@ void light_mode_snapwave() {
   if (CONFIG.MIRROR_ENABLED) {
     mirror_image_downwards(leds_16);
   }
+
+  frame_trail_commit(trail);
 }
 
 void light_mode_snapwave_debug() {
-  static uint32_t debug_call_count = 0;
-  if (snapwave_debug_logging_enabled && (debug_call_count++ % 60 == 0)) {
-    USBSerial.printf("SNAPWAVE_DEBUG: Test variant executing! Mode index=%d\n",
-                     CONFIG.LIGHTSHOW_MODE);
+  if (snapwave_debug_logging_enabled && LOG_EVERY_MS(1000)) {  // (Logger.h)
+    LOG_INFO("SNAPWAVE_DEBUG: Test variant executing! Mode index=%d", int(CONFIG.LIGHTSHOW_MODE));
   }
 
-  for (int i = 0; i < NATIVE_RESOLUTION; i++) {
+  for (int i = 0; i < render_resolution; i++) {
     leds_16[i] = CRGB16{1.0, 0.0, 0.0};
   }
 }
@@ -0,0 +1,246 @@
+#ifndef LOG_QUEUE_H
+#define LOG_QUEUE_H
+
+/*----------------------------------------
+  Sensory Bridge LOG QUEUE
+  ----------------------------------------*/
+
+// Deferred log records: the caller stores the format string's address and
+// its raw arguments, nothing is formatted until the logger task gets to it
+// (Logger.h). Format strings must be literals and %s arguments must outlive
+// the record (literals, names tables), since only pointers are kept.
+//
+// Each core has its own LogQueue, a bounded lock-free queue where every
+// cell carries a sequence number (Vyukov's MPMC design, with one
+// consumer). Tasks sharing a core claim cells with a compare-and-swap, a
+// full queue drops the record and counts it, nobody ever waits.
+//
+// log_format() is a small printf: it walks the format string and hands
+// each conversion to snprintf() with the argument in the type the
+// conversion asks for. Supported: %d %i %u %x %X %o %c %f %e %g %s %p %%,
+// with flags, width, precision and the h/l/ll/z length modifiers (not '*').
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+#define LOG_MAX_ARGS 6
+
+enum LogLevel : uint8_t {
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_WARN,
+  LOG_LEVEL_INFO,
+  LOG_LEVEL_DEBUG,
+  LOG_LEVEL_VERBOSE
+};
+
+struct LogRecord {
+  const char* format;
+  uint32_t time_ms;
+  uint8_t level;
+  uint8_t num_args;
+  uint64_t args[LOG_MAX_ARGS];  // Integers widened, floats as double bits, pointers as addresses
+};
+
+// Arguments ------------------------------------------------------------------
+
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint64_t>::type
+log_arg(T value) {
+  return uint64_t(int64_t(value));
+}
+
+template <class T>
+inline typename std::enable_if<std::is_floating_point<T>::value, uint64_t>::type
+log_arg(T value) {
+  double widened = double(value);
+  uint64_t bits;
+  memcpy(&bits, &widened, sizeof(bits));
+  return bits;
+}
+
+template <class T>
+inline uint64_t log_arg(T* pointer) {
+  return uint64_t(uintptr_t(pointer));
+}
+
+inline void log_fill_args(uint64_t*) {}
+
+template <class First, class... Rest>
+inline void log_fill_args(uint64_t* out, First first, Rest... rest) {
+  *out = log_arg(first);
+  log_fill_args(out + 1, rest...);
+}
+
+// Queue ------------------------------------------------------------------------
+
+template <uint32_t SIZE>
+struct LogQueue {
+  static_assert((SIZE & (SIZE - 1)) == 0, "LogQueue size must be a power of two");
+
+  struct Cell {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+  };
+
+  Cell cells[SIZE];
+  std::atomic<uint32_t> head;     // Next cell to claim
+  uint32_t tail;                  // Next cell to read, consumer only
+  std::atomic<uint32_t> dropped;  // Records that found the queue full
+
+  void clear() {
+    for (uint32_t i = 0; i < SIZE; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    head.store(0, std::memory_order_relaxed);
+    tail = 0;
+    dropped.store(0, std::memory_order_relaxed);
+  }
+
+  // Any task. Returns the cell to fill and pass to publish(), NULL when full.
+  LogRecord* claim(uint32_t* position) {
+    uint32_t pos = head.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells[pos & (SIZE - 1)];
+      int32_t diff = int32_t(cell.sequence.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          *position = pos;
+          return &cell.record;
+        }
+      } else if (diff < 0) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void publish(uint32_t position) {
+    cells[position & (SIZE - 1)].sequence.store(position + 1, std::memory_order_release);
+  }
+
+  // Consumer only: copy out the oldest record, false if there's none
+  bool pop(LogRecord& record) {
+    Cell& cell = cells[tail & (SIZE - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != tail + 1) {
+      return false;
+    }
+    record = cell.record;
+    cell.sequence.store(tail + SIZE, std::memory_order_release);
+    tail++;
+    return true;
+  }
+};
+
+template <uint32_t SIZE, class... Args>
+inline bool log_push(LogQueue<SIZE>& queue, uint8_t level, uint32_t time_ms, const char* format, Args... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+  uint32_t position;
+  LogRecord* record = queue.claim(&position);
+  if (record == NULL) {
+    return false;
+  }
+  record->format = format;
+  record->time_ms = time_ms;
+  record->level = level;
+  record->num_args = sizeof...(Args);
+  log_fill_args(record->args, args...);
+  queue.publish(position);
+  return true;
+}
+
+// Formatting -------------------------------------------------------------------
+
+// Format «record» into «out» (always terminated), returns the length written
+inline size_t log_format(const LogRecord& record, char* out, size_t capacity) {
+  if (capacity == 0) {
+    return 0;
+  }
+  size_t at = 0;
+  uint8_t next_arg = 0;
+  const char* f = record.format;
+
+  while (*f != '\0' && at + 1 < capacity) {
+    if (*f != '%') {
+      out[at++] = *f++;
+      continue;
+    }
+    if (f[1] == '%') {
+      out[at++] = '%';
+      f += 2;
+      continue;
+    }
+
+    // Copy the conversion out so snprintf() gets it on its own
+    char spec[24];
+    uint8_t length = 0;
+    spec[length++] = *f++;
+    while (*f != '\0' && strchr("-+ #0123456789.", *f) != NULL && length < 16) {
+      spec[length++] = *f++;
+    }
+    uint8_t longs = 0;
+    while (*f == 'h' || *f == 'l' || *f == 'z') {
+      longs += (*f == 'l' || *f == 'z') ? 1 : 0;
+      f++;
+    }
+    char conversion = *f;
+    if (conversion == '\0') {
+      break;
+    }
+    f++;
+
+    uint64_t arg = (next_arg < record.num_args) ? record.args[next_arg++] : 0;
+    size_t room = capacity - at;
+    int written;
+    if (conversion == 'c') {
+      spec[length++] = 'c';
+      spec[length] = '\0';
+      written = snprintf(out + at, room, spec, int(arg));
+    } else if (conversion == 'd' || conversion == 'i') {
+      spec[length++] = 'l';
+      spec[length++] = 'l';
+      spec[length++] = 'd';
+      spec[length] = '\0';
+      written = snprintf(out + at, room, spec, (long long)(longs >= 2 ? int64_t(arg) : int64_t(int32_t(arg))));
+    } else if (conversion == 'u' || conversion == 'x' || conversion == 'X' || conversion == 'o') {
+      spec[length++] = 'l';
+      spec[length++] = 'l';
+      spec[length++] = conversion;
+      spec[length] = '\0';
+      written = snprintf(out + at, room, spec, (unsigned long long)(longs >= 2 ? arg : uint64_t(uint32_t(arg))));
+    } else if (strchr("fFeEgGaA", conversion) != NULL) {
+      double value;
+      memcpy(&value, &arg, sizeof(value));
+      spec[length++] = conversion;
+      spec[length] = '\0';
+      written = snprintf(out + at, room, spec, value);
+    } else if (conversion == 's') {
+      spec[length++] = 's';
+      spec[length] = '\0';
+      const char* text = (const char*)uintptr_t(arg);
+      written = snprintf(out + at, room, spec, text != NULL ? text : "(null)");
+    } else if (conversion == 'p') {
+      spec[length++] = 'p';
+      spec[length] = '\0';
+      written = snprintf(out + at, room, spec, (void*)uintptr_t(arg));
+    } else {
+      written = snprintf(out + at, room, "%%%c", conversion);  // Unsupported, shown as is
+    }
+
+    if (written < 0) {
+      break;
+    }
+    at += (size_t(written) < room) ? size_t(written) : room - 1;
+  }
+
+  out[at] = '\0';
+  return at;
+}
+
+#endif // LOG_QUEUE_H
@@ -19,6 +19,9 @@
   USBCDC USBSerial;
 #endif
 
+// CRCs (crc32.h) from the ESP32's ROM routine rather than the slice-by-8 tables
+//#define CRC32_USE_ROM
+
 // External dependencies -------------------------------------------------------------
 #include <WiFi.h>         // Needed for Station Mode
 #include <esp_random.h>   // RNG Functions
@@ -41,8 +44,10 @@
 #include "user_config.h"      // Nothing for now
 #include "constants.h"        // Global constants
 #include "globals.h"          // Global variables
+#include "Logger.h"           // Deferred logging, formatted and printed by its own task
 #include "presets.h"          // Configuration presets by name
 #include "bridge_fs.h"        // Filesystem access (save/load configuration)
+#include "config_transaction.h"  // Batched serial edits, applied together at a frame boundary
 #include "utilities.h"        // Misc. math and other functions
 
 // Enable performance monitoring for 96-bin testing
@@ -50,8 +55,19 @@
 #ifdef ENABLE_PERFORMANCE_MONITORING
 #include "debug/performance_monitor.h"
 #endif
+// Span tracer for "trace_start" / "trace_dump", compiled out unless defined
+//#define ENABLE_SPAN_TRACE
+#include "trace_recorder.h"       // Begin/end events around every pipeline stage, both cores
+#include "quality_governor.h"     // Steps quality down/up to hold frame-time targets
+#include "frame_pacer.h"          // Schedules LED frames against the strip and the audio frames
+#include "latency_probe.h"        // Audio-to-photon latency per pipeline stage
+#include "telemetry.h"            // Binary framed "stream=..." output, drained by its own task
+#include "led_output.h"           // Double-buffered, asynchronous LED transmission
+#include "idle_tier.h"            // Lower LED and audio rates after sustained silence
+#include "frame_buffers.h"        // Canvases and trail buffers swapped by pointer
 #include "i2s_audio.h"        // I2S Microphone audio capture
 #include "led_utilities.h"    // LED color/transform utility functions
+#include "mode_transition.h"  // Cross-fades between light modes
 #include "noise_cal.h"        // Background noise removal
 #include "buttons.h"          // Watch the status of buttons
 #include "knobs.h"            // Watch the status of knobs...
@@ -64,6 +80,7 @@
 #include "test/performance_regression_suite.h"  // Phase 0: Performance validation
 #include "system.h"           // Watch how fast I can check if settings were updated... yada yada..
 #include "GDFT.h"             // Conversion to (and post-processing of) frequency data! (hey, something cool!)
+#include "audio_features.h"   // Per-frame audio features shared by the light modes
 #include "lightshow_modes.h"  // --- FINALLY, the FUN STUFF!
 #include "encoders.h"         // M5Stack Rotate8 encoder handling
 #include "test_audio_diagnostics.h"  // Audio diagnostics for troubleshooting
@@ -183,6 +200,7 @@ void setup() {
     // System cannot continue safely.
     while(1) { delay(1000); }
   }
+  init_logger();  // (Logger.h) Needs serial_mutex
 
   // The Arduino ESP32 core registers each idle task with the watchdog by default.
   // Our dedicated audio loop monopolizes Core 0, so its idle task never runs and the
@@ -199,6 +217,8 @@ void setup() {
   // AudioGuard::init();
   // AudioGuard::initAudioSafe();  // Pre-initialize audio buffers
   
+  init_telemetry();  // (telemetry.h) Starts the stream drain task on core 0
+
 #ifdef ENABLE_PERFORMANCE_MONITORING
   init_performance_monitor();
   USBSerial.println("Performance monitoring enabled.");
@@ -296,6 +316,8 @@ void main_loop_core0() {
   
   // No frame rate limiting - target is 120+ FPS
   
+  TRACE_BEGIN(SPAN_AUDIO_FRAME);  // (trace_recorder.h)
+
   uint32_t t_now_us = micros();        // Timestamp for this loop, used by some core functions
   uint32_t t_now = t_now_us / 1000.0;  // Millisecond version
   
@@ -311,16 +333,14 @@ void main_loop_core0() {
   
   // Print performance metrics every 5 seconds
   if (perf_debug_logging_enabled && (t_now - last_fps_print > 5000)) {
-    xSemaphoreTake(serial_mutex, portMAX_DELAY);
     float actual_fps = frame_count / 5.0;
-    USBSerial.printf("S3_PERF|FPS:%.2f|Race:%lu|Skip:N/A|Target:120+|\n", 
-                     actual_fps, g_race_condition_count);
+    LOG_INFO("S3_PERF|FPS:%.2f|Race:%lu|Skip:N/A|Target:120+|", actual_fps, g_race_condition_count);  // (Logger.h)
     frame_count = 0;
     g_race_condition_count = 0;
     last_fps_print = t_now;
-    xSemaphoreGive(serial_mutex);
   }
 
+  TRACE_BEGIN(SPAN_INPUTS);
   function_id = 0;     // These are for debug_function_timing() in system.h to see what functions take up the most time
   check_knobs(t_now);  // (knobs.h)
   // Check if the knobs have changed
@@ -336,37 +356,60 @@ void main_loop_core0() {
   function_id = 2;
   check_settings(t_now);  // (system.h)
   // Check if the settings have changed
+  TRACE_END(SPAN_INPUTS);
 
   function_id = 3;
+  TRACE_BEGIN(SPAN_SERIAL);
   check_serial(t_now);  // (serial_menu.h)
   // Check if UART commands are available
+  TRACE_END(SPAN_SERIAL);
+
+  refresh_audio_tables();  // (system.h) Rebuilds goertzel constants, and moves the noise floor, if SAMPLE_RATE or NOTE_OFFSET changed
 
   function_id = 4;
 #ifdef ENABLE_PERFORMANCE_MONITORING
   PERF_MONITOR_START();
 #endif
+  TRACE_BEGIN(SPAN_I2S_READ);
   acquire_sample_chunk(t_now);  // (i2s_audio.h)
   // Capture a frame of I2S audio (holy crap, FINALLY something about sound)
+  TRACE_END(SPAN_I2S_READ);
+  uint32_t audio_work_start_us = micros();  // i2s_read() blocks for the chunk, the governor only counts what follows
 #ifdef ENABLE_PERFORMANCE_MONITORING
   PERF_MONITOR_END(i2s_read_time);
 #endif
 
+  update_idle_tier(t_now);  // (idle_tier.h)
+
   function_id = 6;
   run_sweet_spot();  // (led_utilities.h)
   // Based on the current audio volume, alter the Sweet Spot indicator LEDs
 
   // Calculates audio loudness (VU) using RMS, adjusting for noise floor based on calibration
+  TRACE_BEGIN(SPAN_VU);
   calculate_vu();
+  TRACE_END(SPAN_VU);
 
   function_id = 7;
   
-  // PERFORMANCE VALIDATION: Measure GDFT execution time
-  uint32_t gdft_start = micros();
-  process_GDFT();  // (GDFT.h)
-  uint32_t gdft_time = micros() - gdft_start;
-  
-  // Watches the rate of change in the Goertzel bins to guide decisions for auto-color shifting
-  calculate_novelty(t_now);
+  // While idle only one audio frame in IDLE_GDFT_DIVIDER runs the GDFT (idle_tier.h)
+  if (idle_tier_run_gdft()) {
+    // PERFORMANCE VALIDATION: Measure GDFT execution time
+    TRACE_BEGIN(SPAN_GDFT);
+    uint32_t gdft_start = micros();
+    process_GDFT();  // (GDFT.h)
+    uint32_t gdft_time = micros() - gdft_start;
+    idle_tier_report_gdft(gdft_time);
+    TRACE_END(SPAN_GDFT);
+
+    // Watches the rate of change in the Goertzel bins to guide decisions for auto-color shifting
+    TRACE_BEGIN(SPAN_NOVELTY);
+    calculate_novelty(t_now);
+    TRACE_END(SPAN_NOVELTY);
+
+    latency_chunk_analyzed();  // (latency_probe.h)
+    telemetry_stream_spectra();  // (telemetry.h)
+  }
 
   if (CONFIG.AUTO_COLOR_SHIFT == true) {  // Automatically cycle color based on density of positive spectral changes
     // Use the "novelty" findings of the above function to affect color shifting when auto-color shifts are enabled
@@ -376,6 +419,8 @@ void main_loop_core0() {
     hue_shifting_mix = -0.35;
   }
 
+  frame_pacer_audio_frame_ready();  // (frame_pacer.h) Wake led_thread if it's waiting on fresh audio
+
   function_id = 8;
   //lookahead_smoothing();  // (GDFT.h)
   // Peek at upcoming frames to study/prevent flickering
@@ -410,17 +455,9 @@ void main_loop_core0() {
       float avg_system_fps = (benchmark_sample_count > 0) ? (float)system_fps_sum / benchmark_sample_count : 0.0f;
       float avg_led_fps = (benchmark_sample_count > 0) ? (float)led_fps_sum / benchmark_sample_count : 0.0f;
       
-      xSemaphoreTake(serial_mutex, portMAX_DELAY);
-      tx_begin(); // Use the tx_begin/end functions from serial_menu.h for formatted output
-      USBSerial.println("Benchmark Complete!");
-      USBSerial.print("  Average System FPS: ");
-      USBSerial.println(avg_system_fps, 2);
-      USBSerial.print("  Average LED FPS: ");
-      USBSerial.println(avg_led_fps, 2);
-      USBSerial.print("  Samples collected: ");
-      USBSerial.println(benchmark_sample_count);
-      tx_end();
-      xSemaphoreGive(serial_mutex);
+      // Same sbr{{ ... }} reply tx_begin()/tx_end() would frame, printed by the logger task (Logger.h)
+      LOG_INFO("sbr{{\nBenchmark Complete!\n  Average System FPS: %.2f\n  Average LED FPS: %.2f\n  Samples collected: %lu\n}}",
+               avg_system_fps, avg_led_fps, benchmark_sample_count);
 
       // Reset sums and count for next run
       system_fps_sum = 0;
@@ -440,10 +477,15 @@ void main_loop_core0() {
   }
   */
   
-  // CRITICAL: Handle deferred config saves in a safe context
-  // This prevents watchdog timeouts during file operations
+  // Hand a deferred config save to the save task (bridge_fs.h), which
+  // does the flash write. Only a snapshot is copied here
   extern void do_config_save();
+  TRACE_BEGIN(SPAN_CONFIG_SAVE);
   do_config_save();
+  TRACE_END(SPAN_CONFIG_SAVE);
+
+  quality_report_audio_frame(micros() - audio_work_start_us);  // (quality_governor.h)
+  TRACE_END(SPAN_AUDIO_FRAME);
 }
 
 void loop() {
@@ -451,6 +493,29 @@ void loop() {
   delay(1000);
 }
 
+// Draw «mode» into leds_16, with «trail» holding its previous frames (frame_buffers.h)
+void render_primary_mode(uint8_t mode, FrameTrail trail) {
+  if (mode == LIGHT_MODE_GDFT) {
+    light_mode_gdft();
+  } else if (mode == LIGHT_MODE_GDFT_CHROMAGRAM) {
+    light_mode_chromagram_gradient();
+  } else if (mode == LIGHT_MODE_GDFT_CHROMAGRAM_DOTS) {
+    light_mode_chromagram_dots();
+  } else if (mode == LIGHT_MODE_BLOOM) {
+    light_mode_bloom(trail);
+  } else if (mode == LIGHT_MODE_VU_DOT) {
+    light_mode_vu_dot();
+  } else if (mode == LIGHT_MODE_KALEIDOSCOPE) {
+    light_mode_kaleidoscope();
+  } else if (mode == LIGHT_MODE_QUANTUM_COLLAPSE) {
+    light_mode_quantum_collapse();
+  } else if (mode == LIGHT_MODE_SNAPWAVE) {
+    light_mode_snapwave(trail);
+  } else if (mode == LIGHT_MODE_SNAPWAVE_DEBUG) {
+    light_mode_snapwave_debug();
+  }
+}
+
 // Run the lights in their own thread! -------------------------------------------------------------
 void led_thread(void* arg) {
   USBSerial.println("DEBUG: LED thread started!");
@@ -458,55 +523,67 @@ void led_thread(void* arg) {
   
   while (true) {
     if (led_thread_halt == false) {
+      TRACE_BEGIN(SPAN_PACER_WAIT);  // (trace_recorder.h)
+      frame_pacer_wait();  // (frame_pacer.h) Sleeps until this frame's render window
+      TRACE_END(SPAN_PACER_WAIT);
+
+      TRACE_BEGIN(SPAN_LED_FRAME);
+      uint32_t render_start_us = micros();
+
+      apply_config_commit();    // (config_transaction.h) Copies in a committed batch of edits
+      apply_preset_switch();    // (presets.h) Copies in the fields of a requested preset that differ
+      refresh_led_tables();     // (led_utilities.h) Rebuilds the pixel map and LUTs whose inputs changed
+      begin_mode_transition();  // (mode_transition.h) Picks up queued mode changes
+
+      // (quality_governor.h) Drops to half the boot resolution when LED frames run long,
+      // (mode_transition.h) and a cross-fade that wouldn't fit a frame runs at half that
+      set_render_resolution(mode_transition_resolution(quality_render_resolution(render_base_resolution)));
+
       // Cache CONFIG values at start of frame
       cache_frame_config();
       
-      if (mode_transition_queued == true || noise_transition_queued == true) {
+      if (noise_transition_queued == true) {
         run_transition_fade();
       }
 
+      latency_frame_begin();  // (latency_probe.h) Traces this frame if it's the first with a new audio chunk
+      TRACE_BEGIN(SPAN_SPECTRUM);
       get_smooth_spectrogram();
       make_smooth_chromagram();
+      invalidate_audio_features();  // (audio_features.h) Recomputed lazily by the modes that need them
+      TRACE_END(SPAN_SPECTRUM);
 
       // Render the primary LED strip with the primary mode
-      if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_GDFT) {
-        light_mode_gdft();
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_GDFT_CHROMAGRAM) {
-        light_mode_chromagram_gradient();
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_GDFT_CHROMAGRAM_DOTS) {
-        light_mode_chromagram_dots();
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_BLOOM) {
-        light_mode_bloom(leds_16_prev);
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_VU_DOT) {
-        light_mode_vu_dot();
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_KALEIDOSCOPE) {
-        light_mode_kaleidoscope();
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_QUANTUM_COLLAPSE) {
-        light_mode_quantum_collapse();
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_SNAPWAVE) {
-        // Seed primary LED buffer for trails
-        memcpy(leds_16, leds_16_prev, sizeof(CRGB16) * NATIVE_RESOLUTION);
-        // Call waveform with primary state buffers/variables
-        light_mode_snapwave();
-        // Update primary previous buffer for next frame
-        memcpy(leds_16_prev, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
-      } else if (frame_config.LIGHTSHOW_MODE == LIGHT_MODE_SNAPWAVE_DEBUG) {
-        light_mode_snapwave_debug();
+      TRACE_BEGIN(SPAN_RENDER);
+      if (mode_transition_active) {  // (mode_transition.h) Outgoing mode first, then blend in the new one
+        frame_begin(CANVAS_OUTGOING);
+        render_primary_mode(mode_transition_from, TRAIL_PRIMARY);
+        mode_transition_stash();
+        frame_begin(CANVAS_PRIMARY);
+        render_primary_mode(frame_config.LIGHTSHOW_MODE, TRAIL_INCOMING);
+        mode_transition_blend();
+      } else {
+        frame_begin(CANVAS_PRIMARY);
+        render_primary_mode(frame_config.LIGHTSHOW_MODE, TRAIL_PRIMARY);
       }
+      TRACE_END(SPAN_RENDER);
 
-      if (CONFIG.PRISM_COUNT > 0) {
-        apply_prism_effect(CONFIG.PRISM_COUNT, 0.25);
+      TRACE_BEGIN(SPAN_EFFECTS);
+      float prism_count = quality_prism_count(CONFIG.PRISM_COUNT);  // (quality_governor.h)
+      if (prism_count > 0) {
+        apply_prism_effect(prism_count, 0.25);
       }
 
       if (CONFIG.BULB_OPACITY > 0.00) {
         render_bulb_cover();
       }
+      TRACE_END(SPAN_EFFECTS);
       
       // Only process secondary LEDs if enabled
       if (ENABLE_SECONDARY_LEDS) {
-        // Store original LED buffer and settings before modifying anything
-        CRGB16 primary_buffer[NATIVE_RESOLUTION];
-        memcpy(primary_buffer, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
+        TRACE_BEGIN(SPAN_SECONDARY);
+        // Set the primary frame aside (by pointer, frame_buffers.h) and settings before modifying anything
+        FrameTarget primary_frame = frame_save();
         
         // Store original settings
         float saved_photons = CONFIG.PHOTONS;
@@ -540,9 +617,8 @@ void led_thread(void* arg) {
           process_color_shift();
         }
         
-        // Clear and render new pattern for secondary LEDs
-        // Seed secondary pattern buffer for trails from last frame
-        memcpy(leds_16, leds_16_prev_secondary, sizeof(CRGB16) * NATIVE_RESOLUTION);
+        // Render new pattern for secondary LEDs into their own canvas
+        frame_begin(CANVAS_SECONDARY);
         
         // Use the SECONDARY_LIGHTSHOW_MODE directly without modifying CONFIG.LIGHTSHOW_MODE
         if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_GDFT) {
@@ -552,7 +628,7 @@ void led_thread(void* arg) {
         } else if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_GDFT_CHROMAGRAM_DOTS) {
           light_mode_chromagram_dots();
         } else if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_BLOOM) {
-          light_mode_bloom(leds_16_prev_secondary);
+          light_mode_bloom(TRAIL_SECONDARY);
         } else if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_VU_DOT) {
           light_mode_vu_dot();
         } else if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_KALEIDOSCOPE) {
@@ -560,24 +636,22 @@ void led_thread(void* arg) {
         } else if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_QUANTUM_COLLAPSE) {
           light_mode_quantum_collapse();
         } else if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_SNAPWAVE) {
-          // Call waveform with secondary state buffers/variables
-          light_mode_snapwave();
-          // Secondary buffer is saved below, but update its 'previous' state now
-          memcpy(leds_16_prev_secondary, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
+          light_mode_snapwave(TRAIL_SECONDARY);
         } else if (SECONDARY_LIGHTSHOW_MODE == LIGHT_MODE_SNAPWAVE_DEBUG) {
           light_mode_snapwave_debug();
         }
         
-        if (SECONDARY_PRISM_COUNT > 0) {
-          apply_prism_effect(SECONDARY_PRISM_COUNT, 0.25);
+        float secondary_prism_count = quality_prism_count(SECONDARY_PRISM_COUNT);
+        if (secondary_prism_count > 0) {
+          apply_prism_effect(secondary_prism_count, 0.25);
         }
         
-        // Save secondary pattern
-        memcpy(leds_16_secondary, leds_16, sizeof(CRGB16) * NATIVE_RESOLUTION);
+        // Land the secondary pattern in leds_16_secondary (its canvas) and clip it there
+        frame_make_writable();
         clip_led_values(leds_16_secondary); // Clip the secondary buffer values
         
         // Restore primary buffer and settings
-        memcpy(leds_16, primary_buffer, sizeof(CRGB16) * NATIVE_RESOLUTION);
+        frame_restore(primary_frame);
         CONFIG.PHOTONS = saved_photons;
         CONFIG.CHROMA = saved_chroma;
         CONFIG.MOOD = saved_mood;
@@ -594,6 +668,7 @@ void led_thread(void* arg) {
         base_coat_width = saved_base_coat_width;
         base_coat_width_target = saved_base_coat_width_target;
         // CONFIG.MOOD is restored via saved_mood
+        TRACE_END(SPAN_SECONDARY);
 
         // Debug output disabled to prevent memory overflow
         /*
@@ -612,12 +687,25 @@ void led_thread(void* arg) {
         */
       }
       
+      latency_frame_stamp(STAMP_RENDER);
+      TRACE_BEGIN(SPAN_SHOW);
       show_leds();
+      TRACE_END(SPAN_SHOW);
+      frame_pacer_show_done();
+
+      uint32_t render_us = micros() - render_start_us;
+      quality_report_led_frame(render_us);
+      update_quality_governor();  // (quality_governor.h)
+
+      idle_tier_report_led_frame(render_us);
+      update_idle_report();  // (idle_tier.h)
       
       LED_FPS = 0.95 * LED_FPS + 0.05 * (1000000.0 / (esp_timer_get_time() - last_frame_us));
       last_frame_us = esp_timer_get_time();
+      TRACE_END(SPAN_LED_FRAME);
+    } else {
+      vTaskDelay(1);
     }
-    vTaskDelay(1);
   }
 }
 
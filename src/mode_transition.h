@@ -0,0 +1,115 @@
+#ifndef MODE_TRANSITION_H
+#define MODE_TRANSITION_H
+
+/*----------------------------------------
+  Sensory Bridge MODE TRANSITIONS
+  ----------------------------------------*/
+
+// Mode changes used to fade MASTER_BRIGHTNESS to black, switch modes and
+// fade back up. Now, for CONFIG.MODE_FADE_MS, led_thread renders both the
+// outgoing and the incoming mode every frame and cross-fades them:
+//
+//   render outgoing -> CANVAS_OUTGOING -> mode_transition_stash() -> leds_16_xfade
+//   render incoming -> CANVAS_PRIMARY  -> mode_transition_blend() -> leds_16
+//
+// The stash is only a pointer: the outgoing frame stays in its canvas, or
+// in its trail history for trail modes (frame_buffers.h). Each mode keeps
+// its own trails for the duration (TRAIL_PRIMARY for the outgoing one,
+// TRAIL_INCOMING for the new one), and the two are swapped when the fade
+// completes so the new mode carries on with the trails it drew during the
+// blend.
+//
+// Two renders cost about twice the frame time. Modes share too much state
+// to run on two cores at once, so when the pacer's render average says
+// two wouldn't fit in a frame the blend runs at half the render resolution
+// instead (mode_transition_resolution()). Both resolution changes stretch
+// the canvases and trails rather than clearing them (set_render_resolution()),
+// so neither mode starts or ends the blend from black.
+//
+// Noise calibration still fades to black through run_transition_fade().
+
+#include <Arduino.h>
+#include "globals.h"
+#include "frame_pacer.h"
+#include "frame_buffers.h"
+
+#define MODE_FADE_MAX_MS 5000  // Longest CONFIG.MODE_FADE_MS the serial menu accepts
+
+bool     mode_transition_active = false;
+uint8_t  mode_transition_from = 0;      // Outgoing mode, rendered first
+uint32_t mode_transition_start_ms = 0;
+bool     mode_transition_half_res = false;
+
+// Pick up a queued mode change (button or serial), called at the top of each LED frame
+void begin_mode_transition() {
+  if (mode_transition_queued == false) {
+    return;
+  }
+  mode_transition_queued = false;
+
+  uint8_t from = CONFIG.LIGHTSHOW_MODE;
+  if (mode_destination == -1) {  // Triggered via button
+    CONFIG.LIGHTSHOW_MODE++;
+    if (CONFIG.LIGHTSHOW_MODE >= NUM_MODES) {
+      CONFIG.LIGHTSHOW_MODE = 0;
+    }
+  } else {  // Triggered via Serial
+    CONFIG.LIGHTSHOW_MODE = mode_destination;
+    mode_destination = -1;
+  }
+
+  if (CONFIG.LIGHTSHOW_MODE == from || CONFIG.MODE_FADE_MS == 0) {
+    return;  // Nothing to blend, cut straight over
+  }
+
+  // An earlier blend still running is cut short, its incoming mode becomes the outgoing one
+  if (mode_transition_active) {
+    frame_trail_swap(TRAIL_PRIMARY, TRAIL_INCOMING);
+  }
+  frame_trail_clear(TRAIL_INCOMING);
+
+  mode_transition_from = from;
+  mode_transition_start_ms = millis();
+  mode_transition_half_res = (frame_pacer_stats.render_avg_us * 2 > frame_pacer_period_us());
+  mode_transition_active = true;
+}
+
+// Render resolution for this frame, given the one the quality governor picked
+uint16_t mode_transition_resolution(uint16_t resolution) {
+  if (mode_transition_active && mode_transition_half_res && (resolution / 2) >= MIN_RENDER_RESOLUTION) {
+    return (resolution / 2) & ~1;
+  }
+  return resolution;
+}
+
+// Keep the outgoing mode's frame while the incoming one renders into another buffer
+void mode_transition_stash() {
+  leds_16_xfade = leds_16;
+}
+
+// Mix the stashed outgoing frame over the incoming one in leds_16
+void mode_transition_blend() {
+  uint32_t elapsed = millis() - mode_transition_start_ms;
+  uint16_t duration = CONFIG.MODE_FADE_MS;
+
+  if (elapsed >= duration) {
+    // Done, the incoming mode's trails become the regular ones
+    frame_trail_swap(TRAIL_PRIMARY, TRAIL_INCOMING);
+    mode_transition_active = false;
+    return;
+  }
+
+  // Smoothstep over the fade, in Q16
+  SQ15x16 t = SQ15x16(elapsed) / SQ15x16(duration);
+  SQ15x16 mix_in = t * t * (SQ15x16(3.0) - SQ15x16(2.0) * t);
+  SQ15x16 mix_out = SQ15x16(1.0) - mix_in;
+
+  CRGB16* incoming = frame_write_source();  // (frame_buffers.h)
+  for (uint16_t i = 0; i < render_resolution; i++) {
+    leds_16[i].r = incoming[i].r * mix_in + leds_16_xfade[i].r * mix_out;
+    leds_16[i].g = incoming[i].g * mix_in + leds_16_xfade[i].g * mix_out;
+    leds_16[i].b = incoming[i].b * mix_in + leds_16_xfade[i].b * mix_out;
+  }
+}
+
+#endif // MODE_TRANSITION_H
@@ -1,3 +1,24 @@
+/*----------------------------------------
+  Sensory Bridge NOISE CALIBRATION
+  ----------------------------------------*/
+
+// The one-shot calibration (start_noise_cal(), gathered in process_GDFT())
+// sets noise_samples. After that, noise_floor keeps it current from the
+// chunks i2s_audio.h finds silent (silent_chunk, not the sweet spot state,
+// which stays silent for a while after music is back), and named profiles
+// (noise_floor.h) keep the floors of rooms the device goes back to.
+
+#include "noise_floor.h"
+
+#define NOISE_FLOOR_SAVE_INTERVAL_MS (15 * 60 * 1000)  // The tracked floor goes to flash at most this often
+
+NoiseFloorTracker<NUM_FREQS> noise_floor;
+NoiseProfileBank<NUM_FREQS> noise_profiles;  // Saved by save_noise_profiles() (bridge_fs.h)
+uint8_t active_noise_profile = NOISE_PROFILE_NONE;
+bool noise_tracking = true;  // Not saved, it's on after every boot
+uint32_t noise_floor_saved_ms = 0;
+uint8_t noise_floor_note_offset = 0xFF;  // NOTE_OFFSET noise_samples was measured with, 0xFF until the first build
+
 extern void propagate_noise_reset();
 
 void start_noise_cal() {
@@ -12,7 +33,8 @@ void start_noise_cal() {
   for (uint8_t i = 0; i < NUM_FREQS; i++) {
     noise_samples[i] = 0;
   }
-  for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+  active_noise_profile = NOISE_PROFILE_NONE;
+  for (uint16_t i = 0; i < render_resolution; i++) {
     ui_mask[i] = 0;
   }
   USBSerial.println("STARTING NOISE CAL");
@@ -24,7 +46,135 @@ void clear_noise_cal() {
   for (uint16_t i = 0; i < NUM_FREQS; i++) {
     noise_samples[i] = 0;
   }
+  noise_floor.clear();  // Tracking starts over from the next silent window
+  active_noise_profile = NOISE_PROFILE_NONE;
   save_config();
   save_ambient_noise_calibration();
   USBSerial.println("NOISE CAL CLEARED");
-}
\ No newline at end of file
+}
+
+// Restart the tracker from noise_samples, once a calibration completes
+void seed_noise_floor() {
+  float floor[NUM_FREQS];
+  for (uint16_t i = 0; i < NUM_FREQS; i++) {
+    floor[i] = float(noise_samples[i]);
+  }
+  noise_floor.load(floor);
+}
+
+// process_GDFT(), before the floor is subtracted. Every frame goes to the
+// tracker, which counts the ones well inside silence, and each window it
+// finishes becomes noise_samples
+void track_noise_floor(const float* magnitudes) {
+  if (noise_complete == false) {
+    return;
+  }
+  if (noise_floor.update(magnitudes, noise_tracking && silent_chunk) == false) {
+    return;
+  }
+  const float* floor = noise_floor.floor();
+  for (uint16_t i = 0; i < NUM_FREQS; i++) {
+    noise_samples[i] = SQ15x16(floor[i]);
+  }
+
+  // The room's floor survives a reboot, without a flash write every window
+  if (millis() - noise_floor_saved_ms >= NOISE_FLOOR_SAVE_INTERVAL_MS) {
+    noise_floor_saved_ms = millis();
+    save_ambient_noise_calibration();  // (bridge_fs.h)
+  }
+}
+
+// Derived table (system.h) on NOTE_OFFSET. Bin i listens for note
+// i + NOTE_OFFSET (precompute_goertzel_constants()), so when it changes
+// each bin takes the floor of the bin that listened for its note until
+// now, and the bins no bin did take the nearest one's. Tracking restarts
+// from there rather than subtracting another note's floor until enough
+// silent windows have gone by
+void shift_noise_floor() {
+  int16_t shift = int16_t(CONFIG.NOTE_OFFSET) - int16_t(noise_floor_note_offset);
+  bool first_build = (noise_floor_note_offset == 0xFF);
+  noise_floor_note_offset = CONFIG.NOTE_OFFSET;
+  if (first_build || shift == 0 || noise_complete == false) {
+    return;
+  }
+
+  float floor[NUM_FREQS];
+  for (int16_t i = 0; i < NUM_FREQS; i++) {
+    int16_t from = i + shift;
+    from = (from < 0) ? 0 : (from >= NUM_FREQS) ? NUM_FREQS - 1 : from;
+    floor[i] = float(noise_samples[from]);
+  }
+  for (uint16_t i = 0; i < NUM_FREQS; i++) {
+    noise_samples[i] = SQ15x16(floor[i]);
+  }
+  noise_floor.load(floor);
+  active_noise_profile = NOISE_PROFILE_NONE;  // Profiles are stored by bin
+  save_ambient_noise_calibration();  // (bridge_fs.h)
+}
+
+// A slot from a name, or from its number
+uint8_t find_noise_profile(const char* name_or_slot) {
+  uint8_t slot = noise_profiles.find(name_or_slot);
+  if (slot == NOISE_PROFILE_NONE && name_or_slot[0] >= '0' && name_or_slot[0] <= '9' && name_or_slot[1] == '\0') {
+    slot = uint8_t(name_or_slot[0] - '0');
+  }
+  return noise_profiles.used(slot) ? slot : NOISE_PROFILE_NONE;
+}
+
+// Subtract a saved room's floor from the next frame on, no calibration.
+// Tracking carries on from it
+void select_noise_profile(uint8_t slot) {
+  const float* floor = noise_profiles.profiles[slot].floor;
+  for (uint16_t i = 0; i < NUM_FREQS; i++) {
+    noise_samples[i] = SQ15x16(floor[i]);
+  }
+  noise_floor.load(floor);
+  noise_complete = true;
+  active_noise_profile = slot;
+  save_ambient_noise_calibration();  // (bridge_fs.h)
+}
+
+// Save the floor being subtracted now as «name». The slot, NOISE_PROFILE_NONE if it didn't fit
+uint8_t store_noise_profile(const char* name) {
+  float floor[NUM_FREQS];
+  for (uint16_t i = 0; i < NUM_FREQS; i++) {
+    floor[i] = float(noise_samples[i]);
+  }
+  uint8_t slot = noise_profiles.store(name, floor);
+  if (slot != NOISE_PROFILE_NONE) {
+    active_noise_profile = slot;
+    save_noise_profiles();  // (bridge_fs.h)
+  }
+  return slot;
+}
+
+void print_noise_profiles() {
+  for (uint8_t i = 0; i < NOISE_PROFILE_SLOTS; i++) {
+    if (noise_profiles.used(i) == false) {
+      continue;
+    }
+    USBSerial.print("sbs((noise_profile=");
+    USBSerial.print(i);
+    USBSerial.print(",name=");
+    USBSerial.print(noise_profiles.profiles[i].name);
+    USBSerial.println("))");
+  }
+  const NoiseFloorStats& stats = noise_floor.stats();
+  USBSerial.print("sbs((noise_profiles=");
+  USBSerial.print(noise_profiles.count());
+  USBSerial.print(",slots=");
+  USBSerial.print(NOISE_PROFILE_SLOTS);
+  USBSerial.print(",active=");
+  USBSerial.print(active_noise_profile == NOISE_PROFILE_NONE ? "none" : noise_profiles.profiles[active_noise_profile].name);
+  USBSerial.print(",tracking=");
+  USBSerial.print(noise_tracking);
+  USBSerial.print(",silent_frames=");
+  USBSerial.print(stats.frames);
+  USBSerial.print(",discarded=");
+  USBSerial.print(stats.discarded);
+  USBSerial.print(",windows=");
+  USBSerial.print(stats.windows);
+  USBSerial.print(",window_progress=");
+  USBSerial.print(noise_floor.window_progress());
+  USBSerial.println("))");
+}
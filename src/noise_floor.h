@@ -0,0 +1,285 @@
+#ifndef NOISE_FLOOR_H
+#define NOISE_FLOOR_H
+
+/*----------------------------------------
+  Sensory Bridge NOISE FLOOR
+  ----------------------------------------*/
+
+// Keeps the per-bin noise floor up to date while the room is quiet, so
+// the venue doesn't need a new noise calibration when it gets noisier.
+//
+// NoiseFloorTracker is fed the GDFT magnitudes of every frame, with the
+// per-frame silence gate from i2s_audio.h (noise_cal.h). The magnitudes
+// are smoothed over frames, so the ones just after music stops still
+// carry some of it, and a frame's chunk can be quiet while the next one
+// brings the music back. A frame only counts once NOISE_FLOOR_GUARD_FRAMES
+// silent frames came before it and as many after it. Until then it waits
+// in a ring, which a loud frame empties. Each bin estimates a high quantile
+// of what it sees, NOISE_FLOOR_QUANTILE, the way the one-shot calibration
+// takes the loudest of its 256 frames, but without letting one click set
+// the floor. The estimate is P² (Jain & Chlamtac): five markers per bin,
+// moved with a parabola as samples arrive. Nothing is stored per sample.
+//
+// The estimate restarts every NOISE_FLOOR_WINDOW silent frames. Each
+// finished window moves the floor NOISE_FLOOR_BLEND of the way to its
+// estimate, so an old room is forgotten in a few windows while one
+// unusual window only moves it part way. Every bin sees the same number
+// of samples, so the desired marker positions are shared. A bin keeps
+// just its five heights and the three middle positions.
+//
+// NoiseProfileBank holds named floors ("stage", "bar"...). The whole bank
+// is saved as one journal blob (bridge_fs.h), and selecting one loads
+// it into the tracker.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+#include <string.h>
+
+#define NOISE_FLOOR_QUANTILE 0.95f
+#define NOISE_FLOOR_WINDOW   512    // Silent frames per estimate, several seconds
+#define NOISE_FLOOR_BLEND    0.5f
+#define NOISE_FLOOR_GUARD_FRAMES 8  // Silent frames needed either side of one that counts
+
+#define NOISE_PROFILE_SLOTS       4
+#define NOISE_PROFILE_NAME_LENGTH 16  // With the terminator
+#define NOISE_PROFILE_NONE        0xFF
+
+struct NoiseFloorStats {
+  uint32_t frames;     // Silent frames counted
+  uint32_t discarded;  // Silent frames dropped for being too close to sound
+  uint32_t windows;    // Estimates folded into the floor
+};
+
+template <uint16_t BINS>
+class NoiseFloorTracker {
+ public:
+  NoiseFloorTracker() : has_floor(false), silent_run(0), held_next(0), tracker_stats() {
+    memset(floor_values, 0, sizeof(floor_values));
+    restart();
+  }
+
+  // Start from a floor measured some other way (a calibration, a profile)
+  void load(const float* floor) {
+    memcpy(floor_values, floor, sizeof(floor_values));
+    has_floor = true;
+    restart();
+  }
+
+  // Forget everything, the floor is 0 until a window completes
+  void clear() {
+    memset(floor_values, 0, sizeof(floor_values));
+    has_floor = false;
+    restart();
+  }
+
+  // Every frame, «silent» from the per-frame gate. True when a frame it
+  // let through completed a window and floor() moved
+  bool update(const float* magnitudes, bool silent) {
+    if (silent == false) {
+      tracker_stats.discarded += (silent_run < NOISE_FLOOR_GUARD_FRAMES) ? silent_run : NOISE_FLOOR_GUARD_FRAMES;
+      silent_run = 0;  // What's held was too close to this
+      return false;
+    }
+
+    bool completed = false;
+    if (silent_run >= 2 * NOISE_FLOOR_GUARD_FRAMES) {
+      completed = add(held[held_next]);  // NOISE_FLOOR_GUARD_FRAMES old, with as many before it
+    } else if (silent_run >= NOISE_FLOOR_GUARD_FRAMES) {
+      tracker_stats.discarded++;  // Right after sound
+    }
+    memcpy(held[held_next], magnitudes, sizeof(held[held_next]));
+    held_next = (held_next + 1) % NOISE_FLOOR_GUARD_FRAMES;
+    if (silent_run < 2 * NOISE_FLOOR_GUARD_FRAMES) {
+      silent_run++;
+    }
+    return completed;
+  }
+
+  // One frame known to be silent, straight into the estimate. True when
+  // it completed a window and floor() moved
+  bool add(const float* magnitudes) {
+    tracker_stats.frames++;
+    if (count < 5) {
+      for (uint16_t b = 0; b < BINS; b++) {
+        insert_sorted(heights[b], count, magnitudes[b]);
+      }
+      count++;
+      if (count == 5) {
+        for (uint16_t b = 0; b < BINS; b++) {
+          positions[b][0] = 1;
+          positions[b][1] = 2;
+          positions[b][2] = 3;
+        }
+        for (uint8_t i = 0; i < 5; i++) {
+          desired[i] = 1.0f + 4.0f * increment(i);
+        }
+      }
+      return false;
+    }
+
+    count++;
+    for (uint8_t i = 0; i < 5; i++) {
+      desired[i] += increment(i);
+    }
+    for (uint16_t b = 0; b < BINS; b++) {
+      insert(heights[b], positions[b], magnitudes[b]);
+    }
+
+    if (count < NOISE_FLOOR_WINDOW) {
+      return false;
+    }
+    for (uint16_t b = 0; b < BINS; b++) {
+      float estimate = heights[b][2];
+      floor_values[b] = has_floor ? floor_values[b] + NOISE_FLOOR_BLEND * (estimate - floor_values[b]) : estimate;
+    }
+    has_floor = true;
+    tracker_stats.windows++;
+    restart();
+    return true;
+  }
+
+  const float* floor() const { return floor_values; }
+  bool ready() const { return has_floor; }
+  uint16_t window_progress() const { return count; }  // Of NOISE_FLOOR_WINDOW
+  const NoiseFloorStats& stats() const { return tracker_stats; }
+
+ private:
+  float floor_values[BINS];
+  bool has_floor;
+  uint16_t count;           // Samples in this window
+  float desired[5];         // Where the markers should be, the same for every bin
+  float heights[BINS][5];   // Marker 2 is the quantile
+  uint16_t positions[BINS][3];  // Of markers 1-3, marker 0 is at 0 and marker 4 at count - 1
+  float held[NOISE_FLOOR_GUARD_FRAMES][BINS];  // The last silent frames, not counted yet
+  uint8_t silent_run;                           // Silent frames in a row, up to 2 * NOISE_FLOOR_GUARD_FRAMES
+  uint8_t held_next;                            // Oldest in held[], and where the next goes
+  NoiseFloorStats tracker_stats;
+
+  void restart() { count = 0; }
+
+  static float increment(uint8_t marker) {
+    static const float steps[5] = { 0.0f, NOISE_FLOOR_QUANTILE / 2, NOISE_FLOOR_QUANTILE, (1.0f + NOISE_FLOOR_QUANTILE) / 2, 1.0f };
+    return steps[marker];
+  }
+
+  static void insert_sorted(float* values, uint16_t used, float value) {
+    uint16_t i = used;
+    while (i > 0 && values[i - 1] > value) {
+      values[i] = values[i - 1];
+      i--;
+    }
+    values[i] = value;
+  }
+
+  // P², positions counted from 1 as in the paper
+  void insert(float* q, uint16_t* middle, float x) {
+    float n[5] = { 1.0f, float(middle[0]) + 1.0f, float(middle[1]) + 1.0f, float(middle[2]) + 1.0f, float(count) };
+
+    uint8_t k;
+    if (x < q[0]) {
+      q[0] = x;
+      k = 0;
+    } else if (x >= q[4]) {
+      q[4] = x;
+      k = 3;
+    } else {
+      k = 0;
+      while (k < 3 && x >= q[k + 1]) {
+        k++;
+      }
+    }
+    for (uint8_t i = k + 1; i < 4; i++) {  // n[4] is count, already advanced
+      n[i] += 1.0f;
+    }
+
+    for (uint8_t i = 1; i < 4; i++) {
+      float d = desired[i] - n[i];
+      if ((d >= 1.0f && n[i + 1] - n[i] > 1.0f) || (d <= -1.0f && n[i - 1] - n[i] < -1.0f)) {
+        float s = (d > 0.0f) ? 1.0f : -1.0f;
+        float parabolic = q[i] + s / (n[i + 1] - n[i - 1]) *
+                                     ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                                      (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+        if (q[i - 1] < parabolic && parabolic < q[i + 1]) {
+          q[i] = parabolic;
+        } else {
+          uint8_t j = (s > 0.0f) ? i + 1 : i - 1;
+          q[i] += s * (q[j] - q[i]) / (n[j] - n[i]);
+        }
+        n[i] += s;
+      }
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+      middle[i] = uint16_t(n[i + 1] - 1.0f);
+    }
+  }
+};
+
+template <uint16_t BINS>
+struct NoiseProfile {
+  char name[NOISE_PROFILE_NAME_LENGTH];  // Empty for a free slot
+  float floor[BINS];
+};
+
+// What's saved
+template <uint16_t BINS>
+struct NoiseProfileBank {
+  uint16_t bins;  // BINS when saved, a bank for another bin count isn't loaded
+  NoiseProfile<BINS> profiles[NOISE_PROFILE_SLOTS];
+
+  void clear() {
+    memset(this, 0, sizeof(*this));
+    bins = BINS;
+  }
+
+  bool used(uint8_t slot) const { return slot < NOISE_PROFILE_SLOTS && profiles[slot].name[0] != '\0'; }
+  uint8_t count() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < NOISE_PROFILE_SLOTS; i++) {
+      n += used(i) ? 1 : 0;
+    }
+    return n;
+  }
+
+  uint8_t find(const char* name) const {
+    for (uint8_t i = 0; i < NOISE_PROFILE_SLOTS; i++) {
+      if (used(i) && strncmp(profiles[i].name, name, NOISE_PROFILE_NAME_LENGTH) == 0) {
+        return i;
+      }
+    }
+    return NOISE_PROFILE_NONE;
+  }
+
+  // Save «floor» as «name», over the profile of that name or into the
+  // first free slot. The slot, NOISE_PROFILE_NONE if the name doesn't fit
+  // or the bank is full
+  uint8_t store(const char* name, const float* floor) {
+    size_t length = strlen(name);
+    if (length == 0 || length >= NOISE_PROFILE_NAME_LENGTH) {
+      return NOISE_PROFILE_NONE;
+    }
+    uint8_t slot = find(name);
+    for (uint8_t i = 0; i < NOISE_PROFILE_SLOTS && slot == NOISE_PROFILE_NONE; i++) {
+      if (used(i) == false) {
+        slot = i;
+      }
+    }
+    if (slot == NOISE_PROFILE_NONE) {
+      return NOISE_PROFILE_NONE;
+    }
+    memset(profiles[slot].name, 0, NOISE_PROFILE_NAME_LENGTH);
+    memcpy(profiles[slot].name, name, length);
+    memcpy(profiles[slot].floor, floor, sizeof(profiles[slot].floor));
+    return slot;
+  }
+
+  bool remove(uint8_t slot) {
+    if (used(slot) == false) {
+      return false;
+    }
+    memset(&profiles[slot], 0, sizeof(profiles[slot]));
+    return true;
+  }
+};
+
+#endif // NOISE_FLOOR_H
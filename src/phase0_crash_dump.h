@@ -20,6 +20,8 @@
 #include <soc/rtc_cntl_reg.h>
 #include <soc/rtc.h>
 
+#include "crc32.h"  // The dump ends in crc32() of the rest
+
 namespace Phase0 {
 namespace CrashDump {
 
@@ -79,24 +81,6 @@ constexpr uint32_t CRASH_DUMP_MAGIC = 0xDEADC0DE;
 RTC_DATA_ATTR static CrashDumpData rtc_crash_dump;
 RTC_DATA_ATTR static bool rtc_crash_dump_valid = false;
 
-//=============================================================================
-// CRC32 (simplified version for crash dumps)
-//=============================================================================
-
-uint32_t simple_crc32(const void* data, size_t length) {
-    uint32_t crc = 0xFFFFFFFF;
-    const uint8_t* ptr = static_cast<const uint8_t*>(data);
-
-    for (size_t i = 0; i < length; i++) {
-        crc ^= ptr[i];
-        for (int j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
-        }
-    }
-
-    return ~crc;
-}
-
 //=============================================================================
 // Crash Dump Capture
 //=============================================================================
@@ -160,7 +144,7 @@ void captureCrashDump(CrashType type, const char* message = nullptr) {
 
     // Calculate CRC
     size_t crc_size = sizeof(rtc_crash_dump) - sizeof(rtc_crash_dump.crc32);
-    rtc_crash_dump.crc32 = simple_crc32(&rtc_crash_dump, crc_size);
+    rtc_crash_dump.crc32 = crc32(&rtc_crash_dump, crc_size);
 
     // Mark as valid
     rtc_crash_dump_valid = true;
@@ -179,7 +163,7 @@ bool hasCrashDump() {
 
     // Verify CRC
     size_t crc_size = sizeof(rtc_crash_dump) - sizeof(rtc_crash_dump.crc32);
-    uint32_t calculated_crc = simple_crc32(&rtc_crash_dump, crc_size);
+    uint32_t calculated_crc = crc32(&rtc_crash_dump, crc_size);
 
     return (calculated_crc == rtc_crash_dump.crc32);
 }
@@ -17,6 +17,8 @@
 #include <LittleFS.h>
 #include <FS.h>
 
+#include "crc32.h"  // Headers carry crc32() of the data
+
 namespace Phase0 {
 namespace Filesystem {
 
@@ -33,49 +35,6 @@ struct FileHeader {
     uint32_t timestamp;
 };
 
-//=============================================================================
-// CRC32 Calculation
-//=============================================================================
-
-class CRC32 {
-private:
-    static constexpr uint32_t POLYNOMIAL = 0xEDB88320;
-    static uint32_t table[256];
-    static bool table_initialized;
-
-    static void init_table() {
-        if (table_initialized) return;
-
-        for (uint32_t i = 0; i < 256; i++) {
-            uint32_t crc = i;
-            for (uint32_t j = 0; j < 8; j++) {
-                crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
-            }
-            table[i] = crc;
-        }
-        table_initialized = true;
-    }
-
-public:
-    static uint32_t calculate(const uint8_t* data, size_t length) {
-        init_table();
-
-        uint32_t crc = 0xFFFFFFFF;
-        for (size_t i = 0; i < length; i++) {
-            crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
-        }
-        return ~crc;
-    }
-
-    static uint32_t calculate(const void* data, size_t length) {
-        return calculate(static_cast<const uint8_t*>(data), length);
-    }
-};
-
-// Static members
-uint32_t CRC32::table[256] = {0};
-bool CRC32::table_initialized = false;
-
 //=============================================================================
 // Safe File Operations
 //=============================================================================
@@ -143,7 +102,7 @@ public:
         header.magic = CONFIG_MAGIC;
         header.version = CONFIG_VERSION;
         header.data_size = size;
-        header.crc32 = CRC32::calculate(data, size);
+        header.crc32 = crc32(data, size);
         header.timestamp = millis();
 
         // Write to temporary file first
@@ -283,7 +242,7 @@ public:
         }
 
         // Verify CRC
-        uint32_t calculated_crc = CRC32::calculate(buffer, header.data_size);
+        uint32_t calculated_crc = crc32(buffer, header.data_size);
         if (calculated_crc != header.crc32) {
             error_count++;
             last_error_time = millis();
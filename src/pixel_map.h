@@ -0,0 +1,245 @@
+#ifndef PIXEL_MAP_H
+#define PIXEL_MAP_H
+
+/*----------------------------------------
+  Sensory Bridge PIXEL MAP
+  ----------------------------------------*/
+
+// Turns a compact layout description into a flat LUT from logical pixel
+// (the index modes and scale_to_strip() work in) to physical pixel (the
+// position on the wire, across every output). quantize_color() stores
+// each pixel straight to leds_out[pixel_map[i]], so any wiring costs one
+// indexed store per pixel and no per-pixel branches.
+//
+// Layout grammar, whitespace ignored:
+//
+//   layout  := output ( '/' output )*         Outputs in data pin order
+//   output  := segment ( ',' segment )*       Segments in wire order
+//   segment := size flags* ( '@' start )?
+//   size    := N                              Strip of N pixels
+//            | W 'x' H                        Matrix, logical order row by row
+//   flags   := 'r'  Wire enters at the far end
+//              's'  Serpentine, every other row (or column) runs backwards
+//              'c'  Wired column by column instead of row by row
+//
+// A segment takes the next logical pixels unless '@start' places it
+// somewhere else. A logical pixel lands in only one place, so if two
+// segments overlap the later one wins. Wire positions no segment claims
+// stay black.
+//
+// "160"            one plain strip
+// "80/80"          two strips on two pins (LED_NEOPIXEL_X2)
+// "16x16s"         serpentine matrix
+// "30r@30,30@0"    two half strips fed from the middle
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+#include <string.h>
+
+#define PIXEL_MAP_MAX_OUTPUTS  4
+#define PIXEL_MAP_MAX_SEGMENTS 16
+#define PIXEL_MAP_LAYOUT_LEN   96  // Bytes, including the terminator
+
+enum pixel_segment_flags {
+  PIXEL_SEG_REVERSE    = 1 << 0,
+  PIXEL_SEG_SERPENTINE = 1 << 1,
+  PIXEL_SEG_COLUMNS    = 1 << 2,
+};
+
+struct PixelSegment {
+  uint16_t logical_start;
+  uint16_t width;
+  uint16_t height;
+  uint8_t  flags;
+  uint8_t  output;
+};
+
+struct PixelLayout {
+  PixelSegment segments[PIXEL_MAP_MAX_SEGMENTS];
+  uint8_t  num_segments;
+  uint8_t  num_outputs;
+  uint16_t output_start[PIXEL_MAP_MAX_OUTPUTS];  // First wire position of each output
+  uint16_t output_count[PIXEL_MAP_MAX_OUTPUTS];
+  uint16_t physical_count;                       // Sum of all segment sizes
+};
+
+enum pixel_map_errors {
+  PIXEL_MAP_OK,
+  PIXEL_MAP_SYNTAX,
+  PIXEL_MAP_TOO_MANY_SEGMENTS,
+  PIXEL_MAP_TOO_MANY_OUTPUTS,
+  PIXEL_MAP_EMPTY_SEGMENT,
+  PIXEL_MAP_LOGICAL_OVERFLOW,   // A segment reaches past led_count logical pixels
+  PIXEL_MAP_PHYSICAL_OVERFLOW,  // More pixels on the wire than led_count
+
+  NUM_PIXEL_MAP_ERRORS
+};
+
+const char* pixel_map_error_names[NUM_PIXEL_MAP_ERRORS] = {
+  "ok",
+  "syntax",
+  "too_many_segments",
+  "too_many_outputs",
+  "empty_segment",
+  "logical_overflow",
+  "physical_overflow",
+};
+
+static bool pixel_map_read_number(const char*& p, uint32_t& value) {
+  if (*p < '0' || *p > '9') {
+    return false;
+  }
+  value = 0;
+  while (*p >= '0' && *p <= '9') {
+    value = value * 10 + uint32_t(*p - '0');
+    if (value > 0xFFFF) {
+      return false;
+    }
+    p++;
+  }
+  return true;
+}
+
+static void pixel_map_skip_spaces(const char*& p) {
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+}
+
+// Parse «text» into «layout», checking it against a strip of «led_count» pixels
+uint8_t parse_pixel_layout(const char* text, uint16_t led_count, PixelLayout& layout) {
+  memset(&layout, 0, sizeof(layout));
+  layout.num_outputs = 1;
+
+  const char* p = text;
+  uint32_t logical_cursor = 0;
+
+  pixel_map_skip_spaces(p);
+  while (*p != '\0') {
+    if (layout.num_segments >= PIXEL_MAP_MAX_SEGMENTS) {
+      return PIXEL_MAP_TOO_MANY_SEGMENTS;
+    }
+
+    PixelSegment& seg = layout.segments[layout.num_segments];
+    uint32_t width, height = 1;
+    if (!pixel_map_read_number(p, width)) {
+      return PIXEL_MAP_SYNTAX;
+    }
+    if (*p == 'x') {
+      p++;
+      if (!pixel_map_read_number(p, height)) {
+        return PIXEL_MAP_SYNTAX;
+      }
+    }
+    if (width == 0 || height == 0) {
+      return PIXEL_MAP_EMPTY_SEGMENT;
+    }
+
+    while (*p == 'r' || *p == 's' || *p == 'c') {
+      seg.flags |= (*p == 'r') ? PIXEL_SEG_REVERSE : (*p == 's') ? PIXEL_SEG_SERPENTINE : PIXEL_SEG_COLUMNS;
+      p++;
+    }
+
+    uint32_t start = logical_cursor;
+    if (*p == '@') {
+      p++;
+      if (!pixel_map_read_number(p, start)) {
+        return PIXEL_MAP_SYNTAX;
+      }
+    }
+
+    uint32_t size = width * height;
+    if (start + size > led_count) {
+      return PIXEL_MAP_LOGICAL_OVERFLOW;
+    }
+    if (layout.physical_count + size > led_count) {
+      return PIXEL_MAP_PHYSICAL_OVERFLOW;
+    }
+
+    seg.logical_start = start;
+    seg.width = width;
+    seg.height = height;
+    seg.output = layout.num_outputs - 1;
+
+    layout.output_count[seg.output] += size;
+    layout.physical_count += size;
+    layout.num_segments++;
+    logical_cursor = start + size;
+
+    pixel_map_skip_spaces(p);
+    if (*p == ',') {
+      p++;
+    } else if (*p == '/') {
+      if (layout.num_outputs >= PIXEL_MAP_MAX_OUTPUTS) {
+        return PIXEL_MAP_TOO_MANY_OUTPUTS;
+      }
+      layout.output_start[layout.num_outputs] = layout.physical_count;
+      layout.num_outputs++;
+      p++;
+    } else if (*p != '\0') {
+      return PIXEL_MAP_SYNTAX;
+    }
+    pixel_map_skip_spaces(p);
+  }
+
+  if (layout.num_segments == 0) {
+    return PIXEL_MAP_EMPTY_SEGMENT;
+  }
+
+  return PIXEL_MAP_OK;
+}
+
+// Wire position of pixel (x, y) inside one segment
+static uint16_t pixel_segment_wire_index(const PixelSegment& seg, uint16_t x, uint16_t y) {
+  uint16_t lane, along, lane_length;
+  if (seg.flags & PIXEL_SEG_COLUMNS) {
+    lane = x; along = y; lane_length = seg.height;
+  } else {
+    lane = y; along = x; lane_length = seg.width;
+  }
+
+  if ((seg.flags & PIXEL_SEG_SERPENTINE) && (lane & 1)) {
+    along = lane_length - 1 - along;
+  }
+
+  uint16_t wire = lane * lane_length + along;
+  if (seg.flags & PIXEL_SEG_REVERSE) {
+    wire = (seg.width * seg.height) - 1 - wire;
+  }
+  return wire;
+}
+
+// Fill «map» (led_count entries) so map[logical] = physical. Logical pixels
+// no segment covers point at «sink», one spare slot past the transmitted
+// pixels, which keeps the quantize loop free of bounds checks. «reverse»
+// flips each output end to end, which on a single full strip is what
+// CONFIG.REVERSE_ORDER always did. Wire positions past the layout are
+// left where they are.
+void build_pixel_map(const PixelLayout& layout, uint16_t led_count, bool reverse, uint16_t sink, uint16_t* map) {
+  for (uint16_t i = 0; i < led_count; i++) {
+    map[i] = sink;
+  }
+
+  uint16_t wire_base = 0;
+  for (uint8_t s = 0; s < layout.num_segments; s++) {
+    const PixelSegment& seg = layout.segments[s];
+    uint16_t logical = seg.logical_start;
+    uint16_t output_first = layout.output_start[seg.output];
+    uint16_t output_last = output_first + layout.output_count[seg.output] - 1;
+
+    for (uint16_t y = 0; y < seg.height; y++) {
+      for (uint16_t x = 0; x < seg.width; x++) {
+        uint16_t physical = wire_base + pixel_segment_wire_index(seg, x, y);
+        if (reverse) {
+          physical = output_last - (physical - output_first);
+        }
+        map[logical++] = physical;
+      }
+    }
+
+    wire_base += seg.width * seg.height;
+  }
+}
+
+#endif // PIXEL_MAP_H
@@ -0,0 +1,233 @@
+#ifndef PRESET_BANK_H
+#define PRESET_BANK_H
+
+/*----------------------------------------
+  Sensory Bridge PRESET BANK
+  ----------------------------------------*/
+
+// Named CONFIG snapshots, kept in RAM so switching to one is an index, not
+// a file read or a string of serial commands. A preset holds the fields
+// switching to it sets, as saved entries (config_pack(), config_fields.h):
+// a saved preset has every PRESET_FIELDS field, and a built-in theme
+// (presets.h) just the few it's about.
+//
+// request() only records which preset is wanted, from any task. apply(),
+// at the top of an LED frame, copies in the fields that actually differ
+// and reports them. The derived tables (derived_tables.h) then rebuild
+// only when one of those fields is an input.
+//
+// The whole bank is one PresetBankImage, saved as a single journal blob
+// (bridge_fs.h). Its size doesn't depend on CONFIG, and entries name their
+// field by key, so a bank saved by a firmware with another CONFIG layout
+// still loads: each preset keeps the fields that still exist.
+//
+// store() and remove() change presets under «Lock», and apply() copies
+// one out under it, so a frame never gets a half-written preset. Only one
+// task may store() or remove().
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+#include "config_fields.h"
+
+#define PRESET_BANK_SLOTS   8
+#define PRESET_NAME_LENGTH  16   // With the terminator
+#define PRESET_ENTRY_BYTES  256  // Saved entries per preset. Changing it drops saved banks
+#define PRESET_NONE         0xFF
+#define PRESET_BANK_FORMAT  0x50524532  // "PRE2", entries by key
+
+static_assert(CONFIG_PACKED_MAX <= PRESET_ENTRY_BYTES, "A preset can't hold every CONFIG field, raise PRESET_ENTRY_BYTES");
+
+// Fields that belong to the installation or a calibration rather than to a
+// look (the strip, sample rate, sweet spot levels...) are left as they are
+#define PRESET_FIELDS                                                                                              \
+  (CONFIG_MASK_ALL & ~(CONFIG_MASK(SAMPLE_RATE) | CONFIG_MASK(LED_TYPE) | CONFIG_MASK(LED_COUNT) |                 \
+                       CONFIG_MASK(LED_COLOR_ORDER) | CONFIG_MASK(SAMPLES_PER_CHUNK) | CONFIG_MASK(BOOT_ANIMATION) | \
+                       CONFIG_MASK(SWEET_SPOT_MIN_LEVEL) | CONFIG_MASK(SWEET_SPOT_MAX_LEVEL) |                      \
+                       CONFIG_MASK(DC_OFFSET) | CONFIG_MASK(REVERSE_ORDER) | CONFIG_MASK(MAX_CURRENT_MA) |         \
+                       CONFIG_MASK(RENDER_MODE)))
+
+struct Preset {
+  char name[PRESET_NAME_LENGTH];  // Empty for a free slot
+  uint16_t length;                // Bytes of «entries» used
+  uint8_t entries[PRESET_ENTRY_BYTES];  // What switching to it sets (config_pack())
+};
+
+// What's saved
+struct PresetBankImage {
+  uint32_t format;  // PRESET_BANK_FORMAT
+  Preset presets[PRESET_BANK_SLOTS];
+};
+
+struct PresetBankStats {
+  uint32_t switches;
+  uint8_t last_changed;  // Fields the last switch changed
+};
+
+template <typename Lock>
+class PresetBank {
+ public:
+  PresetBank() : image(), pending(PRESET_NONE), current(PRESET_NONE), bank_stats() {
+    clear();
+  }
+
+  void clear() {
+    lock.lock();
+    memset(&image, 0, sizeof(image));
+    image.format = PRESET_BANK_FORMAT;
+    current = PRESET_NONE;
+    lock.unlock();
+  }
+
+  // Take a saved bank, false (keeping this one) if it isn't one. Fields
+  // this firmware no longer has stay in the entries and are skipped
+  bool load(const PresetBankImage& saved) {
+    if (saved.format != PRESET_BANK_FORMAT) {
+      return false;
+    }
+    lock.lock();
+    image = saved;
+    for (Preset& preset : image.presets) {
+      preset.name[PRESET_NAME_LENGTH - 1] = '\0';
+      preset.length = (preset.length > PRESET_ENTRY_BYTES) ? 0 : preset.length;
+    }
+    lock.unlock();
+    return true;
+  }
+
+  // Slot holding «name», PRESET_NONE if none does
+  uint8_t find(const char* name) const {
+    for (uint8_t i = 0; i < PRESET_BANK_SLOTS; i++) {
+      if (used(i) && strncmp(image.presets[i].name, name, PRESET_NAME_LENGTH) == 0) {
+        return i;
+      }
+    }
+    return PRESET_NONE;
+  }
+
+  // Save «values» as «name», over the preset of that name or into the
+  // first free slot. The slot, PRESET_NONE if the name doesn't fit or the
+  // bank is full
+  uint8_t store(const char* name, const SensoryBridge::Config::conf& values, ConfigMask fields = PRESET_FIELDS) {
+    size_t length = strlen(name);
+    if (length == 0 || length >= PRESET_NAME_LENGTH) {
+      return PRESET_NONE;
+    }
+    uint8_t slot = find(name);
+    for (uint8_t i = 0; i < PRESET_BANK_SLOTS && slot == PRESET_NONE; i++) {
+      if (used(i) == false) {
+        slot = i;
+      }
+    }
+    if (slot == PRESET_NONE) {
+      return PRESET_NONE;
+    }
+
+    lock.lock();
+    Preset& preset = image.presets[slot];
+    memset(preset.name, 0, sizeof(preset.name));
+    memcpy(preset.name, name, length);
+    preset.length = config_pack(values, fields & CONFIG_MASK_ALL, preset.entries);
+    lock.unlock();
+    return slot;
+  }
+
+  bool remove(uint8_t slot) {
+    if (used(slot) == false) {
+      return false;
+    }
+    lock.lock();
+    memset(&image.presets[slot], 0, sizeof(Preset));
+    if (current == slot) {
+      current = PRESET_NONE;
+    }
+    lock.unlock();
+    return true;
+  }
+
+  // Any task: switch to «slot» at the next apply(). A later request before
+  // then replaces this one
+  bool request(uint8_t slot) {
+    if (used(slot) == false) {
+      return false;
+    }
+    pending.store(slot, std::memory_order_release);
+    return true;
+  }
+
+  // At a frame boundary: copy the requested preset's fields that differ
+  // into «config». The fields changed, 0 if none or nothing was requested
+  ConfigMask apply(SensoryBridge::Config::conf& config) {
+    uint8_t slot = pending.exchange(PRESET_NONE, std::memory_order_acq_rel);
+    if (slot >= PRESET_BANK_SLOTS) {
+      return 0;
+    }
+    lock.lock();
+    const Preset& preset = image.presets[slot];
+    ConfigMask changed = 0;
+    if (preset.name[0] != '\0') {  // Not removed since the request
+      SensoryBridge::Config::conf values = config;
+      ConfigMask fields = config_unpack(values, preset.entries, preset.length);
+      changed = config_diff(config, values, fields);
+      config_copy_fields(config, values, changed);
+      current = slot;
+      bank_stats.switches++;
+      bank_stats.last_changed = config_mask_count(changed);
+    }
+    lock.unlock();
+    return changed;
+  }
+
+  // Copy a preset's fields into «config» right away, for a config only
+  // this task uses (an open transaction's shadow)
+  bool copy_into(uint8_t slot, SensoryBridge::Config::conf& config) const {
+    if (used(slot) == false) {
+      return false;
+    }
+    config_unpack(config, image.presets[slot].entries, image.presets[slot].length);
+    return true;
+  }
+
+  // The fields switching to «slot» sets, those of its entries this firmware has
+  ConfigMask fields(uint8_t slot) const {
+    SensoryBridge::Config::conf scratch;
+    return used(slot) ? config_unpack(scratch, image.presets[slot].entries, image.presets[slot].length) : 0;
+  }
+
+  bool used(uint8_t slot) const { return slot < PRESET_BANK_SLOTS && image.presets[slot].name[0] != '\0'; }
+  const char* name(uint8_t slot) const { return used(slot) ? image.presets[slot].name : ""; }
+  uint8_t count() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < PRESET_BANK_SLOTS; i++) {
+      n += used(i) ? 1 : 0;
+    }
+    return n;
+  }
+  uint8_t active() const { return current; }  // Last switched to, PRESET_NONE if none or removed
+
+  // The used slot after «slot», wrapping, PRESET_NONE if the bank is empty
+  uint8_t next(uint8_t slot) const {
+    for (uint8_t step = 1; step <= PRESET_BANK_SLOTS; step++) {
+      uint8_t i = uint8_t((slot == PRESET_NONE ? PRESET_BANK_SLOTS - 1 : slot) + step) % PRESET_BANK_SLOTS;
+      if (used(i)) {
+        return i;
+      }
+    }
+    return PRESET_NONE;
+  }
+
+  const PresetBankStats& stats() const { return bank_stats; }
+
+  PresetBankImage image;  // Read it from the storing task only
+
+ private:
+  Lock lock;
+  std::atomic<uint8_t> pending;
+  uint8_t current;
+  PresetBankStats bank_stats;
+};
+
+#endif // PRESET_BANK_H
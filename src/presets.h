@@ -1,48 +1,102 @@
-void set_preset(char* preset_name) {
-  // Modifies current CONFIG struct based on input preset name
-
-  if (strcmp(preset_name, "default") == 0) {
-    CONFIG.SQUARE_ITER = 1;
-    CONFIG.INCANDESCENT_FILTER = 0.80;
-    CONFIG.INCANDESCENT_MODE = false;
-    CONFIG.BASE_COAT = true;
-    CONFIG.BULB_OPACITY = 0.0;
-    CONFIG.SATURATION = 1.0;
-  }
+/*----------------------------------------
+  Sensory Bridge PRESETS
+  ----------------------------------------*/
+
+// The preset bank (preset_bank.h) and the themes a new one starts with.
+// Switches are requested by slot from serial or the encoders, and applied
+// by led_thread at the top of a frame (apply_preset_switch()).
+
+#include "preset_bank.h"
+
+extern void save_config_delayed();  // bridge_fs.h
+
+PresetBank<SpinLock> preset_bank;  // (globals.h)
 
-  else if (strcmp(preset_name, "tinted_bulbs") == 0) {
-    CONFIG.SQUARE_ITER = 1;
-    CONFIG.INCANDESCENT_FILTER = 0.80;
-    CONFIG.INCANDESCENT_MODE = false;
-    CONFIG.BASE_COAT = false;
-    CONFIG.BULB_OPACITY = 1.0;
-    CONFIG.SATURATION = 1.0;
+// Built-in themes only set the bulb and color fields
+#define PRESET_THEME_FIELDS                                                                        \
+  (CONFIG_MASK(SQUARE_ITER) | CONFIG_MASK(INCANDESCENT_FILTER) | CONFIG_MASK(INCANDESCENT_MODE) | \
+   CONFIG_MASK(BASE_COAT) | CONFIG_MASK(BULB_OPACITY) | CONFIG_MASK(SATURATION))
+
+struct PresetTheme {
+  const char* name;
+  float incandescent_filter;
+  bool incandescent_mode;
+  bool base_coat;
+  float bulb_opacity;
+  float saturation;
+};
+
+const PresetTheme preset_themes[] = {
+  //  name            filter  inc_mode  base_coat  bulbs  saturation
+  { "default",        0.80,   false,    true,      0.0,   1.0 },
+  { "tinted_bulbs",   0.80,   false,    false,     1.0,   1.0 },
+  { "incandescent",   1.0,    true,     true,      0.0,   1.0 },
+  { "white",          0.0,    false,    true,      0.0,   0.0 },
+  { "classic",        0.0,    false,    false,     0.0,   1.0 },
+};
+
+// A bank of just the themes: first boot, or no bank saved
+void load_builtin_presets() {
+  preset_bank.clear();
+  for (const PresetTheme& theme : preset_themes) {
+    SensoryBridge::Config::conf values = CONFIG_DEFAULTS;
+    values.SQUARE_ITER = 1;
+    values.INCANDESCENT_FILTER = theme.incandescent_filter;
+    values.INCANDESCENT_MODE = theme.incandescent_mode;
+    values.BASE_COAT = theme.base_coat;
+    values.BULB_OPACITY = theme.bulb_opacity;
+    values.SATURATION = theme.saturation;
+    preset_bank.store(theme.name, values, PRESET_THEME_FIELDS);
   }
+}
 
-  else if (strcmp(preset_name, "incandescent") == 0) {
-    CONFIG.SQUARE_ITER = 1;
-    CONFIG.INCANDESCENT_FILTER = 1.0;
-    CONFIG.INCANDESCENT_MODE = true;
-    CONFIG.BASE_COAT = true;
-    CONFIG.BULB_OPACITY = 0.0;
-    CONFIG.SATURATION = 1.0;
+// A slot from a name, or from its number
+uint8_t find_preset(const char* name_or_slot) {
+  uint8_t slot = preset_bank.find(name_or_slot);
+  if (slot == PRESET_NONE && name_or_slot[0] >= '0' && name_or_slot[0] <= '9' && name_or_slot[1] == '\0') {
+    slot = uint8_t(name_or_slot[0] - '0');
   }
+  return preset_bank.used(slot) ? slot : PRESET_NONE;
+}
 
-  else if (strcmp(preset_name, "white") == 0) {
-    CONFIG.SQUARE_ITER = 1;
-    CONFIG.INCANDESCENT_FILTER = 0;
-    CONFIG.INCANDESCENT_MODE = false;
-    CONFIG.BASE_COAT = true;
-    CONFIG.BULB_OPACITY = 0.0;
-    CONFIG.SATURATION = 0.0;
+// led_thread, at the top of each frame. A mode change cross-fades like
+// any other (begin_mode_transition() runs right after)
+void apply_preset_switch() {
+  uint8_t mode = CONFIG.LIGHTSHOW_MODE;
+  ConfigMask changed = preset_bank.apply(CONFIG);
+  if (changed == 0) {
+    return;
+  }
+  if (changed & CONFIG_MASK(LIGHTSHOW_MODE)) {
+    mode_destination = CONFIG.LIGHTSHOW_MODE;
+    CONFIG.LIGHTSHOW_MODE = mode;
+    mode_transition_queued = true;
   }
+  save_config_delayed();
+}
 
-  else if (strcmp(preset_name, "classic") == 0) {
-    CONFIG.SQUARE_ITER = 1;
-    CONFIG.INCANDESCENT_FILTER = 0.0;
-    CONFIG.INCANDESCENT_MODE = false;
-    CONFIG.BASE_COAT = false;
-    CONFIG.BULB_OPACITY = 0.0;
-    CONFIG.SATURATION = 1.0;
+void print_presets() {
+  for (uint8_t i = 0; i < PRESET_BANK_SLOTS; i++) {
+    if (preset_bank.used(i) == false) {
+      continue;
+    }
+    USBSerial.print("sbs((preset=");
+    USBSerial.print(i);
+    USBSerial.print(",name=");
+    USBSerial.print(preset_bank.name(i));
+    USBSerial.print(",fields=");
+    USBSerial.print(config_mask_count(preset_bank.fields(i)));
+    USBSerial.println("))");
   }
-}
\ No newline at end of file
+  USBSerial.print("sbs((presets=");
+  USBSerial.print(preset_bank.count());
+  USBSerial.print(",slots=");
+  USBSerial.print(PRESET_BANK_SLOTS);
+  USBSerial.print(",active=");
+  USBSerial.print(preset_bank.active() == PRESET_NONE ? "none" : preset_bank.name(preset_bank.active()));
+  USBSerial.print(",switches=");
+  USBSerial.print(preset_bank.stats().switches);
+  USBSerial.print(",last_changed=");
+  USBSerial.print(preset_bank.stats().last_changed);
+  USBSerial.println("))");
+}
@@ -0,0 +1,66 @@
+#ifndef PRISM_FOLD_H
+#define PRISM_FOLD_H
+
+/*----------------------------------------
+  Sensory Bridge PRISM FOLD
+  ----------------------------------------*/
+
+// The geometry of one prism pass (apply_prism_effect(), led_utilities.h):
+// scale the frame to half, shift it up, mirror it downwards. That's the
+// linear map P where output pixel j is the average of pixels 2m and 2m+1,
+// m = j - half on the top half and half - 1 - j on the bottom.
+//
+// P^k averages 2^k source pixels per output pixel. While those are one
+// contiguous run for every pixel, P^k is a box average, read from prefix
+// sums through a start index per pixel (prism_build_spans()). How deep that
+// holds depends on the resolution: 5 levels at 160 px, 4 at 80, and only 1
+// when half the resolution is odd (150 px). Deeper than that, P^k is the
+// deepest box folded one pass at a time (prism_fold()), as the old
+// per-pass loop did.
+//
+// Channels are Q16 integers, SQ15x16's internal layout.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+
+// Fill span_start[0..max_level] (each «resolution» long) with the first
+// pixel of each output pixel's box, level by level, stopping at the first
+// level that isn't one contiguous box for every pixel. The deepest that is
+inline uint8_t prism_build_spans(uint16_t* const* span_start, uint8_t max_level, uint16_t resolution) {
+  const uint16_t half_res = resolution >> 1;
+  for (uint16_t j = 0; j < resolution; j++) {
+    span_start[0][j] = j;
+  }
+
+  for (uint8_t k = 1; k <= max_level; k++) {
+    for (uint16_t j = 0; j < resolution; j++) {
+      uint16_t m = (j >= half_res) ? (j - half_res) : (half_res - 1 - j);
+      uint16_t a = span_start[k - 1][(m << 1) + 0];
+      uint16_t b = span_start[k - 1][(m << 1) + 1];
+      span_start[k][j] = (a < b) ? a : b;
+
+      uint16_t gap = (a < b) ? (b - a) : (a - b);
+      if (gap != (1 << (k - 1))) {
+        return k - 1;
+      }
+    }
+  }
+  return max_level;
+}
+
+// Box average of the 2^level pixels from «start», out of the prefix sums
+inline int32_t prism_box(const int32_t* sum, uint16_t start, uint8_t level) {
+  return (sum[start + (1 << level)] - sum[start]) >> level;
+}
+
+// One pass of P over a whole channel, out = P(in)
+inline void prism_fold(const int32_t* in, int32_t* out, uint16_t resolution) {
+  const uint16_t half_res = resolution >> 1;
+  for (uint16_t j = 0; j < resolution; j++) {
+    uint16_t m = (j >= half_res) ? (j - half_res) : (half_res - 1 - j);
+    out[j] = (in[(m << 1) + 0] + in[(m << 1) + 1]) >> 1;
+  }
+}
+
+#endif // PRISM_FOLD_H
@@ -0,0 +1,382 @@
+#ifndef PROCEDURAL_H
+#define PROCEDURAL_H
+
+/*----------------------------------------
+  Sensory Bridge PROCEDURAL ENGINE
+  ----------------------------------------*/
+
+// Fixed-point building blocks for procedural modes: a sine LUT, a negative
+// exponential LUT, an x^0.8 LUT for falloff curves, gradient noise in 1D and 2D, and a seeded xorshift RNG.
+// Everything works on integers in the same Q16.16 layout SQ15x16 uses
+// internally, so modes wrap results with SQ15x16::fromInternal() for free.
+//
+// Angles are 32-bit phases where 2^32 is one full turn. Adding to a phase
+// wraps for free, so accumulators never lose precision or overflow the
+// way float radians and SQ15x16 radians do after long uptimes.
+//
+// Noise coordinates are 16.16 like FastLED's inoise16(): the integer part
+// picks the lattice cell and the fraction is the position inside it.
+// Results are signed Q15 (-32767..32767). The *_row() calls fill a whole
+// row per call and only rehash the lattice when a pixel crosses into a
+// new cell, which on a strip is every few pixels at most.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+
+#define PROC_PHASE_PER_RAD 683565275.576f  // 2^32 / 2pi
+#define PROC_PHASE_QUARTER 0x40000000u
+
+// Ken Perlin's reference permutation, hashes lattice coordinates
+static const uint8_t noise_perm[256] = {
+  151, 160, 137,  91,  90,  15, 131,  13, 201,  95,  96,  53, 194, 233,   7, 225,
+  140,  36, 103,  30,  69, 142,   8,  99,  37, 240,  21,  10,  23, 190,   6, 148,
+  247, 120, 234,  75,   0,  26, 197,  62,  94, 252, 219, 203, 117,  35,  11,  32,
+   57, 177,  33,  88, 237, 149,  56,  87, 174,  20, 125, 136, 171, 168,  68, 175,
+   74, 165,  71, 134, 139,  48,  27, 166,  77, 146, 158, 231,  83, 111, 229, 122,
+   60, 211, 133, 230, 220, 105,  92,  41,  55,  46, 245,  40, 244, 102, 143,  54,
+   65,  25,  63, 161,   1, 216,  80,  73, 209,  76, 132, 187, 208,  89,  18, 169,
+  200, 196, 135, 130, 116, 188, 159,  86, 164, 100, 109, 198, 173, 186,   3,  64,
+   52, 217, 226, 250, 124, 123,   5, 202,  38, 147, 118, 126, 255,  82,  85, 212,
+  207, 206,  59, 227,  47,  16,  58,  17, 182, 189,  28,  42, 223, 183, 170, 213,
+  119, 248, 152,   2,  44, 154, 163,  70, 221, 153, 101, 155, 167,  43, 172,   9,
+  129,  22,  39, 253,  19,  98, 108, 110,  79, 113, 224, 232, 178, 185, 112, 104,
+  218, 246,  97, 228, 251,  34, 242, 193, 238, 210, 144,  12, 191, 179, 162, 241,
+   81,  51, 145, 235, 249,  14, 239, 107,  49, 192, 214,  31, 181, 199, 106, 157,
+  184,  84, 204, 176, 115, 121,  50,  45, 127,   4, 150, 254, 138, 236, 205,  93,
+  222, 114,  67,  29,  24,  72, 243, 141, 128, 195,  78,  66, 215,  61, 156, 180
+};
+
+// sin(2pi * i / 256) in Q15, one guard entry for interpolation
+static const int16_t proc_sin_table[257] = {
+       0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,   7962,   8739,
+    9512,  10278,  11039,  11793,  12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+   18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,  23170,  23731,  24279,  24811,
+   25329,  25832,  26319,  26790,  27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+   30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,
+   32609,  32678,  32728,  32757,  32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+   32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,  30273,  29956,  29621,  29268,
+   28898,  28510,  28105,  27683,  27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+   23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,
+   15446,  14732,  14010,  13279,  12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+    6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,      0,   -804,  -1608,  -2410,
+   -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+  -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+  -20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+  -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+  -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+  -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580,
+  -31356, -31113, -30852, -30571, -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+  -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403,
+  -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+  -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,  -4808,  -4011,
+   -3212,  -2410,  -1608,   -804,      0
+};
+
+// 6t^5 - 15t^4 + 10t^3 in Q16 (65535 = 1.0), one guard entry
+static const uint16_t noise_fade_table[257] = {
+      0,     0,     0,     1,     2,     5,     8,    13,    19,    27,    37,    49,
+     63,    79,    99,   121,   145,   173,   204,   239,   277,   319,   364,   414,
+    467,   524,   586,   652,   723,   798,   878,   963,  1052,  1146,  1246,  1350,
+   1460,  1574,  1694,  1820,  1951,  2087,  2229,  2376,  2529,  2687,  2851,  3021,
+   3196,  3377,  3564,  3757,  3955,  4159,  4369,  4585,  4806,  5033,  5266,  5505,
+   5749,  5999,  6255,  6517,  6784,  7057,  7335,  7619,  7909,  8204,  8504,  8810,
+   9121,  9437,  9759, 10086, 10418, 10755, 11097, 11445, 11797, 12154, 12515, 12882,
+  13253, 13628, 14008, 14392, 14781, 15174, 15571, 15972, 16377, 16786, 17199, 17616,
+  18036, 18459, 18886, 19317, 19750, 20187, 20627, 21069, 21515, 21963, 22414, 22867,
+  23323, 23781, 24241, 24703, 25167, 25633, 26101, 26570, 27041, 27514, 27987, 28462,
+  28938, 29414, 29892, 30370, 30849, 31328, 31808, 32288, 32768, 33247, 33727, 34207,
+  34686, 35165, 35643, 36121, 36597, 37073, 37548, 38021, 38494, 38965, 39434, 39902,
+  40368, 40832, 41294, 41754, 42212, 42668, 43121, 43572, 44020, 44466, 44908, 45348,
+  45785, 46218, 46649, 47076, 47499, 47919, 48336, 48749, 49158, 49563, 49964, 50361,
+  50754, 51143, 51527, 51907, 52282, 52653, 53020, 53381, 53738, 54090, 54438, 54780,
+  55117, 55449, 55776, 56098, 56414, 56725, 57031, 57331, 57626, 57916, 58200, 58478,
+  58751, 59018, 59280, 59536, 59786, 60030, 60269, 60502, 60729, 60950, 61166, 61376,
+  61580, 61778, 61971, 62158, 62339, 62514, 62684, 62848, 63006, 63159, 63306, 63448,
+  63584, 63715, 63841, 63961, 64075, 64185, 64289, 64389, 64483, 64572, 64657, 64737,
+  64812, 64883, 64949, 65011, 65068, 65121, 65171, 65216, 65258, 65296, 65331, 65362,
+  65390, 65414, 65436, 65456, 65472, 65486, 65498, 65508, 65516, 65522, 65527, 65530,
+  65533, 65534, 65535, 65535, 65535
+};
+
+// x^0.8 for x = i / 64 in Q16 (65535 = 1.0)
+static const uint16_t proc_pow_0_8_table[65] = {
+      0,  2352,  4096,  5665,  7131,  8525,  9864, 11159, 12417, 13643, 14843, 16019,
+  17174, 18310, 19428, 20531, 21618, 22693, 23755, 24805, 25844, 26872, 27891, 28901,
+  29902, 30895, 31879, 32856, 33826, 34789, 35746, 36696, 37640, 38578, 39510, 40437,
+  41359, 42276, 43187, 44094, 44996, 45894, 46787, 47676, 48561, 49442, 50319, 51193,
+  52062, 52928, 53790, 54649, 55505, 56357, 57206, 58052, 58895, 59735, 60572, 61406,
+  62237, 63066, 63891, 64715, 65535
+};
+
+// exp(-8 * i / 256) in Q16 (65535 = 1.0), one guard entry
+static const uint16_t proc_exp_table[257] = {
+  65535, 63519, 61564, 59670, 57834, 56055, 54330, 52659, 51039, 49468, 47946, 46471,
+  45042, 43656, 42313, 41011, 39749, 38526, 37341, 36192, 35078, 33999, 32953, 31939,
+  30957, 30004, 29081, 28186, 27319, 26479, 25664, 24874, 24109, 23367, 22648, 21951,
+  21276, 20622, 19987, 19372, 18776, 18198, 17639, 17096, 16570, 16060, 15566, 15087,
+  14623, 14173, 13737, 13314, 12905, 12508, 12123, 11750, 11388, 11038, 10698, 10369,
+  10050,  9741,  9441,  9151,  8869,  8596,  8332,  8075,  7827,  7586,  7353,  7127,
+   6907,  6695,  6489,  6289,  6096,  5908,  5726,  5550,  5379,  5214,  5054,  4898,
+   4747,  4601,  4460,  4323,  4190,  4061,  3936,  3815,  3697,  3583,  3473,  3366,
+   3263,  3162,  3065,  2971,  2879,  2791,  2705,  2622,  2541,  2463,  2387,  2314,
+   2242,  2173,  2107,  2042,  1979,  1918,  1859,  1802,  1746,  1693,  1641,  1590,
+   1541,  1494,  1448,  1403,  1360,  1318,  1278,  1238,  1200,  1163,  1128,  1093,
+   1059,  1027,   995,   964,   935,   906,   878,   851,   825,   800,   775,   751,
+    728,   706,   684,   663,   642,   623,   604,   585,   567,   550,   533,   516,
+    500,   485,   470,   456,   442,   428,   415,   402,   390,   378,   366,   355,
+    344,   333,   323,   313,   303,   294,   285,   276,   268,   260,   252,   244,
+    236,   229,   222,   215,   209,   202,   196,   190,   184,   178,   173,   168,
+    162,   157,   153,   148,   143,   139,   135,   131,   127,   123,   119,   115,
+    112,   108,   105,   102,    99,    95,    93,    90,    87,    84,    82,    79,
+     77,    74,    72,    70,    68,    66,    64,    62,    60,    58,    56,    54,
+     53,    51,    50,    48,    47,    45,    44,    42,    41,    40,    39,    37,
+     36,    35,    34,    33,    32,    31,    30,    29,    28,    27,    27,    26,
+     25,    24,    23,    23,    22
+};
+
+// 1D gradients, the slope of the noise at each lattice point
+static const int8_t noise_grad1[16] = {
+  1, 2, 3, 4, 5, 6, 7, 8, -1, -2, -3, -4, -5, -6, -7, -8
+};
+
+// Sine ----------------------------------------------------------------------
+
+// sin(phase) in Q16, |error| < 0.0002
+static inline int32_t proc_sin(uint32_t phase) {
+  uint32_t index = phase >> 24;
+  int32_t a = proc_sin_table[index];
+  int32_t b = proc_sin_table[index + 1];
+  int32_t frac = (phase >> 8) & 0xFFFF;
+  return (a + (((b - a) * frac) >> 16)) * 2;  // Q15 to Q16
+}
+
+static inline int32_t proc_cos(uint32_t phase) {
+  return proc_sin(phase + PROC_PHASE_QUARTER);
+}
+
+// Radians to phase. Float is fine for per-frame constants, not per pixel.
+static inline uint32_t proc_phase(float radians) {
+  return uint32_t(int64_t(radians * PROC_PHASE_PER_RAD));
+}
+
+// Q16 radians (SQ15x16::getInternal()) to phase
+static inline uint32_t proc_phase_q16(int32_t radians_q16) {
+  return uint32_t((int64_t(radians_q16) * 683565276) >> 16);
+}
+
+// out[i] = sin(phase0 + i * step) in Q16
+static inline void proc_sin_row(int32_t* out, uint32_t phase0, uint32_t step, uint16_t count) {
+  uint32_t phase = phase0;
+  for (uint16_t i = 0; i < count; i++) {
+    out[i] = proc_sin(phase);
+    phase += step;
+  }
+}
+
+// Exponential ---------------------------------------------------------------
+
+// exp(-x) in Q16 for x in Q16, 0 past x = 8
+static inline int32_t proc_exp_neg(int32_t x_q16) {
+  if (x_q16 <= 0) {
+    return 65535;
+  }
+  if (x_q16 >= (8 << 16)) {
+    return 0;
+  }
+  uint32_t index = uint32_t(x_q16) >> 11;
+  int32_t a = proc_exp_table[index];
+  int32_t b = proc_exp_table[index + 1];
+  int32_t frac = (x_q16 & 0x7FF) << 5;
+  return a + (((b - a) * frac) >> 16);
+}
+
+// Power ---------------------------------------------------------------------
+
+// x^0.8 in Q16 for x in Q16, 1.0 past x = 1. Within 0.003, the steepest
+// stretch is the first step off zero
+static inline int32_t proc_pow_0_8(int32_t x_q16) {
+  if (x_q16 <= 0) {
+    return 0;
+  }
+  if (x_q16 >= (1 << 16)) {
+    return 65535;
+  }
+  uint32_t index = uint32_t(x_q16) >> 10;
+  int32_t a = proc_pow_0_8_table[index];
+  int32_t b = proc_pow_0_8_table[index + 1];
+  int32_t frac = (x_q16 & 0x3FF) << 6;
+  return a + (((b - a) * frac) >> 16);
+}
+
+// RNG -----------------------------------------------------------------------
+
+// Marsaglia xorshift32, a few cycles per draw and reproducible from a seed
+struct ProcRng {
+  uint32_t state;
+};
+
+static inline void proc_seed(ProcRng& rng, uint32_t seed) {
+  rng.state = (seed != 0) ? seed : 0x9E3779B9u;  // Zero would stick at zero
+}
+
+static inline uint32_t proc_rand(ProcRng& rng) {
+  uint32_t x = rng.state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rng.state = x;
+  return x;
+}
+
+// 0 .. n-1, without the bias or the divide of a modulo
+static inline uint32_t proc_rand_below(ProcRng& rng, uint32_t n) {
+  return uint32_t((uint64_t(proc_rand(rng)) * n) >> 32);
+}
+
+// 0.0 .. 1.0 (exclusive) in Q16
+static inline int32_t proc_rand_q16(ProcRng& rng) {
+  return int32_t(proc_rand(rng) >> 16);
+}
+
+// 0.0 .. 1.0 (exclusive)
+static inline float proc_rand_float(ProcRng& rng) {
+  return float(proc_rand(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Noise ---------------------------------------------------------------------
+
+static inline int32_t noise_fade(uint32_t t_q16) {
+  uint32_t index = t_q16 >> 8;
+  int32_t a = noise_fade_table[index];
+  int32_t b = noise_fade_table[index + 1];
+  return a + (((b - a) * int32_t(t_q16 & 0xFF)) >> 8);
+}
+
+static inline int16_t noise_clamp_q15(int32_t n) {
+  if (n > 32767) { return 32767; }
+  if (n < -32767) { return -32767; }
+  return int16_t(n);
+}
+
+// 1D blend of the two lattice slopes around «xf» (Q16), result in Q15
+static inline int16_t noise1_cell(int32_t g0, int32_t g1, uint32_t xf) {
+  int32_t d0 = g0 * int32_t(xf);
+  int32_t d1 = g1 * (int32_t(xf) - 65536);
+  int32_t n = d0 + int32_t((int64_t(d1 - d0) * noise_fade(xf)) >> 16);
+  return noise_clamp_q15(n >> 3);  // Slopes run to 8, the peak is 4.0 in Q16
+}
+
+static inline int32_t noise_grad1_at(uint32_t cell) {
+  return noise_grad1[noise_perm[cell & 0xFF] & 15];
+}
+
+static inline int16_t noise1(uint32_t x) {
+  uint32_t cell = x >> 16;
+  return noise1_cell(noise_grad1_at(cell), noise_grad1_at(cell + 1), x & 0xFFFF);
+}
+
+// out[i] = noise1(x0 + i * dx)
+static inline void noise1_row(int16_t* out, uint32_t x0, uint32_t dx, uint16_t count) {
+  uint32_t x = x0;
+  uint32_t cell = (x >> 16) + 1;  // Anything but the first cell
+  int32_t g0 = 0;
+  int32_t g1 = 0;
+
+  for (uint16_t i = 0; i < count; i++) {
+    if ((x >> 16) != cell) {
+      cell = x >> 16;
+      g0 = noise_grad1_at(cell);
+      g1 = noise_grad1_at(cell + 1);
+    }
+    out[i] = noise1_cell(g0, g1, x & 0xFFFF);
+    x += dx;
+  }
+}
+
+// out[i] = noise1(xs[i] * x_mul + x_offset), for coordinates that aren't
+// evenly spaced. Consecutive pixels in the same cell share the hashes.
+static inline void noise1_row_at(int16_t* out, const uint32_t* xs, uint32_t x_mul, uint32_t x_offset, uint16_t count) {
+  uint32_t cell = ((xs[0] * x_mul + x_offset) >> 16) + 1;
+  int32_t g0 = 0;
+  int32_t g1 = 0;
+
+  for (uint16_t i = 0; i < count; i++) {
+    uint32_t x = xs[i] * x_mul + x_offset;
+    if ((x >> 16) != cell) {
+      cell = x >> 16;
+      g0 = noise_grad1_at(cell);
+      g1 = noise_grad1_at(cell + 1);
+    }
+    out[i] = noise1_cell(g0, g1, x & 0xFFFF);
+  }
+}
+
+// Dot product of one of 8 gradients (4 axes, 4 diagonals) with (x, y)
+static inline int32_t noise_grad2(uint8_t hash, int32_t x, int32_t y) {
+  switch (hash & 7) {
+    case 0:  return  x + y;
+    case 1:  return -x + y;
+    case 2:  return  x - y;
+    case 3:  return -x - y;
+    case 4:  return  x;
+    case 5:  return -x;
+    case 6:  return  y;
+    default: return -y;
+  }
+}
+
+static inline int32_t noise_lerp_q16(int32_t a, int32_t b, int32_t t_q16) {
+  return a + int32_t((int64_t(b - a) * t_q16) >> 16);
+}
+
+// The four corner hashes of the cell at («xi», «yi»)
+struct Noise2Cell {
+  uint8_t h00, h10, h01, h11;
+};
+
+static inline Noise2Cell noise2_hash(uint32_t xi, uint32_t yi) {
+  uint8_t a = noise_perm[xi & 0xFF];
+  uint8_t b = noise_perm[(xi + 1) & 0xFF];
+  Noise2Cell c;
+  c.h00 = noise_perm[(a + yi) & 0xFF];
+  c.h01 = noise_perm[(a + yi + 1) & 0xFF];
+  c.h10 = noise_perm[(b + yi) & 0xFF];
+  c.h11 = noise_perm[(b + yi + 1) & 0xFF];
+  return c;
+}
+
+static inline int16_t noise2_cell(const Noise2Cell& c, int32_t xf, int32_t yf, int32_t v) {
+  int32_t u = noise_fade(uint32_t(xf));
+  int32_t n0 = noise_lerp_q16(noise_grad2(c.h00, xf, yf), noise_grad2(c.h10, xf - 65536, yf), u);
+  int32_t n1 = noise_lerp_q16(noise_grad2(c.h01, xf, yf - 65536), noise_grad2(c.h11, xf - 65536, yf - 65536), u);
+  return noise_clamp_q15(noise_lerp_q16(n0, n1, v) >> 1);  // Peaks near 1.0 in Q16
+}
+
+static inline int16_t noise2(uint32_t x, uint32_t y) {
+  int32_t yf = int32_t(y & 0xFFFF);
+  return noise2_cell(noise2_hash(x >> 16, y >> 16), int32_t(x & 0xFFFF), yf, noise_fade(uint32_t(yf)));
+}
+
+// out[i] = noise2(x0 + i * dx, y), one row of a 2D field or one frame of
+// a 1D strip moving through time along y
+static inline void noise2_row(int16_t* out, uint32_t x0, uint32_t dx, uint32_t y, uint16_t count) {
+  uint32_t yi = y >> 16;
+  int32_t yf = int32_t(y & 0xFFFF);
+  int32_t v = noise_fade(uint32_t(yf));
+
+  uint32_t x = x0;
+  uint32_t cell = (x >> 16) + 1;
+  Noise2Cell c = noise2_hash(cell, yi);
+
+  for (uint16_t i = 0; i < count; i++) {
+    if ((x >> 16) != cell) {
+      cell = x >> 16;
+      c = noise2_hash(cell, yi);
+    }
+    out[i] = noise2_cell(c, int32_t(x & 0xFFFF), yf, v);
+    x += dx;
+  }
+}
+
+#endif
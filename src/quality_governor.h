@@ -0,0 +1,126 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+/*----------------------------------------
+  Sensory Bridge QUALITY GOVERNOR
+  ----------------------------------------*/
+
+// Heavy modes, prism passes and the secondary strip can push a frame past
+// its budget (see TARGET_AUDIO_FPS / TARGET_LED_FPS in the regression
+// suite). The governor watches the audio and LED frame times and steps
+// down one quality level at a time until both fit again, then steps back
+// up once there's comfortable headroom (quality_hysteresis.h). Every level
+// change is reported over serial as "sbs((quality=...))".
+
+#include <Arduino.h>
+#include "globals.h"
+#include "quality_hysteresis.h"
+
+enum quality_levels {
+  QUALITY_FULL,             // Everything as configured
+  QUALITY_NO_DITHER,        // Temporal dithering off
+  QUALITY_PRISM_REDUCED,    // At most one prism pass
+  QUALITY_PRISM_OFF,        // No prism passes
+  QUALITY_HALF_RESOLUTION,  // Render at half the boot resolution and scale up
+  QUALITY_GDFT_INTERLACED,  // Long-window GDFT bins alternate frames
+
+  NUM_QUALITY_LEVELS
+};
+
+const char* quality_level_names[NUM_QUALITY_LEVELS] = {
+  "full",
+  "no_dither",
+  "prism_reduced",
+  "prism_off",
+  "half_resolution",
+  "gdft_interlaced",
+};
+
+// Frame budgets, in microseconds
+#define QUALITY_AUDIO_BUDGET_US (1000000 / 120)  // 120 FPS audio
+#define QUALITY_LED_BUDGET_US   (1000000 / 60)   // 60 FPS LEDs
+
+#define GDFT_INTERLACE_BINS (NUM_FREQS / 2)  // Lowest bins have the longest Goertzel windows
+
+QualityHysteresis<NUM_QUALITY_LEVELS> quality_governor(QUALITY_AUDIO_BUDGET_US, QUALITY_LED_BUDGET_US);
+bool quality_auto = true;  // false = level locked from the serial menu
+
+volatile uint32_t quality_audio_frame_us = 0;  // Written on core 0, GDFT and feature work only
+uint32_t quality_led_frame_us = 0;             // Written on core 1
+
+bool quality_report_pending = false;
+
+// Queries used by the pipeline -------------------------------------------
+
+inline bool quality_allows_dithering() {
+  return quality_governor.level() < QUALITY_NO_DITHER;
+}
+
+inline float quality_prism_count(float configured) {
+  if (quality_governor.level() >= QUALITY_PRISM_OFF) {
+    return 0.0;
+  } else if (quality_governor.level() >= QUALITY_PRISM_REDUCED && configured > 1.0) {
+    return 1.0;
+  }
+  return configured;
+}
+
+// Pixels to render this frame, given the resolution chosen at boot
+inline uint16_t quality_render_resolution(uint16_t base) {
+  if (quality_governor.level() >= QUALITY_HALF_RESOLUTION && (base / 2) >= MIN_RENDER_RESOLUTION) {
+    return (base / 2) & ~1;  // Modes mirror around the center, keep it even
+  }
+  return base;
+}
+
+inline bool quality_gdft_interlaced() {
+  return quality_governor.level() >= QUALITY_GDFT_INTERLACED;
+}
+
+// Frame time reports -------------------------------------------------------
+
+void quality_report_audio_frame(uint32_t frame_us) {
+  quality_audio_frame_us = frame_us;
+}
+
+void quality_report_led_frame(uint32_t frame_us) {
+  quality_led_frame_us = frame_us;
+}
+
+void set_quality_level(uint8_t new_level) {
+  if (quality_governor.set(new_level)) {
+    quality_report_pending = true;
+  }
+}
+
+void print_quality_status() {
+  USBSerial.print("sbs((quality=");
+  USBSerial.print(quality_governor.level());
+  USBSerial.print(",name=");
+  USBSerial.print(quality_level_names[quality_governor.level()]);
+  USBSerial.print(",auto=");
+  USBSerial.print(quality_auto);
+  USBSerial.print(",audio_us=");
+  USBSerial.print(uint32_t(quality_governor.audio_avg_us()));
+  USBSerial.print(",led_us=");
+  USBSerial.print(uint32_t(quality_governor.led_avg_us()));
+  USBSerial.print(",changes=");
+  USBSerial.print(quality_governor.changes());
+  USBSerial.println("))");
+}
+
+// Called once per LED frame (core 1), after quality_report_led_frame()
+void update_quality_governor() {
+  if (quality_governor.update(quality_audio_frame_us, quality_led_frame_us, quality_auto)) {
+    quality_report_pending = true;
+  }
+
+  // Never block the LED thread on the serial port, just try again next frame
+  if (quality_report_pending && xSemaphoreTake(serial_mutex, 0) == pdTRUE) {
+    print_quality_status();
+    xSemaphoreGive(serial_mutex);
+    quality_report_pending = false;
+  }
+}
+
+#endif // QUALITY_GOVERNOR_H
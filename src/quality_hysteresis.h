@@ -0,0 +1,94 @@
+#ifndef QUALITY_HYSTERESIS_H
+#define QUALITY_HYSTERESIS_H
+
+/*----------------------------------------
+  Sensory Bridge QUALITY HYSTERESIS
+  ----------------------------------------*/
+
+// When the quality governor (quality_governor.h) moves between levels.
+// update() takes one LED frame's audio and LED frame times and smooths
+// them. After QUALITY_DEGRADE_FRAMES over either budget it steps down a
+// level, and after QUALITY_RECOVER_FRAMES with both under
+// QUALITY_RECOVER_RATIO of their budgets it steps back up. In between it
+// holds.
+//
+// The audio frame time has to be the work the frame does, not the wait
+// for the next I2S chunk, or it never gets under the recovery ratio.
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+
+// Degrade quickly, recover slowly, and only with real headroom
+#define QUALITY_DEGRADE_FRAMES 30    // ~0.5s over budget before stepping down
+#define QUALITY_RECOVER_FRAMES 180   // ~3s under the recovery ratio before stepping up
+#define QUALITY_RECOVER_RATIO  0.70  // Step up only below 70% of the budget
+
+template <uint8_t LEVELS>
+class QualityHysteresis {
+ public:
+  QualityHysteresis(uint32_t audio_budget_us, uint32_t led_budget_us)
+      : audio_budget(audio_budget_us), led_budget(led_budget_us), current(0), audio_avg(0.0f), led_avg(0.0f),
+        over_count(0), under_count(0), level_changes(0) {}
+
+  // One LED frame. Steps only when «automatic», the averages are kept
+  // either way. True when the level changed
+  bool update(uint32_t audio_frame_us, uint32_t led_frame_us, bool automatic) {
+    audio_avg = audio_avg * 0.9f + audio_frame_us * 0.1f;
+    led_avg = led_avg * 0.9f + led_frame_us * 0.1f;
+    if (automatic == false) {
+      return false;
+    }
+
+    bool over_budget = (audio_avg > audio_budget) || (led_avg > led_budget);
+    bool headroom = (audio_avg < audio_budget * QUALITY_RECOVER_RATIO) && (led_avg < led_budget * QUALITY_RECOVER_RATIO);
+
+    if (over_budget) {
+      under_count = 0;
+      if (++over_count >= QUALITY_DEGRADE_FRAMES && current < LEVELS - 1) {
+        return set(current + 1);
+      }
+    } else if (headroom) {
+      over_count = 0;
+      if (++under_count >= QUALITY_RECOVER_FRAMES && current > 0) {
+        return set(current - 1);
+      }
+    } else {  // Inside the hysteresis band, hold
+      over_count = 0;
+      under_count = 0;
+    }
+    return false;
+  }
+
+  // Go to «new_level» (clamped) and start counting again. True when it changed
+  bool set(uint8_t new_level) {
+    if (new_level >= LEVELS) {
+      new_level = LEVELS - 1;
+    }
+    over_count = 0;
+    under_count = 0;
+    if (new_level == current) {
+      return false;
+    }
+    current = new_level;
+    level_changes++;
+    return true;
+  }
+
+  uint8_t level() const { return current; }
+  float audio_avg_us() const { return audio_avg; }
+  float led_avg_us() const { return led_avg; }
+  uint32_t changes() const { return level_changes; }
+
+ private:
+  uint32_t audio_budget;
+  uint32_t led_budget;
+  uint8_t current;
+  float audio_avg;
+  float led_avg;
+  uint16_t over_count;
+  uint16_t under_count;
+  uint32_t level_changes;
+};
+
+#endif // QUALITY_HYSTERESIS_H
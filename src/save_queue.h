@@ -0,0 +1,145 @@
+#ifndef SAVE_QUEUE_H
+#define SAVE_QUEUE_H
+
+/*----------------------------------------
+  Sensory Bridge SAVE QUEUE
+  ----------------------------------------*/
+
+// Hands snapshots of what needs saving (CONFIG, the noise profile) from
+// the audio and LED paths to the one task that writes flash (bridge_fs.h),
+// so neither ever waits on a write.
+//
+// Each kind of save has a slot with two buffers of its own. post() copies
+// the caller's data into the slot's «posted» buffer and returns: that copy
+// is the snapshot, the caller can change its data right away. take(), in
+// the writer, copies the oldest pending snapshot into the slot's «writing»
+// buffer and hands that over, so the next post() can land while the write
+// is still going.
+//
+// A slot is queued at most once. Posting it again before the writer got to
+// it only replaces the snapshot, so a burst of saves is one write of the
+// last one. Posting NULL queues an erase, which a later post() replaces
+// like any other snapshot.
+//
+// Copies are done under «Lock» (lock()/unlock()), a spinlock on the device,
+// held just for the memcpy. Only one task may take().
+//
+// Nothing in here depends on Arduino, test/host builds it as is.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+struct SaveSlot {
+  void* posted;   // Latest snapshot, written by post()
+  void* writing;  // What the writer is working from
+  uint16_t size;
+  bool pending;
+  bool erase;     // The pending snapshot is an erase
+};
+
+struct SaveQueueStats {
+  uint32_t posted;
+  uint32_t coalesced;  // Posts that replaced a snapshot still waiting
+  uint32_t written;
+  uint32_t failed;
+  uint32_t last_us;    // Write latency, measured by the writer
+  uint32_t max_us;
+  uint8_t max_depth;
+};
+
+template <size_t SLOTS, typename Lock>
+class SaveQueue {
+ public:
+  SaveQueue() : slots(), order(), head(0), count(0), busy(false), queue_stats() {}
+
+  // Both buffers are «size» bytes and stay owned by the caller
+  bool add_slot(uint8_t kind, void* posted, void* writing, uint16_t size) {
+    if (kind >= SLOTS || posted == NULL || writing == NULL) {
+      return false;
+    }
+    slots[kind] = { posted, writing, size, false, false };
+    return true;
+  }
+
+  // Copy «data» (NULL for an erase) and queue it, false for an unknown slot
+  bool post(uint8_t kind, const void* data) {
+    if (kind >= SLOTS || slots[kind].posted == NULL) {
+      return false;
+    }
+    SaveSlot& slot = slots[kind];
+    lock.lock();
+    if (data != NULL) {
+      memcpy(slot.posted, data, slot.size);
+    }
+    slot.erase = (data == NULL);
+    queue_stats.posted++;
+    if (slot.pending) {
+      queue_stats.coalesced++;
+    } else {
+      slot.pending = true;
+      order[(head + count) % SLOTS] = kind;
+      count++;
+      if (count > queue_stats.max_depth) {
+        queue_stats.max_depth = count;
+      }
+    }
+    lock.unlock();
+    return true;
+  }
+
+  // Writer only. The oldest pending slot, with «data» pointing at its
+  // snapshot (NULL for an erase) until done()
+  bool take(uint8_t& kind, const void*& data) {
+    lock.lock();
+    if (count == 0) {
+      lock.unlock();
+      return false;
+    }
+    kind = order[head];
+    head = (head + 1) % SLOTS;
+    count--;
+
+    SaveSlot& slot = slots[kind];
+    slot.pending = false;
+    data = NULL;
+    if (slot.erase == false) {
+      memcpy(slot.writing, slot.posted, slot.size);
+      data = slot.writing;
+    }
+    busy = true;
+    lock.unlock();
+    return true;
+  }
+
+  // Writer only, after the write take() handed over
+  void done(bool ok, uint32_t us) {
+    lock.lock();
+    if (ok) {
+      queue_stats.written++;
+    } else {
+      queue_stats.failed++;
+    }
+    queue_stats.last_us = us;
+    if (us > queue_stats.max_us) {
+      queue_stats.max_us = us;
+    }
+    busy = false;
+    lock.unlock();
+  }
+
+  uint8_t depth() const { return count; }
+  bool idle() const { return count == 0 && busy == false; }  // Everything posted is on flash (or failed)
+  const SaveQueueStats& stats() const { return queue_stats; }
+
+ private:
+  Lock lock;
+  SaveSlot slots[SLOTS];
+  uint8_t order[SLOTS];  // Pending slots, oldest first
+  uint8_t head;
+  volatile uint8_t count;
+  volatile bool busy;
+  SaveQueueStats queue_stats;
+};
+
+#endif // SAVE_QUEUE_H
@@ -7,6 +7,9 @@
 
 extern void check_current_function();  // system.h
 extern void reboot();                  // system.h
+extern void print_derived_tables();    // system.h
+
+#include "command_table.h"
 
 #ifdef ENABLE_PERFORMANCE_MONITORING
 #include "debug/performance_monitor.h"
@@ -40,7 +43,7 @@ void ack() {
   USBSerial.println("SBOK");
 }
 
-void bad_command(char* command_type, char* command_data) {
+void bad_command(const char* command_type, const char* command_data) {
   tx_begin(true);
   USBSerial.print("Bad command: ");
   USBSerial.print(command_type);
@@ -158,6 +161,12 @@ void dump_info() {
   USBSerial.print("CONFIG.LED_COLOR_ORDER: ");
   USBSerial.println(CONFIG.LED_COLOR_ORDER);
 
+  USBSerial.print("CONFIG.RENDER_MODE: ");
+  USBSerial.println(CONFIG.RENDER_MODE);
+
+  USBSerial.print("CONFIG.MODE_FADE_MS: ");
+  USBSerial.println(CONFIG.MODE_FADE_MS);
+
   USBSerial.print("CONFIG.SAMPLES_PER_CHUNK: ");
   USBSerial.println(CONFIG.SAMPLES_PER_CHUNK);
 
@@ -268,1422 +277,1459 @@ void dump_info() {
 }
 
 // This parses a completed command to decide how to handle it
-void parse_command(char* command_buf) {
-
-  // COMMANDS WITHOUT METADATA ###############################
-
-  // Get firmware version -----------------------------------
-  if (strcmp(command_buf, "v") == 0 || strcmp(command_buf, "V") == 0 || strcmp(command_buf, "version") == 0) {
-
-    tx_begin();
-    USBSerial.print("VERSION: ");
-    USBSerial.println(FIRMWARE_VERSION);
-    tx_end();
-
+// COMMAND TABLE ############################################
+
+// Every command is one row of serial_commands[] below: its name, the
+// handler that runs it and, for settings, the field it writes, the range
+// the value is clamped to and what has to happen after a change. Settings
+// share the generic handlers (set_number, set_toggle, set_choice), anything
+// else has a handler of its own. parse_command() finds the row through a
+// perfect hash built at compile time (command_table.h), one probe per
+// command however long the table gets.
+
+struct SerialCommand;
+typedef void (*SerialCommandHandler)(const SerialCommand& command, char* data);
+
+enum SerialCommandFlags : uint8_t {
+  CMD_BARE     = 1 << 0,  // Takes no "=value"
+  CMD_VALUE    = 1 << 1,  // Needs "=value" (neither flag: either way)
+  CMD_SAVE     = 1 << 2,  // save_config_delayed() after a change
+  CMD_SAVE_NOW = 1 << 3,  // save_config() after a change
+  CMD_REBOOT   = 1 << 4,  // Only read at boot: save_config() and reboot after a change
+  CMD_WHOLE    = 1 << 5,  // Drop the fraction of a float setting
+  CMD_FINE     = 1 << 6,  // Print a float setting with 6 decimals
+};
+
+struct SerialChoice {
+  const char* name;
+  int32_t value;
+};
+
+struct SerialCommand {
+  const char* name;
+  SerialCommandHandler handler;
+  uint8_t flags;
+  void* target;                // Field a generic setter writes
+  const char* label;           // Printed with the new value
+  double min;                  // set_number() clamps to [min, max]
+  double max;
+  const SerialChoice* choices; // set_choice() options, ending with a NULL name
+  void (*apply)();             // Runs once a generic setter has changed its field
+};
+
+// The CONFIG_DEFAULTS field matching «command.target», NULL if it isn't in CONFIG
+const void* command_default(const SerialCommand& command) {
+  const uint8_t* field = (const uint8_t*)command.target;
+  const uint8_t* config = (const uint8_t*)&CONFIG;
+  if (field < config || field >= config + sizeof(CONFIG)) {
+    return NULL;
   }
+  return (const uint8_t*)&CONFIG_DEFAULTS + (field - config);
+}
 
-  // Print help ---------------------------------------------
-  else if (strcmp(command_buf, "h") == 0 || strcmp(command_buf, "H") == 0 || strcmp(command_buf, "help") == 0) {
-
-    tx_begin();
-    USBSerial.println("SENSORY BRIDGE - Serial Menu ------------------------------------------------------------------------------------");
-    USBSerial.println();
-    USBSerial.println("                                            v | Print firmware version number");
-    USBSerial.println("                                        reset | Reboot Sensory Bridge");
-    USBSerial.println("                                factory_reset | Delete configuration, including noise cal, reboot");
-    USBSerial.println("                             restore_defaults | Delete configuration, reboot");
-    USBSerial.println("                                get_main_unit | Print if this unit is set to MAIN for SensorySync");
-    USBSerial.println("                                         dump | Print tons of useful variables in realtime");
-    USBSerial.println("                                         stop | Stops the output of any enabled streams");
-    USBSerial.println("                                          fps | Return the system FPS");
-    USBSerial.println("                                      led_fps | Return the LED FPS");
-    USBSerial.println("                                  audio_guard | Display audio guard protection status");
-    USBSerial.println("                                      chip_id | Return the chip id (MAC) of the CPU");
-    USBSerial.println("                                     get_mode | Get lightshow mode's ID (index)");
-    USBSerial.println("                                get_num_modes | Return the number of modes available");
-    USBSerial.println("                              start_noise_cal | Remotely begin a noise calibration");
-    USBSerial.println("                              clear_noise_cal | Remotely clear the stored noise calibration");
-    USBSerial.println("                             start_benchmark | Start a timed benchmark (calculates avg FPS)");
-    USBSerial.println("                               set_mode=[int] | Set the mode number");
-    USBSerial.println("          mirror_enabled=[true/false/default] | Remotely toggle lightshow mirroring");
-    USBSerial.println("           reverse_order=[true/false/default] | Toggle whether image is flipped upside down before final rendering");
-    USBSerial.println("                          get_mode_name=[int] | Get a mode's name by ID (index)");
-    USBSerial.println("                                stream=[type] | Stream live data to a Serial Plotter.");
-    USBSerial.println("                                                Options are: audio, fps, magnitudes, spectrogram, chromagram");
-    USBSerial.println("led_type=['neopixel'/'neopixel_x2'/'dotstar'] | Sets which LED protocol to use, 3 wire, 4 wire, or dual-data mode");
-    USBSerial.println("                 led_count=[int or 'default'] | Sets how many LEDs your display will use (native resolution is 128)");
-    USBSerial.println("        led_color_order=[GRB/RGB/BGR/default] | Sets LED color ordering, default GRB");
-    USBSerial.println("       led_interpolation=[true/false/default] | Toggles linear LED interpolation when running in a non-native resolution (slower)");
-    USBSerial.println("                           debug=[true/false] | Enables debug mode, where functions are timed");
-    USBSerial.println("                sample_rate=[hz or 'default'] | Sets the microphone sample rate");
-    USBSerial.println("              note_offset=[0-32 or 'default'] | Sets the lowest note, as a positive offset from A1 (55.0Hz)");
-    USBSerial.println("               square_iter=[int or 'default'] | Sets the number of times the LED output is squared (contrast)");
-    USBSerial.println("         samples_per_chunk=[int or 'default'] | Sets the number of samples collected every frame");
-    USBSerial.println("             sensitivity=[float or 'default'] | Sets the scaling of audio data (>1.0 is more sensitive, <1.0 is less sensitive)");
-    USBSerial.println("          boot_animation=[true/false/default] | Enable or disable the boot animation");
-    USBSerial.println("                   set_main_unit=[true/false] | Sets if this unit is MAIN or not for SensorySync");
-    USBSerial.println("            sweet_spot_min=[int or 'default'] | Sets the minimum amplitude to be inside the 'Sweet Spot'");
-    USBSerial.println("            sweet_spot_max=[int or 'default'] | Sets the maximum amplitude to be inside the 'Sweet Spot'");
-    USBSerial.println("         chromagram_range=[1-64 or 'default'] | Range between 1 and 64, how many notes at the bottom of the");
-    USBSerial.println("                                                spectrogram should be considered in chromagram sums");
-    USBSerial.println("         standby_dimming=[true/false/default] | Toggle dimming during detected silence");
-    USBSerial.println("                       bass_mode=[true/false] | Toggle bass-mode, which alters note_offset and chromagram_range for bass-y tunes");
-    USBSerial.println("            max_current_ma=[int or 'default'] | Sets the maximum current FastLED will attempt to limit the LED consumption to");
-    USBSerial.println("      temporal_dithering=[true/false/default] | Toggle per-LED temporal dithering that simulates higher bit-depths");
-    USBSerial.println("        auto_color_shift=[true/false/default] | Toggle automated color shifting based on positive spectral changes");
-    USBSerial.println("     incandescent_filter=[float or 'default'] | Set the intensity of the incandescent LUT (reduces harsh blues)");
-    USBSerial.println("       incandescent_mode=[true/false/default] | Force all output into monochrome and tint with 2700K incandescent color");
-    USBSerial.println("               base_coat=[true/false/default] | Enable a dim gray backdrop to the LEDs (approves appearance in most modes)");
-    USBSerial.println("            bulb_opacity=[float or 'default'] | Set opacity of a filter that portrays the output as 32 \"bulbs\" with separation and hot spots");
-    USBSerial.println("              saturation=[float or 'default'] | Sets the saturation of internal hues");
-    USBSerial.println("               prism_count=[int or 'default'] | Sets the number of times the \"prism\" effect is applied");
-    USBSerial.println("                         preset=[preset_name] | Sets multiple configuration options at once to match a preset theme");
-    USBSerial.println();
-    USBSerial.println("                         -- SECONDARY LED STRIP CONTROL --");
-    USBSerial.println("         secondary_enabled=[true/false] | Enable or disable the secondary LED strip");
-    USBSerial.println("                  secondary_mode=[0-7] | Set mode for secondary LED strip");
-    USBSerial.println("              secondary_photons=[0-1.0] | Set brightness for secondary LED strip");
-    USBSerial.println("               secondary_chroma=[0-1.0] | Set chroma value for secondary LED strip");
-    USBSerial.println("                 secondary_mood=[0-1.0] | Set mood value for secondary LED strip");
-    USBSerial.println("            secondary_saturation=[0-1.0] | Set saturation for secondary LED strip");
-    USBSerial.println("          secondary_prism_count=[0-10] | Set prism count for secondary LED strip");
-    USBSerial.println("   secondary_mirror_enabled=[true/false] | Toggle mirroring on secondary LED strip");
-    USBSerial.println("    secondary_reverse_order=[true/false] | Toggle image flipping on secondary LED strip");
-    USBSerial.println("              secondary_base_coat=[true/false] | Enable dim backdrop on secondary LED strip");
-    USBSerial.println("                  secondary_status | Display current status of secondary LED strip");
-#ifdef ENABLE_PERFORMANCE_MONITORING
-    USBSerial.println();
-    USBSerial.println("                         -- PERFORMANCE MONITORING (96-BIN TEST) --");
-    USBSerial.println("                                         PERF | Show detailed performance report");
-    USBSerial.println("                                   PERF LOG ON|OFF | Toggle periodic PERF summary");
-    USBSerial.println("                                 PERF FREQ ON|OFF | Toggle freq spectrum logging");
-    USBSerial.println("                                   PERF SWEEP | Run frequency sweep test");
-    USBSerial.println("                                  PERF STRESS | Run 60-second stress test");
-    USBSerial.println("                                   PERF RESET | Reset performance metrics");
-#endif
-    tx_end(); 
+// Where a setter writes: its target, or the staged copy of it while a
+// transaction is open (config_transaction.h). NULL if it can't be staged.
+void* command_field(const SerialCommand& command) {
+  if (config_transaction_open == false) {
+    return command.target;
   }
-
-  // So that software can automatically identify this device -
-  else if (strcmp(command_buf, "SB?") == 0) {
-
-    USBSerial.println("SB!");
-
+  uint8_t field = config_field_at(CONFIG, command.target);  // (config_fields.h)
+  if (field == NUM_CONFIG_FIELDS) {
+    tx_begin(true);
+    USBSerial.print(command.name);
+    USBSerial.println(" isn't part of CONFIG, commit or abort first");
+    tx_end(true);
+    return NULL;
   }
+  return config_field_ptr(config_shadow, field);
+}
 
-  // Reset the micro ----------------------------------------
-  else if (strcmp(command_buf, "reset") == 0) {
+// Side effects of a CONFIG edit before its reply: merged into the open
+// transaction, or run right away
+void config_edit_effects(uint8_t flags, void (*apply)()) {
+  if (config_transaction_open) {
+    if (stage_config_effects(flags & (CMD_SAVE_NOW | CMD_REBOOT), flags & CMD_REBOOT, apply) == false) {  // (config_transaction.h)
+      tx_begin(true);
+      USBSerial.println("Too many apply hooks in this batch, commit will be refused");
+      tx_end(true);
+    }
+    return;
+  }
+  if (apply != NULL) {
+    apply();
+  }
+  if (flags & (CMD_SAVE_NOW | CMD_REBOOT)) {
+    save_config();
+  } else if (flags & CMD_SAVE) {
+    save_config_delayed();
+  }
+}
 
-    ack();
+// After the reply: settings only read at boot save and reboot now
+void config_edit_done(uint8_t flags) {
+  if (config_transaction_open == false && (flags & CMD_REBOOT)) {
+    do_config_save();  // (bridge_fs.h) Otherwise the save would wait for a main loop that never comes
     reboot();
-
   }
+}
 
-  // Clear configs and reset micro --------------------------
-  else if (strcmp(command_buf, "factory_reset") == 0) {
-
-    ack();
-    factory_reset();
-
+// "STAGED " in front of replies to edits that went into a transaction
+void print_staged() {
+  if (config_transaction_open) {
+    USBSerial.print("STAGED ");
   }
+}
 
-  // Clear configs and reset micro --------------------------
-  else if (strcmp(command_buf, "restore_defaults") == 0) {
+void print_command_value(const SerialCommand& command, float value) {
+  USBSerial.println(value, (command.flags & CMD_FINE) ? 6 : 2);
+}
 
-    ack();
-    restore_defaults();
+template <class T>
+void print_command_value(const SerialCommand& command, T value) {
+  USBSerial.println(value);
+}
 
-  }
+// After any generic setter has written its field
+template <class T>
+void finish_setting(const SerialCommand& command, T value) {
+  config_edit_effects(command.flags, command.apply);
 
-  // Return chip ID -----------------------------------------
-  else if (strcmp(command_buf, "chip_id") == 0) {
+  tx_begin();
+  print_staged();
+  USBSerial.print(command.label);
+  USBSerial.print(": ");
+  print_command_value(command, value);
+  tx_end();
 
-    tx_begin();
-    print_chip_id();
-    tx_end();
+  config_edit_done(command.flags);
+}
 
+// [number or 'default'], clamped to the row's range
+template <class T>
+void set_number(const SerialCommand& command, char* data) {
+  T* field = (T*)command_field(command);
+  const T* fallback = (const T*)command_default(command);
+  if (field == NULL) {
+    return;
   }
 
-  // Identify unit via 2 yellow flashes ---------------------
-  else if (strcmp(command_buf, "identify") == 0) {
-
-    ack();
-    CRGB16 col = {1.00, 0.25, 0.00};
-    blocking_flash(col);
-
+  if (fallback != NULL && strcmp(data, "default") == 0) {
+    *field = *fallback;
+  } else {
+    char* end = NULL;
+    double value = strtod(data, &end);
+    if (end == data || *end != '\0') {
+      bad_command(command.name, data);
+      return;
+    }
+    value = constrain(value, command.min, command.max);
+    if (command.flags & CMD_WHOLE) {
+      value = floor(value);
+    }
+    *field = T(value);
   }
 
-  // Clear configs and reset micro --------------------------
-  else if (strcmp(command_buf, "start_noise_cal") == 0) {
+  finish_setting(command, *field);
+}
 
-    ack();
-    noise_transition_queued = true;
+// [true/false/'default']
+void set_toggle(const SerialCommand& command, char* data) {
+  bool* field = (bool*)command_field(command);
+  const bool* fallback = (const bool*)command_default(command);
+  if (field == NULL) {
+    return;
+  }
 
+  if (strcmp(data, "true") == 0) {
+    *field = true;
+  } else if (strcmp(data, "false") == 0) {
+    *field = false;
+  } else if (fallback != NULL && strcmp(data, "default") == 0) {
+    *field = *fallback;
+  } else {
+    bad_command(command.name, data);
+    return;
   }
 
-  // Clear configs and reset micro --------------------------
-  else if (strcmp(command_buf, "clear_noise_cal") == 0) {
+  finish_setting(command, *field);
+}
 
-    ack();
-    clear_noise_cal();
+// [one of the row's choices or 'default']
+template <class T>
+void set_choice(const SerialCommand& command, char* data) {
+  T* field = (T*)command_field(command);
+  const T* fallback = (const T*)command_default(command);
+  if (field == NULL) {
+    return;
+  }
 
+  bool good = false;
+  if (fallback != NULL && strcmp(data, "default") == 0) {
+    *field = *fallback;
+    good = true;
   }
-  // Delete noise calibration file --------------------------
-  else if (strcmp(command_buf, "delete_noise_file") == 0) {
-    if (LittleFS.remove("/noise_cal.bin")) {
-      USBSerial.println("Noise calibration file deleted. Restart device for clean state.");
-    } else {
-      USBSerial.println("Failed to delete noise calibration file.");
+  for (const SerialChoice* choice = command.choices; choice->name != NULL && good == false; choice++) {
+    if (strcmp(data, choice->name) == 0) {
+      *field = T(choice->value);
+      good = true;
     }
   }
-  // Show current noise levels -------------------------------
-  else if (strcmp(command_buf, "show_noise_levels") == 0) {
-    USBSerial.println("Current noise calibration levels:");
-    for (uint8_t i = 0; i < NUM_FREQS; i += 8) {
-      USBSerial.printf("Freq[%d-%d]: %.2f %.2f %.2f %.2f %.2f %.2f %.2f %.2f\n", 
-                       i, i+7,
-                       float(noise_samples[i]), float(noise_samples[i+1]),
-                       float(noise_samples[i+2]), float(noise_samples[i+3]),
-                       float(noise_samples[i+4]), float(noise_samples[i+5]),
-                       float(noise_samples[i+6]), float(noise_samples[i+7]));
-    }
+  if (good == false) {
+    bad_command(command.name, data);
+    return;
   }
 
-  // Returns the number of modes available ------------------
-  else if (strcmp(command_buf, "get_num_modes") == 0) {
+  finish_setting(command, *field);
+}
 
-    tx_begin();
-    USBSerial.print("NUM_MODES: ");
-    USBSerial.println(NUM_MODES);
-    tx_end();
+const SerialChoice led_color_order_choices[] = {
+  { "GRB", GRB }, { "RGB", RGB }, { "BGR", BGR }, { NULL, 0 }
+};
 
-  }
+const SerialChoice render_mode_choices[] = {
+  { "compat", RENDER_MODE_COMPAT }, { "native", RENDER_MODE_NATIVE }, { "half", RENDER_MODE_HALF }, { NULL, 0 }
+};
 
-  // Returns the mode ID ------------------------------------
-  else if (strcmp(command_buf, "get_mode") == 0) {
-
-    tx_begin();
-    USBSerial.print("MODE: ");
-    USBSerial.println(CONFIG.LIGHTSHOW_MODE);
-    tx_end();
+void apply_max_current() {
+  FastLED.setMaxPowerInVoltsAndMilliamps(5.0, CONFIG.MAX_CURRENT_MA);
+}
 
-  }
+void queue_mode_transition() {
+  mode_transition_queued = true;
+}
 
-  // View crash dump from previous boot ----------------------
-  else if (strcmp(command_buf, "D") == 0 || strcmp(command_buf, "dump") == 0) {
-    Phase0::CrashDump::printCrashDump();
-  }
+// COMMAND HANDLERS #########################################
 
-  // Clear crash dump ----------------------------------------
-  else if (strcmp(command_buf, "C") == 0 || strcmp(command_buf, "clear_dump") == 0) {
-    Phase0::CrashDump::clearCrashDump();
-    USBSerial.println("Crash dump cleared");
-  }
+// Get firmware version -----------------------------------
+void cmd_version(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.print("VERSION: ");
+  USBSerial.println(FIRMWARE_VERSION);
+  tx_end();
+}
 
-  // Trigger manual crash dump (for testing) ----------------
-  else if (strcmp(command_buf, "test_crash") == 0) {
-    USBSerial.println("Triggering manual crash dump...");
-    Phase0::CrashDump::triggerManualDump("Manual test dump");
-    delay(100);
-    reboot();
-  }
+// Print help ---------------------------------------------
+void cmd_help(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.println("SENSORY BRIDGE - Serial Menu ------------------------------------------------------------------------------------");
+  USBSerial.println();
+  USBSerial.println("                                            v | Print firmware version number");
+  USBSerial.println("                                        reset | Reboot Sensory Bridge");
+  USBSerial.println("                                factory_reset | Delete configuration, including noise cal, reboot");
+  USBSerial.println("                             restore_defaults | Delete configuration, reboot");
+  USBSerial.println("                                get_main_unit | Print if this unit is set to MAIN for SensorySync");
+  USBSerial.println("                                         dump | Print tons of useful variables in realtime");
+  USBSerial.println("                                         stop | Stops the output of any enabled streams");
+  USBSerial.println("                                          fps | Return the system FPS");
+  USBSerial.println("                                      led_fps | Return the LED FPS");
+  USBSerial.println("                                      quality | Return the quality governor's level and frame times");
+  USBSerial.println("                           quality=[auto/int] | Let the governor pick the quality level, or lock it");
+  USBSerial.println("                                        pacer | Return LED frame pacing stats (intervals, missed deadlines)");
+  USBSerial.println("                         led_fps_target=[int] | Set the frame pacer's target LED FPS");
+  USBSerial.println("                                         idle | Return idle tier state and CPU/transmit savings");
+  USBSerial.println("                                      derived | Return how often each derived table was rebuilt, and how long it took");
+  USBSerial.println("                                      journal | Return config journal usage, compactions, and the save queue");
+  USBSerial.println("                                      latency | Return audio-to-photon latency per stage (p50/p95/p99/max)");
+  USBSerial.println("                                latency_reset | Clear the latency histograms");
+#ifdef ENABLE_SPAN_TRACE
+  USBSerial.println("                                  trace_start | Clear the span trace rings and start recording");
+  USBSerial.println("                                   trace_dump | Stop recording, dump the rings as binary (tools/trace_to_chrome)");
+#endif
+  USBSerial.println("                                  audio_guard | Display audio guard protection status");
+  USBSerial.println("                                      chip_id | Return the chip id (MAC) of the CPU");
+  USBSerial.println("                                     get_mode | Get lightshow mode's ID (index)");
+  USBSerial.println("                                get_num_modes | Return the number of modes available");
+  USBSerial.println("                              start_noise_cal | Remotely begin a noise calibration");
+  USBSerial.println("                              clear_noise_cal | Remotely clear the stored noise calibration");
+  USBSerial.println("                  noise_tracking=[true/false] | Keep updating the noise floor during silence (on after boot)");
+  USBSerial.println("         noise_profile=[profile_name or slot] | Subtracts a saved room's noise floor, no calibration");
+  USBSerial.println("            noise_profile_save=[profile_name] | Saves the noise floor being subtracted as a named profile");
+  USBSerial.println("  noise_profile_delete=[profile_name or slot] | Removes a noise profile");
+  USBSerial.println("                               noise_profiles | Return the noise profiles, and how the floor tracking is doing");
+  USBSerial.println("                             start_benchmark | Start a timed benchmark (calculates avg FPS)");
+  USBSerial.println("                               set_mode=[int] | Set the mode number");
+  USBSerial.println("              mode_fade_ms=[int or 'default'] | Cross-fade time between modes, 0 cuts straight over");
+  USBSerial.println("          mirror_enabled=[true/false/default] | Remotely toggle lightshow mirroring");
+  USBSerial.println("           reverse_order=[true/false/default] | Toggle whether image is flipped upside down before final rendering");
+  USBSerial.println("                          get_mode_name=[int] | Get a mode's name by ID (index)");
+  USBSerial.println("                                stream=[type] | Stream live data as binary frames (tools/telemetry_decode)");
+  USBSerial.println("                                                Options are: audio, fps, magnitudes, spectrogram, chromagram,");
+  USBSerial.println("                                                max_mags, max_mags_followers");
+  USBSerial.println("                                    telemetry | Return streamed frames sent and dropped, save queue depth and latency");
+  USBSerial.println("led_type=['neopixel'/'neopixel_x2'/'dotstar'] | Sets which LED protocol to use, 3 wire, 4 wire, or dual-data mode");
+  USBSerial.println("                 led_count=[int or 'default'] | Sets how many LEDs your display will use");
+  USBSerial.println("     render_mode=[compat/native/half/default] | Draw at 160 px and scale, at led_count, or at half of led_count");
+  USBSerial.println("                            render_resolution | Return the resolution modes are drawn at");
+  USBSerial.println("                                    pixel_map | Return the output wiring layout");
+  USBSerial.println("                   pixel_map=[layout/default] | Set the wiring, e.g. '80/80', '16x16s', '30r@30,30@0'");
+  USBSerial.println("        led_color_order=[GRB/RGB/BGR/default] | Sets LED color ordering, default GRB");
+  USBSerial.println("       led_interpolation=[true/false/default] | Toggles linear LED interpolation when running in a non-native resolution (slower)");
+  USBSerial.println("                           debug=[true/false] | Enables debug mode, where functions are timed");
+  USBSerial.println("                sample_rate=[hz or 'default'] | Sets the microphone sample rate");
+  USBSerial.println("              note_offset=[0-32 or 'default'] | Sets the lowest note, as a positive offset from A1 (55.0Hz)");
+  USBSerial.println("               square_iter=[int or 'default'] | Sets the number of times the LED output is squared (contrast)");
+  USBSerial.println("         samples_per_chunk=[int or 'default'] | Sets the number of samples collected every frame");
+  USBSerial.println("             sensitivity=[float or 'default'] | Sets the scaling of audio data (>1.0 is more sensitive, <1.0 is less sensitive)");
+  USBSerial.println("          boot_animation=[true/false/default] | Enable or disable the boot animation");
+  USBSerial.println("                   set_main_unit=[true/false] | Sets if this unit is MAIN or not for SensorySync");
+  USBSerial.println("            sweet_spot_min=[int or 'default'] | Sets the minimum amplitude to be inside the 'Sweet Spot'");
+  USBSerial.println("            sweet_spot_max=[int or 'default'] | Sets the maximum amplitude to be inside the 'Sweet Spot'");
+  USBSerial.println("         chromagram_range=[1-64 or 'default'] | Range between 1 and 64, how many notes at the bottom of the");
+  USBSerial.println("                                                spectrogram should be considered in chromagram sums");
+  USBSerial.println("         standby_dimming=[true/false/default] | Toggle dimming during detected silence");
+  USBSerial.println("                       bass_mode=[true/false] | Toggle bass-mode, which alters note_offset and chromagram_range for bass-y tunes");
+  USBSerial.println("            max_current_ma=[int or 'default'] | Sets the maximum current FastLED will attempt to limit the LED consumption to");
+  USBSerial.println("      temporal_dithering=[true/false/default] | Toggle per-LED temporal dithering that simulates higher bit-depths");
+  USBSerial.println("        auto_color_shift=[true/false/default] | Toggle automated color shifting based on positive spectral changes");
+  USBSerial.println("     incandescent_filter=[float or 'default'] | Set the intensity of the incandescent LUT (reduces harsh blues)");
+  USBSerial.println("       incandescent_mode=[true/false/default] | Force all output into monochrome and tint with 2700K incandescent color");
+  USBSerial.println("               base_coat=[true/false/default] | Enable a dim gray backdrop to the LEDs (approves appearance in most modes)");
+  USBSerial.println("            bulb_opacity=[float or 'default'] | Set opacity of a filter that portrays the output as 32 \"bulbs\" with separation and hot spots");
+  USBSerial.println("              saturation=[float or 'default'] | Sets the saturation of internal hues");
+  USBSerial.println("               prism_count=[int or 'default'] | Sets the number of times the \"prism\" effect is applied");
+  USBSerial.println("                 preset=[preset_name or slot] | Switches to a saved preset or theme on the next frame");
+  USBSerial.println("                    preset_save=[preset_name] | Saves the current settings (not the strip or calibration) as a preset");
+  USBSerial.println("          preset_delete=[preset_name or slot] | Removes a preset from the bank");
+  USBSerial.println("                                      presets | Return the presets in the bank, and the one last switched to");
+  USBSerial.println();
+  USBSerial.println("                         -- BATCHED CHANGES --");
+  USBSerial.println("                                        begin | Hold the configuration changes that follow instead of applying them");
+  USBSerial.println("                                       commit | Check the held changes and apply them together on the next frame");
+  USBSerial.println("                                        abort | Drop the held changes");
+  USBSerial.println("                                  transaction | Show whether changes are being held, and how many");
+  USBSerial.println();
+  USBSerial.println("                         -- SECONDARY LED STRIP CONTROL --");
+  USBSerial.println("         secondary_enabled=[true/false] | Enable or disable the secondary LED strip");
+  USBSerial.println("                  secondary_mode=[0-7] | Set mode for secondary LED strip");
+  USBSerial.println("              secondary_photons=[0-1.0] | Set brightness for secondary LED strip");
+  USBSerial.println("               secondary_chroma=[0-1.0] | Set chroma value for secondary LED strip");
+  USBSerial.println("                 secondary_mood=[0-1.0] | Set mood value for secondary LED strip");
+  USBSerial.println("            secondary_saturation=[0-1.0] | Set saturation for secondary LED strip");
+  USBSerial.println("          secondary_prism_count=[0-10] | Set prism count for secondary LED strip");
+  USBSerial.println("   secondary_mirror_enabled=[true/false] | Toggle mirroring on secondary LED strip");
+  USBSerial.println("    secondary_reverse_order=[true/false] | Toggle image flipping on secondary LED strip");
+  USBSerial.println("              secondary_base_coat=[true/false] | Enable dim backdrop on secondary LED strip");
+  USBSerial.println("                  secondary_status | Display current status of secondary LED strip");
+#ifdef ENABLE_PERFORMANCE_MONITORING
+  USBSerial.println();
+  USBSerial.println("                         -- PERFORMANCE MONITORING (96-BIN TEST) --");
+  USBSerial.println("                                         PERF | Show detailed performance report");
+  USBSerial.println("                                   PERF LOG ON|OFF | Toggle periodic PERF summary");
+  USBSerial.println("                                 PERF FREQ ON|OFF | Toggle freq spectrum logging");
+  USBSerial.println("                                   PERF SWEEP | Run frequency sweep test");
+  USBSerial.println("                                  PERF STRESS | Run 60-second stress test");
+  USBSerial.println("                                   PERF RESET | Reset performance metrics");
+#endif
+  tx_end(); 
+}
 
-  // Run performance regression tests ------------------------
-  else if (strcmp(command_buf, "perf_test") == 0) {
-    USBSerial.println("Running performance regression tests...\n");
-    bool passed = PerformanceTest::runAll(true);
-    USBSerial.println(passed ? "\n✅ All tests PASSED" : "\n❌ Some tests FAILED");
-  }
+// So that software can automatically identify this device -
+void cmd_identify_device(const SerialCommand& command, char* data) {
+  USBSerial.println("SB!");
+}
 
-  // Capture golden performance metrics ----------------------
-  else if (strcmp(command_buf, "perf_golden") == 0) {
-    USBSerial.println("Capturing golden performance metrics...\n");
-    PerformanceTest::captureGolden();
-  }
+// Reset the micro ----------------------------------------
+void cmd_reset(const SerialCommand& command, char* data) {
+  ack();
+  reboot();
+}
 
-  // Returns the reason why the ESP32 last rebooted ---------
-  else if (strcmp(command_buf, "reset_reason") == 0) {
-    tx_begin();
-    switch (esp_reset_reason()) {
-      case ESP_RST_UNKNOWN:
-        USBSerial.println("UNKNOWN");
-        break;
-      case ESP_RST_POWERON:
-        USBSerial.println("POWERON");
-        break;
-      case ESP_RST_EXT:
-        USBSerial.println("EXTERNAL");
-        break;
-      case ESP_RST_SW:
-        USBSerial.println("SOFTWARE");
-        break;
-      case ESP_RST_PANIC:
-        USBSerial.println("PANIC");
-        break;
-      case ESP_RST_INT_WDT:
-        USBSerial.println("INTERNAL WATCHDOG");
-        break;
-      case ESP_RST_TASK_WDT:
-        USBSerial.println("TASK WATCHDOG");
-        break;
-      case ESP_RST_WDT:
-        USBSerial.println("WATCHDOG");
-        break;
-      case ESP_RST_DEEPSLEEP:
-        USBSerial.println("DEEPSLEEP");
-        break;
-      case ESP_RST_BROWNOUT:
-        USBSerial.println("BROWNOUT");
-        break;
-      case ESP_RST_SDIO:
-        USBSerial.println("SDIO");
-        break;
-    }
-    tx_end();
-  }
+// Clear configs and reset micro --------------------------
+void cmd_factory_reset(const SerialCommand& command, char* data) {
+  ack();
+  factory_reset();
+}
 
-  // Dump tons of variables to the monitor ------------------
-  else if (strcmp(command_buf, "dump") == 0) {
+// Clear configs and reset micro --------------------------
+void cmd_restore_defaults(const SerialCommand& command, char* data) {
+  ack();
+  restore_defaults();
+}
 
-    tx_begin();
-    dump_info();
-    tx_end();
+// Return chip ID -----------------------------------------
+void cmd_chip_id(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_chip_id();
+  tx_end();
+}
 
-  }
+// Identify unit via 2 yellow flashes ---------------------
+void cmd_identify(const SerialCommand& command, char* data) {
+  ack();
+  CRGB16 col = {1.00, 0.25, 0.00};
+  blocking_flash(col);
+}
 
-  // If a streaming or plotting a variable, stop ------------
-  else if (strcmp(command_buf, "stop") == 0) {
+// Begin a noise calibration ------------------------------
+void cmd_start_noise_cal(const SerialCommand& command, char* data) {
+  ack();
+  noise_transition_queued = true;
+}
 
-    stop_streams();
-    ack();
+// Clear the noise calibration ----------------------------
+void cmd_clear_noise_cal(const SerialCommand& command, char* data) {
+  ack();
+  clear_noise_cal();
+}
 
+// Delete noise calibration file --------------------------
+void cmd_delete_noise_file(const SerialCommand& command, char* data) {
+  if (delete_ambient_noise_calibration()) {  // (bridge_fs.h)
+    USBSerial.println("Saved noise calibration deleted. Restart device for clean state.");
+  } else {
+    USBSerial.println("Failed to delete saved noise calibration.");
   }
+}
 
-  // Print the average FPS ----------------------------------
-  else if (strcmp(command_buf, "fps") == 0) {
-
-    tx_begin();
-    USBSerial.print("SYSTEM_FPS: ");
-    USBSerial.println(SYSTEM_FPS);
-    tx_end();
-
+// Show current noise levels -------------------------------
+void cmd_show_noise_levels(const SerialCommand& command, char* data) {
+  USBSerial.println("Current noise calibration levels:");
+  for (uint8_t i = 0; i < NUM_FREQS; i += 8) {
+    USBSerial.printf("Freq[%d-%d]: %.2f %.2f %.2f %.2f %.2f %.2f %.2f %.2f\n",
+                     i, i+7,
+                     float(noise_samples[i]), float(noise_samples[i+1]),
+                     float(noise_samples[i+2]), float(noise_samples[i+3]),
+                     float(noise_samples[i+4]), float(noise_samples[i+5]),
+                     float(noise_samples[i+6]), float(noise_samples[i+7]));
   }
+}
 
-  // Print the average FPS ----------------------------------
-  else if (strcmp(command_buf, "led_fps") == 0) {
-
-    tx_begin();
-    USBSerial.print("LED_FPS: ");
-    USBSerial.println(LED_FPS);
-    tx_end();
+// Subtract a saved room's noise floor (noise_cal.h) ------
+void cmd_noise_profile(const SerialCommand& command, char* data) {
+  uint8_t slot = find_noise_profile(data);
+  if (slot == NOISE_PROFILE_NONE) {
+    bad_command(command.name, data);
+    return;
+  }
+  select_noise_profile(slot);
+  tx_begin();
+  USBSerial.print("ENABLED NOISE PROFILE: ");
+  USBSerial.println(noise_profiles.profiles[slot].name);
+  tx_end();
+}
 
+// Save the floor being subtracted as a profile ----------
+void cmd_noise_profile_save(const SerialCommand& command, char* data) {
+  uint8_t slot = store_noise_profile(data);
+  if (slot == NOISE_PROFILE_NONE) {
+    tx_begin(true);
+    USBSerial.printf("Noise profile names are 1-%d characters, and %d can be saved\n", NOISE_PROFILE_NAME_LENGTH - 1, NOISE_PROFILE_SLOTS);
+    tx_end(true);
+    return;
   }
-  
-  // Print audio guard status -------------------------------
-  else if (strcmp(command_buf, "audio_guard") == 0) {
 
-    tx_begin();
-    // AudioGuard::printAudioState();  // TODO: Need to include audio_guard.h before this file
-    USBSerial.println("Audio Guard status (temporarily disabled - include order issue)");
-    tx_end();
+  tx_begin();
+  USBSerial.print("SAVED NOISE PROFILE ");
+  USBSerial.print(slot);
+  USBSerial.print(": ");
+  USBSerial.println(noise_profiles.profiles[slot].name);
+  tx_end();
+}
 
+void cmd_noise_profile_delete(const SerialCommand& command, char* data) {
+  uint8_t slot = find_noise_profile(data);
+  if (slot == NOISE_PROFILE_NONE) {
+    bad_command(command.name, data);
+    return;
   }
+  noise_profiles.remove(slot);
+  if (active_noise_profile == slot) {
+    active_noise_profile = NOISE_PROFILE_NONE;  // noise_samples keeps its floor
+  }
+  save_noise_profiles();  // (bridge_fs.h)
+  ack();
+}
 
-  // Print the knob values ----------------------------------
-  else if (strcmp(command_buf, "get_knobs") == 0) {
+// Print the noise profiles and the tracker ---------------
+void cmd_noise_profiles(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_noise_profiles();  // (noise_cal.h)
+  tx_end();
+}
 
-    USBSerial.print("{");
+// Returns the number of modes available ------------------
+void cmd_get_num_modes(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.print("NUM_MODES: ");
+  USBSerial.println(NUM_MODES);
+  tx_end();
+}
 
-    USBSerial.print('"');
-    USBSerial.print("PHOTONS");
-    USBSerial.print('"');
-    USBSerial.print(':');
-    USBSerial.print(CONFIG.PHOTONS);
+// Returns the mode ID ------------------------------------
+void cmd_get_mode(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.print("MODE: ");
+  USBSerial.println(CONFIG.LIGHTSHOW_MODE);
+  tx_end();
+}
 
-    USBSerial.print(',');
+// View crash dump from previous boot ----------------------
+void cmd_crash_dump(const SerialCommand& command, char* data) {
+  Phase0::CrashDump::printCrashDump();
+}
 
-    USBSerial.print('"');
-    USBSerial.print("CHROMA");
-    USBSerial.print('"');
-    USBSerial.print(':');
-    USBSerial.print(CONFIG.CHROMA);
+// Clear crash dump ----------------------------------------
+void cmd_clear_dump(const SerialCommand& command, char* data) {
+  Phase0::CrashDump::clearCrashDump();
+  USBSerial.println("Crash dump cleared");
+}
 
-    USBSerial.print(',');
+// Trigger manual crash dump (for testing) ----------------
+void cmd_test_crash(const SerialCommand& command, char* data) {
+  USBSerial.println("Triggering manual crash dump...");
+  Phase0::CrashDump::triggerManualDump("Manual test dump");
+  delay(100);
+  reboot();
+}
 
-    USBSerial.print('"');
-    USBSerial.print("MOOD");
-    USBSerial.print('"');
-    USBSerial.print(':');
-    USBSerial.print(CONFIG.MOOD);
+// Run performance regression tests ------------------------
+void cmd_perf_test(const SerialCommand& command, char* data) {
+  USBSerial.println("Running performance regression tests...\n");
+  bool passed = PerformanceTest::runAll(true);
+  USBSerial.println(passed ? "\n✅ All tests PASSED" : "\n❌ Some tests FAILED");
+}
 
-    USBSerial.println('}');
+// Capture golden performance metrics ----------------------
+void cmd_perf_golden(const SerialCommand& command, char* data) {
+  USBSerial.println("Capturing golden performance metrics...\n");
+  PerformanceTest::captureGolden();
+}
 
+// Returns the reason why the ESP32 last rebooted ---------
+void cmd_reset_reason(const SerialCommand& command, char* data) {
+  tx_begin();
+  switch (esp_reset_reason()) {
+    case ESP_RST_UNKNOWN:
+      USBSerial.println("UNKNOWN");
+      break;
+    case ESP_RST_POWERON:
+      USBSerial.println("POWERON");
+      break;
+    case ESP_RST_EXT:
+      USBSerial.println("EXTERNAL");
+      break;
+    case ESP_RST_SW:
+      USBSerial.println("SOFTWARE");
+      break;
+    case ESP_RST_PANIC:
+      USBSerial.println("PANIC");
+      break;
+    case ESP_RST_INT_WDT:
+      USBSerial.println("INTERNAL WATCHDOG");
+      break;
+    case ESP_RST_TASK_WDT:
+      USBSerial.println("TASK WATCHDOG");
+      break;
+    case ESP_RST_WDT:
+      USBSerial.println("WATCHDOG");
+      break;
+    case ESP_RST_DEEPSLEEP:
+      USBSerial.println("DEEPSLEEP");
+      break;
+    case ESP_RST_BROWNOUT:
+      USBSerial.println("BROWNOUT");
+      break;
+    case ESP_RST_SDIO:
+      USBSerial.println("SDIO");
+      break;
   }
+  tx_end();
+}
 
-  // Print the button values --------------------------------
-  else if (strcmp(command_buf, "get_buttons") == 0) {
-
-    USBSerial.print("{");
-
-    USBSerial.print('"');
-    USBSerial.print("NOISE");
-    USBSerial.print('"');
-    USBSerial.print(':');
-    USBSerial.print(digitalRead(noise_button.pin));
-
-    USBSerial.print(',');
+// If a streaming or plotting a variable, stop ------------
+void cmd_stop(const SerialCommand& command, char* data) {
+  stop_streams();
+  ack();
+}
 
-    USBSerial.print('"');
-    USBSerial.print("MODE");
-    USBSerial.print('"');
-    USBSerial.print(':');
-    USBSerial.print(digitalRead(mode_button.pin));
+// Print the average FPS ----------------------------------
+void cmd_fps(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.print("SYSTEM_FPS: ");
+  USBSerial.println(SYSTEM_FPS);
+  tx_end();
+}
 
-    USBSerial.println('}');
+// Print the average FPS ----------------------------------
+void cmd_led_fps(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.print("LED_FPS: ");
+  USBSerial.println(LED_FPS);
+  tx_end();
+}
 
+// Print the quality governor status, or set its level ----
+void cmd_quality(const SerialCommand& command, char* data) {
+  bool good = false;
+  if (data[0] == '\0') {
+    good = true;  // Status only
+  } else if (strcmp(data, "auto") == 0) {
+    quality_auto = true;
+    good = true;
+  } else {
+    int16_t level = atol(data);
+    if (level >= QUALITY_FULL && level < NUM_QUALITY_LEVELS) {
+      quality_auto = false;
+      set_quality_level(level);
+      good = true;
+    }
   }
-  
-  // Show frequency peak debug info -------------------------
-  else if (strcmp(command_buf, "freq_debug") == 0) {
+
+  if (good) {
     tx_begin();
-    USBSerial.println("=== FREQUENCY DEBUG INFO ===");
-    USBSerial.print("NUM_FREQS: ");
-    USBSerial.println(NUM_FREQS);
-    USBSerial.print("Sample Rate: ");
-    USBSerial.println(CONFIG.SAMPLE_RATE);
-    USBSerial.print("Note Offset: ");
-    USBSerial.println(CONFIG.NOTE_OFFSET);
-    USBSerial.println("\nFrequency allocation:");
-    USBSerial.println("First 5 bins:");
-    for (int i = 0; i < 5; i++) {
-      USBSerial.print("  Bin ");
-      USBSerial.print(i);
-      USBSerial.print(": ");
-      USBSerial.print(frequencies[i].target_freq);
-      USBSerial.print(" Hz (block_size=");
-      USBSerial.print(frequencies[i].block_size);
-      USBSerial.println(")");
-    }
-    USBSerial.println("...");
-    USBSerial.println("Last 5 bins:");
-    for (int i = NUM_FREQS-5; i < NUM_FREQS; i++) {
-      USBSerial.print("  Bin ");
-      USBSerial.print(i);
-      USBSerial.print(": ");
-      USBSerial.print(frequencies[i].target_freq);
-      USBSerial.print(" Hz (block_size=");
-      USBSerial.print(frequencies[i].block_size);
-      USBSerial.println(")");
-    }
-    USBSerial.println("\nCurrent magnitudes:");
-    float max_mag = 0;
-    int peak_bin = 0;
-    for (int i = 0; i < NUM_FREQS; i++) {
-      if (magnitudes_final[i] > max_mag) {
-        max_mag = magnitudes_final[i];
-        peak_bin = i;
-      }
-    }
-    USBSerial.print("Peak: Bin ");
-    USBSerial.print(peak_bin);
-    USBSerial.print(" (");
-    USBSerial.print(frequencies[peak_bin].target_freq);
-    USBSerial.print(" Hz) = ");
-    USBSerial.println(max_mag);
+    print_quality_status();  // (quality_governor.h)
     tx_end();
+  } else {
+    bad_command(command.name, data);
   }
+}
 
-  // COMMANDS WITH METADATA ##################################
-
-  else {  // Commands with metadata are parsed here
+// Print the render resolution --------------------------
+void cmd_render_resolution(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.print("sbs((render_mode=");
+  USBSerial.print(CONFIG.RENDER_MODE);
+  USBSerial.print(",base=");
+  USBSerial.print(render_base_resolution);
+  USBSerial.print(",current=");
+  USBSerial.print(render_resolution);
+  USBSerial.print(",capacity=");
+  USBSerial.print(render_capacity);
+  USBSerial.print(",led_count=");
+  USBSerial.print(CONFIG.LED_COUNT);
+  USBSerial.println("))");
+  tx_end();
+}
 
-    // PARSER #############################
-    // Parse command type
-    char command_type[32] = { 0 };
-    uint8_t reading_index = 0;
-    for (uint8_t i = 0; i < 32; i++) {
-      reading_index++;
-      if (command_buf[i] != '=') {
-        command_type[i] = command_buf[i];
-      } else {
-        break;
-      }
-    }
+// Print the idle tier status ---------------------------
+void cmd_idle(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_idle_status();  // (idle_tier.h)
+  tx_end();
+}
 
-    // Then parse command data
-    char command_data[94] = { 0 };
-    for (uint8_t i = 0; i < 94; i++) {
-      if (command_buf[reading_index + i] != 0) {
-        command_data[i] = command_buf[reading_index + i];
-      } else {
-        break;
-      }
-    }
-    // PARSER #############################
-
-    // Now react accordingly:
-
-    // Run DC Offset Diagnostics ------------------------------
-    else if (strcmp(command_type, "dc_diag") == 0) {
-      tx_begin();
-      USBSerial.println("Running DC offset diagnostics...");
-      tx_end();
-      // Include guard to only use if test diagnostics header is included
-      #ifdef test_audio_diagnostics_h
-      diagnose_dc_offset();  // Run the diagnostic once
-      #else
-      USBSerial.println("DC diagnostics not available - include test_audio_diagnostics.h");
-      #endif
-    }
+// Print the config journal state -----------------------
+void cmd_journal(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_config_journal_status();  // (bridge_fs.h)
+  print_save_queue_status();      // (bridge_fs.h)
+  tx_end();
+}
 
-    // Toggle Debug Mode --------------------------------------
-    else if (strcmp(command_type, "debug") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "true") == 0) {
-        good = true;
-        debug_mode = true;
-        cpu_usage.attach_ms(5, check_current_function);
-      } else if (strcmp(command_data, "false") == 0) {
-        good = true;
-        debug_mode = false;
-        cpu_usage.detach();
-      } else {
-        bad_command(command_type, command_data);
-      }
+// Print the derived table rebuild stats ----------------
+void cmd_derived(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_derived_tables();  // (system.h)
+  tx_end();
+}
 
-      if (good) {
-        tx_begin();
-        USBSerial.print("debug_mode: ");
-        USBSerial.println(debug_mode);
-        tx_end();
-      }
-    }
+// Print the pixel map, or set it -----------------------
+void cmd_pixel_map(const SerialCommand& command, char* data) {
+  if (data[0] == '\0') {
+    tx_begin();
+    USBSerial.print("sbs((pixel_map=");
+    USBSerial.print(pixel_layout_text[0] == '\0' ? "default" : pixel_layout_text);
+    USBSerial.print(",outputs=");
+    USBSerial.print(pixel_layout.num_outputs);
+    USBSerial.print(",segments=");
+    USBSerial.print(pixel_layout.num_segments);
+    USBSerial.print(",mapped=");
+    USBSerial.print(pixel_layout.physical_count);
+    USBSerial.print(",led_count=");
+    USBSerial.print(CONFIG.LED_COUNT);
+    USBSerial.println("))");
+    tx_end();
+    return;
+  }
 
-    // Set Sample Rate ----------------------------------------
-    else if (strcmp(command_type, "sample_rate") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        good = true;
-        CONFIG.SAMPLE_RATE = CONFIG_DEFAULTS.SAMPLE_RATE;
-      } else {
-        good = true;
-        CONFIG.SAMPLE_RATE = constrain(atol(command_data), 6400, 44100);
-      }
+  PixelLayout layout;
+  uint8_t error = PIXEL_MAP_OK;
+  if (strcmp(data, "default") != 0) {
+    error = validate_pixel_layout(data, layout);  // (led_utilities.h)
+  }
 
-      if (good) {
-        save_config();
-        tx_begin();
-        USBSerial.print("CONFIG.SAMPLE_RATE: ");
-        USBSerial.println(CONFIG.SAMPLE_RATE);
-        tx_end();
-        reboot();
-      }
+  if (error != PIXEL_MAP_OK) {
+    tx_begin();
+    USBSerial.print("Invalid pixel layout '");
+    USBSerial.print(data);
+    USBSerial.print("': ");
+    USBSerial.println(pixel_map_error_names[error]);
+    tx_end();
+  } else {
+    if (strcmp(data, "default") == 0) {
+      pixel_layout_text[0] = '\0';
+    } else {
+      strncpy(pixel_layout_text, data, sizeof(pixel_layout_text) - 1);
+      pixel_layout_text[sizeof(pixel_layout_text) - 1] = '\0';
     }
+    save_pixel_layout();  // (bridge_fs.h)
 
-    // Set Mode Number ----------------------------------------
-    else if (strcmp(command_type, "set_mode") == 0) {
-      mode_transition_queued = true;
-      mode_destination = constrain(atol(command_data), 0, NUM_MODES - 1);
-
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.LIGHTSHOW_MODE: ");
-      USBSerial.println(mode_destination);
-      tx_end();
-    }
+    tx_begin();
+    USBSerial.print("PIXEL_MAP: ");
+    USBSerial.println(pixel_layout_text[0] == '\0' ? "default" : pixel_layout_text);
+    tx_end();
+    reboot();  // Output boundaries are bound to FastLED at boot
+  }
+}
 
-    // Get Mode Name By ID ------------------------------------
-    else if (strcmp(command_type, "get_mode_name") == 0) {
-      uint16_t mode_id = atol(command_data);
-
-      if (mode_id < NUM_MODES) {
-        char buf[32] = { 0 };
-        for (uint8_t i = 0; i < 32; i++) {
-          char c = mode_names[32 * mode_id + i];
-          if (c != 0) {
-            buf[i] = c;
-          } else {
-            break;
-          }
-        }
-
-        tx_begin();
-        USBSerial.print("MODE_NAME: ");
-        USBSerial.println(buf);
-        tx_end();
-      } else {
-        bad_command(command_type, command_data);
-      }
-    }
+// Print the frame pacer stats --------------------------
+void cmd_pacer(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_frame_pacer_stats();  // (frame_pacer.h)
+  tx_end();
+}
 
-    // Set Note Offset ----------------------------------------
-    else if (strcmp(command_type, "note_offset") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.NOTE_OFFSET = CONFIG_DEFAULTS.NOTE_OFFSET;
-      } else {
-        CONFIG.NOTE_OFFSET = constrain(atol(command_data), 0, 32);
-      }
-      save_config();
-      tx_begin();
-      USBSerial.print("CONFIG.NOTE_OFFSET: ");
-      USBSerial.println(CONFIG.NOTE_OFFSET);
-      tx_end();
-      reboot();
-    }
+// Print the binary stream counters --------------------
+void cmd_telemetry(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_telemetry_stats();  // (telemetry.h)
+  tx_end();
+}
 
-    // Set Square Iterations ----------------------------------
-    else if (strcmp(command_type, "square_iter") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.SQUARE_ITER = CONFIG_DEFAULTS.SQUARE_ITER;
-      } else {
-        CONFIG.SQUARE_ITER = constrain(atol(command_data), 0, 10);
-      }
-      save_config_delayed();
+// Print the audio-to-photon latency --------------------
+void cmd_latency(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_latency_stats();  // (latency_probe.h)
+  tx_end();
+}
 
-      tx_begin();
-      USBSerial.print("CONFIG.SQUARE_ITER: ");
-      USBSerial.println(CONFIG.SQUARE_ITER);
-      tx_end();
-    }
+// Clear the latency histograms -------------------------
+void cmd_latency_reset(const SerialCommand& command, char* data) {
+  ack();
+  reset_latency_stats();  // (latency_probe.h)
+}
 
-    // Set LED Type ---------------------------------------
-    else if (strcmp(command_type, "led_type") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "neopixel") == 0) {
-        CONFIG.LED_TYPE = LED_NEOPIXEL;
-        CONFIG.LED_COLOR_ORDER = GRB;
-        good = true;
-      } 
-      else if (strcmp(command_data, "neopixel_x2") == 0) {
-        CONFIG.LED_TYPE = LED_NEOPIXEL_X2;
-        CONFIG.LED_COLOR_ORDER = GRB;
-        good = true;
-      } else if (strcmp(command_data, "dotstar") == 0) {
-        CONFIG.LED_TYPE = LED_DOTSTAR;
-        CONFIG.LED_COLOR_ORDER = BGR;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+#ifdef ENABLE_SPAN_TRACE
+// Start recording pipeline spans -----------------------
+void cmd_trace_start(const SerialCommand& command, char* data) {
+  ack();
+  trace_start();  // (trace_recorder.h)
+}
 
-      if (good) {
-        save_config();
-        tx_begin();
-        USBSerial.print("CONFIG.LED_TYPE: ");
-        USBSerial.println(CONFIG.LED_TYPE);
-        tx_end();
-        reboot();
-      }
-    }
+// Dump the recorded spans ------------------------------
+void cmd_trace_dump(const SerialCommand& command, char* data) {
+  tx_begin();
+  trace_dump();  // (trace_recorder.h)
+  tx_end();
+}
+#endif
 
-    // Set LED Count ------------------------------------
-    else if (strcmp(command_type, "led_count") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.LED_COUNT = CONFIG_DEFAULTS.LED_COUNT;
-      } else {
-        CONFIG.LED_COUNT = constrain(atol(command_data), 1, 10000);
-      }
+// Print audio guard status -------------------------------
+void cmd_audio_guard(const SerialCommand& command, char* data) {
+  tx_begin();
+  // AudioGuard::printAudioState();  // TODO: Need to include audio_guard.h before this file
+  USBSerial.println("Audio Guard status (temporarily disabled - include order issue)");
+  tx_end();
+}
 
-      save_config();
-      tx_begin();
-      USBSerial.print("CONFIG.LED_COUNT: ");
-      USBSerial.println(CONFIG.LED_COUNT);
-      tx_end();
-      reboot();
-    }
+// Print the knob values ----------------------------------
+void cmd_get_knobs(const SerialCommand& command, char* data) {
+  USBSerial.print("{");
 
-    // Set LED Interpolation ----------------------------
-    else if (strcmp(command_type, "led_interpolation") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.LED_INTERPOLATION = CONFIG_DEFAULTS.LED_INTERPOLATION;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.LED_INTERPOLATION = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.LED_INTERPOLATION = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+  USBSerial.print('"');
+  USBSerial.print("PHOTONS");
+  USBSerial.print('"');
+  USBSerial.print(':');
+  USBSerial.print(CONFIG.PHOTONS);
 
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.LED_INTERPOLATION: ");
-        USBSerial.println(CONFIG.LED_INTERPOLATION);
-        tx_end();
-      }
-    }
+  USBSerial.print(',');
 
-    // Set Base Coat ----------------------------
-    else if (strcmp(command_type, "base_coat") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.BASE_COAT = CONFIG_DEFAULTS.BASE_COAT;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.BASE_COAT = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.BASE_COAT = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+  USBSerial.print('"');
+  USBSerial.print("CHROMA");
+  USBSerial.print('"');
+  USBSerial.print(':');
+  USBSerial.print(CONFIG.CHROMA);
 
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.BASE_COAT: ");
-        USBSerial.println(CONFIG.BASE_COAT);
-        tx_end();
-      }
-    }
+  USBSerial.print(',');
 
-    // Set LED Temporal Dithering ----------------------------
-    else if (strcmp(command_type, "temporal_dithering") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.TEMPORAL_DITHERING = CONFIG_DEFAULTS.TEMPORAL_DITHERING;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.TEMPORAL_DITHERING = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.TEMPORAL_DITHERING = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+  USBSerial.print('"');
+  USBSerial.print("MOOD");
+  USBSerial.print('"');
+  USBSerial.print(':');
+  USBSerial.print(CONFIG.MOOD);
 
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.TEMPORAL_DITHERING: ");
-        USBSerial.println(CONFIG.TEMPORAL_DITHERING);
-        tx_end();
-      }
-    }
+  USBSerial.println('}');
+}
 
-    // Set LED Color Order ----------------------------
-    else if (strcmp(command_type, "led_color_order") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.LED_COLOR_ORDER = CONFIG_DEFAULTS.LED_COLOR_ORDER;
-        good = true;
-      } else if (strcmp(command_data, "GRB") == 0) {
-        CONFIG.LED_COLOR_ORDER = GRB;
-        good = true;
-      } else if (strcmp(command_data, "RGB") == 0) {
-        CONFIG.LED_COLOR_ORDER = RGB;
-        good = true;
-      } else if (strcmp(command_data, "BGR") == 0) {
-        CONFIG.LED_COLOR_ORDER = BGR;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+// Print the button values --------------------------------
+void cmd_get_buttons(const SerialCommand& command, char* data) {
+  USBSerial.print("{");
 
-      if (good) {
-        save_config();
-        tx_begin();
-        USBSerial.print("CONFIG.LED_COLOR_ORDER: ");
-        USBSerial.println(CONFIG.LED_COLOR_ORDER);
-        tx_end();
-        reboot();
-      }
-    }
+  USBSerial.print('"');
+  USBSerial.print("NOISE");
+  USBSerial.print('"');
+  USBSerial.print(':');
+  USBSerial.print(digitalRead(noise_button.pin));
 
-    // Set Samples Per Chunk ---------------------------
-    else if (strcmp(command_type, "samples_per_chunk") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.SAMPLES_PER_CHUNK = CONFIG_DEFAULTS.SAMPLES_PER_CHUNK;
-      } else {
-        CONFIG.SAMPLES_PER_CHUNK = constrain(atol(command_data), 0, SAMPLE_HISTORY_LENGTH);
-      }
+  USBSerial.print(',');
 
-      save_config();
-      tx_begin();
-      USBSerial.print("CONFIG.SAMPLES_PER_CHUNK: ");
-      USBSerial.println(CONFIG.SAMPLES_PER_CHUNK);
-      tx_end();
-      reboot();
-    }
+  USBSerial.print('"');
+  USBSerial.print("MODE");
+  USBSerial.print('"');
+  USBSerial.print(':');
+  USBSerial.print(digitalRead(mode_button.pin));
 
-    // Set Audio Sensitivity ----------------------------
-    else if (strcmp(command_type, "sensitivity") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.SENSITIVITY = CONFIG_DEFAULTS.SENSITIVITY;
-      } else {
-        CONFIG.SENSITIVITY = atof(command_data);
-      }
+  USBSerial.println('}');
+}
 
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.SENSITIVITY: ");
-      USBSerial.println(CONFIG.SENSITIVITY);
-      tx_end();
+// Show frequency peak debug info -------------------------
+void cmd_freq_debug(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.println("=== FREQUENCY DEBUG INFO ===");
+  USBSerial.print("NUM_FREQS: ");
+  USBSerial.println(NUM_FREQS);
+  USBSerial.print("Sample Rate: ");
+  USBSerial.println(CONFIG.SAMPLE_RATE);
+  USBSerial.print("Note Offset: ");
+  USBSerial.println(CONFIG.NOTE_OFFSET);
+  USBSerial.println("\nFrequency allocation:");
+  USBSerial.println("First 5 bins:");
+  for (int i = 0; i < 5; i++) {
+    USBSerial.print("  Bin ");
+    USBSerial.print(i);
+    USBSerial.print(": ");
+    USBSerial.print(frequencies[i].target_freq);
+    USBSerial.print(" Hz (block_size=");
+    USBSerial.print(frequencies[i].block_size);
+    USBSerial.println(")");
+  }
+  USBSerial.println("...");
+  USBSerial.println("Last 5 bins:");
+  for (int i = NUM_FREQS-5; i < NUM_FREQS; i++) {
+    USBSerial.print("  Bin ");
+    USBSerial.print(i);
+    USBSerial.print(": ");
+    USBSerial.print(frequencies[i].target_freq);
+    USBSerial.print(" Hz (block_size=");
+    USBSerial.print(frequencies[i].block_size);
+    USBSerial.println(")");
+  }
+  USBSerial.println("\nCurrent magnitudes:");
+  float max_mag = 0;
+  int peak_bin = 0;
+  for (int i = 0; i < NUM_FREQS; i++) {
+    if (magnitudes_final[i] > max_mag) {
+      max_mag = magnitudes_final[i];
+      peak_bin = i;
     }
+  }
+  USBSerial.print("Peak: Bin ");
+  USBSerial.print(peak_bin);
+  USBSerial.print(" (");
+  USBSerial.print(frequencies[peak_bin].target_freq);
+  USBSerial.print(" Hz) = ");
+  USBSerial.println(max_mag);
+  tx_end();
+}
 
-    // Toggle Boot Animation --------------------------
-    else if (strcmp(command_type, "boot_animation") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.BOOT_ANIMATION = CONFIG_DEFAULTS.BOOT_ANIMATION;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.BOOT_ANIMATION = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.BOOT_ANIMATION = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+// Run DC Offset Diagnostics ------------------------------
+void cmd_dc_diag(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.println("Running DC offset diagnostics...");
+  tx_end();
+  // Include guard to only use if test diagnostics header is included
+  #ifdef test_audio_diagnostics_h
+  diagnose_dc_offset();  // Run the diagnostic once
+  #else
+  USBSerial.println("DC diagnostics not available - include test_audio_diagnostics.h");
+  #endif
+}
 
-      if (good) {
-        save_config();
-        tx_begin();
-        USBSerial.print("CONFIG.BOOT_ANIMATION: ");
-        USBSerial.println(CONFIG.BOOT_ANIMATION);
-        tx_end();
-        reboot();
-      }
-    }
+// Toggle Debug Mode --------------------------------------
+void cmd_debug(const SerialCommand& command, char* data) {
+  if (strcmp(data, "true") == 0) {
+    debug_mode = true;
+    cpu_usage.attach_ms(5, check_current_function);
+  } else if (strcmp(data, "false") == 0) {
+    debug_mode = false;
+    cpu_usage.detach();
+  } else {
+    bad_command(command.name, data);
+    return;
+  }
 
-    // Toggle Lightshow Mirroring ---------------------
-    else if (strcmp(command_type, "mirror_enabled") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.MIRROR_ENABLED = CONFIG_DEFAULTS.MIRROR_ENABLED;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.MIRROR_ENABLED = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.MIRROR_ENABLED = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+  tx_begin();
+  USBSerial.print("debug_mode: ");
+  USBSerial.println(debug_mode);
+  tx_end();
+}
 
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.MIRROR_ENABLED: ");
-        USBSerial.println(CONFIG.MIRROR_ENABLED);
-        tx_end();
-      }
-    }
+// Get Mode Name By ID ------------------------------------
+void cmd_get_mode_name(const SerialCommand& command, char* data) {
+  uint16_t mode_id = atol(data);
 
-    // Set Sweet Spot LOW threshold -------------------
-    else if (strcmp(command_type, "sweet_spot_min") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.SWEET_SPOT_MIN_LEVEL = CONFIG_DEFAULTS.SWEET_SPOT_MIN_LEVEL;
+  if (mode_id < NUM_MODES) {
+    char buf[32] = { 0 };
+    for (uint8_t i = 0; i < 32; i++) {
+      char c = mode_names[32 * mode_id + i];
+      if (c != 0) {
+        buf[i] = c;
       } else {
-        CONFIG.SWEET_SPOT_MIN_LEVEL = constrain(atof(command_data), 0, uint32_t(-1));
+        break;
       }
-
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.SWEET_SPOT_MIN_LEVEL: ");
-      USBSerial.println(CONFIG.SWEET_SPOT_MIN_LEVEL);
-      tx_end();
     }
 
-    // Set Sweet Spot HIGH threshold ------------------
-    else if (strcmp(command_type, "sweet_spot_max") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.SWEET_SPOT_MAX_LEVEL = CONFIG_DEFAULTS.SWEET_SPOT_MAX_LEVEL;
-      } else {
-        CONFIG.SWEET_SPOT_MAX_LEVEL = constrain(atof(command_data), 0, uint32_t(-1));
-      }
+    tx_begin();
+    USBSerial.print("MODE_NAME: ");
+    USBSerial.println(buf);
+    tx_end();
+  } else {
+    bad_command(command.name, data);
+  }
+}
 
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.SWEET_SPOT_MAX_LEVEL: ");
-      USBSerial.println(CONFIG.SWEET_SPOT_MAX_LEVEL);
-      tx_end();
-    }
+// Set LED Type (and the color order that goes with it) ---
+void cmd_led_type(const SerialCommand& command, char* data) {
+  SensoryBridge::Config::conf& config = staged_config();  // (config_transaction.h)
+  if (strcmp(data, "neopixel") == 0) {
+    config.LED_TYPE = LED_NEOPIXEL;
+    config.LED_COLOR_ORDER = GRB;
+  } else if (strcmp(data, "neopixel_x2") == 0) {
+    config.LED_TYPE = LED_NEOPIXEL_X2;
+    config.LED_COLOR_ORDER = GRB;
+  } else if (strcmp(data, "dotstar") == 0) {
+    config.LED_TYPE = LED_DOTSTAR;
+    config.LED_COLOR_ORDER = BGR;
+  } else {
+    bad_command(command.name, data);
+    return;
+  }
 
-    // Set Chromagram Range ---------------
-    else if (strcmp(command_type, "chromagram_range") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.CHROMAGRAM_RANGE = CONFIG_DEFAULTS.CHROMAGRAM_RANGE;
-      } else {
-        CONFIG.CHROMAGRAM_RANGE = constrain(atof(command_data), 1, 64);
-      }
+  config_edit_effects(CMD_REBOOT, NULL);
+  tx_begin();
+  print_staged();
+  USBSerial.print("CONFIG.LED_TYPE: ");
+  USBSerial.println(config.LED_TYPE);
+  tx_end();
+  config_edit_done(CMD_REBOOT);
+}
 
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.CHROMAGRAM_RANGE: ");
-      USBSerial.println(CONFIG.CHROMAGRAM_RANGE);
-      tx_end();
-    }
+// Toggle bass mode -------------------
+void cmd_bass_mode(const SerialCommand& command, char* data) {
+  SensoryBridge::Config::conf& config = staged_config();
+  if (strcmp(data, "true") == 0) {
+    config.NOTE_OFFSET = 0;
+    config.CHROMAGRAM_RANGE = 24;
+  } else if (strcmp(data, "false") == 0) {
+    config.NOTE_OFFSET = CONFIG_DEFAULTS.NOTE_OFFSET;
+    config.CHROMAGRAM_RANGE = CONFIG_DEFAULTS.CHROMAGRAM_RANGE;
+  } else {
+    bad_command(command.name, data);
+    return;
+  }
 
-    // Set Standby Dimming behavior -------
-    else if (strcmp(command_type, "standby_dimming") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.STANDBY_DIMMING = CONFIG_DEFAULTS.STANDBY_DIMMING;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.STANDBY_DIMMING = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.STANDBY_DIMMING = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+  config_edit_effects(CMD_SAVE, NULL);  // Goertzel constants and the noise floor follow NOTE_OFFSET (system.h)
+  tx_begin();
+  print_staged();
+  USBSerial.println("BASS MODE ENABLED");
+  tx_end();
+  config_edit_done(CMD_SAVE);
+}
 
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.STANDBY_DIMMING: ");
-        USBSerial.println(CONFIG.STANDBY_DIMMING);
-        tx_end();
-      }
-    }
+// Stream a given value over Serial -----------------
+void cmd_stream(const SerialCommand& command, char* data) {
+  stop_streams();  // Stop any current streams
+  if (strcmp(data, "audio") == 0) {
+    stream_audio = true;
+  } else if (strcmp(data, "fps") == 0) {
+    stream_fps = true;
+  } else if (strcmp(data, "max_mags") == 0) {
+    stream_max_mags = true;
+  } else if (strcmp(data, "max_mags_followers") == 0) {
+    stream_max_mags_followers = true;
+  } else if (strcmp(data, "magnitudes") == 0) {
+    stream_magnitudes = true;
+  } else if (strcmp(data, "spectrogram") == 0) {
+    stream_spectrogram = true;
+  } else if (strcmp(data, "chromagram") == 0) {
+    stream_chromagram = true;
+  } else {
+    bad_command(command.name, data);
+    return;
+  }
+  ack();
+}
 
-    // Toggle bass mode -------------------
-    else if (strcmp(command_type, "bass_mode") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "true") == 0) {
-        CONFIG.NOTE_OFFSET = 0;
-        CONFIG.CHROMAGRAM_RANGE = 24;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.NOTE_OFFSET = CONFIG_DEFAULTS.NOTE_OFFSET;
-        CONFIG.CHROMAGRAM_RANGE = CONFIG_DEFAULTS.CHROMAGRAM_RANGE;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+// Switch to a preset (presets.h), by name or slot --
+void cmd_preset(const SerialCommand& command, char* data) {
+  uint8_t slot = find_preset(data);
+  if (slot == PRESET_NONE) {
+    bad_command(command.name, data);
+    return;
+  }
 
-      if (good) {
-        save_config();
-        tx_begin();
-        USBSerial.println("BASS MODE ENABLED");
-        tx_end();
-        reboot();
-      }
-    }
+  if (config_transaction_open) {
+    preset_bank.copy_into(slot, config_shadow);  // Applied with the rest of the batch
+    config_edit_effects(CMD_SAVE, NULL);
+  } else {
+    preset_bank.request(slot);  // led_thread switches at the top of its next frame
+  }
+  // Nothing has switched yet: the batch commits it, or led_thread does. The
+  // presets command shows it as active once it has
+  tx_begin();
+  USBSerial.print(config_transaction_open ? "STAGED PRESET: " : "PENDING PRESET: ");
+  USBSerial.println(preset_bank.name(slot));
+  tx_end();
+}
 
-    // Set if image should be reversed ------------------------
-    else if (strcmp(command_type, "reverse_order") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.REVERSE_ORDER = CONFIG_DEFAULTS.REVERSE_ORDER;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.REVERSE_ORDER = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.REVERSE_ORDER = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+// Save the current settings as a preset ------------
+void cmd_preset_save(const SerialCommand& command, char* data) {
+  uint8_t slot = preset_bank.store(data, staged_config());
+  if (slot == PRESET_NONE) {
+    tx_begin(true);
+    USBSerial.printf("Preset names are 1-%d characters, and the bank holds %d\n", PRESET_NAME_LENGTH - 1, PRESET_BANK_SLOTS);
+    tx_end(true);
+    return;
+  }
+  save_presets();  // (bridge_fs.h)
+
+  tx_begin();
+  USBSerial.print("SAVED PRESET ");
+  USBSerial.print(slot);
+  USBSerial.print(": ");
+  USBSerial.println(preset_bank.name(slot));
+  tx_end();
+}
 
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.REVERSE_ORDER: ");
-        USBSerial.println(CONFIG.REVERSE_ORDER);
-        tx_end();
-      }
-    }
+void cmd_preset_delete(const SerialCommand& command, char* data) {
+  uint8_t slot = find_preset(data);
+  if (slot == PRESET_NONE) {
+    bad_command(command.name, data);
+    return;
+  }
+  preset_bank.remove(slot);
+  save_presets();  // (bridge_fs.h)
+  ack();
+}
 
-    // Set max LED current ----------------------------
-    else if (strcmp(command_type, "max_current_ma") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.MAX_CURRENT_MA = CONFIG_DEFAULTS.MAX_CURRENT_MA;
-      } else {
-        CONFIG.MAX_CURRENT_MA = constrain(atof(command_data), 0, uint32_t(-1));
-      }
+// Print the preset bank ----------------------------
+void cmd_presets(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_presets();  // (presets.h)
+  tx_end();
+}
 
-      FastLED.setMaxPowerInVoltsAndMilliamps(5.0, CONFIG.MAX_CURRENT_MA);
+// Secondary LED Controls ----------------------------
+void cmd_secondary_mode(const SerialCommand& command, char* data) {
+  uint8_t mode = atoi(data);
+  if (mode < NUM_MODES) {
+    uint8_t previous_mode = SECONDARY_LIGHTSHOW_MODE; // Store previous mode
+    SECONDARY_LIGHTSHOW_MODE = mode;
 
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.MAX_CURRENT_MA: ");
-      USBSerial.println(CONFIG.MAX_CURRENT_MA);
-      tx_end();
-    }
+    tx_begin();
+    USBSerial.print("SECONDARY_MODE: ");
+    USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
+    USBSerial.print(" (");
+    USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
+    USBSerial.println(")");
+    tx_end();
 
-    // Stream a given value over Serial -----------------
-    else if (strcmp(command_type, "stream") == 0) {
-      stop_streams();  // Stop any current streams
-      if (strcmp(command_data, "audio") == 0) {
-        stream_audio = true;
-        ack();
-      } else if (strcmp(command_data, "fps") == 0) {
-        stream_fps = true;
-        ack();
-      } else if (strcmp(command_data, "max_mags") == 0) {
-        stream_max_mags = true;
-        ack();
-      } else if (strcmp(command_data, "max_mags_followers") == 0) {
-        stream_max_mags_followers = true;
-        ack();
-      } else if (strcmp(command_data, "magnitudes") == 0) {
-        stream_magnitudes = true;
-        ack();
-      } else if (strcmp(command_data, "spectrogram") == 0) {
-        stream_spectrogram = true;
-        ack();
-      } else if (strcmp(command_data, "chromagram") == 0) {
-        stream_chromagram = true;
-        ack();
-      } else {
-        bad_command(command_type, command_data);
-      }
+    if (debug_mode) {
+      USBSerial.print("SECONDARY MODE CHANGED: from ");
+      USBSerial.print(previous_mode);
+      USBSerial.print(" (");
+      USBSerial.print(mode_names + (previous_mode * 32));
+      USBSerial.print(") to ");
+      USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
+      USBSerial.print(" (");
+      USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
+      USBSerial.println(")");
     }
 
-    // Toggle Color Shift ---------------------------------
-    else if (strcmp(command_type, "auto_color_shift") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.AUTO_COLOR_SHIFT = CONFIG_DEFAULTS.AUTO_COLOR_SHIFT;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.AUTO_COLOR_SHIFT = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.AUTO_COLOR_SHIFT = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
-
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.AUTO_COLOR_SHIFT: ");
-        USBSerial.println(CONFIG.AUTO_COLOR_SHIFT);
-        tx_end();
-      }
-    }
+    // Enable secondary LEDs if they aren't already
+    ENABLE_SECONDARY_LEDS = true;
+  } else {
+    bad_command(command.name, data);
+  }
+}
 
-    // Set Incandescent LUT intensity ----------------------------
-    else if (strcmp(command_type, "incandescent_filter") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.INCANDESCENT_FILTER = CONFIG_DEFAULTS.INCANDESCENT_FILTER;
-      } else {
-        CONFIG.INCANDESCENT_FILTER = atof(command_data);
-        if (CONFIG.INCANDESCENT_FILTER < 0.0) {
-          CONFIG.INCANDESCENT_FILTER = 0.0;
-        } else if (CONFIG.INCANDESCENT_FILTER > 1.0) {
-          CONFIG.INCANDESCENT_FILTER = 1.0;
-        }
-      }
+void cmd_secondary_status(const SerialCommand& command, char* data) {
+  tx_begin();
+  USBSerial.print("SECONDARY_ENABLED: ");
+  USBSerial.println(ENABLE_SECONDARY_LEDS ? "true" : "false");
+  USBSerial.print("SECONDARY_MODE: ");
+  USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
+  USBSerial.print(" (");
+  USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
+  USBSerial.println(")");
+  USBSerial.print("SECONDARY_PHOTONS: ");
+  USBSerial.println(SECONDARY_PHOTONS, 6);
+  USBSerial.print("SECONDARY_CHROMA: ");
+  USBSerial.println(SECONDARY_CHROMA, 6);
+  USBSerial.print("SECONDARY_MOOD: ");
+  USBSerial.println(SECONDARY_MOOD, 6);
+  USBSerial.print("SECONDARY_SATURATION: ");
+  USBSerial.println(SECONDARY_SATURATION, 6);
+  USBSerial.print("SECONDARY_PRISM_COUNT: ");
+  USBSerial.println(SECONDARY_PRISM_COUNT);
+  USBSerial.print("SECONDARY_MIRROR_ENABLED: ");
+  USBSerial.println(SECONDARY_MIRROR_ENABLED ? "true" : "false");
+  USBSerial.print("SECONDARY_REVERSE_ORDER: ");
+  USBSerial.println(SECONDARY_REVERSE_ORDER ? "true" : "false");
+  USBSerial.print("SECONDARY_BASE_COAT: ");
+  USBSerial.println(SECONDARY_BASE_COAT ? "true" : "false");
+  tx_end();
+}
 
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.INCANDESCENT_FILTER: ");
-      USBSerial.println(CONFIG.INCANDESCENT_FILTER);
-      tx_end();
-    }
+// Backward compatibility for old commands ------------------
+void cmd_legacy_secondary_on(const SerialCommand& command, char* data) {
+  ENABLE_SECONDARY_LEDS = true;
+  USBSerial.println("Secondary LEDs enabled");
+  USBSerial.println("NOTE: This command is deprecated, please use secondary_enabled=true instead");
+}
 
-    // Toggle Incandescent Mode ----------------------------
-    else if (strcmp(command_type, "incandescent_mode") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.INCANDESCENT_MODE = CONFIG_DEFAULTS.INCANDESCENT_MODE;
-        good = true;
-      } else if (strcmp(command_data, "true") == 0) {
-        CONFIG.INCANDESCENT_MODE = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        CONFIG.INCANDESCENT_MODE = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+void cmd_legacy_secondary_off(const SerialCommand& command, char* data) {
+  ENABLE_SECONDARY_LEDS = false;
+  USBSerial.println("Secondary LEDs disabled");
+  USBSerial.println("NOTE: This command is deprecated, please use secondary_enabled=false instead");
+}
 
-      if (good) {
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("CONFIG.INCANDESCENT_MODE: ");
-        USBSerial.println(CONFIG.INCANDESCENT_MODE);
-        tx_end();
-      }
-    }
+void cmd_legacy_secondary_status(const SerialCommand& command, char* data) {
+  USBSerial.print("Secondary LEDs: ");
+  USBSerial.println(ENABLE_SECONDARY_LEDS ? "ENABLED" : "DISABLED");
+  USBSerial.print("  Mode: ");
+  USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
+  USBSerial.print(" (");
+  USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
+  USBSerial.println(")");
+  USBSerial.print("  Photons: ");
+  USBSerial.println(SECONDARY_PHOTONS);
+  USBSerial.print("  Chroma: ");
+  USBSerial.println(SECONDARY_CHROMA);
+  USBSerial.print("  Mood: ");
+  USBSerial.println(SECONDARY_MOOD);
+  USBSerial.println("NOTE: This command is deprecated, please use secondary_status instead");
+}
 
-    // Set Bulb Cover Opacity ----------------------------
-    else if (strcmp(command_type, "bulb_opacity") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.BULB_OPACITY = CONFIG_DEFAULTS.BULB_OPACITY;
-      } else {
-        CONFIG.BULB_OPACITY = atof(command_data);
-        if (CONFIG.BULB_OPACITY < 0.0) {
-          CONFIG.BULB_OPACITY = 0.0;
-        } else if (CONFIG.BULB_OPACITY > 1.0) {
-          CONFIG.BULB_OPACITY = 1.0;
-        }
-      }
+// Test tone generation command ------------------------------
+void cmd_test_tone(const SerialCommand& command, char* data) {
+  // Parse frequency from data
+  float freq = atof(data);
+  if (freq >= 20.0 && freq <= 20000.0) {
+    // generate_test_tone(freq); // TODO: Implement
+    tx_begin();
+    USBSerial.print("Generated test tone at ");
+    USBSerial.print(freq);
+    USBSerial.println(" Hz in sample window");
+    tx_end();
+  } else {
+    bad_command(command.name, data);
+  }
+}
 
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.BULB_OPACITY: ");
-      USBSerial.println(CONFIG.BULB_OPACITY);
-      tx_end();
-    }
+// Set frame pacer target FPS ------------------------------
+void cmd_led_fps_target(const SerialCommand& command, char* data) {
+  int16_t fps = atol(data);
+  if (fps >= FRAME_PACER_MIN_FPS && fps <= 1000) {
+    set_frame_pacer_target_fps(fps);
+    tx_begin();
+    USBSerial.print("led_fps_target: ");
+    USBSerial.print(frame_pacer_target_fps);
+    USBSerial.print(" (period ");
+    USBSerial.print(frame_pacer_period_us());
+    USBSerial.println(" us)");
+    tx_end();
+  } else {
+    bad_command(command.name, data);
+  }
+}
 
-    // Set Saturation ----------------------------
-    else if (strcmp(command_type, "saturation") == 0) {
-      if (strcmp(command_data, "default") == 0) {
-        CONFIG.SATURATION = CONFIG_DEFAULTS.SATURATION;
-      } else {
-        CONFIG.SATURATION = atof(command_data);
-        if (CONFIG.SATURATION < 0.0) {
-          CONFIG.SATURATION = 0.0;
-        } else if (CONFIG.SATURATION > 1.0) {
-          CONFIG.SATURATION = 1.0;
-        }
-      }
+// Start system benchmark -----------------------------------
+void cmd_start_benchmark(const SerialCommand& command, char* data) {
+  if (!benchmark_running) {
+    benchmark_running = true;
+    benchmark_start_time = millis();
+    system_fps_sum = 0;
+    led_fps_sum = 0;
+    benchmark_sample_count = 0;
+    ack();
+    tx_begin();
+    USBSerial.print("Benchmark started (Duration: ");
+    USBSerial.print(benchmark_duration / 1000);
+    USBSerial.println(" seconds)...");
+    tx_end();
+  } else {
+    tx_begin(true);
+    USBSerial.println("Benchmark already running.");
+    tx_end(true);
+  }
+}
 
-      save_config_delayed();
-      tx_begin();
-      USBSerial.print("CONFIG.SATURATION: ");
-      USBSerial.println(CONFIG.SATURATION);
-      tx_end();
-    }
+// Batched changes ------------------------------------------
+void cmd_begin(const SerialCommand& command, char* data) {
+  if (config_transaction_open) {
+    tx_begin(true);
+    USBSerial.println("Already holding changes, commit or abort first");
+    tx_end(true);
+    return;
+  }
+  begin_config_transaction();  // (config_transaction.h)
+  ack();
+}
 
-    // Set Prism Count ----------------------------------------
-    else if (strcmp(command_type, "prism_count") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "default") == 0) {
-        good = true;
-        CONFIG.PRISM_COUNT = CONFIG_DEFAULTS.PRISM_COUNT;
-      } else {
-        good = true;
-        CONFIG.PRISM_COUNT = constrain(atol(command_data), 0, 10);
-      }
+void cmd_commit(const SerialCommand& command, char* data) {
+  const char* reason = NULL;
+  ConfigMask changed = staged_config_fields();
+  ConfigCommitResult result = commit_config_transaction(&reason);
 
-      if (good) {
-        save_config();
-        tx_begin();
-        USBSerial.print("CONFIG.PRISM_COUNT: ");
-        USBSerial.println(CONFIG.PRISM_COUNT);
-        tx_end();
-      }
+  if (result == CONFIG_COMMIT_QUEUED || result == CONFIG_COMMIT_REBOOT) {
+    tx_begin();
+    USBSerial.print("sbs((commit=");
+    USBSerial.print(config_mask_count(changed));
+    USBSerial.print(",reboot=");
+    USBSerial.print(result == CONFIG_COMMIT_REBOOT ? 1 : 0);
+    USBSerial.println("))");
+    tx_end();
+    if (result == CONFIG_COMMIT_REBOOT) {
+      save_config();
+      do_config_save();  // Now, reboot() doesn't come back to the loop that would
+      reboot();
     }
+    return;
+  }
 
-    // Set CONFIG preset ----------------------------
-    else if (strcmp(command_type, "preset") == 0) {
-      bool good = false;
-
-      if      (strcmp(command_data, "default")      == 0) { good = true; }
-      else if (strcmp(command_data, "tinted_bulbs") == 0) { good = true; }
-      else if (strcmp(command_data, "incandescent") == 0) { good = true; }
-      else if (strcmp(command_data, "white")        == 0) { good = true; }
-      else if (strcmp(command_data, "classic")      == 0) { good = true; }
-
-      else { // Bad preset name
-        bad_command(command_type, command_data);
-      }
-
-      if (good) {
-        set_preset(command_data); // presets.h
+  tx_begin(true);
+  if (result == CONFIG_COMMIT_NOT_OPEN) {
+    USBSerial.println("Nothing to commit, use begin first");
+  } else if (result == CONFIG_COMMIT_EMPTY) {
+    USBSerial.println("No changes were held, nothing to commit");
+  } else if (result == CONFIG_COMMIT_BUSY) {
+    USBSerial.println("The last commit hasn't been applied yet, try again");
+  } else {
+    USBSerial.print("Commit refused: ");
+    USBSerial.println(reason);
+  }
+  tx_end(true);
+}
 
-        save_config_delayed();
-        tx_begin();
-        USBSerial.print("ENABLED PRESET: ");
-        USBSerial.println(command_data);
-        tx_end();
-      }
-    }
+void cmd_abort(const SerialCommand& command, char* data) {
+  if (config_transaction_open == false) {
+    tx_begin(true);
+    USBSerial.println("No changes are being held");
+    tx_end(true);
+    return;
+  }
+  abort_config_transaction();
+  ack();
+}
 
-    // Secondary LED Controls ----------------------------
-    else if (strcmp(command_type, "secondary_enabled") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "true") == 0) {
-        ENABLE_SECONDARY_LEDS = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        ENABLE_SECONDARY_LEDS = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+void cmd_transaction(const SerialCommand& command, char* data) {
+  tx_begin();
+  print_config_transaction_status();  // (config_transaction.h)
+  tx_end();
+}
 
-      if (good) {
-        tx_begin();
-        USBSerial.print("SECONDARY_ENABLED: ");
-        USBSerial.println(ENABLE_SECONDARY_LEDS);
-        tx_end();
-      }
-    }
-    
-    else if (strcmp(command_type, "secondary_mode") == 0) {
-      uint8_t mode = atoi(command_data);
-      if (mode < NUM_MODES) {
-        uint8_t previous_mode = SECONDARY_LIGHTSHOW_MODE; // Store previous mode
-        SECONDARY_LIGHTSHOW_MODE = mode;
-        
-        tx_begin();
-        USBSerial.print("SECONDARY_MODE: ");
-        USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
-        USBSerial.print(" (");
-        USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
-        USBSerial.println(")");
-        tx_end();
-        
-        if (debug_mode) {
-          USBSerial.print("SECONDARY MODE CHANGED: from ");
-          USBSerial.print(previous_mode);
-          USBSerial.print(" (");
-          USBSerial.print(mode_names + (previous_mode * 32));
-          USBSerial.print(") to ");
-          USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
-          USBSerial.print(" (");
-          USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
-          USBSerial.println(")");
-        }
-        
-        // Enable secondary LEDs if they aren't already
-        ENABLE_SECONDARY_LEDS = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
-    }
-    
-    else if (strcmp(command_type, "secondary_photons") == 0) {
-      SECONDARY_PHOTONS = constrain(atof(command_data), 0.0, 1.0);
-      
-      tx_begin();
-      USBSerial.print("SECONDARY_PHOTONS: ");
-      USBSerial.println(SECONDARY_PHOTONS, 6);
-      tx_end();
-    }
-    
-    else if (strcmp(command_type, "secondary_chroma") == 0) {
-      SECONDARY_CHROMA = constrain(atof(command_data), 0.0, 1.0);
-      
-      tx_begin();
-      USBSerial.print("SECONDARY_CHROMA: ");
-      USBSerial.println(SECONDARY_CHROMA, 6);
-      tx_end();
-    }
-    
-    else if (strcmp(command_type, "secondary_mood") == 0) {
-      SECONDARY_MOOD = constrain(atof(command_data), 0.0, 1.0);
-      
-      tx_begin();
-      USBSerial.print("SECONDARY_MOOD: ");
-      USBSerial.println(SECONDARY_MOOD, 6);
-      tx_end();
-    }
-    
-    else if (strcmp(command_type, "secondary_saturation") == 0) {
-      SECONDARY_SATURATION = constrain(atof(command_data), 0.0, 1.0);
-      
-      tx_begin();
-      USBSerial.print("SECONDARY_SATURATION: ");
-      USBSerial.println(SECONDARY_SATURATION, 6);
-      tx_end();
-    }
-    
-    else if (strcmp(command_type, "secondary_prism_count") == 0) {
-      SECONDARY_PRISM_COUNT = constrain(atoi(command_data), 0, 10);
-      
-      tx_begin();
-      USBSerial.print("SECONDARY_PRISM_COUNT: ");
-      USBSerial.println(SECONDARY_PRISM_COUNT);
-      tx_end();
+// THE TABLE ################################################
+
+#define COMMAND(name, handler, flags) \
+  { name, handler, flags, NULL, NULL, 0, 0, NULL, NULL }
+#define NUMBER(name, type, field, min, max, flags) \
+  { name, set_number<type>, CMD_VALUE | (flags), &field, #field, min, max, NULL, NULL }
+#define TOGGLE(name, field, flags) \
+  { name, set_toggle, CMD_VALUE | (flags), &field, #field, 0, 1, NULL, NULL }
+#define CHOICE(name, type, field, choices, flags) \
+  { name, set_choice<type>, CMD_VALUE | (flags), &field, #field, 0, 0, choices, NULL }
+
+constexpr SerialCommand serial_commands[] = {
+  COMMAND("v",                 cmd_version,           CMD_BARE),
+  COMMAND("V",                 cmd_version,           CMD_BARE),
+  COMMAND("version",           cmd_version,           CMD_BARE),
+  COMMAND("h",                 cmd_help,              CMD_BARE),
+  COMMAND("H",                 cmd_help,              CMD_BARE),
+  COMMAND("help",              cmd_help,              CMD_BARE),
+  COMMAND("SB?",               cmd_identify_device,   CMD_BARE),
+  COMMAND("reset",             cmd_reset,             CMD_BARE),
+  COMMAND("factory_reset",     cmd_factory_reset,     CMD_BARE),
+  COMMAND("restore_defaults",  cmd_restore_defaults,  CMD_BARE),
+  COMMAND("chip_id",           cmd_chip_id,           CMD_BARE),
+  COMMAND("identify",          cmd_identify,          CMD_BARE),
+  COMMAND("start_noise_cal",   cmd_start_noise_cal,   CMD_BARE),
+  COMMAND("clear_noise_cal",   cmd_clear_noise_cal,   CMD_BARE),
+  COMMAND("delete_noise_file", cmd_delete_noise_file, CMD_BARE),
+  COMMAND("show_noise_levels", cmd_show_noise_levels, CMD_BARE),
+  COMMAND("noise_profiles",    cmd_noise_profiles,    CMD_BARE),
+  COMMAND("get_num_modes",     cmd_get_num_modes,     CMD_BARE),
+  COMMAND("get_mode",          cmd_get_mode,          CMD_BARE),
+  COMMAND("D",                 cmd_crash_dump,        CMD_BARE),
+  COMMAND("dump",              cmd_crash_dump,        CMD_BARE),
+  COMMAND("C",                 cmd_clear_dump,        CMD_BARE),
+  COMMAND("clear_dump",        cmd_clear_dump,        CMD_BARE),
+  COMMAND("test_crash",        cmd_test_crash,        CMD_BARE),
+  COMMAND("perf_test",         cmd_perf_test,         CMD_BARE),
+  COMMAND("perf_golden",       cmd_perf_golden,       CMD_BARE),
+  COMMAND("reset_reason",      cmd_reset_reason,      CMD_BARE),
+  COMMAND("stop",              cmd_stop,              CMD_BARE),
+  COMMAND("fps",               cmd_fps,               CMD_BARE),
+  COMMAND("led_fps",           cmd_led_fps,           CMD_BARE),
+  COMMAND("quality",           cmd_quality,           0),
+  COMMAND("render_resolution", cmd_render_resolution, CMD_BARE),
+  COMMAND("idle",              cmd_idle,              CMD_BARE),
+  COMMAND("derived",           cmd_derived,           CMD_BARE),
+  COMMAND("journal",           cmd_journal,           CMD_BARE),
+  COMMAND("presets",           cmd_presets,           CMD_BARE),
+  COMMAND("pixel_map",         cmd_pixel_map,         0),
+  COMMAND("pacer",             cmd_pacer,             CMD_BARE),
+  COMMAND("telemetry",         cmd_telemetry,         CMD_BARE),
+  COMMAND("latency",           cmd_latency,           CMD_BARE),
+  COMMAND("latency_reset",     cmd_latency_reset,     CMD_BARE),
+#ifdef ENABLE_SPAN_TRACE
+  COMMAND("trace_start",       cmd_trace_start,       CMD_BARE),
+  COMMAND("trace_dump",        cmd_trace_dump,        CMD_BARE),
+#endif
+  COMMAND("audio_guard",       cmd_audio_guard,       CMD_BARE),
+  COMMAND("get_knobs",         cmd_get_knobs,         CMD_BARE),
+  COMMAND("get_buttons",       cmd_get_buttons,       CMD_BARE),
+  COMMAND("freq_debug",        cmd_freq_debug,        CMD_BARE),
+  COMMAND("dc_diag",           cmd_dc_diag,           0),
+  COMMAND("debug",             cmd_debug,             CMD_VALUE),
+  COMMAND("get_mode_name",     cmd_get_mode_name,     CMD_VALUE),
+  COMMAND("led_type",          cmd_led_type,          CMD_VALUE),
+  COMMAND("bass_mode",         cmd_bass_mode,         CMD_VALUE),
+  COMMAND("stream",            cmd_stream,            CMD_VALUE),
+  COMMAND("preset",            cmd_preset,            CMD_VALUE),
+  COMMAND("preset_save",       cmd_preset_save,       CMD_VALUE),
+  COMMAND("preset_delete",     cmd_preset_delete,     CMD_VALUE),
+  COMMAND("noise_profile",     cmd_noise_profile,     CMD_VALUE),
+  COMMAND("noise_profile_save", cmd_noise_profile_save, CMD_VALUE),
+  COMMAND("noise_profile_delete", cmd_noise_profile_delete, CMD_VALUE),
+  COMMAND("test_tone",         cmd_test_tone,         CMD_VALUE),
+  COMMAND("led_fps_target",    cmd_led_fps_target,    CMD_VALUE),
+  COMMAND("start_benchmark",   cmd_start_benchmark,   0),
+  COMMAND("begin",             cmd_begin,             CMD_BARE),
+  COMMAND("commit",            cmd_commit,            CMD_BARE),
+  COMMAND("abort",             cmd_abort,             CMD_BARE),
+  COMMAND("transaction",       cmd_transaction,       CMD_BARE),
+
+  NUMBER("sample_rate",         uint32_t, CONFIG.SAMPLE_RATE,          6400, 44100,                 CMD_REBOOT),
+  NUMBER("note_offset",         uint8_t,  CONFIG.NOTE_OFFSET,          0,    32,                    CMD_SAVE),
+  NUMBER("led_count",           uint16_t, CONFIG.LED_COUNT,            1,    10000,                 CMD_REBOOT),
+  NUMBER("samples_per_chunk",   uint16_t, CONFIG.SAMPLES_PER_CHUNK,    1,    SAMPLE_HISTORY_LENGTH, CMD_REBOOT),
+  NUMBER("mode_fade_ms",        uint16_t, CONFIG.MODE_FADE_MS,         0,    MODE_FADE_MAX_MS,      CMD_SAVE),
+  NUMBER("square_iter",         uint8_t,  CONFIG.SQUARE_ITER,          0,    10,                    CMD_SAVE),
+  NUMBER("sensitivity",         float,    CONFIG.SENSITIVITY,          0,    FLT_MAX,               CMD_SAVE),
+  NUMBER("sweet_spot_min",      uint32_t, CONFIG.SWEET_SPOT_MIN_LEVEL, 0,    UINT32_MAX,            CMD_SAVE),
+  NUMBER("sweet_spot_max",      uint32_t, CONFIG.SWEET_SPOT_MAX_LEVEL, 0,    UINT32_MAX,            CMD_SAVE),
+  NUMBER("chromagram_range",    uint8_t,  CONFIG.CHROMAGRAM_RANGE,     1,    64,                    CMD_SAVE),
+  NUMBER("incandescent_filter", float,    CONFIG.INCANDESCENT_FILTER,  0,    1,                     CMD_SAVE),
+  NUMBER("bulb_opacity",        float,    CONFIG.BULB_OPACITY,         0,    1,                     CMD_SAVE),
+  NUMBER("saturation",          float,    CONFIG.SATURATION,           0,    1,                     CMD_SAVE),
+  NUMBER("prism_count",         float,    CONFIG.PRISM_COUNT,          0,    10,                    CMD_SAVE_NOW | CMD_WHOLE),
+  { "max_current_ma", set_number<uint32_t>, CMD_VALUE | CMD_SAVE, &CONFIG.MAX_CURRENT_MA, "CONFIG.MAX_CURRENT_MA", 0, UINT32_MAX, NULL, apply_max_current },
+  { "set_mode", set_number<int16_t>, CMD_VALUE | CMD_SAVE, &mode_destination, "CONFIG.LIGHTSHOW_MODE", 0, NUM_MODES - 1, NULL, queue_mode_transition },
+
+  TOGGLE("boot_animation",      CONFIG.BOOT_ANIMATION,     CMD_REBOOT),
+  TOGGLE("led_interpolation",   CONFIG.LED_INTERPOLATION,  CMD_SAVE),
+  TOGGLE("base_coat",           CONFIG.BASE_COAT,          CMD_SAVE),
+  TOGGLE("temporal_dithering",  CONFIG.TEMPORAL_DITHERING, CMD_SAVE),
+  TOGGLE("mirror_enabled",      CONFIG.MIRROR_ENABLED,     CMD_SAVE),
+  TOGGLE("standby_dimming",     CONFIG.STANDBY_DIMMING,    CMD_SAVE),
+  TOGGLE("reverse_order",       CONFIG.REVERSE_ORDER,      CMD_SAVE),
+  TOGGLE("auto_color_shift",    CONFIG.AUTO_COLOR_SHIFT,   CMD_SAVE),
+  TOGGLE("incandescent_mode",   CONFIG.INCANDESCENT_MODE,  CMD_SAVE),
+  TOGGLE("noise_tracking",      noise_tracking,            0),  // Not saved
+
+  CHOICE("led_color_order", uint16_t, CONFIG.LED_COLOR_ORDER, led_color_order_choices, CMD_REBOOT),
+  CHOICE("render_mode",     uint8_t,  CONFIG.RENDER_MODE,     render_mode_choices,     CMD_REBOOT),  // The render arena is sized at boot
+
+  // The secondary strip isn't saved
+  { "secondary_enabled", set_toggle, CMD_VALUE, &ENABLE_SECONDARY_LEDS, "SECONDARY_ENABLED", 0, 1, NULL, NULL },
+  NUMBER("secondary_photons",     float,   SECONDARY_PHOTONS,     0, 1,  CMD_FINE),
+  NUMBER("secondary_chroma",      float,   SECONDARY_CHROMA,      0, 1,  CMD_FINE),
+  NUMBER("secondary_mood",        float,   SECONDARY_MOOD,        0, 1,  CMD_FINE),
+  NUMBER("secondary_saturation",  float,   SECONDARY_SATURATION,  0, 1,  CMD_FINE),
+  NUMBER("secondary_prism_count", uint8_t, SECONDARY_PRISM_COUNT, 0, 10, 0),
+  TOGGLE("secondary_mirror_enabled", SECONDARY_MIRROR_ENABLED, 0),
+  TOGGLE("secondary_reverse_order",  SECONDARY_REVERSE_ORDER,  0),
+  TOGGLE("secondary_base_coat",      SECONDARY_BASE_COAT,      0),
+  COMMAND("secondary_mode",    cmd_secondary_mode,    CMD_VALUE),
+  COMMAND("secondary_status",  cmd_secondary_status,  0),
+  COMMAND("SECONDARY_ON",      cmd_legacy_secondary_on,     CMD_BARE),
+  COMMAND("SECONDARY_OFF",     cmd_legacy_secondary_off,    CMD_BARE),
+  COMMAND("SECONDARY_STATUS",  cmd_legacy_secondary_status, CMD_BARE),
+};
+
+#undef COMMAND
+#undef NUMBER
+#undef TOGGLE
+#undef CHOICE
+
+constexpr auto serial_command_index = build_command_index(serial_commands);  // (command_table.h)
+static_assert(serial_command_index.complete, "Two serial commands have the same name");
+
+// Distinct apply hooks in «commands», the most one batch can gather
+template <size_t N>
+constexpr uint8_t count_apply_hooks(const SerialCommand (&commands)[N]) {
+  uint8_t count = 0;
+  for (size_t i = 0; i < N; i++) {
+    bool first = (commands[i].apply != NULL);
+    for (size_t j = 0; j < i && first; j++) {
+      first = (commands[j].apply != commands[i].apply);
     }
-    
-    else if (strcmp(command_type, "secondary_mirror_enabled") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "true") == 0) {
-        SECONDARY_MIRROR_ENABLED = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        SECONDARY_MIRROR_ENABLED = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+    count += first ? 1 : 0;
+  }
+  return count;
+}
+static_assert(count_apply_hooks(serial_commands) <= CONFIG_TRANSACTION_MAX_HOOKS,
+              "A batch could gather more apply hooks than CONFIG_TRANSACTION_MAX_HOOKS (config_transaction.h)");
 
-      if (good) {
-        tx_begin();
-        USBSerial.print("SECONDARY_MIRROR_ENABLED: ");
-        USBSerial.println(SECONDARY_MIRROR_ENABLED);
-        tx_end();
-      }
-    }
-    
-    else if (strcmp(command_type, "secondary_reverse_order") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "true") == 0) {
-        SECONDARY_REVERSE_ORDER = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        SECONDARY_REVERSE_ORDER = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+// COMMAND PARSER ###########################################
 
-      if (good) {
-        tx_begin();
-        USBSerial.print("SECONDARY_REVERSE_ORDER: ");
-        USBSerial.println(SECONDARY_REVERSE_ORDER);
-        tx_end();
-      }
-    }
-    
-    else if (strcmp(command_type, "secondary_base_coat") == 0) {
-      bool good = false;
-      if (strcmp(command_data, "true") == 0) {
-        SECONDARY_BASE_COAT = true;
-        good = true;
-      } else if (strcmp(command_data, "false") == 0) {
-        SECONDARY_BASE_COAT = false;
-        good = true;
-      } else {
-        bad_command(command_type, command_data);
-      }
+// Commands only matched by how they start, which a hash can't do
+void parse_prefixed_command(char* command_buf) {
+#ifdef ENABLE_PERFORMANCE_MONITORING
+  if (strncmp(command_buf, "PERF", 4) == 0) {
+    handle_perf_command(command_buf);
+    return;
+  }
+#endif
 
-      if (good) {
-        tx_begin();
-        USBSerial.print("SECONDARY_BASE_COAT: ");
-        USBSerial.println(SECONDARY_BASE_COAT);
-        tx_end();
-      }
-    }
-    
-    else if (strcmp(command_type, "secondary_status") == 0) {
-      tx_begin();
-      USBSerial.print("SECONDARY_ENABLED: ");
-      USBSerial.println(ENABLE_SECONDARY_LEDS ? "true" : "false");
-      USBSerial.print("SECONDARY_MODE: ");
-      USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
-      USBSerial.print(" (");
-      USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
-      USBSerial.println(")");
-      USBSerial.print("SECONDARY_PHOTONS: ");
-      USBSerial.println(SECONDARY_PHOTONS, 6);
-      USBSerial.print("SECONDARY_CHROMA: ");
-      USBSerial.println(SECONDARY_CHROMA, 6);
-      USBSerial.print("SECONDARY_MOOD: ");
-      USBSerial.println(SECONDARY_MOOD, 6);
-      USBSerial.print("SECONDARY_SATURATION: ");
-      USBSerial.println(SECONDARY_SATURATION, 6);
-      USBSerial.print("SECONDARY_PRISM_COUNT: ");
-      USBSerial.println(SECONDARY_PRISM_COUNT);
-      USBSerial.print("SECONDARY_MIRROR_ENABLED: ");
-      USBSerial.println(SECONDARY_MIRROR_ENABLED ? "true" : "false");
-      USBSerial.print("SECONDARY_REVERSE_ORDER: ");
-      USBSerial.println(SECONDARY_REVERSE_ORDER ? "true" : "false");
-      USBSerial.print("SECONDARY_BASE_COAT: ");
-      USBSerial.println(SECONDARY_BASE_COAT ? "true" : "false");
-      tx_end();
-    }
-    
-    // Add backward compatibility for old commands
-    else if (strcmp(command_buf, "SECONDARY_ON") == 0) {
+  // Deprecated, "SECONDARY_MODE 3" as well as "SECONDARY_MODE=3"
+  if (strncmp(command_buf, "SECONDARY_MODE", 14) == 0) {
+    uint8_t mode = atoi(command_buf + 15);
+    if (mode < NUM_MODES) {
+      SECONDARY_LIGHTSHOW_MODE = mode;
+      USBSerial.print("Secondary mode set to: ");
+      USBSerial.println(mode_names + (mode * 32));
       ENABLE_SECONDARY_LEDS = true;
-      USBSerial.println("Secondary LEDs enabled");
-      USBSerial.println("NOTE: This command is deprecated, please use secondary_enabled=true instead");
-    }
-    else if (strcmp(command_buf, "SECONDARY_OFF") == 0) {
-      ENABLE_SECONDARY_LEDS = false;
-      USBSerial.println("Secondary LEDs disabled");
-      USBSerial.println("NOTE: This command is deprecated, please use secondary_enabled=false instead");
-    }
-    else if (strncmp(command_buf, "SECONDARY_MODE", 14) == 0) {
-      uint8_t mode = atoi(command_buf + 15);
-      if (mode < NUM_MODES) {
-        SECONDARY_LIGHTSHOW_MODE = mode;
-        USBSerial.print("Secondary mode set to: ");
-        USBSerial.println(mode_names + (mode * 32));
-        ENABLE_SECONDARY_LEDS = true;
-        USBSerial.println("NOTE: This command is deprecated, please use secondary_mode=[int] instead");
-      } else {
-        USBSerial.println("Invalid mode number");
-      }
-    }
-    else if (strcmp(command_buf, "SECONDARY_STATUS") == 0) {
-      USBSerial.print("Secondary LEDs: ");
-      USBSerial.println(ENABLE_SECONDARY_LEDS ? "ENABLED" : "DISABLED");
-      USBSerial.print("  Mode: ");
-      USBSerial.print(SECONDARY_LIGHTSHOW_MODE);
-      USBSerial.print(" (");
-      USBSerial.print(mode_names + (SECONDARY_LIGHTSHOW_MODE * 32));
-      USBSerial.println(")");
-      USBSerial.print("  Photons: ");
-      USBSerial.println(SECONDARY_PHOTONS);
-      USBSerial.print("  Chroma: ");
-      USBSerial.println(SECONDARY_CHROMA);
-      USBSerial.print("  Mood: ");
-      USBSerial.println(SECONDARY_MOOD);
-      USBSerial.println("NOTE: This command is deprecated, please use secondary_status instead");
+      USBSerial.println("NOTE: This command is deprecated, please use secondary_mode=[int] instead");
+    } else {
+      USBSerial.println("Invalid mode number");
     }
+    return;
+  }
 
-    // Test tone generation command ------------------------------
-    else if (strcmp(command_type, "test_tone") == 0) {
-      // Parse frequency from command_data
-      float freq = atof(command_data);
-      if (freq >= 20.0 && freq <= 20000.0) {
-        // generate_test_tone(freq); // TODO: Implement
-        tx_begin();
-        USBSerial.print("Generated test tone at ");
-        USBSerial.print(freq);
-        USBSerial.println(" Hz in sample window");
-        tx_end();
-      } else {
-        bad_command(command_type, command_data);
-      }
-    }
-    
-    // Performance monitoring commands --------------------------
-#ifdef ENABLE_PERFORMANCE_MONITORING
-    else if (strncmp(command_type, "PERF", 4) == 0) {
-      handle_perf_command(command_buf);
-    }
-#endif
+  bad_command(command_buf, "");
+}
 
-    // Start system benchmark -----------------------------------
-    else if (strcmp(command_type, "start_benchmark") == 0) {
-
-      if (!benchmark_running) {
-        benchmark_running = true;
-        benchmark_start_time = millis();
-        system_fps_sum = 0;
-        led_fps_sum = 0;
-        benchmark_sample_count = 0;
-        ack();
-        tx_begin();
-        USBSerial.print("Benchmark started (Duration: ");
-        USBSerial.print(benchmark_duration / 1000);
-        USBSerial.println(" seconds)...");
-        tx_end();
-      } else {
-        tx_begin(true);
-        USBSerial.println("Benchmark already running.");
-        tx_end(true);
-      }
+void parse_command(char* command_buf) {
+  // "name" or "name=value", the name alone finds the row
+  char* equals = strchr(command_buf, '=');
+  size_t name_length = (equals != NULL) ? size_t(equals - command_buf) : strlen(command_buf);
+  const SerialCommand* command = serial_command_index.find(serial_commands, command_buf, name_length);
+  if (command == NULL) {
+    parse_prefixed_command(command_buf);
+    return;
+  }
 
-    }
+  char* data = command_buf + name_length;  // Empty for a bare command
+  if (equals != NULL) {
+    *equals = '\0';
+    data = equals + 1;
+  }
 
-    // COMMAND NOT RECOGNISED #############################
-    else {
-      bad_command(command_type, command_data);
-    }
-    // COMMAND NOT RECOGNISED #############################
+  if (((command->flags & CMD_BARE) && equals != NULL) || ((command->flags & CMD_VALUE) && equals == NULL)) {
+    bad_command(command->name, data);
+    return;
   }
+
+  command->handler(*command, data);
 }
 
 // Called on every frame, collects incoming characters until
 // potential commands are found
 void check_serial(uint32_t t_now) {
   serial_iter++;
-  if (USBSerial.available() > 0) {
+  if (!command_ready && USBSerial.available() > 0) {
     char c = USBSerial.read();
     if (c != '\n') {  // If normal character, add to buffer
       command_buf[command_buf_index] = c;
@@ -1696,9 +1742,18 @@ void check_serial(uint32_t t_now) {
 
     } else {  // If a newline character is received,
       // the command in the buffer should be parsed
-      parse_command(command_buf);                   // Parse
-      memset(&command_buf, 0, sizeof(char) * 128);  // Clear
-      command_buf_index = 0;                        // Reset
+      command_ready = true;
     }
   }
+
+  // The reply can't split a telemetry frame (telemetry.h), but the drain
+  // task can hold serial_mutex for as long as the host leaves USB full.
+  // Never wait for it here: keep the line and try again next frame
+  if (command_ready && xSemaphoreTake(serial_mutex, 0) == pdTRUE) {
+    parse_command(command_buf);  // Parse
+    xSemaphoreGive(serial_mutex);
+    memset(&command_buf, 0, sizeof(char) * 128);  // Clear
+    command_buf_index = 0;                        // Reset
+    command_ready = false;
+  }
 }
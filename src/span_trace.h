@@ -0,0 +1,261 @@
+#ifndef SPAN_TRACE_H
+#define SPAN_TRACE_H
+
+/*----------------------------------------
+  Sensory Bridge SPAN TRACE
+  ----------------------------------------*/
+
+// Begin/end events for the pipeline stages on both cores, for looking at
+// how they interleave on a timeline. Each event is 8 bytes: the CPU cycle
+// counter, the span and begin or end. Each core has its own ring of
+// SPAN_TRACE_EVENTS, so a core only ever contends with other tasks on the
+// same core, and a slot is claimed with one atomic add.
+//
+// The two cores' cycle counters aren't synchronized, so every
+// SPAN_TRACE_ANCHOR_EVERY events a core also stores its cycle count next
+// to esp_timer's microseconds (common to both cores). Decoding puts every
+// event on that shared clock through its own core's latest anchor. Cycle
+// counts wrap every ~18s at 240MHz, a ring covers far less than that.
+//
+// Dump format, little-endian:
+//
+//   "SBTR" u8 version u8 cores u16 cpu_mhz u8 tracks u8 spans
+//   tracks x { u8 length, name }
+//   spans x { u8 track, u8 length, name }
+//   cores x { u8 core, u32 anchor_cycles, u32 anchor_us, u32 count,
+//             count x { u32 cycles, u8 span, u8 kind, u16 0 } }
+//
+// Recording and the dump writer run on the device (trace_recorder.h),
+// trace_read_dump() on the host (tools/trace_to_chrome.cpp). Nothing in
+// here depends on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+#define SPAN_TRACE_EVENTS       1024  // Per core, power of two
+#define SPAN_TRACE_CORES        2
+#define SPAN_TRACE_ANCHOR_EVERY 256   // Events between clock anchors, power of two
+#define SPAN_TRACE_VERSION      1
+
+// Which task a span runs on, so the host can give each its own row
+enum TraceTrack : uint8_t {
+  TRACK_AUDIO,  // main_loop_core0(), core 0
+  TRACK_LED,    // led_thread, core 1
+  TRACK_TX,     // led_tx task, core 1
+  NUM_TRACE_TRACKS
+};
+
+static const char* const trace_track_names[NUM_TRACE_TRACKS] = {
+  "audio", "led_thread", "led_tx"
+};
+
+enum TraceSpan : uint8_t {
+  // Core 0, main_loop_core0()
+  SPAN_AUDIO_FRAME,
+  SPAN_INPUTS,       // Knobs, buttons, settings
+  SPAN_SERIAL,
+  SPAN_I2S_READ,
+  SPAN_VU,
+  SPAN_GDFT,
+  SPAN_NOVELTY,
+  SPAN_CONFIG_SAVE,
+  // Core 1, led_thread and led_tx
+  SPAN_PACER_WAIT,
+  SPAN_LED_FRAME,
+  SPAN_SPECTRUM,     // Smoothing the spectrogram and chromagram
+  SPAN_RENDER,       // Primary mode(s), cross-fade included
+  SPAN_EFFECTS,      // Prism and bulb cover
+  SPAN_SECONDARY,
+  SPAN_SHOW,
+  SPAN_QUANTIZE,
+  SPAN_PRESENT,      // Waits out the previous transfer, copies and starts the next
+  SPAN_TX,           // FastLED.show() on the led_tx task
+  NUM_TRACE_SPANS
+};
+
+static const char* const trace_span_names[NUM_TRACE_SPANS] = {
+  "audio_frame", "inputs", "serial", "i2s_read", "vu", "gdft", "novelty", "config_save",
+  "pacer_wait", "led_frame", "spectrum", "render", "effects", "secondary", "show", "quantize", "present", "tx"
+};
+
+static const uint8_t trace_span_tracks[NUM_TRACE_SPANS] = {
+  TRACK_AUDIO, TRACK_AUDIO, TRACK_AUDIO, TRACK_AUDIO, TRACK_AUDIO, TRACK_AUDIO, TRACK_AUDIO, TRACK_AUDIO,
+  TRACK_LED, TRACK_LED, TRACK_LED, TRACK_LED, TRACK_LED, TRACK_LED, TRACK_LED, TRACK_LED, TRACK_LED, TRACK_TX
+};
+
+enum TraceEventKind : uint8_t {
+  TRACE_BEGIN_EVENT,
+  TRACE_END_EVENT
+};
+
+struct TraceEvent {
+  uint32_t cycles;
+  uint8_t span;
+  uint8_t kind;
+  uint16_t reserved;
+};
+
+struct TraceRing {
+  std::atomic<uint32_t> head;  // Events ever pushed
+  uint32_t anchor_cycles;      // Latest cycle count / microsecond pair from this core
+  uint32_t anchor_us;
+  TraceEvent events[SPAN_TRACE_EVENTS];
+};
+
+inline void trace_ring_clear(TraceRing& ring) {
+  ring.head.store(0, std::memory_order_relaxed);
+  ring.anchor_cycles = 0;
+  ring.anchor_us = 0;
+}
+
+// Returns true when it's time for a trace_ring_anchor() from the same core
+inline bool trace_ring_push(TraceRing& ring, uint32_t cycles, uint8_t span, uint8_t kind) {
+  uint32_t index = ring.head.fetch_add(1, std::memory_order_relaxed);
+  TraceEvent& event = ring.events[index & (SPAN_TRACE_EVENTS - 1)];
+  event.cycles = cycles;
+  event.span = span;
+  event.kind = kind;
+  event.reserved = 0;
+  return (index & (SPAN_TRACE_ANCHOR_EVERY - 1)) == 0;
+}
+
+inline void trace_ring_anchor(TraceRing& ring, uint32_t cycles, uint32_t now_us) {
+  ring.anchor_cycles = cycles;
+  ring.anchor_us = now_us;
+}
+
+// Writing -------------------------------------------------------------------
+
+// «write» is any callable taking (const uint8_t*, size_t). Rings must not
+// be pushed to meanwhile.
+template <class Write>
+void trace_write_dump(const TraceRing rings[], uint8_t num_cores, uint16_t cpu_mhz, Write& write) {
+  uint8_t header[10] = { 'S', 'B', 'T', 'R', SPAN_TRACE_VERSION, num_cores,
+                         uint8_t(cpu_mhz), uint8_t(cpu_mhz >> 8), NUM_TRACE_TRACKS, NUM_TRACE_SPANS };
+  write(header, sizeof(header));
+
+  for (uint8_t t = 0; t < NUM_TRACE_TRACKS; t++) {
+    uint8_t length = strlen(trace_track_names[t]);
+    write(&length, 1);
+    write((const uint8_t*)trace_track_names[t], length);
+  }
+  for (uint8_t s = 0; s < NUM_TRACE_SPANS; s++) {
+    uint8_t entry[2] = { trace_span_tracks[s], uint8_t(strlen(trace_span_names[s])) };
+    write(entry, 2);
+    write((const uint8_t*)trace_span_names[s], entry[1]);
+  }
+
+  for (uint8_t c = 0; c < num_cores; c++) {
+    const TraceRing& ring = rings[c];
+    uint32_t head = ring.head.load(std::memory_order_acquire);
+    uint32_t count = (head < SPAN_TRACE_EVENTS) ? head : SPAN_TRACE_EVENTS;
+
+    uint8_t core_header[13];
+    core_header[0] = c;
+    uint32_t fields[3] = { ring.anchor_cycles, ring.anchor_us, count };
+    for (uint8_t f = 0; f < 3; f++) {
+      for (uint8_t b = 0; b < 4; b++) {
+        core_header[1 + f * 4 + b] = uint8_t(fields[f] >> (b * 8));
+      }
+    }
+    write(core_header, sizeof(core_header));
+
+    for (uint32_t i = head - count; i != head; i++) {
+      const TraceEvent& event = ring.events[i & (SPAN_TRACE_EVENTS - 1)];
+      uint8_t bytes[8] = { uint8_t(event.cycles), uint8_t(event.cycles >> 8), uint8_t(event.cycles >> 16),
+                           uint8_t(event.cycles >> 24), event.span, event.kind, 0, 0 };
+      write(bytes, sizeof(bytes));
+    }
+  }
+}
+
+// Reading -------------------------------------------------------------------
+
+struct TraceDumpInfo {
+  uint8_t num_cores;
+  uint16_t cpu_mhz;
+  uint8_t num_tracks;
+  uint8_t num_spans;
+  char track_names[256][32];
+  char span_names[256][32];
+  uint8_t span_tracks[256];
+};
+
+inline uint32_t trace_get_u32(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// Copy a length-prefixed name at data[at] into «name», 0 if it runs past «length»
+inline size_t trace_get_name(const uint8_t* data, size_t length, size_t at, char name[32]) {
+  if (at >= length || at + 1 + data[at] > length) {
+    return 0;
+  }
+  uint8_t copy = (data[at] < 31) ? data[at] : 31;
+  memcpy(name, data + at + 1, copy);
+  name[copy] = '\0';
+  return at + 1 + data[at];
+}
+
+// Walk a dump, calling visit(core, span, kind, time_us) for every event in
+// ring order, with time_us on the shared microsecond clock. Returns the
+// bytes consumed, 0 if «data» doesn't start with a valid dump.
+template <class Visit>
+size_t trace_read_dump(const uint8_t* data, size_t length, TraceDumpInfo& info, Visit& visit) {
+  if (length < 10 || memcmp(data, "SBTR", 4) != 0 || data[4] != SPAN_TRACE_VERSION) {
+    return 0;
+  }
+  info.num_cores = data[5];
+  info.cpu_mhz = uint16_t(data[6] | (data[7] << 8));
+  info.num_tracks = data[8];
+  info.num_spans = data[9];
+  if (info.cpu_mhz == 0) {
+    return 0;
+  }
+  size_t at = 10;
+
+  for (uint16_t t = 0; t < info.num_tracks; t++) {
+    if ((at = trace_get_name(data, length, at, info.track_names[t])) == 0) {
+      return 0;
+    }
+  }
+  for (uint16_t s = 0; s < info.num_spans; s++) {
+    if (at >= length || data[at] >= info.num_tracks) {
+      return 0;
+    }
+    info.span_tracks[s] = data[at];
+    if ((at = trace_get_name(data, length, at + 1, info.span_names[s])) == 0) {
+      return 0;
+    }
+  }
+
+  uint32_t first_anchor_us = 0;
+  for (uint8_t c = 0; c < info.num_cores; c++) {
+    if (at + 13 > length) {
+      return 0;
+    }
+    uint8_t core = data[at];
+    uint32_t anchor_cycles = trace_get_u32(data + at + 1);
+    uint32_t anchor_us_raw = trace_get_u32(data + at + 5);
+    if (c == 0) {
+      first_anchor_us = anchor_us_raw;
+    }
+    // The microsecond clock is truncated to 32 bits, keep the cores together if it wrapped between anchors
+    double anchor_us = double(first_anchor_us) + double(int32_t(anchor_us_raw - first_anchor_us));
+    uint32_t count = trace_get_u32(data + at + 9);
+    at += 13;
+    if (count > (length - at) / 8) {
+      return 0;
+    }
+
+    for (uint32_t e = 0; e < count; e++, at += 8) {
+      int32_t cycles_from_anchor = int32_t(trace_get_u32(data + at) - anchor_cycles);
+      double time_us = anchor_us + double(cycles_from_anchor) / info.cpu_mhz;
+      visit(core, data[at + 4], data[at + 5], time_us);
+    }
+  }
+
+  return at;
+}
+
+#endif // SPAN_TRACE_H
@@ -10,10 +10,12 @@ void reboot() {
     MASTER_BRIGHTNESS = i;
     run_sweet_spot();
     show_leds();
-    FastLED.delay(12); // Takes ~250ms total
+    delay(12); // Takes ~250ms total
   }
+  flush_led_output();  // (led_output.h) FastLED is only called directly once the strip is idle
   FastLED.setBrightness(0);
   FastLED.show();
+  flush_saves();  // (bridge_fs.h) Whatever was posted just before reaches flash
   ESP.restart();
 }
 
@@ -92,7 +94,7 @@ void enable_usb_update_mode() {
 
   MASTER_BRIGHTNESS = 1.0;
 
-  uint8_t led_index = 0;
+  uint16_t led_index = 0;
   uint8_t sweet_index = 0;
 
   const uint8_t sweet_order[3][3] = {
@@ -102,7 +104,7 @@ void enable_usb_update_mode() {
   };
 
   while (true) {
-    for (uint8_t i = 0; i < NATIVE_RESOLUTION; i++) {
+    for (uint16_t i = 0; i < render_resolution; i++) {
       leds_16[i] = {0, 0, 0};
     }
 
@@ -115,7 +117,7 @@ void enable_usb_update_mode() {
       #endif
     }
     else {
-      leds_16[NATIVE_RESOLUTION-1-led_index] = {0, 0.25, 0};
+      leds_16[render_resolution-1-led_index] = {0, 0.25, 0};
       #ifndef ARDUINO_ESP32S3_DEV
       ledcWrite(SWEET_SPOT_LEFT_CHANNEL,   sweet_order[sweet_index][2] * 4095);
       ledcWrite(SWEET_SPOT_CENTER_CHANNEL, sweet_order[sweet_index][1] * 4095);
@@ -126,7 +128,7 @@ void enable_usb_update_mode() {
 
     show_leds();
 
-    if(led_index == 0 || led_index == NATIVE_RESOLUTION/2){
+    if(led_index == 0 || led_index == render_resolution/2){
       sweet_index++;
       if (sweet_index >= 3) {
         sweet_index = 0;
@@ -134,7 +136,7 @@ void enable_usb_update_mode() {
     }
 
     led_index++;
-    if (led_index >= NATIVE_RESOLUTION) {
+    if (led_index >= render_resolution) {
       led_index = 0;      
     }
     yield();
@@ -282,6 +284,48 @@ void precompute_goertzel_constants() {
   }
 }
 
+// Derived tables (derived_tables.h) ------------------------------------------
+
+enum audio_table_ids {
+  AUDIO_TABLE_GOERTZEL,
+  AUDIO_TABLE_NOISE_FLOOR,
+  NUM_AUDIO_TABLES
+};
+
+const DerivedTable audio_table_list[NUM_AUDIO_TABLES] = {
+  { "goertzel",    CONFIG_MASK(SAMPLE_RATE) | CONFIG_MASK(NOTE_OFFSET), NULL, precompute_goertzel_constants },
+  { "noise_floor", CONFIG_MASK(NOTE_OFFSET),                            NULL, shift_noise_floor },  // (noise_cal.h)
+};
+
+DerivedTables<NUM_AUDIO_TABLES> audio_tables(audio_table_list, derived_clock_us);  // (led_utilities.h) for the clock
+
+// main_loop_core0, once inputs and serial are done changing CONFIG for this frame
+uint8_t refresh_audio_tables() {
+  return audio_tables.refresh(CONFIG);
+}
+
+template <size_t N>
+void print_derived_table_stats(const DerivedTables<N>& tables) {
+  for (size_t t = 0; t < N; t++) {
+    USBSerial.print("sbs((table=");
+    USBSerial.print(tables.tables[t].name);
+    USBSerial.print(",builds=");
+    USBSerial.print(tables.stats[t].builds);
+    USBSerial.print(",last_us=");
+    USBSerial.print(tables.stats[t].last_us);
+    USBSerial.print(",max_us=");
+    USBSerial.print(tables.stats[t].max_us);
+    USBSerial.print(",total_us=");
+    USBSerial.print(tables.stats[t].total_us);
+    USBSerial.println("))");
+  }
+}
+
+void print_derived_tables() {
+  print_derived_table_stats(audio_tables);
+  print_derived_table_stats(led_tables);  // (led_utilities.h)
+}
+
 void debug_function_timing(uint32_t t_now) {
   static uint32_t last_timing_print = t_now;
 
@@ -370,6 +414,7 @@ void init_system() {
   #endif
 
   init_leds();
+  proc_seed(mode_rng, esp_random());  // (procedural.h)
 
   #ifndef ARDUINO_ESP32S3_DEV
   // MODE held down on boot (S2 only - S3 has no physical buttons)
@@ -390,7 +435,7 @@ void init_system() {
   
   generate_a_weights();
   generate_window_lookup();
-  precompute_goertzel_constants();
+  refresh_audio_tables();  // Goertzel constants and the noise floor's note offset, rebuilt by main_loop_core0 when their inputs change
 
   USBSerial.println("SYSTEM INIT COMPLETE!");
 
@@ -421,11 +466,7 @@ void log_fps(uint32_t t_now_us) {
 
   SYSTEM_FPS = fps_sum / 10.0;
 
-  if (stream_fps == true) {
-    USBSerial.print("sbs((fps=");
-    USBSerial.print(SYSTEM_FPS);
-    USBSerial.println("))");
-  }
+  telemetry_stream_fps();  // (telemetry.h)
 
   t_last = t_now_us;
 }
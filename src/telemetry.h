@@ -0,0 +1,154 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*----------------------------------------
+  Sensory Bridge TELEMETRY
+  ----------------------------------------*/
+
+// Device side of telemetry_frame.h. The "stream=..." outputs queue one
+// binary frame each into a ring and return, a low priority task on core 0
+// writes the ring to USB a whole frame at a time, under serial_mutex like
+// every other writer. When the host can't keep up whole frames are dropped
+// (and counted), the audio thread never waits on the port.
+//
+// Every stream is produced on the audio thread, so the ring has a single
+// producer: audio from acquire_sample_chunk(), fps from log_fps() and the
+// spectral streams from telemetry_stream_spectra() once the GDFT has run.
+// chromagram_smooth belongs to led_thread and is sent as it stands.
+//
+// "telemetry" reports frames sent and dropped. tools/telemetry_decode.cpp
+// turns a capture back into values.
+
+#include <Arduino.h>
+#include "globals.h"
+#include "telemetry_frame.h"
+
+#define TELEMETRY_RING_SIZE 16384  // ~100ms of every stream at once
+
+TelemetryRing<TELEMETRY_RING_SIZE> telemetry_ring;
+TaskHandle_t telemetry_task = NULL;
+
+uint16_t telemetry_sequence[NUM_TELEMETRY_TYPES] = { 0 };  // Per type, gaps mean dropped frames
+uint32_t telemetry_frames_sent = 0;
+uint32_t telemetry_frames_dropped = 0;
+uint32_t telemetry_bytes_sent = 0;
+
+// Audio thread only, one frame is built at a time
+static uint8_t telemetry_scratch[TELEMETRY_MAX_PACKET];
+static uint8_t telemetry_frame_out[TELEMETRY_MAX_FRAME];
+static int32_t telemetry_values[TELEMETRY_MAX_VALUES];
+
+void telemetry_send(TelemetryType type, const int32_t* values, uint16_t count) {
+  size_t length = telemetry_build_frame(type, telemetry_sequence[type]++, micros(), values, count,
+                                        telemetry_scratch, telemetry_frame_out);
+  if (telemetry_ring.push(telemetry_frame_out, length)) {
+    telemetry_frames_sent++;
+    telemetry_bytes_sent += length;
+  } else {
+    telemetry_frames_dropped++;
+  }
+}
+
+void telemetry_send_floats(TelemetryType type, const float* values, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++) {
+    telemetry_values[i] = int32_t(values[i]);
+  }
+  telemetry_send(type, telemetry_values, count);
+}
+
+void telemetry_send_fixed(TelemetryType type, const SQ15x16* values, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++) {
+    telemetry_values[i] = values[i].getInternal();
+  }
+  telemetry_send(type, telemetry_values, count);
+}
+
+// acquire_sample_chunk(), once waveform[] holds the new chunk
+void telemetry_stream_audio() {
+  if (stream_audio == false) {
+    return;
+  }
+  uint16_t count = (CONFIG.SAMPLES_PER_CHUNK < TELEMETRY_MAX_VALUES) ? CONFIG.SAMPLES_PER_CHUNK : TELEMETRY_MAX_VALUES;
+  for (uint16_t i = 0; i < count; i++) {
+    telemetry_values[i] = waveform[i];
+  }
+  telemetry_send(TELEM_AUDIO, telemetry_values, count);
+}
+
+// log_fps(), once SYSTEM_FPS is updated
+void telemetry_stream_fps() {
+  if (stream_fps == false) {
+    return;
+  }
+  SQ15x16 fps = SYSTEM_FPS;
+  telemetry_send_fixed(TELEM_FPS, &fps, 1);
+}
+
+// Audio thread, after the GDFT and novelty
+void telemetry_stream_spectra() {
+  if (stream_magnitudes) {
+    telemetry_send_floats(TELEM_MAGNITUDES, magnitudes_final, NUM_FREQS);
+  }
+  if (stream_spectrogram) {
+    telemetry_send_fixed(TELEM_SPECTROGRAM, spectrogram, NUM_FREQS);
+  }
+  if (stream_chromagram) {
+    telemetry_send_fixed(TELEM_CHROMAGRAM, chromagram_smooth, 12);
+  }
+  if (stream_max_mags) {
+    telemetry_send_floats(TELEM_MAX_MAGS, max_mags, NUM_ZONES);
+  }
+  if (stream_max_mags_followers) {
+    telemetry_send_floats(TELEM_MAX_MAGS_FOLLOWERS, max_mags_followers, NUM_ZONES);
+  }
+}
+
+// Writes queued frames as USB takes them. Each frame goes out whole under
+// serial_mutex, so a reply or log line never lands inside one
+void telemetry_drain_task(void* arg) {
+  static uint8_t frame[TELEMETRY_MAX_FRAME];
+  while (true) {
+    uint32_t length = telemetry_ring.pop_frame(frame, sizeof(frame));
+    if (length == 0) {
+      vTaskDelay(1);
+      continue;
+    }
+
+    xSemaphoreTake(serial_mutex, portMAX_DELAY);
+    for (uint32_t written = 0; written < length;) {
+      int room = USBSerial.availableForWrite();
+      if (room <= 0) {
+        vTaskDelay(1);  // Frames can be longer than the USB buffer, finish this one first
+        continue;
+      }
+      uint32_t chunk = (length - written < uint32_t(room)) ? length - written : uint32_t(room);
+      written += USBSerial.write(frame + written, chunk);
+    }
+    xSemaphoreGive(serial_mutex);
+  }
+}
+
+void init_telemetry() {
+  telemetry_ring.clear();
+  xTaskCreatePinnedToCore(telemetry_drain_task, "telemetry", 3072, NULL, tskIDLE_PRIORITY + 1, &telemetry_task, 0);
+}
+
+void print_telemetry_stats() {
+  USBSerial.print("sbs((telemetry_sent=");
+  USBSerial.print(telemetry_frames_sent);
+  USBSerial.print(",dropped=");
+  USBSerial.print(telemetry_frames_dropped);
+  USBSerial.print(",bytes=");
+  USBSerial.print(telemetry_bytes_sent);
+  USBSerial.print(",queued=");
+  USBSerial.print(telemetry_ring.used());
+  USBSerial.print(",save_queue=");
+  USBSerial.print(save_queue.depth());  // (bridge_fs.h)
+  USBSerial.print(",save_us=");
+  USBSerial.print(save_queue.stats().last_us);
+  USBSerial.print(",save_max_us=");
+  USBSerial.print(save_queue.stats().max_us);
+  USBSerial.println("))");
+}
+
+#endif // TELEMETRY_H
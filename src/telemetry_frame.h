@@ -0,0 +1,343 @@
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+/*----------------------------------------
+  Sensory Bridge TELEMETRY FRAMES
+  ----------------------------------------*/
+
+// Binary packets for the "stream=..." outputs, in place of printing every
+// value as ASCII. Before framing a packet is, little-endian:
+//
+//   u8 type  u8 flags  u16 sequence  u32 time_us  u16 count  payload  u16 crc
+//
+// «crc» is CRC-16/CCITT-FALSE over everything before it. The payload is
+// «count» values in the type's format (TelemetryFormat), either at fixed
+// width or, with TELEM_FLAG_DELTA, as zigzag varints of each value minus
+// the one before it (the first minus 0). Whichever is smaller is sent, so
+// smooth data like audio and spectra usually goes out at 1-2 bytes a value.
+//
+// Each packet is COBS-encoded and written between two 0x00 bytes, so a
+// reader can resync at the next zero after a dropped byte, and any ASCII
+// printed in between (it never contains 0x00) just fails its CRC.
+//
+// telemetry.h queues packets on the device and drains them from a task,
+// tools/telemetry_decode.cpp reads them on the host. Nothing in here depends
+// on Arduino, test/host builds it as is.
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+#define TELEMETRY_MAX_VALUES  512
+#define TELEMETRY_HEADER_SIZE 10
+#define TELEMETRY_MAX_PACKET  (TELEMETRY_HEADER_SIZE + 5 * TELEMETRY_MAX_VALUES + 2)
+#define TELEMETRY_MAX_FRAME   (TELEMETRY_MAX_PACKET + TELEMETRY_MAX_PACKET / 254 + 3)  // COBS overhead and both zeros
+
+enum TelemetryType : uint8_t {
+  TELEM_AUDIO,               // waveform[], one chunk
+  TELEM_FPS,                 // SYSTEM_FPS
+  TELEM_MAGNITUDES,          // magnitudes_final[]
+  TELEM_SPECTROGRAM,         // spectrogram[]
+  TELEM_CHROMAGRAM,          // chromagram_smooth[]
+  TELEM_MAX_MAGS,            // max_mags[]
+  TELEM_MAX_MAGS_FOLLOWERS,  // max_mags_followers[]
+  NUM_TELEMETRY_TYPES
+};
+
+enum TelemetryFormat : uint8_t {
+  TELEM_FORMAT_I16,     // Integer, 2 bytes at fixed width
+  TELEM_FORMAT_I32,     // Integer, 4 bytes
+  TELEM_FORMAT_Q16_16   // SQ15x16's internal value, 4 bytes
+};
+
+static const char* const telemetry_type_names[NUM_TELEMETRY_TYPES] = {
+  "audio", "fps", "magnitudes", "spectrogram", "chromagram", "max_mags", "max_mags_followers"
+};
+
+static const uint8_t telemetry_type_formats[NUM_TELEMETRY_TYPES] = {
+  TELEM_FORMAT_I16, TELEM_FORMAT_Q16_16, TELEM_FORMAT_I32, TELEM_FORMAT_Q16_16,
+  TELEM_FORMAT_Q16_16, TELEM_FORMAT_I32, TELEM_FORMAT_I32
+};
+
+#define TELEM_FLAG_DELTA 0x01
+
+// CRC-16/CCITT-FALSE, a nibble at a time ------------------------------------
+
+inline uint16_t telemetry_crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF) {
+  static const uint16_t nibble_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+  };
+  for (size_t i = 0; i < length; i++) {
+    crc = (crc << 4) ^ nibble_table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ nibble_table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+
+// COBS -------------------------------------------------------------------------
+
+// Encode «length» bytes into «out» (room for length + length / 254 + 1),
+// no zeros in the result. Returns the encoded length.
+inline size_t telemetry_cobs_encode(const uint8_t* data, size_t length, uint8_t* out) {
+  size_t code_at = 0, at = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < length; i++) {
+    if (data[i] == 0) {
+      out[code_at] = code;
+      code_at = at++;
+      code = 1;
+    } else {
+      out[at++] = data[i];
+      if (++code == 0xFF) {
+        out[code_at] = code;
+        code_at = at++;
+        code = 1;
+      }
+    }
+  }
+  out[code_at] = code;
+  return at;
+}
+
+// Decode a frame without its zeros. «out» may be «data», the output never
+// overtakes the input. Returns the decoded length, 0 if malformed.
+inline size_t telemetry_cobs_decode(const uint8_t* data, size_t length, uint8_t* out) {
+  size_t at = 0, written = 0;
+  while (at < length) {
+    uint8_t code = data[at++];
+    if (code == 0 || at + code - 1 > length) {
+      return 0;
+    }
+    for (uint8_t i = 1; i < code; i++) {
+      out[written++] = data[at++];
+    }
+    if (code != 0xFF && at < length) {
+      out[written++] = 0;
+    }
+  }
+  return written;
+}
+
+// Packets ----------------------------------------------------------------------
+
+inline uint8_t telemetry_value_width(uint8_t format) {
+  return (format == TELEM_FORMAT_I16) ? 2 : 4;
+}
+
+inline uint32_t telemetry_zigzag(int32_t value) {
+  return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+
+inline uint8_t telemetry_varint_size(uint32_t value) {
+  uint8_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+// Build the unframed packet for «count» values into «out» (TELEMETRY_MAX_PACKET).
+// I16 values outside int16 are clamped. Returns the packet length.
+inline size_t telemetry_build_packet(uint8_t type, uint16_t sequence, uint32_t time_us,
+                                     const int32_t* values, uint16_t count, uint8_t* out) {
+  if (count > TELEMETRY_MAX_VALUES) {
+    count = TELEMETRY_MAX_VALUES;
+  }
+  uint8_t format = telemetry_type_formats[type];
+  uint8_t width = telemetry_value_width(format);
+
+  size_t delta_size = 0;
+  int32_t last = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    int32_t value = values[i];
+    if (format == TELEM_FORMAT_I16) {
+      value = (value > 32767) ? 32767 : (value < -32768) ? -32768 : value;
+    }
+    delta_size += telemetry_varint_size(telemetry_zigzag(int32_t(uint32_t(value) - uint32_t(last))));
+    last = value;
+  }
+  bool delta = delta_size < size_t(count) * width;
+
+  out[0] = type;
+  out[1] = delta ? TELEM_FLAG_DELTA : 0;
+  out[2] = uint8_t(sequence);
+  out[3] = uint8_t(sequence >> 8);
+  for (uint8_t b = 0; b < 4; b++) {
+    out[4 + b] = uint8_t(time_us >> (b * 8));
+  }
+  out[8] = uint8_t(count);
+  out[9] = uint8_t(count >> 8);
+
+  size_t at = TELEMETRY_HEADER_SIZE;
+  last = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    int32_t value = values[i];
+    if (format == TELEM_FORMAT_I16) {
+      value = (value > 32767) ? 32767 : (value < -32768) ? -32768 : value;
+    }
+    if (delta) {
+      uint32_t zigzag = telemetry_zigzag(int32_t(uint32_t(value) - uint32_t(last)));
+      while (zigzag >= 0x80) {
+        out[at++] = uint8_t(zigzag) | 0x80;
+        zigzag >>= 7;
+      }
+      out[at++] = uint8_t(zigzag);
+    } else {
+      for (uint8_t b = 0; b < width; b++) {
+        out[at++] = uint8_t(uint32_t(value) >> (b * 8));
+      }
+    }
+    last = value;
+  }
+
+  uint16_t crc = telemetry_crc16(out, at);
+  out[at++] = uint8_t(crc);
+  out[at++] = uint8_t(crc >> 8);
+  return at;
+}
+
+// Build and frame in one go: 0x00, COBS, 0x00. «out» holds TELEMETRY_MAX_FRAME,
+// «scratch» TELEMETRY_MAX_PACKET. Returns the frame length.
+inline size_t telemetry_build_frame(uint8_t type, uint16_t sequence, uint32_t time_us,
+                                    const int32_t* values, uint16_t count, uint8_t* scratch, uint8_t* out) {
+  size_t length = telemetry_build_packet(type, sequence, time_us, values, count, scratch);
+  out[0] = 0;
+  size_t encoded = telemetry_cobs_encode(scratch, length, out + 1);
+  out[1 + encoded] = 0;
+  return encoded + 2;
+}
+
+struct TelemetryPacket {
+  uint8_t type;
+  uint8_t flags;
+  uint16_t sequence;
+  uint32_t time_us;
+  uint16_t count;
+  int32_t values[TELEMETRY_MAX_VALUES];
+};
+
+// Parse an unframed (COBS-decoded) packet. False on a bad CRC, unknown type
+// or a payload that doesn't match its count.
+inline bool telemetry_parse_packet(const uint8_t* data, size_t length, TelemetryPacket& packet) {
+  if (length < TELEMETRY_HEADER_SIZE + 2) {
+    return false;
+  }
+  uint16_t crc = uint16_t(data[length - 2] | (data[length - 1] << 8));
+  if (telemetry_crc16(data, length - 2) != crc) {
+    return false;
+  }
+  packet.type = data[0];
+  packet.flags = data[1];
+  packet.sequence = uint16_t(data[2] | (data[3] << 8));
+  packet.time_us = uint32_t(data[4]) | (uint32_t(data[5]) << 8) | (uint32_t(data[6]) << 16) | (uint32_t(data[7]) << 24);
+  packet.count = uint16_t(data[8] | (data[9] << 8));
+  if (packet.type >= NUM_TELEMETRY_TYPES || packet.count > TELEMETRY_MAX_VALUES) {
+    return false;
+  }
+
+  uint8_t format = telemetry_type_formats[packet.type];
+  uint8_t width = telemetry_value_width(format);
+  size_t at = TELEMETRY_HEADER_SIZE, end = length - 2;
+  int32_t last = 0;
+  for (uint16_t i = 0; i < packet.count; i++) {
+    if (packet.flags & TELEM_FLAG_DELTA) {
+      uint32_t zigzag = 0;
+      for (uint8_t shift = 0;; shift += 7) {
+        if (at >= end || shift > 28) {
+          return false;
+        }
+        zigzag |= uint32_t(data[at] & 0x7F) << shift;
+        if ((data[at++] & 0x80) == 0) {
+          break;
+        }
+      }
+      int32_t delta = int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+      last = int32_t(uint32_t(last) + uint32_t(delta));
+    } else {
+      if (at + width > end) {
+        return false;
+      }
+      uint32_t raw = 0;
+      for (uint8_t b = 0; b < width; b++) {
+        raw |= uint32_t(data[at++]) << (b * 8);
+      }
+      last = (width == 2) ? int32_t(int16_t(raw)) : int32_t(raw);
+    }
+    packet.values[i] = last;
+  }
+  return at == end;
+}
+
+// Single-producer, single-consumer byte queue ------------------------------
+
+// The audio thread pushes whole frames or nothing, the drain task takes
+// them back out one whole frame at a time (or reads whatever is contiguous
+// and releases it once written).
+template <uint32_t SIZE>
+struct TelemetryRing {
+  static_assert((SIZE & (SIZE - 1)) == 0, "TelemetryRing size must be a power of two");
+
+  uint8_t bytes[SIZE];
+  std::atomic<uint32_t> head;  // Bytes ever pushed
+  std::atomic<uint32_t> tail;  // Bytes ever released
+
+  void clear() {
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+  }
+
+  uint32_t used() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  // Producer: all of «data» or nothing if it doesn't fit
+  bool push(const uint8_t* data, uint32_t length) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (SIZE - (h - tail.load(std::memory_order_acquire)) < length) {
+      return false;
+    }
+    uint32_t at = h & (SIZE - 1);
+    uint32_t first = (length < SIZE - at) ? length : SIZE - at;
+    memcpy(bytes + at, data, first);
+    memcpy(bytes, data + first, length - first);
+    head.store(h + length, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer: longest contiguous run waiting, up to the end of the buffer
+  uint32_t peek(const uint8_t** data) const {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t waiting = head.load(std::memory_order_acquire) - t;
+    uint32_t at = t & (SIZE - 1);
+    *data = bytes + at;
+    return (waiting < SIZE - at) ? waiting : SIZE - at;
+  }
+
+  void release(uint32_t length) {
+    tail.store(tail.load(std::memory_order_relaxed) + length, std::memory_order_release);
+  }
+
+  // Consumer: the next whole frame (0x00, COBS, 0x00) copied into «out»
+  // and released, its length. 0 if none is waiting. Bytes that don't end
+  // within «max» aren't a frame of ours and are dropped
+  uint32_t pop_frame(uint8_t* out, uint32_t max) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t waiting = head.load(std::memory_order_acquire) - t;
+    for (uint32_t i = 0; i < waiting; i++) {
+      if (i == max) {
+        release(i);
+        return 0;
+      }
+      out[i] = bytes[(t + i) & (SIZE - 1)];
+      if (i > 0 && out[i] == 0) {
+        release(i + 1);
+        return i + 1;
+      }
+    }
+    return 0;
+  }
+};
+
+#endif // TELEMETRY_FRAME_H
@@ -0,0 +1,114 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+/*----------------------------------------
+  Sensory Bridge TRACE RECORDER
+  ----------------------------------------*/
+
+// Device side of span_trace.h. TRACE_BEGIN(SPAN_x) / TRACE_END(SPAN_x)
+// wrap the pipeline stages on both cores and cost nothing unless
+// ENABLE_SPAN_TRACE is defined (main.cpp). When it is, each one reads the
+// cycle counter and claims a slot in the calling core's ring, a handful of
+// cycles, and only records between "trace_start" and "trace_dump".
+//
+// "trace_dump" stops recording and writes the rings in the binary format
+// described in span_trace.h, after a sbs((trace_dump_bytes=N)) line. On the
+// host, tools/trace_to_chrome.cpp turns a capture of that into Chrome trace
+// JSON for chrome://tracing or ui.perfetto.dev.
+
+#include "span_trace.h"
+
+#ifdef ENABLE_SPAN_TRACE
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+TraceRing trace_rings[SPAN_TRACE_CORES];
+volatile bool trace_armed = false;
+
+inline void trace_event(uint8_t span, uint8_t kind) {
+  if (trace_armed == false) {
+    return;
+  }
+  uint32_t cycles = ESP.getCycleCount();
+  TraceRing& ring = trace_rings[xPortGetCoreID()];
+  if (trace_ring_push(ring, cycles, span, kind)) {
+    trace_ring_anchor(ring, cycles, uint32_t(esp_timer_get_time()));
+  }
+}
+
+#define TRACE_BEGIN(span) trace_event(span, TRACE_BEGIN_EVENT)
+#define TRACE_END(span)   trace_event(span, TRACE_END_EVENT)
+
+// Clear both rings and start recording
+void trace_start() {
+  trace_armed = false;
+  vTaskDelay(1);  // Lets a push already under way on the other core land first
+  for (uint8_t c = 0; c < SPAN_TRACE_CORES; c++) {
+    trace_ring_clear(trace_rings[c]);
+  }
+  trace_armed = true;
+}
+
+// Collects the dump into USB-sized writes
+struct TraceSerialWriter {
+  uint8_t buffer[256];
+  uint16_t used = 0;
+  uint32_t total = 0;
+  bool counting = false;
+
+  void operator()(const uint8_t* data, size_t length) {
+    total += length;
+    if (counting) {
+      return;
+    }
+    while (length > 0) {
+      size_t take = sizeof(buffer) - used;
+      if (take > length) {
+        take = length;
+      }
+      memcpy(buffer + used, data, take);
+      used += take;
+      data += take;
+      length -= take;
+      if (used == sizeof(buffer)) {
+        flush();
+      }
+    }
+  }
+
+  void flush() {
+    USBSerial.write(buffer, used);
+    used = 0;
+  }
+};
+
+// Stop recording and write the rings to the serial port. Call between
+// tx_begin() and tx_end().
+void trace_dump() {
+  trace_armed = false;
+  vTaskDelay(1);
+
+  uint16_t cpu_mhz = getCpuFrequencyMhz();
+  TraceSerialWriter counter;
+  counter.counting = true;
+  trace_write_dump(trace_rings, SPAN_TRACE_CORES, cpu_mhz, counter);
+
+  USBSerial.print("sbs((trace_dump_bytes=");
+  USBSerial.print(counter.total);
+  USBSerial.println("))");
+
+  TraceSerialWriter writer;
+  trace_write_dump(trace_rings, SPAN_TRACE_CORES, cpu_mhz, writer);
+  writer.flush();
+  USBSerial.println();
+}
+
+#else
+
+#define TRACE_BEGIN(span) do {} while (0)
+#define TRACE_END(span)   do {} while (0)
+
+#endif // ENABLE_SPAN_TRACE
+
+#endif // TRACE_RECORDER_H
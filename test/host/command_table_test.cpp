@@ -0,0 +1,156 @@
+/**
+ * Command Table Test (host)
+ *
+ * Checks src/command_table.h: that an index over the device's command
+ * names builds at compile time, finds every name at the row it came from,
+ * including as the front of "name=value", finds nothing for prefixes,
+ * extensions, case changes or unknown names, and that two rows with the
+ * same name leave the index incomplete. Also times a lookup of every name
+ * against the strcmp() chain it replaces.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/command_table_test.cpp -o command_table_test
+ *   ./command_table_test
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#include "command_table.h"
+#include "host_check.h"
+
+struct Row {
+  const char* name;
+  int id;
+};
+
+// The serial menu's commands, as of writing
+static constexpr Row rows[] = {
+  { "v", 0 }, { "V", 1 }, { "version", 2 }, { "h", 3 }, { "H", 4 }, { "help", 5 }, { "SB?", 6 },
+  { "reset", 7 }, { "factory_reset", 8 }, { "restore_defaults", 9 }, { "chip_id", 10 },
+  { "identify", 11 }, { "start_noise_cal", 12 }, { "clear_noise_cal", 13 },
+  { "delete_noise_file", 14 }, { "show_noise_levels", 15 }, { "get_num_modes", 16 },
+  { "get_mode", 17 }, { "D", 18 }, { "dump", 19 }, { "C", 20 }, { "clear_dump", 21 },
+  { "test_crash", 22 }, { "perf_test", 23 }, { "perf_golden", 24 }, { "reset_reason", 25 },
+  { "stop", 26 }, { "fps", 27 }, { "led_fps", 28 }, { "quality", 29 },
+  { "render_resolution", 30 }, { "idle", 31 }, { "pixel_map", 32 }, { "pacer", 33 },
+  { "telemetry", 34 }, { "latency", 35 }, { "latency_reset", 36 }, { "trace_start", 37 },
+  { "trace_dump", 38 }, { "audio_guard", 39 }, { "get_knobs", 40 }, { "get_buttons", 41 },
+  { "freq_debug", 42 }, { "dc_diag", 43 }, { "debug", 44 }, { "sample_rate", 45 },
+  { "set_mode", 46 }, { "mode_fade_ms", 47 }, { "get_mode_name", 48 }, { "note_offset", 49 },
+  { "square_iter", 50 }, { "led_type", 51 }, { "led_count", 52 }, { "render_mode", 53 },
+  { "led_interpolation", 54 }, { "base_coat", 55 }, { "temporal_dithering", 56 },
+  { "led_color_order", 57 }, { "samples_per_chunk", 58 }, { "sensitivity", 59 },
+  { "boot_animation", 60 }, { "mirror_enabled", 61 }, { "sweet_spot_min", 62 },
+  { "sweet_spot_max", 63 }, { "chromagram_range", 64 }, { "standby_dimming", 65 },
+  { "bass_mode", 66 }, { "reverse_order", 67 }, { "max_current_ma", 68 }, { "stream", 69 },
+  { "auto_color_shift", 70 }, { "incandescent_filter", 71 }, { "incandescent_mode", 72 },
+  { "bulb_opacity", 73 }, { "saturation", 74 }, { "prism_count", 75 }, { "preset", 76 },
+  { "secondary_enabled", 77 }, { "secondary_mode", 78 }, { "secondary_photons", 79 },
+  { "secondary_chroma", 80 }, { "secondary_mood", 81 }, { "secondary_saturation", 82 },
+  { "secondary_prism_count", 83 }, { "secondary_mirror_enabled", 84 },
+  { "secondary_reverse_order", 85 }, { "secondary_base_coat", 86 }, { "secondary_status", 87 },
+  { "SECONDARY_ON", 88 }, { "SECONDARY_OFF", 89 }, { "SECONDARY_STATUS", 90 },
+  { "test_tone", 91 }, { "led_fps_target", 92 }, { "start_benchmark", 93 },
+};
+static constexpr size_t NUM_ROWS = sizeof(rows) / sizeof(rows[0]);
+
+static constexpr auto row_index = build_command_index(rows);
+static_assert(row_index.complete, "index over the command names builds at compile time");
+
+static constexpr Row duplicated[] = { { "stop", 0 }, { "fps", 1 }, { "stop", 2 } };
+static_assert(build_command_index(duplicated).complete == false, "duplicate names leave the index incomplete");
+
+static const Row* lookup(const char* name) {
+  return row_index.find(rows, name, strlen(name));
+}
+
+int main() {
+  // Every name
+  {
+    bool ok = true;
+    for (size_t i = 0; i < NUM_ROWS; i++) {
+      const Row* row = lookup(rows[i].name);
+      ok &= (row != NULL && row->id == int(i));
+    }
+    check(ok, "every name finds its own row");
+  }
+
+  // In front of a value
+  {
+    const char* command = "led_count=300";
+    const Row* row = row_index.find(rows, command, strchr(command, '=') - command);
+    check(row != NULL && strcmp(row->name, "led_count") == 0, "name in front of '=' is found by length");
+  }
+
+  // Near misses
+  {
+    const char* misses[] = { "", "led", "led_coun", "led_countt", "LED_COUNT", "Stop", "stop ",
+                             "secondary", "SECONDARY_MODE", "PERF", "vv", "hh", "dumpp", "x", "=" };
+    bool ok = true;
+    for (const char* name : misses) {
+      ok &= (lookup(name) == NULL);
+    }
+    check(ok, "prefixes, extensions, case changes and unknown names find nothing");
+  }
+
+  // Every string of up to three characters from a small alphabet
+  {
+    const char alphabet[] = "vVhHDCSB?_a";
+    char name[4] = {};
+    uint32_t found = 0;
+    bool ok = true;
+    for (size_t a = 0; a < sizeof(alphabet) - 1; a++) {
+      for (int b = -1; b < int(sizeof(alphabet) - 1); b++) {
+        for (int c = -1; c < (b < 0 ? 0 : int(sizeof(alphabet) - 1)); c++) {
+          name[0] = alphabet[a];
+          name[1] = (b < 0) ? '\0' : alphabet[b];
+          name[2] = (c < 0) ? '\0' : alphabet[c];
+          const Row* row = lookup(name);
+          if (row != NULL) {
+            ok &= (strcmp(row->name, name) == 0);
+            found++;
+          }
+        }
+      }
+    }
+    check(ok && found == 7, "short strings only ever find the row with that exact name");
+  }
+
+  // Timing
+  {
+    const int rounds = 20000;
+    uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < NUM_ROWS; i++) {
+        const char* name = rows[(i * 37 + r) % NUM_ROWS].name;
+        sink += lookup(name)->id;
+      }
+    }
+    auto hashed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < NUM_ROWS; i++) {
+        const char* name = rows[(i * 37 + r) % NUM_ROWS].name;
+        for (size_t j = 0; j < NUM_ROWS; j++) {
+          if (strcmp(rows[j].name, name) == 0) {
+            sink += rows[j].id;
+            break;
+          }
+        }
+      }
+    }
+    auto chained = std::chrono::steady_clock::now() - start;
+
+    double per_hashed = std::chrono::duration<double, std::nano>(hashed).count() / (rounds * NUM_ROWS);
+    double per_chained = std::chrono::duration<double, std::nano>(chained).count() / (rounds * NUM_ROWS);
+    printf("  %zu names, %u slots: %.1f ns per lookup, strcmp chain %.1f ns (%u)\n",
+           NUM_ROWS, unsigned(row_index.SLOTS), per_hashed, per_chained, sink & 1);
+    check(per_hashed < per_chained, "hashed lookup beats the strcmp chain");
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,190 @@
+/**
+ * Config Fields Test (host)
+ *
+ * Checks src/config_fields.h: that the field table covers the CONFIG
+ * struct, that config_diff() finds exactly the fields changed (and not
+ * padding), that config_copy_fields() copies only the masked fields,
+ * that config_field_at() maps a field's address back to its ID, and that
+ * a CONFIG saved by the firmware before RENDER_MODE and MODE_FADE_MS were
+ * appended imports with those two left at their defaults, and that packed
+ * entries come back by key, skipping fields that are gone or resized.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/config_fields_test.cpp -o config_fields_test
+ *   ./config_fields_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "config_fields.h"
+#include "host_check.h"
+
+using SensoryBridge::Config::conf;
+
+// CONFIG as the firmware before the journal saved it to /CONFIG_xxxxx.BIN
+struct BaselineConf {
+  float    PHOTONS;
+  float    CHROMA;
+  float    MOOD;
+  uint8_t  LIGHTSHOW_MODE;
+  bool     MIRROR_ENABLED;
+  uint32_t SAMPLE_RATE;
+  uint8_t  NOTE_OFFSET;
+  uint8_t  SQUARE_ITER;
+  uint8_t  LED_TYPE;
+  uint16_t LED_COUNT;
+  uint16_t LED_COLOR_ORDER;
+  bool     LED_INTERPOLATION;
+  uint16_t SAMPLES_PER_CHUNK;
+  float    SENSITIVITY;
+  bool     BOOT_ANIMATION;
+  uint32_t SWEET_SPOT_MIN_LEVEL;
+  uint32_t SWEET_SPOT_MAX_LEVEL;
+  int32_t  DC_OFFSET;
+  uint8_t  CHROMAGRAM_RANGE;
+  bool     STANDBY_DIMMING;
+  bool     REVERSE_ORDER;
+  uint32_t MAX_CURRENT_MA;
+  bool     TEMPORAL_DITHERING;
+  bool     AUTO_COLOR_SHIFT;
+  float    INCANDESCENT_FILTER;
+  bool     INCANDESCENT_MODE;
+  float    BULB_OPACITY;
+  float    SATURATION;
+  float    PRISM_COUNT;
+  bool     BASE_COAT;
+  float    VU_LEVEL_FLOOR;
+};
+
+static conf make_config() {
+  conf config;
+  memset(&config, 0, sizeof(config));
+  config.PHOTONS = 1.0;
+  config.LED_COUNT = 128;
+  config.SAMPLE_RATE = 16000;
+  config.MODE_FADE_MS = 250;
+  return config;
+}
+
+int main() {
+  // Table
+  {
+    check(NUM_CONFIG_FIELDS == 33, "33 fields listed");
+    check(strcmp(config_fields[CFG_LED_COUNT].name, "LED_COUNT") == 0, "names come from the list");
+    check(config_fields[CFG_LED_COUNT].offset == offsetof(conf, LED_COUNT) &&
+          config_fields[CFG_LED_COUNT].size == sizeof(uint16_t), "offsets and sizes match the struct");
+    check(config_mask_count(CONFIG_MASK_ALL) == NUM_CONFIG_FIELDS, "CONFIG_MASK_ALL has a bit per field");
+  }
+
+  // Diff
+  {
+    conf a = make_config();
+    conf b = a;
+    check(config_diff(a, b) == 0, "a copy differs in nothing");
+
+    b.LED_COUNT = 300;
+    b.MODE_FADE_MS = 0;
+    b.MIRROR_ENABLED = true;
+    ConfigMask expected = CONFIG_MASK(LED_COUNT) | CONFIG_MASK(MODE_FADE_MS) | CONFIG_MASK(MIRROR_ENABLED);
+    check(config_diff(a, b) == expected, "diff finds exactly the changed fields");
+
+    conf c = a;
+    memset((uint8_t*)&c + offsetof(conf, MIRROR_ENABLED) + 1, 0xAA,
+           offsetof(conf, SAMPLE_RATE) - offsetof(conf, MIRROR_ENABLED) - 1);
+    check(config_diff(a, c) == 0, "padding between fields is ignored");
+  }
+
+  // Copy
+  {
+    conf from = make_config();
+    from.LED_COUNT = 300;
+    from.PHOTONS = 0.5;
+    from.SATURATION = 0.25;
+
+    conf to = make_config();
+    to.MOOD = 0.75;  // Changed on this side only, e.g. by a knob
+    config_copy_fields(to, from, CONFIG_MASK(LED_COUNT) | CONFIG_MASK(SATURATION));
+    check(to.LED_COUNT == 300 && to.SATURATION == 0.25f, "masked fields are copied");
+    check(to.PHOTONS == 1.0f && to.MOOD == 0.75f, "unmasked fields are left alone");
+  }
+
+  // Address to field
+  {
+    conf config = make_config();
+    check(config_field_at(config, &config.LED_COUNT) == CFG_LED_COUNT, "field address maps to its ID");
+    check(config_field_at(config, &config.MODE_FADE_MS) == CFG_MODE_FADE_MS, "last field maps to its ID");
+    check(config_field_at(config, (uint8_t*)&config.LED_COUNT + 1) == NUM_CONFIG_FIELDS, "middle of a field maps to nothing");
+    uint32_t elsewhere = 0;
+    check(config_field_at(config, &elsewhere) == NUM_CONFIG_FIELDS, "address outside CONFIG maps to nothing");
+  }
+
+  // An older firmware's CONFIG
+  {
+    BaselineConf saved;
+    memset(&saved, 0, sizeof(saved));
+    saved.PHOTONS = 0.4f;
+    saved.LED_COUNT = 300;
+    saved.SWEET_SPOT_MAX_LEVEL = 12345;
+    saved.SATURATION = 0.6f;
+    saved.VU_LEVEL_FLOOR = 0.125f;
+    check(sizeof(saved) < sizeof(conf), "the older CONFIG is shorter than this one");
+
+    conf config = make_config();
+    config.RENDER_MODE = 2;
+    ConfigMask taken = config_from_prefix(config, &saved, sizeof(saved));
+    check(taken == (CONFIG_MASK_ALL & ~(CONFIG_MASK(RENDER_MODE) | CONFIG_MASK(MODE_FADE_MS))),
+          "every field it has is taken, the appended ones aren't");
+    check(config.PHOTONS == 0.4f && config.LED_COUNT == 300 && config.SWEET_SPOT_MAX_LEVEL == 12345 &&
+          config.SATURATION == 0.6f && config.VU_LEVEL_FLOOR == 0.125f, "with their saved values");
+    check(config.RENDER_MODE == 2 && config.MODE_FADE_MS == 250, "and the appended fields keep their defaults");
+
+    conf cut = make_config();
+    taken = config_from_prefix(cut, &saved, offsetof(BaselineConf, LED_COUNT) + 1);
+    check(cut.LED_COUNT == 128 && (taken & CONFIG_MASK(LED_COUNT)) == 0 && (taken & CONFIG_MASK(LED_TYPE)),
+          "a field cut off at the end of the image isn't taken");
+  }
+
+  // Entries by key
+  {
+    check(config_fields[CFG_LED_COUNT].key == config_key("LED_COUNT"), "a field's key is its name's hash, not its position");
+
+    conf from = make_config();
+    from.LED_COUNT = 300;
+    from.SATURATION = 0.25;
+    from.MODE_FADE_MS = 40;
+    uint8_t packed[CONFIG_PACKED_MAX + 16];
+    uint16_t length = config_pack(from, CONFIG_MASK_ALL, packed);
+    check(length <= CONFIG_PACKED_MAX, "everything packs into CONFIG_PACKED_MAX");
+
+    conf to = make_config();
+    check(config_unpack(to, packed, length) == CONFIG_MASK_ALL && config_diff(to, from) == 0, "and unpacks back");
+
+    // What a firmware with MOOD gone, LED_COUNT widened and a new field
+    // in front would have saved
+    uint8_t other[64];
+    uint16_t at = 0;
+    uint16_t added = config_key("NEW_FIELD");
+    other[at++] = uint8_t(added);
+    other[at++] = uint8_t(added >> 8);
+    other[at++] = 4;
+    at += 4;
+    other[at++] = uint8_t(config_fields[CFG_LED_COUNT].key);
+    other[at++] = uint8_t(config_fields[CFG_LED_COUNT].key >> 8);
+    other[at++] = 4;
+    at += 4;
+    at += config_pack(from, CONFIG_MASK(SATURATION) | CONFIG_MASK(MODE_FADE_MS), other + at);
+
+    conf into = make_config();
+    ConfigMask taken = config_unpack(into, other, at);
+    check(taken == (CONFIG_MASK(SATURATION) | CONFIG_MASK(MODE_FADE_MS)) && into.SATURATION == 0.25f &&
+          into.MODE_FADE_MS == 40, "fields found by key are taken wherever they are in the entries");
+    check(into.LED_COUNT == 128, "an unknown key, or a known one at another size, is skipped");
+
+    conf cut = make_config();
+    taken = config_unpack(cut, packed, length - 1);
+    check((taken & CONFIG_MASK(MODE_FADE_MS)) == 0 && (taken & CONFIG_MASK(PHOTONS)), "an entry cut off at the end isn't taken");
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,322 @@
+/**
+ * Config Journal Test (host)
+ *
+ * Checks src/config_journal.h against a mock NOR flash that can lose power
+ * in the middle of any program or erase (test/mocks/mock_journal_flash.h):
+ *   - saves come back after a remount, as single-field delta records
+ *   - compaction keeps the newest copy of everything and alternates banks
+ *   - cutting the power at every point of a save, a blob save and a
+ *     compaction always boots to the state before or after it, never a
+ *     mix, and the journal keeps working afterwards
+ *   - a different CONFIG layout replays the fields it still shares, by key
+ *   - garbage in flash formats instead of replaying
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc -Itest/mocks test/host/config_journal_test.cpp -o config_journal_test
+ *   ./config_journal_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_journal.h"
+#include "host_check.h"
+#include "mock_journal_flash.h"
+
+using SensoryBridge::Config::conf;
+
+#define SECTOR_BYTES     4096
+#define SECTORS_PER_BANK 1
+#define NOISE_BLOB       0
+#define NUM_BINS         96
+
+static conf defaults() {
+  conf config;
+  memset(&config, 0, sizeof(config));  // Padding too, so whole-struct compares work
+  config.PHOTONS = 1.0;
+  config.CHROMA = 0.5;
+  config.SAMPLE_RATE = 16000;
+  config.LED_COUNT = 128;
+  config.MODE_FADE_MS = 250;
+  return config;
+}
+
+static bool same(const conf& a, const conf& b) {
+  return config_diff(a, b) == 0;
+}
+
+// One boot: a journal, its noise blob copy, and what mount() gave back
+struct Boot {
+  float noise[NUM_BINS];
+  ConfigJournal journal;
+  conf config;
+  JournalMountResult result;
+
+  explicit Boot(MockJournalFlash& flash) : noise(), journal(flash, SECTORS_PER_BANK), config(defaults()) {
+    journal.add_blob(NOISE_BLOB, noise, sizeof(noise));
+    result = journal.mount(config);
+  }
+};
+
+static void fill_noise(float* noise, float base) {
+  for (int i = 0; i < NUM_BINS; i++) {
+    noise[i] = base + i;
+  }
+}
+
+// Cut the power at every unit of «op», reboot, and require the state
+// before or after it. Then the journal must still take a save
+template <typename Setup, typename Op, typename Before, typename After>
+static bool sweep_power_loss(Setup setup, Op op, Before before, After after, uint32_t* cuts) {
+  bool ok = true;
+  for (int64_t cut = 0;; cut++) {
+    MockJournalFlash flash(SECTOR_BYTES, 2 * SECTORS_PER_BANK);
+    {
+      Boot boot(flash);
+      setup(boot);
+    }
+
+    flash.cut_power_after(cut);
+    {
+      Boot boot(flash);
+      op(boot);
+    }
+    bool completed = flash.powered();
+    flash.restore_power();
+
+    Boot next(flash);
+    bool is_before = before(next);
+    bool is_after = after(next);
+    ok &= (next.result != JOURNAL_FAILED) && (is_before || is_after);
+    if (completed) {
+      ok &= is_after;
+    }
+
+    conf later = next.config;
+    later.SATURATION = 0.125;
+    ok &= next.journal.save_config(later);
+    Boot last(flash);
+    ok &= same(last.config, later) && last.result == JOURNAL_MOUNTED;
+    ok &= (flash.overwrites == 0);
+
+    if (completed) {
+      *cuts = uint32_t(cut);
+      return ok;
+    }
+  }
+}
+
+int main() {
+  // Round trip
+  {
+    MockJournalFlash flash(SECTOR_BYTES, 2 * SECTORS_PER_BANK);
+    conf saved;
+    {
+      Boot boot(flash);
+      check(boot.result == JOURNAL_FORMATTED && same(boot.config, defaults()), "blank flash formats with the defaults");
+
+      saved = boot.config;
+      saved.LED_COUNT = 300;
+      uint64_t before = flash.programmed;
+      uint32_t syncs_before = flash.syncs;
+      check(boot.journal.save_config(saved), "save");
+      uint64_t record = flash.programmed - before;
+      check(flash.syncs == syncs_before + 1, "a save is synced once, one flush of the whole record on the device");
+      printf("  one uint16_t field: %llu bytes programmed, a whole-struct rewrite is %zu+\n",
+             (unsigned long long)record, sizeof(conf));
+      check(record == sizeof(JournalRecordHeader) + CONFIG_ENTRY_HEADER + sizeof(uint16_t) + sizeof(uint32_t),
+            "a one-field save is one small record");
+
+      before = flash.programmed;
+      check(boot.journal.save_config(saved) && flash.programmed == before, "saving an unchanged config writes nothing");
+
+      saved.MIRROR_ENABLED = true;
+      saved.SENSITIVITY = 2.5;
+      boot.journal.save_config(saved);
+
+      float noise[NUM_BINS];
+      fill_noise(noise, 10.0f);
+      check(boot.journal.save_blob(NOISE_BLOB, noise), "blob save");
+    }
+    {
+      Boot boot(flash);
+      check(boot.result == JOURNAL_MOUNTED && same(boot.config, saved), "fields come back after a remount");
+      check(boot.journal.has_blob(NOISE_BLOB) && boot.noise[5] == 15.0f, "the blob comes back too");
+      check(boot.journal.erase_blob(NOISE_BLOB), "blob erase");
+    }
+    {
+      Boot boot(flash);
+      check(boot.journal.has_blob(NOISE_BLOB) == false && same(boot.config, saved), "an erased blob stays erased");
+    }
+  }
+
+  // Compaction
+  {
+    MockJournalFlash flash(SECTOR_BYTES, 2 * SECTORS_PER_BANK);
+    conf saved = defaults();
+    uint8_t banks_seen = 0;
+    uint32_t compactions = 0;
+    uint32_t syncs = 0;
+    {
+      Boot boot(flash);
+      float noise[NUM_BINS];
+      fill_noise(noise, 1.0f);
+      boot.journal.save_blob(NOISE_BLOB, noise);
+      for (uint32_t i = 0; i < 2000; i++) {
+        saved.PHOTONS = float(i % 100) / 100.0f;
+        saved.LIGHTSHOW_MODE = i % 7;
+        boot.journal.save_config(saved);
+        banks_seen |= 1 << boot.journal.bank();
+      }
+      compactions = boot.journal.stats().compactions;
+      syncs = flash.syncs;
+    }
+    Boot boot(flash);
+    check(compactions > 5 && banks_seen == 3, "a full bank compacts into the other one, back and forth");
+    check(same(boot.config, saved) && boot.noise[0] == 1.0f, "everything survives many compactions");
+    int32_t difference = int32_t(flash.erase_counts[0]) - int32_t(flash.erase_counts[1]);
+    check(abs(difference) <= 1, "both banks wear the same");
+    check(syncs <= 2001 + 2 * (compactions + 1), "one sync per record, two per compaction (before and after the header)");
+    printf("  2000 saves: %u compactions, erases per sector %u/%u\n", compactions, flash.erase_counts[0], flash.erase_counts[1]);
+  }
+
+  // Power loss
+  {
+    conf a = defaults();
+    a.LED_COUNT = 200;
+    conf b = a;
+    b.LED_COUNT = 300;
+    b.PRISM_COUNT = 2.0;
+    b.REVERSE_ORDER = true;
+
+    uint32_t cuts = 0;
+    bool ok = sweep_power_loss(
+        [&](Boot& boot) { boot.journal.save_config(a); },
+        [&](Boot& boot) { boot.journal.save_config(b); },
+        [&](Boot& boot) { return same(boot.config, a); },
+        [&](Boot& boot) { return same(boot.config, b); }, &cuts);
+    check(ok, "power lost anywhere in a multi-field save boots to all or none of it");
+    printf("  %u cut points\n", cuts);
+
+    ok = sweep_power_loss(
+        [&](Boot& boot) {
+          float noise[NUM_BINS];
+          fill_noise(noise, 1.0f);
+          boot.journal.save_blob(NOISE_BLOB, noise);
+        },
+        [&](Boot& boot) {
+          float noise[NUM_BINS];
+          fill_noise(noise, 2.0f);
+          boot.journal.save_blob(NOISE_BLOB, noise);
+        },
+        [&](Boot& boot) { return boot.noise[0] == 1.0f && boot.noise[NUM_BINS - 1] == 1.0f + NUM_BINS - 1; },
+        [&](Boot& boot) { return boot.noise[0] == 2.0f && boot.noise[NUM_BINS - 1] == 2.0f + NUM_BINS - 1; }, &cuts);
+    check(ok, "power lost anywhere in a blob save boots to the old or new blob");
+    printf("  %u cut points\n", cuts);
+
+    // Fill the bank until one more two-field save fits, and a save after that doesn't
+    conf full;
+    conf mid;
+    conf compacted;
+    bool op_compacted = false;
+    ok = sweep_power_loss(
+        [&](Boot& boot) {
+          float noise[NUM_BINS];
+          fill_noise(noise, 3.0f);
+          boot.journal.save_blob(NOISE_BLOB, noise);
+          full = defaults();
+          uint32_t fits = ConfigJournal::record_size(2 + sizeof(uint16_t) + sizeof(float));
+          uint32_t after = ConfigJournal::record_size(1 + sizeof(float));
+          for (uint32_t i = 0; boot.journal.capacity() - boot.journal.used() >= fits + after; i++) {
+            full.MOOD = float(i);
+            boot.journal.save_config(full);
+          }
+          mid = full;
+          mid.LED_COUNT = 999;
+          mid.MOOD = -2.0;
+          compacted = mid;
+          compacted.CHROMA = 0.25;
+        },
+        [&](Boot& boot) {
+          uint32_t compactions = boot.journal.stats().compactions;
+          boot.journal.save_config(mid);
+          boot.journal.save_config(compacted);
+          op_compacted = boot.journal.stats().compactions > compactions;
+        },
+        [&](Boot& boot) { return (same(boot.config, full) || same(boot.config, mid)) && boot.noise[0] == 3.0f; },
+        [&](Boot& boot) { return same(boot.config, compacted) && boot.noise[0] == 3.0f; }, &cuts);
+    check(ok && op_compacted, "power lost anywhere in a compaction keeps the last complete save and the blob");
+    printf("  %u cut points\n", cuts);
+  }
+
+  // Layout change
+  {
+    MockJournalFlash flash(SECTOR_BYTES, 2 * SECTORS_PER_BANK);
+    conf saved = defaults();
+    {
+      Boot boot(flash);
+      saved.LED_COUNT = 42;
+      saved.SENSITIVITY = 3.0;
+      boot.journal.save_config(saved);
+      float noise[NUM_BINS];
+      fill_noise(noise, 7.0f);
+      boot.journal.save_blob(NOISE_BLOB, noise);
+      boot.journal.compact();
+
+      // Rewrite the active bank's header as another firmware would have
+      uint32_t base = boot.journal.bank() * SECTOR_BYTES * SECTORS_PER_BANK;
+      JournalBankHeader header;
+      memcpy(&header, &flash.memory[base], sizeof(header));
+      header.layout ^= 1;
+      header.crc = crc32(&header, offsetof(JournalBankHeader, crc));
+      memcpy(&flash.memory[base], &header, sizeof(header));
+
+      // And append a save of its: LED_COUNT, a field this firmware doesn't
+      // have (longer than any record of its own), and CHROMA at another size
+      uint8_t payload[512];
+      conf other = saved;
+      other.LED_COUNT = 77;
+      uint16_t length = config_pack(other, CONFIG_MASK(LED_COUNT), payload);
+      uint16_t unknown = config_key("GONE_FIELD");
+      payload[length++] = uint8_t(unknown);
+      payload[length++] = uint8_t(unknown >> 8);
+      payload[length++] = 250;
+      memset(payload + length, 0xAB, 250);
+      length += 250;
+      payload[length++] = uint8_t(config_fields[CFG_CHROMA].key);
+      payload[length++] = uint8_t(config_fields[CFG_CHROMA].key >> 8);
+      payload[length++] = 2;
+      payload[length++] = 0x12;
+      payload[length++] = 0x34;
+
+      JournalRecordHeader record = { JOURNAL_FIELDS, 0, length };
+      uint32_t crc = crc32_final(crc32_update(crc32_update(CRC32_INIT, &record, sizeof(record)), payload, length));
+      uint32_t at = base + boot.journal.used();
+      flash.program(at, &record, sizeof(record));
+      flash.program(at + sizeof(record), payload, length);
+      flash.program(at + ConfigJournal::record_size(length) - sizeof(crc), &crc, sizeof(crc));
+      check(length > CONFIG_PACKED_MAX, "(that record is longer than this firmware's scratch)");
+    }
+    Boot boot(flash);
+    saved.LED_COUNT = 77;
+    check(boot.result == JOURNAL_RECOVERED && same(boot.config, saved),
+          "another layout's fields are replayed by key, unknown and resized ones skipped");
+    check(boot.noise[0] == 7.0f, "and its blobs are restored");
+    Boot again(flash);
+    check(again.result == JOURNAL_MOUNTED && same(again.config, saved), "it compacts into this layout, the next boot is clean");
+  }
+
+  // Garbage
+  {
+    MockJournalFlash flash(SECTOR_BYTES, 2 * SECTORS_PER_BANK);
+    srand(1);
+    for (size_t i = 0; i < flash.memory.size(); i++) {
+      flash.memory[i] = uint8_t(rand());
+    }
+    Boot boot(flash);
+    check(boot.result == JOURNAL_FORMATTED && same(boot.config, defaults()), "random flash formats with the defaults");
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,110 @@
+/**
+ * Derived Tables Test (host)
+ *
+ * Checks src/derived_tables.h: that every table is built on the first
+ * refresh(), that a change rebuilds only the tables reading that field,
+ * once however many of their fields changed, that unrelated fields and
+ * repeated refreshes rebuild nothing, that key() and invalidate() force a
+ * rebuild, and that builds are counted and timed.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/derived_tables_test.cpp -o derived_tables_test
+ *   ./derived_tables_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "derived_tables.h"
+#include "host_check.h"
+
+using SensoryBridge::Config::conf;
+
+// Each build advances the fake clock by a known amount
+static uint32_t fake_us = 0;
+static uint32_t fake_clock() {
+  return fake_us;
+}
+
+static int goertzel_builds = 0;
+static int pixel_map_builds = 0;
+static int palette_builds = 0;
+static uint32_t palette_index = 0;
+
+static void build_goertzel() {
+  goertzel_builds++;
+  fake_us += 120;
+}
+static void build_pixel_map() {
+  pixel_map_builds++;
+  fake_us += 30;
+}
+static void build_palette() {
+  palette_builds++;
+  fake_us += 10;
+}
+static uint32_t palette_key() {
+  return palette_index;
+}
+
+enum { GOERTZEL, PIXEL_MAP, PALETTE, NUM_TABLES };
+
+static const DerivedTable list[NUM_TABLES] = {
+  { "goertzel",  CONFIG_MASK(SAMPLE_RATE) | CONFIG_MASK(NOTE_OFFSET),  NULL,        build_goertzel  },
+  { "pixel_map", CONFIG_MASK(LED_COUNT) | CONFIG_MASK(REVERSE_ORDER),  NULL,        build_pixel_map },
+  { "palette",   0,                                                    palette_key, build_palette   },
+};
+
+static bool counts(int goertzel, int pixel_map, int palette) {
+  return goertzel_builds == goertzel && pixel_map_builds == pixel_map && palette_builds == palette;
+}
+
+int main() {
+  DerivedTables<NUM_TABLES> tables(list, fake_clock);
+
+  conf config;
+  memset(&config, 0, sizeof(config));
+  config.SAMPLE_RATE = 16000;
+  config.LED_COUNT = 128;
+
+  check(tables.inputs == (CONFIG_MASK(SAMPLE_RATE) | CONFIG_MASK(NOTE_OFFSET) | CONFIG_MASK(LED_COUNT) | CONFIG_MASK(REVERSE_ORDER)),
+        "inputs are the union of every table's fields");
+
+  // First refresh
+  check(tables.refresh(config) == 3 && counts(1, 1, 1), "first refresh builds every table");
+  check(tables.refresh(config) == 0 && counts(1, 1, 1), "a second refresh builds nothing");
+
+  // Changes
+  config.PHOTONS = 0.5;
+  config.MOOD = 0.25;
+  check(tables.refresh(config) == 0 && counts(1, 1, 1), "fields no table reads rebuild nothing");
+
+  config.NOTE_OFFSET = 12;
+  config.SAMPLE_RATE = 12800;
+  check(tables.refresh(config) == 1 && counts(2, 1, 1), "two inputs of one table rebuild it once");
+
+  config.REVERSE_ORDER = true;
+  config.NOTE_OFFSET = 0;
+  check(tables.refresh(config) == 2 && counts(3, 2, 1), "a change to each of two tables rebuilds both");
+
+  config.NOTE_OFFSET = 5;
+  config.NOTE_OFFSET = 0;
+  check(tables.refresh(config) == 0 && counts(3, 2, 1), "a field changed and changed back between refreshes rebuilds nothing");
+
+  // Keys and invalidation
+  palette_index = 3;
+  check(tables.refresh(config) == 1 && counts(3, 2, 2), "a new key rebuilds its table");
+  check(tables.refresh(config) == 0, "an unchanged key doesn't");
+
+  tables.invalidate(PIXEL_MAP);
+  check(tables.refresh(config) == 1 && counts(3, 3, 2), "invalidate() rebuilds on the next refresh");
+  check(tables.refresh(config) == 0, "and only on that one");
+
+  // Stats
+  const DerivedTableStats& goertzel = tables.stats[GOERTZEL];
+  check(goertzel.builds == 3 && goertzel.last_us == 120 && goertzel.max_us == 120 && goertzel.total_us == 360,
+        "builds are counted and timed");
+  check(tables.stats[PALETTE].builds == 2 && tables.stats[PALETTE].total_us == 20, "each table keeps its own stats");
+
+  return check_summary();
+}
@@ -0,0 +1,33 @@
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+/**
+ * Host Test Checks
+ *
+ * What every test/host program reports with: check() prints one PASS or
+ * FAIL line and counts the failures, and check_summary() prints the footer
+ * and gives main() its exit code.
+ *
+ *   int main() {
+ *     check(1 + 1 == 2, "addition");
+ *     return check_summary();
+ *   }
+ */
+
+#include <stdio.h>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("[%s] %s\n", ok ? "PASS" : "FAIL", what);
+  if (!ok) {
+    failures++;
+  }
+}
+
+static int check_summary() {
+  printf("\n%s (%d failure%s)\n", failures == 0 ? "ALL PASSED" : "FAILED", failures, failures == 1 ? "" : "s");
+  return failures == 0 ? 0 : 1;
+}
+
+#endif // HOST_CHECK_H
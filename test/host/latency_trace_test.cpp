@@ -0,0 +1,152 @@
+/**
+ * Latency Trace Test (host)
+ *
+ * Checks src/latency_trace.h: bucket edges, percentiles against a sorted
+ * copy of the same samples, the rolling window forgetting old samples,
+ * stage arithmetic in latency_record() (including micros() wrapping), that
+ * a frame reusing the previous frame's chunk isn't traced, and that a
+ * reader never sees a torn (capture, gdft) pair while another thread
+ * publishes as fast as it can.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -pthread -Isrc test/host/latency_trace_test.cpp -o latency_trace_test
+ *   ./latency_trace_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "host_check.h"
+#include "latency_trace.h"
+
+int main() {
+  // Buckets
+  {
+    bool exact = true;
+    for (uint32_t us = 0; us < LATENCY_EXACT_US; us++) {
+      exact &= (latency_bucket(us) == us && latency_bucket_top(us) == us);
+    }
+    check(exact, "exact buckets below 16us");
+
+    bool ordered = true, within = true;
+    uint16_t last = 0;
+    for (uint32_t us = 1; us < (1u << 24); us += 1 + us / 64) {
+      uint16_t b = latency_bucket(us);
+      ordered &= (b >= last && b < LATENCY_BUCKETS);
+      within &= (us <= latency_bucket_top(b) && latency_bucket_top(b) <= us + us / 8);
+      last = b;
+    }
+    check(ordered, "buckets are monotonic and in range");
+    check(within, "each value is within 12.5% of its bucket's top");
+    check(latency_bucket(0xFFFFFFFFu) == LATENCY_BUCKETS - 1, "huge values land in the last bucket");
+  }
+
+  // Percentiles
+  {
+    LatencyHistogram h;
+    latency_hist_reset(h);
+    check(latency_hist_percentile(h, 50) == 0 && latency_hist_count(h) == 0, "empty histogram reads 0");
+
+    std::vector<uint32_t> samples;
+    srand(7);
+    for (int i = 0; i < 3000; i++) {
+      uint32_t us = 2000 + rand() % 6000;
+      if (i % 100 == 0) { us = 20000 + rand() % 5000; }  // 1% spikes
+      samples.push_back(us);
+      latency_hist_add(h, us);
+    }
+    std::vector<uint32_t> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    bool close = true;
+    for (uint8_t p : { 50, 95, 99 }) {
+      uint32_t exact = sorted[(sorted.size() * p + 99) / 100 - 1];
+      uint32_t got = latency_hist_percentile(h, p);
+      printf("  p%u exact %u, histogram %u\n", p, exact, got);
+      close &= (got >= exact && got <= exact + exact / 8);
+    }
+    check(close, "p50/p95/p99 at or up to 12.5% above the exact value");
+    check(latency_hist_max(h) == sorted.back(), "max is exact");
+    check(latency_hist_percentile(h, 100) == sorted.back(), "p100 is the max");
+  }
+
+  // Rolling window
+  {
+    LatencyHistogram h;
+    latency_hist_reset(h);
+    for (int i = 0; i < LATENCY_WINDOW; i++) { latency_hist_add(h, 50000); }
+    for (int i = 0; i < LATENCY_WINDOW; i++) { latency_hist_add(h, 1000); }
+    check(latency_hist_max(h) == 50000, "previous window still counts");
+    latency_hist_add(h, 1000);  // Starts a third window, the first one goes
+    check(latency_hist_max(h) == 1000 && latency_hist_percentile(h, 99) <= 1000, "old spike ages out");
+    check(latency_hist_count(h) == LATENCY_WINDOW + 1, "count covers both windows");
+  }
+
+  // Frames and stages
+  {
+    LatencyChunkSlot slot = {};
+    LatencyStats stats = {};
+    LatencyFrame frame = {};
+    uint32_t last_chunk = 0;
+
+    check(!latency_begin_frame(frame, slot, last_chunk, 100), "nothing published, nothing traced");
+
+    uint32_t base = 0xFFFFF000u;  // micros() wraps during this frame
+    latency_publish_chunk(slot, base, base + 900);
+    check(latency_begin_frame(frame, slot, last_chunk, base + 1000), "new chunk is traced");
+    latency_stamp(frame, STAMP_RENDER, base + 3000);
+    latency_stamp(frame, STAMP_QUANTIZE, base + 3400);
+    latency_stamp(frame, STAMP_TX_START, base + 5000);
+    latency_stamp(frame, STAMP_TX_END, base + 9800);
+    latency_record(stats, frame);
+
+    const uint32_t expect[NUM_LATENCY_STAGES] = { 900, 100, 2000, 400, 1600, 4800, 9800 };
+    bool stages_ok = true;
+    for (uint8_t s = 0; s < NUM_LATENCY_STAGES; s++) {
+      stages_ok &= (latency_hist_max(stats.stages[s]) == expect[s]);
+    }
+    check(stages_ok, "stage gaps and end to end, across the wrap");
+
+    LatencyFrame repeat = {};
+    check(!latency_begin_frame(repeat, slot, last_chunk, base + 20000), "same chunk again isn't traced");
+    latency_stamp(repeat, STAMP_RENDER, 1);
+    latency_record(stats, repeat);
+    check(stats.frames == 1, "untraced frame isn't recorded");
+
+    stats.reset_requested = true;
+    latency_record(stats, repeat);
+    check(stats.frames == 0 && latency_hist_count(stats.stages[LATENCY_TOTAL]) == 0, "reset request is honoured");
+  }
+
+  // Seqlock under contention
+  {
+    LatencyChunkSlot slot = {};
+    std::atomic<bool> stop(false);
+    std::thread writer([&]() {
+      for (uint32_t i = 1; !stop.load(); i++) {
+        latency_publish_chunk(slot, i * 3, i * 3 + 7);  // gdft is always capture + 7
+        for (volatile int spin = 0; spin < 100; spin++) {}  // Leave readers a gap now and then
+      }
+    });
+
+    uint32_t last_chunk = 0, traced = 0, torn = 0;
+    LatencyFrame frame = {};
+    for (uint32_t i = 0; i < 200000000 && traced < 20000; i++) {
+      if (latency_begin_frame(frame, slot, last_chunk, 0)) {
+        traced++;
+        torn += (frame.at[STAMP_GDFT] != frame.at[STAMP_CAPTURE] + 7);
+      }
+    }
+    stop.store(true);
+    writer.join();
+
+    printf("  %u frames traced while publishing\n", traced);
+    check(traced > 0 && torn == 0, "no torn chunk stamps");
+  }
+
+  return check_summary();
+}
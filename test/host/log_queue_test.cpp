@@ -0,0 +1,147 @@
+/**
+ * Log Queue Test (host)
+ *
+ * Checks src/log_queue.h: log_format() matches snprintf() for every
+ * supported conversion (with flags, width, precision and length
+ * modifiers), a full queue drops and counts instead of waiting, and
+ * records from several producers all arrive intact, each producer's in
+ * order, while a consumer drains at the same time.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -pthread -Isrc test/host/log_queue_test.cpp -o log_queue_test
+ *   ./log_queue_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "host_check.h"
+#include "log_queue.h"
+
+static LogQueue<16> small_queue;
+static LogQueue<64> shared_queue;
+
+// Push through a queue and format, to compare with snprintf() on the same arguments
+template <class... Args>
+static bool formats_like_printf(const char* format, Args... args) {
+  small_queue.clear();
+  log_push(small_queue, LOG_LEVEL_INFO, 0, format, args...);
+  LogRecord record;
+  small_queue.pop(record);
+  char ours[128], theirs[128];
+  log_format(record, ours, sizeof(ours));
+  snprintf(theirs, sizeof(theirs), format, args...);
+  if (strcmp(ours, theirs) != 0) {
+    printf("  '%s' gave '%s', printf gives '%s'\n", format, ours, theirs);
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  // Formatting
+  {
+    bool ok = true;
+    ok &= formats_like_printf("plain text, 100%% literal");
+    ok &= formats_like_printf("S3_PERF|FPS:%.2f|Race:%lu|", 118.456f, 3ul);
+    ok &= formats_like_printf("%d %i %5d %-5d| %+d %05d", -42, 7, 123, 45, 6, -7);
+    ok &= formats_like_printf("%u %x %X %#x %o %08X", 4000000000u, 255u, 48879u, 16u, 8u, 0xBEEFu);
+    ok &= formats_like_printf("%hd %hu %ld %lld %llu %zu", short(-3), (unsigned short)65535, -123456l,
+                              -9000000000ll, 18000000000000000000ull, size_t(12));
+    ok &= formats_like_printf("%c%c%c", 'a', 'b', 'c');
+    ok &= formats_like_printf("%f %.3f %8.2f %e %g %G", 3.14159, 2.0f, -1.5, 12345.678, 0.0001, 1e20);
+    ok &= formats_like_printf("%s (%8s) [%-6s] %.3s", "mode", "bloom", "vu", "truncated");
+    ok &= formats_like_printf("%u-%u (%u LEDs)", uint16_t(3), uint16_t(40), 38);
+    ok &= formats_like_printf("%d %d", true, false);
+    check(ok, "matches snprintf for the supported conversions");
+
+    small_queue.clear();
+    log_push(small_queue, LOG_LEVEL_INFO, 0, "%s", (const char*)NULL);
+    LogRecord record;
+    small_queue.pop(record);
+    char out[32];
+    log_format(record, out, sizeof(out));
+    check(strcmp(out, "(null)") == 0, "NULL string is printed as (null)");
+
+    small_queue.clear();
+    log_push(small_queue, LOG_LEVEL_INFO, 0, "%s and more", "a fairly long argument");
+    small_queue.pop(record);
+    char tiny[10];
+    size_t length = log_format(record, tiny, sizeof(tiny));
+    check(length == 9 && strcmp(tiny, "a fairly ") == 0, "output is cut at the buffer and terminated");
+  }
+
+  // Full queue
+  {
+    small_queue.clear();
+    uint32_t accepted = 0;
+    for (int i = 0; i < 40; i++) {
+      accepted += log_push(small_queue, LOG_LEVEL_DEBUG, i, "record %d", i);
+    }
+    check(accepted == 16 && small_queue.dropped.load() == 24, "full queue drops and counts the rest");
+
+    LogRecord record;
+    bool order = true;
+    for (int i = 0; i < 16; i++) {
+      order &= small_queue.pop(record) && record.time_ms == uint32_t(i);
+    }
+    check(order && !small_queue.pop(record), "kept records come out oldest first");
+    check(log_push(small_queue, LOG_LEVEL_DEBUG, 99, "again"), "room again once drained");
+  }
+
+  // Producers and a consumer at once
+  {
+    shared_queue.clear();
+    const int producers = 3, per_producer = 200000;
+    std::atomic<int> done(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+      threads.emplace_back([&, p]() {
+        for (int i = 0; i < per_producer; i++) {
+          log_push(shared_queue, LOG_LEVEL_INFO, uint32_t(i), "producer %d item %d check %d", p, i, p * 1000003 + i);
+          if (i % 32 == 0) {
+            std::this_thread::yield();  // Give the consumer a turn on machines with few cores
+          }
+        }
+        done++;
+      });
+    }
+
+    uint32_t received = 0, torn = 0, out_of_order = 0;
+    int32_t last[producers];
+    for (int p = 0; p < producers; p++) {
+      last[p] = -1;
+    }
+    LogRecord record;
+    while (true) {
+      bool finished = done.load() == producers;  // Read before popping, so nothing lands after the last pop
+      if (!shared_queue.pop(record)) {
+        if (finished) {
+          break;
+        }
+        continue;
+      }
+      int p = int(int64_t(record.args[0]));
+      int i = int(int64_t(record.args[1]));
+      torn += (record.num_args != 3 || p < 0 || p >= producers || int64_t(record.args[2]) != p * 1000003 + i ||
+               record.time_ms != uint32_t(i));
+      if (p >= 0 && p < producers) {
+        out_of_order += (i <= last[p]);
+        last[p] = i;
+      }
+      received++;
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    uint32_t dropped = shared_queue.dropped.load();
+    printf("  %u received, %u dropped\n", received, dropped);
+    check(received + dropped == uint32_t(producers * per_producer), "every record is either received or counted as dropped");
+    check(torn == 0 && out_of_order == 0, "no torn records, each producer's in order");
+  }
+
+  return check_summary();
+}
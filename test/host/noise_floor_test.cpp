@@ -0,0 +1,285 @@
+/**
+ * Noise Floor Test (host)
+ *
+ * Checks src/noise_floor.h: that the P² estimate lands near the true
+ * NOISE_FLOOR_QUANTILE of each bin's samples, that one loud click doesn't
+ * move it the way a maximum would, that the floor follows a room that gets
+ * louder (or quieter) within a few windows, that frames next to music
+ * don't count as silence, and storing, finding and removing named
+ * profiles. Then times update() for NUM_FREQS bins.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/noise_floor_test.cpp -o noise_floor_test
+ *   ./noise_floor_test
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "host_check.h"
+#include "noise_floor.h"
+
+const uint16_t BINS = 96;  // NUM_FREQS
+
+static uint32_t seed = 1;
+static float uniform() {
+  seed = seed * 1103515245 + 12345;
+  return float((seed >> 8) & 0xFFFF) / 65536.0f;
+}
+
+// Bin b's noise is uniform over [level, 2 * level], so its true quantile is known
+static void frame(float* magnitudes, float level) {
+  for (uint16_t b = 0; b < BINS; b++) {
+    float bin_level = level * (1.0f + b / float(BINS));
+    magnitudes[b] = bin_level * (1.0f + uniform());
+  }
+}
+
+static float true_quantile(uint16_t b, float level) {
+  return level * (1.0f + b / float(BINS)) * (1.0f + NOISE_FLOOR_QUANTILE);
+}
+
+// The device's path to the tracker: GDFT magnitudes smoothed over frames
+// (process_GDFT(), alpha 0.3) and a silence gate on the smoothed loudness
+// of each chunk (acquire_sample_chunk(), alpha 0.2)
+struct Pipeline {
+  float smoothed[BINS];
+  float loudness;
+  float threshold;
+
+  explicit Pipeline(float noise_level) : loudness(0.0f), threshold(noise_level * 1.5f * 1.5f * 1.4f) {
+    memset(smoothed, 0, sizeof(smoothed));
+  }
+
+  // One frame at «gain» times the room noise. True when the gate calls it silent
+  bool step(float noise_level, float gain) {
+    float magnitudes[BINS];
+    frame(magnitudes, noise_level);
+    float sum = 0.0f;
+    for (uint16_t b = 0; b < BINS; b++) {
+      magnitudes[b] *= gain;
+      smoothed[b] = magnitudes[b] * 0.3f + smoothed[b] * 0.7f;
+      sum += magnitudes[b];
+    }
+    loudness = (sum / BINS) * 0.2f + loudness * 0.8f;
+    return loudness <= threshold;
+  }
+};
+
+// Music at 20x the noise, faded in over 20 frames
+static float music_gain(uint32_t frame_in_music) {
+  return (frame_in_music < 20) ? 1.0f + 19.0f * frame_in_music / 20.0f : 20.0f;
+}
+
+// Worst relative error of «floor» against the true quantile
+static float worst_error(const float* floor, float level) {
+  float worst = 0.0f;
+  for (uint16_t b = 0; b < BINS; b++) {
+    float expected = true_quantile(b, level);
+    worst = std::max(worst, fabsf(floor[b] - expected) / expected);
+  }
+  return worst;
+}
+
+int main() {
+  float magnitudes[BINS];
+
+  // One window
+  {
+    NoiseFloorTracker<BINS> tracker;
+    check(tracker.ready() == false, "a new tracker has no floor");
+    bool completed = false;
+    for (uint16_t i = 0; i < NOISE_FLOOR_WINDOW; i++) {
+      frame(magnitudes, 100.0f);
+      completed = tracker.add(magnitudes);
+      if (i + 1 < NOISE_FLOOR_WINDOW && completed) {
+        break;
+      }
+    }
+    check(completed && tracker.ready() && tracker.stats().windows == 1, "a floor after NOISE_FLOOR_WINDOW silent frames");
+    float error = worst_error(tracker.floor(), 100.0f);
+    printf("  worst bin %.2f%% off the true quantile\n", error * 100.0f);
+    check(error < 0.03f, "P² lands within 3% of the true quantile in every bin");
+    check(tracker.window_progress() == 0, "and the next window starts");
+  }
+
+  // Against the exact quantile of the same samples
+  {
+    NoiseFloorTracker<BINS> tracker;
+    std::vector<float> seen;
+    for (uint16_t i = 0; i < NOISE_FLOOR_WINDOW; i++) {
+      frame(magnitudes, 50.0f);
+      magnitudes[0] = 50.0f * expf(3.0f * uniform());  // Skewed, not uniform
+      seen.push_back(magnitudes[0]);
+      tracker.add(magnitudes);
+    }
+    std::sort(seen.begin(), seen.end());
+    float exact = seen[size_t(NOISE_FLOOR_QUANTILE * (seen.size() - 1))];
+    check(fabsf(tracker.floor()[0] - exact) / exact < 0.08f, "and near the sorted samples' quantile on a skewed bin");
+  }
+
+  // A click
+  {
+    NoiseFloorTracker<BINS> tracker;
+    for (uint16_t i = 0; i < NOISE_FLOOR_WINDOW; i++) {
+      frame(magnitudes, 100.0f);
+      if (i == NOISE_FLOOR_WINDOW / 2) {
+        for (float& m : magnitudes) {
+          m *= 50.0f;
+        }
+      }
+      tracker.add(magnitudes);
+    }
+    float error = worst_error(tracker.floor(), 100.0f);
+    printf("  worst bin %.2f%% off after a click 50x the noise\n", error * 100.0f);
+    check(error < 0.15f, "one loud frame nudges the floor, where a maximum would take it");
+  }
+
+  // The room changes
+  {
+    NoiseFloorTracker<BINS> tracker;
+    float calibrated[BINS];
+    for (uint16_t b = 0; b < BINS; b++) {
+      calibrated[b] = true_quantile(b, 100.0f);
+    }
+    tracker.load(calibrated);
+    check(tracker.ready() && tracker.floor()[5] == calibrated[5], "load() starts from a calibration");
+
+    uint8_t windows = 0;
+    while (worst_error(tracker.floor(), 400.0f) > 0.05f && windows < 20) {
+      for (uint16_t i = 0; i < NOISE_FLOOR_WINDOW; i++) {
+        frame(magnitudes, 400.0f);
+        tracker.add(magnitudes);
+      }
+      windows++;
+    }
+    printf("  %u windows to follow a room 4x louder\n", windows);
+    check(windows <= 6, "a louder room is followed within a few windows");
+
+    windows = 0;
+    while (worst_error(tracker.floor(), 25.0f) > 0.05f && windows < 20) {
+      for (uint16_t i = 0; i < NOISE_FLOOR_WINDOW; i++) {
+        frame(magnitudes, 25.0f);
+        tracker.add(magnitudes);
+      }
+      windows++;
+    }
+    check(windows <= 10, "and so is a quieter one");
+
+    tracker.clear();
+    check(tracker.ready() == false && tracker.floor()[0] == 0.0f, "clear() forgets the floor");
+  }
+
+  // Short pauses in music
+  {
+    const float NOISE = 100.0f;
+    const uint32_t PAUSE_FRAMES = 120;   // About a second between songs
+    const uint32_t MUSIC_FRAMES = 400;
+    const uint32_t HELD_STATE_FRAMES = 190;  // sweet_spot_state holds 1500 ms, at ~125 audio FPS
+
+    // The floor of the smoothed noise alone
+    NoiseFloorTracker<BINS> reference;
+    Pipeline quiet(NOISE);
+    for (uint32_t i = 0; i < NOISE_FLOOR_WINDOW * 6; i++) {
+      quiet.step(NOISE, 1.0f);
+      if (i >= 50) {
+        reference.add(quiet.smoothed);
+      }
+    }
+
+    NoiseFloorTracker<BINS> gated;      // update() with the per-frame gate
+    NoiseFloorTracker<BINS> held;       // add() while a held state says silent, as before
+    Pipeline room(NOISE);
+    bool held_silent = false;
+    uint32_t held_since = 0;
+    uint32_t t = 0;
+    for (uint32_t cycle = 0; cycle < 40; cycle++) {
+      for (uint32_t i = 0; i < PAUSE_FRAMES + MUSIC_FRAMES; i++, t++) {
+        float gain = (i < PAUSE_FRAMES) ? 1.0f : music_gain(i - PAUSE_FRAMES);
+        bool silent = room.step(NOISE, gain);
+        gated.update(room.smoothed, silent);
+
+        if (silent != held_silent && t - held_since > HELD_STATE_FRAMES) {
+          held_silent = silent;
+          held_since = t;
+        }
+        if (held_silent) {
+          held.add(room.smoothed);
+        }
+      }
+    }
+
+    float gated_worst = 0.0f;
+    float held_worst = 0.0f;
+    for (uint16_t b = 0; b < BINS; b++) {
+      gated_worst = std::max(gated_worst, fabsf(gated.floor()[b] / reference.floor()[b] - 1.0f));
+      held_worst = std::max(held_worst, fabsf(held.floor()[b] / reference.floor()[b] - 1.0f));
+    }
+    printf("  through music with %u-frame pauses: gated %.1f%% off the noise floor, held state %.0f%% off (%u windows, %u frames dropped)\n",
+           PAUSE_FRAMES, gated_worst * 100.0f, held_worst * 100.0f, gated.stats().windows, gated.stats().discarded);
+    check(gated.stats().windows >= 3, "short pauses still add up to windows");
+    check(gated_worst < 0.10f, "the per-frame gate and guard frames keep music out of the floor");
+    check(held_worst > 1.0f, "where the held sweet spot state lets the music in");
+
+    NoiseFloorTracker<BINS> broken;
+    Pipeline pulses(NOISE);
+    for (uint32_t i = 0; i < 20000; i++) {
+      broken.update(pulses.smoothed, pulses.step(NOISE, (i % 20 == 0) ? 20.0f : 1.0f));
+    }
+    check(broken.stats().frames == 0, "silence broken every few frames never counts");
+  }
+
+  // Profiles
+  {
+    NoiseProfileBank<BINS> bank;
+    bank.clear();
+    float floor[BINS];
+    for (uint16_t b = 0; b < BINS; b++) {
+      floor[b] = float(b);
+    }
+    printf("  NoiseProfileBank is %zu bytes, one journal blob\n", sizeof(bank));
+    check(sizeof(bank) < 0xFFFF, "the bank fits one journal record");
+
+    uint8_t stage = bank.store("stage", floor);
+    floor[0] = 7.0f;
+    uint8_t bar = bank.store("bar", floor);
+    check(stage == 0 && bar == 1 && bank.count() == 2 && bank.find("bar") == bar && bank.find("nope") == NOISE_PROFILE_NONE,
+          "profiles go into the first free slots and are found by name");
+    check(bank.profiles[bar].floor[0] == 7.0f && bank.profiles[stage].floor[0] == 0.0f, "each keeps its own floor");
+
+    floor[0] = 9.0f;
+    check(bank.store("stage", floor) == stage && bank.profiles[stage].floor[0] == 9.0f, "storing a name again replaces it");
+    check(bank.store("", floor) == NOISE_PROFILE_NONE && bank.store("a_name_far_too_long", floor) == NOISE_PROFILE_NONE,
+          "names have to be 1-15 characters");
+
+    bank.store("street", floor);
+    bank.store("hall", floor);
+    check(bank.store("one_more", floor) == NOISE_PROFILE_NONE, "a full bank refuses new names");
+    check(bank.remove(bar) && bank.find("bar") == NOISE_PROFILE_NONE && bank.remove(bar) == false, "remove");
+    check(bank.store("one_more", floor) == bar, "a removed slot is reused");
+    check(bank.bins == BINS, "the bank records its bin count");
+  }
+
+  // Cost
+  {
+    NoiseFloorTracker<BINS> tracker;
+    const uint32_t FRAMES = 100000;
+    std::vector<float> frames(size_t(BINS) * 64);
+    for (uint16_t i = 0; i < 64; i++) {
+      frame(&frames[size_t(i) * BINS], 100.0f);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+      tracker.update(&frames[size_t(i % 64) * BINS], true);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  update() %.2f us per frame of %u bins (%.1f)\n", seconds * 1e6 / FRAMES, BINS, tracker.floor()[0]);
+    check(tracker.stats().frames == FRAMES - NOISE_FLOOR_GUARD_FRAMES * 2, "every silent frame past the first guard frames is counted");
+  }
+
+  return check_summary();
+}
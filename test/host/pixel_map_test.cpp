@@ -0,0 +1,98 @@
+/**
+ * Pixel Map Test (host)
+ *
+ * Parses layout strings with src/pixel_map.h and checks the LUTs they build
+ * against hand-written wiring: plain and reversed strips, outputs, placed
+ * segments, serpentine and column-major matrices, REVERSE_ORDER per output,
+ * and the errors for layouts that don't fit the strip.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/pixel_map_test.cpp -o pixel_map_test
+ *   ./pixel_map_test
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#include "host_check.h"
+#include "pixel_map.h"
+
+static std::vector<uint16_t> map_for(const char* text, uint16_t led_count, bool reverse = false) {
+  PixelLayout layout;
+  std::vector<uint16_t> map(led_count);
+  if (parse_pixel_layout(text, led_count, layout) != PIXEL_MAP_OK) {
+    return {};
+  }
+  build_pixel_map(layout, led_count, reverse, led_count, map.data());
+  return map;
+}
+
+int main() {
+  // Identity and REVERSE_ORDER
+  {
+    std::vector<uint16_t> map = map_for("8", 8);
+    check(map == std::vector<uint16_t>({0, 1, 2, 3, 4, 5, 6, 7}), "plain strip is the identity");
+
+    map = map_for("8", 8, true);
+    check(map == std::vector<uint16_t>({7, 6, 5, 4, 3, 2, 1, 0}), "reverse_order flips the whole wire");
+  }
+
+  // Two outputs, second one wired from the far end
+  {
+    PixelLayout layout;
+    uint8_t error = parse_pixel_layout("4/4r", 8, layout);
+    check(error == PIXEL_MAP_OK && layout.num_outputs == 2 &&
+          layout.output_start[1] == 4 && layout.output_count[1] == 4, "outputs split the wire");
+
+    std::vector<uint16_t> map = map_for("4/4r", 8);
+    check(map == std::vector<uint16_t>({0, 1, 2, 3, 7, 6, 5, 4}), "reversed segment on the second output");
+
+    map = map_for("4/4", 8, true);
+    check(map == std::vector<uint16_t>({3, 2, 1, 0, 7, 6, 5, 4}), "reverse_order flips each output on its own");
+  }
+
+  // REVERSE_ORDER on a layout shorter than the strip stays inside the layout
+  {
+    std::vector<uint16_t> map = map_for("3/3", 8, true);
+    check(map == std::vector<uint16_t>({2, 1, 0, 5, 4, 3, 8, 8}), "reverse_order on a partial layout");
+  }
+
+  // Placed segments: fed from the middle, both halves running outwards
+  {
+    std::vector<uint16_t> map = map_for("4r@0,4@4", 8);
+    check(map == std::vector<uint16_t>({3, 2, 1, 0, 4, 5, 6, 7}), "segments placed with '@'");
+  }
+
+  // 4x3 serpentine matrix, rows alternate direction on the wire
+  {
+    std::vector<uint16_t> map = map_for("4x3s", 12);
+    check(map == std::vector<uint16_t>({0, 1, 2, 3,
+                                        7, 6, 5, 4,
+                                        8, 9, 10, 11}), "serpentine matrix");
+  }
+
+  // 3x2 matrix wired column by column, serpentine
+  {
+    std::vector<uint16_t> map = map_for("3x2cs", 6);
+    check(map == std::vector<uint16_t>({0, 3, 4,
+                                        1, 2, 5}), "column-major serpentine matrix");
+  }
+
+  // Fewer mapped pixels than LEDs: the rest point at the sink
+  {
+    std::vector<uint16_t> map = map_for("2@1", 4);
+    check(map == std::vector<uint16_t>({4, 0, 1, 4}), "unmapped logical pixels go to the sink");
+  }
+
+  // Errors
+  {
+    PixelLayout layout;
+    check(parse_pixel_layout("9", 8, layout) == PIXEL_MAP_LOGICAL_OVERFLOW, "segment longer than the strip");
+    check(parse_pixel_layout("4,4@0,4@4", 8, layout) == PIXEL_MAP_PHYSICAL_OVERFLOW, "more pixels on the wire than LEDs");
+    check(parse_pixel_layout("4,x", 8, layout) == PIXEL_MAP_SYNTAX, "syntax error");
+    check(parse_pixel_layout("0", 8, layout) == PIXEL_MAP_EMPTY_SEGMENT, "empty segment");
+    check(parse_pixel_layout("1/1/1/1/1", 8, layout) == PIXEL_MAP_TOO_MANY_OUTPUTS, "too many outputs");
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,243 @@
+/**
+ * Preset Bank Test (host)
+ *
+ * Checks src/preset_bank.h: storing, finding, replacing and removing
+ * presets, that a switch waits for apply() and copies only the fields
+ * that differ (and only the preset's own), that derived tables
+ * (derived_tables.h) rebuild after a switch only when an input changed,
+ * that a bank saved with another CONFIG layout still loads with the fields
+ * that exist, and that a thread switching presets never sees one half
+ * stored.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -pthread -Isrc test/host/preset_bank_test.cpp -o preset_bank_test
+ *   ./preset_bank_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "derived_tables.h"
+#include "host_check.h"
+#include "preset_bank.h"
+
+using SensoryBridge::Config::conf;
+
+struct MutexLock {
+  std::mutex mutex;
+  void lock() { mutex.lock(); }
+  void unlock() { mutex.unlock(); }
+};
+
+static conf defaults() {
+  conf config;
+  memset(&config, 0, sizeof(config));
+  config.PHOTONS = 1.0;
+  config.SATURATION = 1.0;
+  config.SAMPLE_RATE = 16000;
+  config.LED_COUNT = 128;
+  return config;
+}
+
+static uint32_t fake_us = 0;
+static uint32_t fake_clock() {
+  return fake_us;
+}
+static int goertzel_builds = 0;
+static int pixel_map_builds = 0;
+static void build_goertzel() {
+  goertzel_builds++;
+}
+static void build_pixel_map() {
+  pixel_map_builds++;
+}
+
+// A field's value as «bank» would set it from «slot»
+static conf preset_values(const PresetBank<MutexLock>& bank, uint8_t slot) {
+  conf values = defaults();
+  bank.copy_into(slot, values);
+  return values;
+}
+
+// One saved entry (config_pack()) as another firmware might have written it
+static uint8_t* put_entry(uint8_t* at, const char* name, const void* value, uint8_t size) {
+  at[0] = uint8_t(config_key(name));
+  at[1] = uint8_t(config_key(name) >> 8);
+  at[2] = size;
+  memcpy(at + CONFIG_ENTRY_HEADER, value, size);
+  return at + CONFIG_ENTRY_HEADER + size;
+}
+
+static const DerivedTable list[2] = {
+  { "goertzel",  CONFIG_MASK(SAMPLE_RATE) | CONFIG_MASK(NOTE_OFFSET), NULL, build_goertzel  },
+  { "pixel_map", CONFIG_MASK(LED_COUNT) | CONFIG_MASK(REVERSE_ORDER), NULL, build_pixel_map },
+};
+
+int main() {
+  printf("  PresetBankImage is %zu bytes, one journal blob\n", sizeof(PresetBankImage));
+  check(sizeof(PresetBankImage) < 0xFFFF, "the bank fits one journal record");
+
+  // Storing
+  {
+    PresetBank<MutexLock> bank;
+    conf config = defaults();
+    check(bank.count() == 0 && bank.active() == PRESET_NONE, "a new bank is empty");
+
+    config.MOOD = 0.25;
+    uint8_t chill = bank.store("chill", config);
+    config.MOOD = 0.75;
+    uint8_t party = bank.store("party", config);
+    check(chill == 0 && party == 1 && bank.count() == 2, "presets go into the first free slots");
+    check(bank.find("party") == party && bank.find("nope") == PRESET_NONE, "found by name");
+
+    config.MOOD = 0.5;
+    check(bank.store("chill", config) == chill && bank.count() == 2 && preset_values(bank, chill).MOOD == 0.5f,
+          "storing a name again replaces that preset");
+    check(bank.store("", config) == PRESET_NONE && bank.store("a_name_far_too_long", config) == PRESET_NONE,
+          "names have to be 1-15 characters");
+
+    check(bank.remove(chill) && bank.find("chill") == PRESET_NONE && bank.remove(chill) == false, "remove");
+    check(bank.store("ambient", config) == chill, "a removed slot is reused");
+    check(bank.next(PRESET_NONE) == 0 && bank.next(0) == 1 && bank.next(1) == 0, "next() wraps over the used slots");
+
+    char name[8];
+    for (uint8_t i = bank.count(); i < PRESET_BANK_SLOTS; i++) {
+      snprintf(name, sizeof(name), "p%u", i);
+      bank.store(name, config);
+    }
+    check(bank.count() == PRESET_BANK_SLOTS && bank.store("one_more", config) == PRESET_NONE, "a full bank refuses new names");
+  }
+
+  // Switching
+  {
+    PresetBank<MutexLock> bank;
+    DerivedTables<2> tables(list, fake_clock);
+    conf config = defaults();
+    tables.refresh(config);
+
+    conf look = config;
+    look.PHOTONS = 0.5;
+    look.NOTE_OFFSET = 7;
+    look.LED_COUNT = 300;  // Not a PRESET_FIELDS field
+    uint8_t full = bank.store("look", look);
+
+    conf theme = defaults();
+    theme.SATURATION = 0.0;
+    theme.MOOD = 0.9f;
+    uint8_t white = bank.store("white", theme, CONFIG_MASK(SATURATION));
+
+    check(bank.request(PRESET_BANK_SLOTS - 1) == false, "an empty slot can't be requested");
+    check(bank.request(full) && config.PHOTONS == 1.0f, "a request changes nothing by itself");
+    ConfigMask changed = bank.apply(config);
+    check(changed == (CONFIG_MASK(PHOTONS) | CONFIG_MASK(NOTE_OFFSET)) && config.PHOTONS == 0.5f && config.NOTE_OFFSET == 7,
+          "apply() copies the fields that differ and reports them");
+    check(config.LED_COUNT == 128, "but leaves the strip alone");
+    check(bank.active() == full && bank.apply(config) == 0, "a request is applied once");
+
+    check(tables.refresh(config) == 1 && goertzel_builds == 2 && pixel_map_builds == 1,
+          "only the table with a changed input rebuilds");
+
+    bank.request(white);
+    changed = bank.apply(config);
+    check(changed == CONFIG_MASK(SATURATION) && config.SATURATION == 0.0f && config.MOOD == 0.0f && config.PHOTONS == 0.5f,
+          "a theme only sets its own fields");
+    check(tables.refresh(config) == 0, "and rebuilds no table that doesn't read them");
+
+    bank.request(white);
+    check(bank.apply(config) == 0 && bank.stats().switches == 3 && bank.stats().last_changed == 0,
+          "switching to what's already there changes nothing");
+
+    bank.request(full);
+    bank.request(white);
+    bank.apply(config);
+    check(bank.active() == white && config.PHOTONS == 0.5f, "a later request replaces an earlier one");
+
+    bank.request(full);
+    bank.remove(full);
+    check(bank.apply(config) == 0, "a preset removed before its switch isn't applied");
+
+    conf staged = defaults();
+    check(bank.copy_into(white, staged) && staged.SATURATION == 0.0f && staged.PHOTONS == 1.0f,
+          "copy_into() sets a preset's fields right away");
+  }
+
+  // Saving and loading
+  {
+    PresetBank<MutexLock> bank;
+    conf config = defaults();
+    config.CHROMA = 0.3f;
+    bank.store("saved", config);
+    PresetBankImage image = bank.image;
+
+    PresetBank<MutexLock> next_boot;
+    check(next_boot.load(image) && next_boot.find("saved") == 0 && preset_values(next_boot, 0).CHROMA == 0.3f,
+          "a saved bank loads");
+    check(next_boot.fields(0) == PRESET_FIELDS, "with every field it was stored with");
+
+    // What another layout would have saved, by key: CHROMA, a field this
+    // firmware doesn't have, MOOD at another size, then SATURATION
+    Preset& old = image.presets[1];
+    memset(&old, 0, sizeof(old));
+    strcpy(old.name, "old");
+    float chroma = 0.6f;
+    float saturation = 0.25f;
+    uint16_t mood = 1;
+    uint8_t* at = old.entries;
+    at = put_entry(at, "CHROMA", &chroma, sizeof(chroma));
+    at = put_entry(at, "RETIRED_FIELD", &mood, sizeof(mood));
+    at = put_entry(at, "MOOD", &mood, sizeof(mood));
+    at = put_entry(at, "SATURATION", &saturation, sizeof(saturation));
+    old.length = uint16_t(at - old.entries);
+
+    PresetBank<MutexLock> other_firmware;
+    conf current = defaults();
+    current.MOOD = 0.5f;
+    check(other_firmware.load(image) && other_firmware.find("old") == 1, "one saved with another CONFIG layout loads");
+    check(other_firmware.fields(1) == (CONFIG_MASK(CHROMA) | CONFIG_MASK(SATURATION)), "keeping the fields that still exist");
+    other_firmware.request(1);
+    check(other_firmware.apply(current) == (CONFIG_MASK(CHROMA) | CONFIG_MASK(SATURATION)) && current.CHROMA == 0.6f &&
+              current.SATURATION == 0.25f && current.MOOD == 0.5f,
+          "and switching to it sets just those");
+
+    image.format ^= 1;
+    PresetBank<MutexLock> not_a_bank;
+    check(not_a_bank.load(image) == false && not_a_bank.count() == 0, "a blob that isn't a preset bank doesn't load");
+  }
+
+  // One thread storing, another switching
+  {
+    PresetBank<MutexLock> bank;
+    conf a = defaults();
+    a.PHOTONS = 0.0;  // PHOTONS, CHROMA and MOOD always stored equal
+    bank.store("x", a);
+    const conf start = a;
+
+    const uint32_t ROUNDS = 200000;
+    std::atomic<bool> storing(true);
+    bool torn = false;
+    std::thread switcher([&] {
+      conf config = start;
+      while (storing.load()) {
+        bank.request(0);
+        bank.apply(config);
+        torn |= (config.PHOTONS != config.CHROMA || config.CHROMA != config.MOOD);
+      }
+    });
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+      float value = float(i % 100) / 100.0f;
+      a.PHOTONS = value;
+      a.CHROMA = value;
+      a.MOOD = value;
+      bank.store("x", a);
+    }
+    storing = false;
+    switcher.join();
+    check(torn == false, "a switch never copies a preset halfway through being stored");
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,144 @@
+/**
+ * Prism Fold Test (host)
+ *
+ * Checks src/prism_fold.h against the prism loop it replaced: scale to
+ * half, shift up, mirror downwards, once per pass. At 160, 150 and 80 px
+ * and 1 to 8 passes, every fold depth taken the way apply_prism_effect()
+ * does (box averages from prefix sums up to the deepest contiguous level,
+ * prism_fold() past it) has to match that loop to within rounding. Also
+ * shows what reusing the deepest box for deeper passes got wrong.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/prism_fold_test.cpp -o prism_fold_test
+ *   ./prism_fold_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "host_check.h"
+#include "prism_fold.h"
+
+#define PRISM_MAX_LEVEL 6  // led_utilities.h
+#define MAX_PASSES      8
+
+typedef std::vector<int32_t> Channel;
+
+// One pass of the old loop: scale_image_to_half(), shift_leds_up() by
+// half, mirror_image_downwards(). SQ15x16 * 0.5 is a shift right
+static Channel old_pass(const Channel& in) {
+  uint16_t resolution = uint16_t(in.size());
+  uint16_t half_res = resolution >> 1;
+  Channel halved(resolution, 0);
+  for (uint16_t i = 0; i < half_res; i++) {
+    halved[i] = (in[i << 1] >> 1) + (in[(i << 1) + 1] >> 1);
+  }
+  Channel shifted(resolution, 0);
+  for (uint16_t i = 0; i < resolution - half_res; i++) {
+    shifted[half_res + i] = halved[i];
+  }
+  Channel mirrored(resolution, 0);
+  for (uint16_t i = 0; i < half_res; i++) {
+    mirrored[half_res + i] = shifted[half_res + i];
+    mirrored[half_res - 1 - i] = shifted[half_res + i];
+  }
+  return mirrored;
+}
+
+// Every depth 1..passes the way apply_prism_effect() takes them
+struct Depths {
+  uint8_t levels;
+  std::vector<Channel> depth;  // [k], k = 1..passes
+  std::vector<Channel> reused;  // [k], the deepest box reused past «levels», as before
+};
+
+static Depths prism_depths(const Channel& source, uint8_t passes) {
+  uint16_t resolution = uint16_t(source.size());
+  std::vector<uint16_t> storage(size_t(PRISM_MAX_LEVEL + 1) * resolution);
+  uint16_t* span_start[PRISM_MAX_LEVEL + 1];
+  for (uint8_t k = 0; k <= PRISM_MAX_LEVEL; k++) {
+    span_start[k] = &storage[size_t(k) * resolution];
+  }
+
+  Depths out;
+  out.levels = prism_build_spans(span_start, PRISM_MAX_LEVEL, resolution);
+  out.depth.resize(passes + 1, Channel(resolution));
+  out.reused.resize(passes + 1, Channel(resolution));
+
+  Channel sum(resolution + 1, 0);
+  for (uint16_t i = 0; i < resolution; i++) {
+    sum[i + 1] = sum[i] + source[i];
+  }
+  for (uint8_t k = 1; k <= passes; k++) {
+    uint8_t level = (k > out.levels) ? out.levels : k;
+    for (uint16_t j = 0; j < resolution; j++) {
+      out.reused[k][j] = prism_box(sum.data(), span_start[level][j], level);
+      if (k <= out.levels) {
+        out.depth[k][j] = out.reused[k][j];
+      }
+    }
+  }
+
+  if (passes > out.levels) {
+    Channel depth(resolution);
+    for (uint16_t j = 0; j < resolution; j++) {
+      depth[j] = prism_box(sum.data(), span_start[out.levels][j], out.levels);
+    }
+    for (uint8_t k = out.levels + 1; k <= passes; k++) {
+      prism_fold(depth.data(), sum.data(), resolution);  // The sums take the next depth, as on the device
+      depth.assign(sum.begin(), sum.begin() + resolution);
+      out.depth[k] = depth;
+    }
+  }
+  return out;
+}
+
+static int32_t worst_difference(const Channel& a, const Channel& b) {
+  int32_t worst = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    int32_t difference = abs(a[i] - b[i]);
+    worst = (difference > worst) ? difference : worst;
+  }
+  return worst;
+}
+
+int main() {
+  const uint16_t resolutions[] = { 160, 150, 80 };
+  const uint8_t expected_levels[] = { 5, 1, 4 };
+  srand(1);
+
+  for (uint8_t r = 0; r < 3; r++) {
+    uint16_t resolution = resolutions[r];
+    Channel source(resolution);
+    for (uint16_t i = 0; i < resolution; i++) {
+      source[i] = rand() % (2 << 16);  // Up to 2.0 in Q16, prism output runs over 1.0
+    }
+
+    Depths depths = prism_depths(source, MAX_PASSES);
+    char what[96];
+    snprintf(what, sizeof(what), "%u px: one contiguous box up to level %u", resolution, expected_levels[r]);
+    check(depths.levels == expected_levels[r], what);
+
+    Channel reference = source;
+    bool matches = true;
+    int32_t worst_reused = 0;
+    for (uint8_t k = 1; k <= MAX_PASSES; k++) {
+      reference = old_pass(reference);
+      int32_t difference = worst_difference(depths.depth[k], reference);
+      matches &= (difference <= 2 * k);  // Each old pass rounded down twice
+      if (k > depths.levels) {
+        int32_t reused = worst_difference(depths.reused[k], reference);
+        worst_reused = (reused > worst_reused) ? reused : worst_reused;
+      }
+    }
+    snprintf(what, sizeof(what), "%u px: passes 1-%u match the old loop", resolution, MAX_PASSES);
+    check(matches, what);
+    printf("  %u px: reusing the deepest box was up to %.3f off past level %u\n", resolution,
+           worst_reused / 65536.0, depths.levels);
+    snprintf(what, sizeof(what), "%u px: where reusing the deepest box didn't", resolution);
+    check(worst_reused > 2 * MAX_PASSES, what);
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,200 @@
+/**
+ * Procedural Engine Test (host)
+ *
+ * Checks src/procedural.h against libm and against itself: sine, exp and
+ * x^0.8 LUT accuracy, noise range, zero crossings at lattice points, continuity
+ * between neighbouring samples, the *_row() batch calls matching the
+ * scalar ones, and xorshift determinism and spread. Also prints the time
+ * per call next to the libm and rand() calls the modes used before.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/procedural_test.cpp -o procedural_test
+ *   ./procedural_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "host_check.h"
+#include "procedural.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double ns_per_call(Clock::time_point start, uint32_t calls) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+}
+
+int main() {
+  // Sine, exp and x^0.8 LUTs
+  {
+    double worst_sin = 0.0;
+    for (uint32_t k = 0; k < 100000; k++) {
+      uint32_t phase = k * 42949u;
+      double ref = sin(double(phase) * (2.0 * M_PI / 4294967296.0));
+      double err = fabs(proc_sin(phase) / 65536.0 - ref);
+      if (err > worst_sin) { worst_sin = err; }
+    }
+    printf("  sin worst error %.6f\n", worst_sin);
+    check(worst_sin < 0.0002, "proc_sin() within 0.0002 of sin()");
+
+    check(abs(proc_cos(0) - 65534) <= 2 && abs(proc_cos(PROC_PHASE_QUARTER)) <= 2, "proc_cos() is a quarter turn ahead");
+    check(proc_phase(float(M_PI)) - 0x80000000u + 64 < 128, "proc_phase() maps pi to half a turn");
+    check(proc_phase_q16(int32_t(M_PI * 65536)) - 0x80000000u + 65536 < 131072, "proc_phase_q16() maps pi to half a turn");
+
+    double worst_exp = 0.0;
+    for (int32_t x = 0; x < (8 << 16); x += 97) {
+      double err = fabs(proc_exp_neg(x) / 65536.0 - exp(-x / 65536.0));
+      if (err > worst_exp) { worst_exp = err; }
+    }
+    printf("  exp worst error %.6f\n", worst_exp);
+    check(worst_exp < 0.001 && proc_exp_neg(9 << 16) == 0, "proc_exp_neg() within 0.001 of exp(-x)");
+
+    double worst_pow = 0.0;
+    for (int32_t x = 0; x <= (1 << 16); x += 7) {
+      double err = fabs(proc_pow_0_8(x) / 65536.0 - pow(x / 65536.0, 0.8));
+      if (err > worst_pow) { worst_pow = err; }
+    }
+    printf("  x^0.8 worst error %.6f\n", worst_pow);
+    check(worst_pow < 0.003 && proc_pow_0_8(2 << 16) == 65535, "proc_pow_0_8() within 0.003 of pow(x, 0.8)");
+  }
+
+  // 1D noise
+  {
+    bool lattice_zero = true;
+    for (uint32_t cell = 0; cell < 512; cell++) {
+      lattice_zero &= (noise1(cell << 16) == 0);
+    }
+    check(lattice_zero, "noise1() is zero on lattice points");
+
+    int32_t lo = 0, hi = 0, worst_step = 0;
+    int16_t last = noise1(0);
+    for (uint32_t x = 64; x < (300u << 16); x += 64) {
+      int16_t n = noise1(x);
+      if (n < lo) { lo = n; }
+      if (n > hi) { hi = n; }
+      if (abs(n - last) > worst_step) { worst_step = abs(n - last); }
+      last = n;
+    }
+    printf("  noise1 range %d..%d, worst step %d\n", lo, hi, worst_step);
+    check(lo < -16000 && hi > 16000, "noise1() spans most of the Q15 range");
+    check(worst_step < 512, "noise1() is continuous");
+
+    std::vector<int16_t> row(500);
+    noise1_row(row.data(), 123456789u, 3000, row.size());
+    bool same = true;
+    for (uint32_t i = 0; i < row.size(); i++) {
+      same &= (row[i] == noise1(123456789u + i * 3000));
+    }
+    check(same, "noise1_row() matches noise1()");
+
+    std::vector<uint32_t> xs(500);
+    for (uint32_t i = 0; i < xs.size(); i++) {
+      xs[i] = (i + 18) * (i + 18) * (i + 18);
+    }
+    noise1_row_at(row.data(), xs.data(), 3, 777u, row.size());
+    same = true;
+    for (uint32_t i = 0; i < row.size(); i++) {
+      same &= (row[i] == noise1(xs[i] * 3 + 777u));
+    }
+    check(same, "noise1_row_at() matches noise1()");
+  }
+
+  // 2D noise
+  {
+    int32_t lo = 0, hi = 0, worst_step = 0;
+    for (uint32_t y = 0; y < (40u << 16); y += 5000) {
+      int16_t last = noise2(0, y);
+      for (uint32_t x = 256; x < (40u << 16); x += 256) {
+        int16_t n = noise2(x, y);
+        if (n < lo) { lo = n; }
+        if (n > hi) { hi = n; }
+        if (abs(n - last) > worst_step) { worst_step = abs(n - last); }
+        last = n;
+      }
+    }
+    printf("  noise2 range %d..%d, worst step %d\n", lo, hi, worst_step);
+    check(lo < -16000 && hi > 16000, "noise2() spans most of the Q15 range");
+    check(worst_step < 512, "noise2() is continuous");
+    check(noise2(5 << 16, 9 << 16) == 0, "noise2() is zero on lattice points");
+
+    std::vector<int16_t> row(500);
+    noise2_row(row.data(), 4000000000u, 7000, 987654u, row.size());
+    bool same = true;
+    for (uint32_t i = 0; i < row.size(); i++) {
+      same &= (row[i] == noise2(4000000000u + i * 7000, 987654u));
+    }
+    check(same, "noise2_row() matches noise2() across the coordinate wrap");
+  }
+
+  // RNG
+  {
+    ProcRng a, b;
+    proc_seed(a, 1234);
+    proc_seed(b, 1234);
+    bool same = true;
+    for (int i = 0; i < 1000; i++) {
+      same &= (proc_rand(a) == proc_rand(b));
+    }
+    check(same, "same seed, same sequence");
+
+    proc_seed(a, 0);
+    check(proc_rand(a) != 0, "seed 0 doesn't stall the generator");
+
+    uint32_t buckets[10] = {0};
+    float lo = 1.0f, hi = 0.0f;
+    for (int i = 0; i < 100000; i++) {
+      buckets[proc_rand_below(a, 10)]++;
+      float f = proc_rand_float(a);
+      if (f < lo) { lo = f; }
+      if (f > hi) { hi = f; }
+    }
+    bool even = true;
+    for (int i = 0; i < 10; i++) {
+      even &= (buckets[i] > 9500 && buckets[i] < 10500);
+    }
+    check(even, "proc_rand_below() is evenly spread");
+    check(lo >= 0.0f && hi < 1.0f && hi > 0.999f, "proc_rand_float() covers [0, 1)");
+  }
+
+  // Speed against what the modes called before (host numbers, not ESP32)
+  {
+    const uint32_t calls = 2000000;
+    volatile double sink_d = 0.0;
+    volatile int32_t sink_i = 0;
+
+    Clock::time_point t = Clock::now();
+    for (uint32_t i = 0; i < calls; i++) { sink_d = sink_d + sin(i * 0.001); }
+    double t_sin = ns_per_call(t, calls);
+
+    t = Clock::now();
+    for (uint32_t i = 0; i < calls; i++) { sink_i = sink_i + proc_sin(i * 4294967u); }
+    double t_lut = ns_per_call(t, calls);
+
+    std::vector<int16_t> row(500);
+    t = Clock::now();
+    for (uint32_t i = 0; i < calls / 500; i++) {
+      noise1_row(row.data(), i << 12, 9000, row.size());
+      sink_i = sink_i + row[i % 500];
+    }
+    double t_noise = ns_per_call(t, calls);
+
+    ProcRng rng;
+    proc_seed(rng, 99);
+    t = Clock::now();
+    for (uint32_t i = 0; i < calls; i++) { sink_i = sink_i + rand(); }
+    double t_rand = ns_per_call(t, calls);
+
+    t = Clock::now();
+    for (uint32_t i = 0; i < calls; i++) { sink_i = sink_i + int32_t(proc_rand(rng)); }
+    double t_xor = ns_per_call(t, calls);
+
+    printf("  sin() %.1f ns, proc_sin() %.1f ns\n", t_sin, t_lut);
+    printf("  noise1_row() %.1f ns/pixel\n", t_noise);
+    printf("  rand() %.1f ns, proc_rand() %.1f ns\n", t_rand, t_xor);
+  }
+
+  return check_summary();
+}
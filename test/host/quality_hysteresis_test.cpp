@@ -0,0 +1,96 @@
+/**
+ * Quality Hysteresis Test (host)
+ *
+ * Checks src/quality_hysteresis.h: that a frame over budget for
+ * QUALITY_DEGRADE_FRAMES steps quality down, that headroom for
+ * QUALITY_RECOVER_FRAMES steps it back up to full, that frames inside
+ * the hysteresis band hold the level, and that a locked level doesn't
+ * move. Also shows why the audio frame time must leave out the blocking
+ * I2S read: with the ~8 ms chunk wait counted, the governor never recovers.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/quality_hysteresis_test.cpp -o quality_hysteresis_test
+ *   ./quality_hysteresis_test
+ */
+
+#include <stdio.h>
+
+#include "host_check.h"
+#include "quality_hysteresis.h"
+
+const uint8_t LEVELS = 6;                      // NUM_QUALITY_LEVELS
+const uint32_t AUDIO_BUDGET_US = 1000000 / 120;  // QUALITY_AUDIO_BUDGET_US
+const uint32_t LED_BUDGET_US = 1000000 / 60;     // QUALITY_LED_BUDGET_US
+const uint32_t I2S_READ_US = 8000;             // One 128-sample chunk at 16 kHz
+
+// Feed «frames» LED frames with these times, the level at the end
+static uint8_t run(QualityHysteresis<LEVELS>& governor, uint32_t frames, uint32_t audio_us, uint32_t led_us,
+                   bool automatic = true) {
+  for (uint32_t i = 0; i < frames; i++) {
+    governor.update(audio_us, led_us, automatic);
+  }
+  return governor.level();
+}
+
+int main() {
+  // Down and back up
+  {
+    QualityHysteresis<LEVELS> governor(AUDIO_BUDGET_US, LED_BUDGET_US);
+    check(run(governor, 1000, 3000, 8000) == 0, "comfortable frames stay at full quality");
+
+    run(governor, 60, 3000, 20000);
+    check(governor.level() >= 1, "LED frames over budget step quality down");
+
+    uint8_t degraded = run(governor, 400, 12000, 8000);
+    check(degraded > 1, "and so do audio frames over budget");
+
+    uint32_t frames = 0;
+    while (governor.level() > 0 && frames < 10000) {
+      governor.update(3000, 8000, true);
+      frames++;
+    }
+    printf("  %u frames of headroom back to full from level %u\n", frames, degraded);
+    check(governor.level() == 0, "with headroom again, quality steps back up to full");
+    check(governor.changes() == uint32_t(degraded) * 2, "one change per step, down and up");
+  }
+
+  // The band
+  {
+    QualityHysteresis<LEVELS> governor(AUDIO_BUDGET_US, LED_BUDGET_US);
+    governor.set(3);
+    uint32_t in_band_us = uint32_t(AUDIO_BUDGET_US * 0.85);  // Under budget, over the recovery ratio
+    check(run(governor, 2000, in_band_us, 8000) == 3, "between the recovery ratio and the budget the level holds");
+
+    // Headroom that keeps getting interrupted never adds up to a recovery
+    for (int i = 0; i < 20; i++) {
+      run(governor, QUALITY_RECOVER_FRAMES / 2, 3000, 8000);
+      run(governor, 20, in_band_us, 8000);
+    }
+    check(governor.level() == 3, "short stretches of headroom don't step up");
+  }
+
+  // Locked from the serial menu
+  {
+    QualityHysteresis<LEVELS> governor(AUDIO_BUDGET_US, LED_BUDGET_US);
+    governor.set(2);
+    check(run(governor, 1000, 20000, 30000, false) == 2 && run(governor, 1000, 1000, 1000, false) == 2,
+          "a locked level doesn't move");
+    check(governor.audio_avg_us() < 2000.0f, "but the averages are still kept for the status line");
+    check(governor.set(LEVELS + 3) && governor.level() == LEVELS - 1, "set() clamps to the last level");
+  }
+
+  // What it measures
+  {
+    QualityHysteresis<LEVELS> waiting(AUDIO_BUDGET_US, LED_BUDGET_US);
+    QualityHysteresis<LEVELS> working(AUDIO_BUDGET_US, LED_BUDGET_US);
+    waiting.set(2);
+    working.set(2);
+    const uint32_t work_us = 2500;  // GDFT and features, well inside the budget
+    run(waiting, 5000, I2S_READ_US + work_us, 8000);
+    run(working, 5000, work_us, 8000);
+    check(waiting.level() >= 2, "timing the I2S wait as well, quality never comes back");
+    check(working.level() == 0, "timing only the work after it, quality recovers");
+  }
+
+  return check_summary();
+}
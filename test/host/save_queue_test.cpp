@@ -0,0 +1,188 @@
+/**
+ * Save Queue Test (host)
+ *
+ * Checks src/save_queue.h: that a post is a copy the caller can change
+ * right away, that repeated posts coalesce into one write of the last
+ * snapshot, that slots come out oldest first, that an erase replaces a
+ * pending save and the other way round, that a post during a write
+ * doesn't touch what's being written, and that two threads posting
+ * against a writer never see a torn snapshot and end on the last one.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -pthread -Isrc test/host/save_queue_test.cpp -o save_queue_test
+ *   ./save_queue_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "host_check.h"
+#include "save_queue.h"
+
+struct MutexLock {
+  std::mutex mutex;
+  void lock() { mutex.lock(); }
+  void unlock() { mutex.unlock(); }
+};
+
+enum { CONFIG, NOISE, NUM_KINDS };
+
+// Every word the same, so a torn copy shows
+struct Snapshot {
+  uint32_t words[64];
+};
+
+static Snapshot snapshot(uint32_t value) {
+  Snapshot s;
+  for (uint32_t& word : s.words) {
+    word = value;
+  }
+  return s;
+}
+
+static bool whole(const void* data, uint32_t* value) {
+  const Snapshot* s = (const Snapshot*)data;
+  for (uint32_t word : s->words) {
+    if (word != s->words[0]) {
+      return false;
+    }
+  }
+  *value = s->words[0];
+  return true;
+}
+
+struct Buffers {
+  Snapshot posted[NUM_KINDS];
+  Snapshot writing[NUM_KINDS];
+};
+
+template <typename Queue>
+static void add_slots(Queue& queue, Buffers& buffers) {
+  for (uint8_t k = 0; k < NUM_KINDS; k++) {
+    queue.add_slot(k, &buffers.posted[k], &buffers.writing[k], sizeof(Snapshot));
+  }
+}
+
+int main() {
+  // Single thread
+  {
+    Buffers buffers;
+    SaveQueue<NUM_KINDS, MutexLock> queue;
+    check(queue.post(CONFIG, NULL) == false, "a slot that wasn't added can't be posted to");
+    add_slots(queue, buffers);
+    check(queue.post(NUM_KINDS, NULL) == false, "nor can one out of range");
+
+    uint8_t kind;
+    const void* data;
+    uint32_t value = 0;
+    check(queue.idle() && queue.take(kind, data) == false, "empty at first");
+
+    Snapshot s = snapshot(1);
+    queue.post(CONFIG, &s);
+    s = snapshot(2);  // The caller's copy is its own again
+    queue.post(CONFIG, &s);
+    s = snapshot(3);
+    queue.post(CONFIG, &s);
+    s = snapshot(99);
+    check(queue.depth() == 1 && queue.stats().coalesced == 2, "three posts of one slot queue it once");
+    check(queue.take(kind, data) && kind == CONFIG && whole(data, &value) && value == 3, "and write the last snapshot");
+    check(queue.idle() == false, "not idle while writing");
+    queue.done(true, 500);
+    check(queue.idle() && queue.take(kind, data) == false, "idle once written");
+
+    // Order
+    s = snapshot(10);
+    queue.post(NOISE, &s);
+    s = snapshot(11);
+    queue.post(CONFIG, &s);
+    s = snapshot(12);
+    queue.post(NOISE, &s);
+    check(queue.depth() == 2, "two slots pending");
+    check(queue.take(kind, data) && kind == NOISE && whole(data, &value) && value == 12,
+          "the first posted comes out first, with its latest snapshot");
+
+    // A post during the write
+    s = snapshot(13);
+    queue.post(NOISE, &s);
+    check(whole(data, &value) && value == 12, "a post during a write leaves the write's copy alone");
+    queue.done(true, 100);
+    check(queue.take(kind, data) && kind == CONFIG, "then the next oldest");
+    queue.done(false, 900);
+    check(queue.take(kind, data) && kind == NOISE && whole(data, &value) && value == 13, "and the one posted during the write");
+    queue.done(true, 200);
+
+    // Erases
+    s = snapshot(20);
+    queue.post(NOISE, &s);
+    queue.post(NOISE, NULL);
+    check(queue.take(kind, data) && kind == NOISE && data == NULL, "an erase replaces a pending save");
+    queue.done(true, 50);
+    queue.post(NOISE, NULL);
+    s = snapshot(21);
+    queue.post(NOISE, &s);
+    check(queue.take(kind, data) && data != NULL && whole(data, &value) && value == 21, "and a save replaces a pending erase");
+    queue.done(true, 50);
+
+    const SaveQueueStats& stats = queue.stats();
+    check(stats.written == 5 && stats.failed == 1, "writes and failures are counted");
+    check(stats.last_us == 50 && stats.max_us == 900 && stats.max_depth == 2, "latency and depth are tracked");
+  }
+
+  // Two producers and a writer
+  {
+    Buffers buffers;
+    SaveQueue<NUM_KINDS, MutexLock> queue;
+    add_slots(queue, buffers);
+
+    const uint32_t POSTS = 200000;
+    std::atomic<bool> producing(true);
+    uint32_t written[NUM_KINDS] = { 0, 0 };
+    uint32_t writes = 0;
+    bool torn = false;
+    bool backwards = false;
+
+    std::thread writer([&] {
+      uint8_t kind;
+      const void* data;
+      while (true) {
+        bool more = producing.load();
+        while (queue.take(kind, data)) {
+          uint32_t value = 0;
+          torn |= (whole(data, &value) == false);
+          backwards |= (value < written[kind]);
+          written[kind] = value;
+          writes++;
+          queue.done(true, 1);
+        }
+        if (more == false) {
+          break;
+        }
+        std::this_thread::yield();
+      }
+    });
+    auto producer = [&](uint8_t kind) {
+      for (uint32_t i = 1; i <= POSTS; i++) {
+        Snapshot s = snapshot(i);
+        queue.post(kind, &s);
+      }
+    };
+    std::thread config_producer(producer, CONFIG);
+    std::thread noise_producer(producer, NOISE);
+    config_producer.join();
+    noise_producer.join();
+    producing = false;
+    writer.join();
+
+    check(torn == false, "no write ever sees a half-copied snapshot");
+    check(backwards == false, "snapshots are written in the order they were posted");
+    check(written[CONFIG] == POSTS && written[NOISE] == POSTS && queue.idle(), "the last post of each slot is the last write");
+    printf("  %u posts, %u writes, %u coalesced\n", 2 * POSTS, writes, queue.stats().coalesced);
+    check(writes + queue.stats().coalesced == 2 * POSTS, "every post is written or coalesced");
+  }
+
+  return check_summary();
+}
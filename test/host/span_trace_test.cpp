@@ -0,0 +1,145 @@
+/**
+ * Span Trace Test (host)
+ *
+ * Checks src/span_trace.h: a dump written from two rings reads back with
+ * every event in order, spans land on the shared microsecond clock through
+ * each core's own anchor (including a cycle counter that wraps), a ring
+ * that overflowed keeps only its newest events, a truncated dump is
+ * rejected, and two threads pushing to one ring never lose or share a slot.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -pthread -Isrc test/host/span_trace_test.cpp -o span_trace_test
+ *   ./span_trace_test
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "host_check.h"
+#include "span_trace.h"
+
+struct ByteSink {
+  std::vector<uint8_t> bytes;
+  void operator()(const uint8_t* data, size_t length) {
+    bytes.insert(bytes.end(), data, data + length);
+  }
+};
+
+struct Decoded {
+  uint8_t core, span, kind;
+  double time_us;
+};
+
+struct EventSink {
+  std::vector<Decoded> events;
+  void operator()(uint8_t core, uint8_t span, uint8_t kind, double time_us) {
+    events.push_back({ core, span, kind, time_us });
+  }
+};
+
+static TraceRing rings[SPAN_TRACE_CORES];
+static TraceDumpInfo info;
+
+// What the device does per event, with a fake clock: «cycles» at «mhz»
+// since «boot_cycles», which was at «boot_us» on the shared clock
+static void push(TraceRing& ring, uint32_t cycles, uint8_t span, uint8_t kind, uint32_t boot_cycles, uint32_t boot_us, uint16_t mhz) {
+  if (trace_ring_push(ring, cycles, span, kind)) {
+    trace_ring_anchor(ring, cycles, boot_us + (cycles - boot_cycles) / mhz);
+  }
+}
+
+int main() {
+  const uint16_t mhz = 240;
+
+  // Round trip across two cores
+  {
+    for (TraceRing& ring : rings) {
+      trace_ring_clear(ring);
+    }
+    // Core 0's counter started at 0 at 1s, core 1's is near wrapping and started at 1.5s
+    uint32_t boot0 = 0, boot1 = 0xFFF00000u;
+    push(rings[0], boot0 + 240 * 10, SPAN_GDFT, TRACE_BEGIN_EVENT, boot0, 1000000, mhz);
+    push(rings[0], boot0 + 240 * 110, SPAN_GDFT, TRACE_END_EVENT, boot0, 1000000, mhz);
+    push(rings[1], boot1 + 240 * 20, SPAN_RENDER, TRACE_BEGIN_EVENT, boot1, 1500000, mhz);
+    push(rings[1], boot1 + 240 * 5000, SPAN_RENDER, TRACE_END_EVENT, boot1, 1500000, mhz);  // Past the wrap
+
+    ByteSink sink;
+    trace_write_dump(rings, SPAN_TRACE_CORES, mhz, sink);
+    EventSink events;
+    size_t used = trace_read_dump(sink.bytes.data(), sink.bytes.size(), info, events);
+
+    check(used == sink.bytes.size(), "whole dump consumed");
+    check(info.num_cores == 2 && info.cpu_mhz == mhz && info.num_spans == NUM_TRACE_SPANS, "header");
+    check(strcmp(info.span_names[SPAN_TX], "tx") == 0 && info.span_tracks[SPAN_TX] == TRACK_TX &&
+          strcmp(info.track_names[TRACK_LED], "led_thread") == 0, "span and track names");
+
+    bool order = events.events.size() == 4 &&
+                 events.events[0].core == 0 && events.events[0].span == SPAN_GDFT && events.events[0].kind == TRACE_BEGIN_EVENT &&
+                 events.events[1].core == 0 && events.events[1].kind == TRACE_END_EVENT &&
+                 events.events[2].core == 1 && events.events[2].span == SPAN_RENDER && events.events[3].kind == TRACE_END_EVENT;
+    check(order, "events in ring order with core, span and kind");
+
+    if (events.events.size() == 4) {
+      const std::vector<Decoded>& e = events.events;
+      printf("  core 0 gdft %.1f-%.1fus, core 1 render %.1f-%.1fus\n", e[0].time_us, e[1].time_us, e[2].time_us, e[3].time_us);
+      check(fabs(e[0].time_us - 1000010) < 1 && fabs(e[1].time_us - 1000110) < 1, "core 0 on the shared clock");
+      check(fabs(e[2].time_us - 1500020) < 1 && fabs(e[3].time_us - 1505000) < 1, "core 1 on the shared clock, across a cycle counter wrap");
+    }
+
+    check(trace_read_dump(sink.bytes.data(), sink.bytes.size() - 3, info, events) == 0, "truncated dump is rejected");
+    sink.bytes[4] = SPAN_TRACE_VERSION + 1;
+    check(trace_read_dump(sink.bytes.data(), sink.bytes.size(), info, events) == 0, "unknown version is rejected");
+  }
+
+  // Overflow keeps the newest events
+  {
+    for (TraceRing& ring : rings) {
+      trace_ring_clear(ring);
+    }
+    const uint32_t total = SPAN_TRACE_EVENTS * 3 + 17;
+    for (uint32_t i = 0; i < total; i++) {
+      push(rings[1], 1000 + i * 240, SPAN_SHOW, i & 1, 0, 0, mhz);
+    }
+    ByteSink sink;
+    trace_write_dump(rings, SPAN_TRACE_CORES, mhz, sink);
+    EventSink events;
+    trace_read_dump(sink.bytes.data(), sink.bytes.size(), info, events);
+
+    bool newest = events.events.size() == SPAN_TRACE_EVENTS;
+    for (size_t i = 0; newest && i < events.events.size(); i++) {
+      uint32_t n = total - SPAN_TRACE_EVENTS + i;
+      newest = events.events[i].core == 1 && events.events[i].kind == (n & 1) &&
+               fabs(events.events[i].time_us - (1000.0 / mhz + n)) < 1;
+    }
+    check(newest, "a full ring dumps its newest SPAN_TRACE_EVENTS, oldest first, timed from the latest anchor");
+  }
+
+  // Two tasks on one core
+  {
+    static TraceRing ring;
+    trace_ring_clear(ring);
+    const uint32_t per_thread = SPAN_TRACE_EVENTS / 2;
+    auto writer = [&](uint8_t span) {
+      for (uint32_t i = 0; i < per_thread; i++) {
+        trace_ring_push(ring, i, span, TRACE_BEGIN_EVENT);
+      }
+    };
+    std::thread a(writer, SPAN_RENDER);
+    std::thread b(writer, SPAN_TX);
+    a.join();
+    b.join();
+
+    uint32_t seen[NUM_TRACE_SPANS] = {};
+    for (uint32_t i = 0; i < SPAN_TRACE_EVENTS; i++) {
+      seen[ring.events[i].span]++;
+    }
+    check(ring.head.load() == SPAN_TRACE_EVENTS && seen[SPAN_RENDER] == per_thread && seen[SPAN_TX] == per_thread,
+          "concurrent pushes each get their own slot");
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,214 @@
+/**
+ * Telemetry Frame Test (host)
+ *
+ * Checks src/telemetry_frame.h: the CRC against its check value, COBS
+ * round trips around the 254-byte block edges, packets reading back
+ * exactly in both fixed and delta form (and delta being picked for smooth
+ * data), damaged or truncated packets being rejected, the ring dropping
+ * whole frames when full and handing them out in order across its wrap,
+ * one whole frame at a time for the drain task,
+ * and that a stream of frames with ASCII in between decodes every frame.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc test/host/telemetry_frame_test.cpp -o telemetry_frame_test
+ *   ./telemetry_frame_test
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "host_check.h"
+#include "telemetry_frame.h"
+
+static uint8_t scratch[TELEMETRY_MAX_PACKET];
+static uint8_t frame[TELEMETRY_MAX_FRAME];
+static TelemetryPacket packet;
+
+static bool same_values(const int32_t* values, uint16_t count) {
+  if (packet.count != count) {
+    return false;
+  }
+  for (uint16_t i = 0; i < count; i++) {
+    if (packet.values[i] != values[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  // CRC
+  {
+    const char* check_string = "123456789";
+    check(telemetry_crc16((const uint8_t*)check_string, 9) == 0x29B1, "CRC-16/CCITT-FALSE check value");
+  }
+
+  // COBS
+  {
+    bool ok = true;
+    std::vector<uint8_t> in, encoded, decoded;
+    srand(3);
+    for (size_t length : { 0, 1, 2, 253, 254, 255, 256, 508, 509, 1000 }) {
+      for (int pattern = 0; pattern < 4; pattern++) {
+        in.assign(length, 0);
+        for (size_t i = 0; i < length; i++) {
+          in[i] = (pattern == 0) ? 0 : (pattern == 1) ? 0x55 : (pattern == 2) ? uint8_t(i % 7 ? i : 0) : uint8_t(rand());
+        }
+        encoded.assign(length + length / 254 + 1, 0xEE);
+        size_t n = telemetry_cobs_encode(in.data(), length, encoded.data());
+        ok &= (n <= encoded.size() && memchr(encoded.data(), 0, n) == NULL);
+        decoded.assign(n, 0);
+        size_t m = telemetry_cobs_decode(encoded.data(), n, decoded.data());
+        ok &= (m == length && memcmp(decoded.data(), in.data(), length) == 0);
+      }
+    }
+    check(ok, "COBS round trips without zeros, across block edges");
+
+    uint8_t malformed[3] = { 5, 1, 1 };  // Claims 4 bytes, has 2
+    check(telemetry_cobs_decode(malformed, 3, malformed) == 0, "COBS rejects a block running past the end");
+  }
+
+  // Packets
+  {
+    int32_t audio[128];
+    for (int i = 0; i < 128; i++) {
+      audio[i] = int32_t(3000 * sin(i * 0.1));
+    }
+    size_t length = telemetry_build_packet(TELEM_AUDIO, 7, 123456789, audio, 128, scratch);
+    printf("  128 audio samples: %zu bytes (fixed would be %d)\n", length, TELEMETRY_HEADER_SIZE + 256 + 2);
+    check((scratch[1] & TELEM_FLAG_DELTA) && length < TELEMETRY_HEADER_SIZE + 256 + 2, "smooth audio goes out delta encoded and smaller");
+    check(telemetry_parse_packet(scratch, length, packet) && packet.type == TELEM_AUDIO && packet.sequence == 7 &&
+          packet.time_us == 123456789 && same_values(audio, 128), "delta packet reads back exactly");
+
+    int32_t noise[96];
+    srand(5);
+    for (int i = 0; i < 96; i++) {
+      noise[i] = int32_t(uint32_t(rand()) * 2654435761u);
+    }
+    length = telemetry_build_packet(TELEM_SPECTROGRAM, 65535, 1, noise, 96, scratch);
+    check((scratch[1] & TELEM_FLAG_DELTA) == 0 && length == TELEMETRY_HEADER_SIZE + 96 * 4 + 2, "incompressible data stays fixed width");
+    check(telemetry_parse_packet(scratch, length, packet) && same_values(noise, 96), "fixed packet reads back exactly");
+
+    int32_t extremes[4] = { INT32_MIN, INT32_MAX, INT32_MIN, 0 };
+    length = telemetry_build_packet(TELEM_MAGNITUDES, 0, 0, extremes, 4, scratch);
+    check(telemetry_parse_packet(scratch, length, packet) && same_values(extremes, 4), "int32 extremes survive");
+
+    int32_t loud[2] = { 40000, -40000 };
+    int32_t clamped[2] = { 32767, -32768 };
+    length = telemetry_build_packet(TELEM_AUDIO, 0, 0, loud, 2, scratch);
+    check(telemetry_parse_packet(scratch, length, packet) && same_values(clamped, 2), "audio outside int16 is clamped");
+
+    length = telemetry_build_packet(TELEM_AUDIO, 7, 0, audio, 128, scratch);
+    bool all_caught = true;
+    for (size_t i = 0; i < length; i++) {
+      scratch[i] ^= 0x10;
+      all_caught &= !telemetry_parse_packet(scratch, length, packet);
+      scratch[i] ^= 0x10;
+    }
+    check(all_caught, "any flipped bit is rejected");
+    check(!telemetry_parse_packet(scratch, length - 1, packet), "truncated packet is rejected");
+  }
+
+  // Ring
+  {
+    static TelemetryRing<64> ring;
+    ring.clear();
+    uint8_t block[24];
+    uint8_t next = 0, expect = 0;
+    bool ok = true;
+    uint32_t dropped = 0;
+    for (int round = 0; round < 200; round++) {
+      for (int k = 0; k < 3; k++) {  // Producer gets ahead
+        for (uint8_t& b : block) {
+          b = next++;
+        }
+        if (!ring.push(block, sizeof(block))) {
+          next -= sizeof(block);  // Dropped whole, nothing half-written
+          dropped++;
+        }
+      }
+      ok &= ring.used() <= 64;
+      uint32_t budget = 20 + round % 17;  // Consumer drains a bit at a time
+      const uint8_t* data;
+      uint32_t n;
+      while (budget > 0 && (n = ring.peek(&data)) > 0) {
+        n = (n < budget) ? n : budget;
+        for (uint32_t i = 0; i < n; i++) {
+          ok &= (data[i] == expect++);
+        }
+        ring.release(n);
+        budget -= n;
+      }
+    }
+    check(ok && dropped > 0, "ring drops whole frames when full and reads back in order across its wrap");
+  }
+
+  // Whole frames out of the ring
+  {
+    static TelemetryRing<256> ring;
+    ring.clear();
+    static uint8_t popped[TELEMETRY_MAX_FRAME];
+    int32_t values[8];
+    bool ok = true;
+    uint16_t sent = 0, received = 0;
+    for (int round = 0; round < 100; round++) {
+      for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < 8; i++) {
+          values[i] = (sent * 8 + i) * 977;
+        }
+        size_t length = telemetry_build_frame(TELEM_FPS, sent, 0, values, 1 + sent % 8, scratch, frame);
+        if (ring.push(frame, uint32_t(length))) {
+          sent++;
+        }
+      }
+      uint32_t length;
+      while ((length = ring.pop_frame(popped, sizeof(popped))) > 0) {
+        size_t unframed = telemetry_cobs_decode(popped + 1, length - 2, scratch);
+        ok &= popped[0] == 0 && popped[length - 1] == 0;
+        ok &= unframed > 0 && telemetry_parse_packet(scratch, unframed, packet) && packet.sequence == received++;
+      }
+    }
+    check(ok && received == sent && ring.used() == 0, "pop_frame() hands out exactly one whole frame at a time, across the wrap");
+  }
+
+  // Stream with text in between
+  {
+    std::vector<uint8_t> stream;
+    const char* text = "sbr{{\nSBOK\n}}\n";
+    int32_t values[96];
+    for (int f = 0; f < 20; f++) {
+      for (int i = 0; i < 96; i++) {
+        values[i] = (f * 1000 + i * 37) & 0xFFFF;
+      }
+      size_t n = telemetry_build_frame(TELEM_SPECTROGRAM, f, f * 8000, values, 96, scratch, frame);
+      stream.insert(stream.end(), frame, frame + n);
+      if (f % 3 == 0) {
+        stream.insert(stream.end(), text, text + strlen(text));
+      }
+    }
+
+    uint32_t decoded = 0, in_order = 0;
+    std::vector<uint8_t> chunk;
+    for (uint8_t byte : stream) {
+      if (byte != 0) {
+        chunk.push_back(byte);
+        continue;
+      }
+      if (chunk.empty()) {
+        continue;
+      }
+      size_t m = telemetry_cobs_decode(chunk.data(), chunk.size(), chunk.data());
+      if (m > 0 && telemetry_parse_packet(chunk.data(), m, packet)) {
+        in_order += (packet.sequence == decoded);
+        decoded++;
+      }
+      chunk.clear();
+    }
+    check(decoded == 20 && in_order == 20, "every frame decodes with ASCII between frames");
+  }
+
+  return check_summary();
+}
@@ -0,0 +1,123 @@
+#ifndef MOCK_JOURNAL_FLASH_H
+#define MOCK_JOURNAL_FLASH_H
+
+/**
+ * Mock Journal Flash (host only)
+ *
+ * Stands in for the flash under ConfigJournal (src/config_journal.h). It
+ * behaves like NOR flash: erase() sets a sector to 0xFF, and program()
+ * can only clear bits, so writing over a programmed byte ANDs into it
+ * (and is counted, the journal should never do that).
+ *
+ * cut_power_after(n) lets n more units of work through, one unit per
+ * byte programmed and one per sector erased, then the power fails:
+ *   - the byte being programmed gets only half its bits
+ *   - the sector being erased is only half erased
+ *   - every call after that fails, until restore_power()
+ * Mounting a new ConfigJournal on the same flash after restore_power()
+ * is then the next boot.
+ *
+ * Erases are counted per sector, to compare wear between sectors, and
+ * sync() calls are counted: on the device each one is a LittleFS flush.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "config_journal.h"
+
+class MockJournalFlash : public JournalFlash {
+ public:
+  MockJournalFlash(uint32_t sector_bytes, uint32_t sectors)
+      : bytes_per_sector(sector_bytes), memory(size_t(sector_bytes) * sectors, 0xFF), erase_counts(sectors, 0) {}
+
+  uint32_t sector_size() const override { return bytes_per_sector; }
+  uint32_t num_sectors() const override { return uint32_t(erase_counts.size()); }
+
+  bool read(uint32_t address, void* data, uint32_t length) override {
+    if (power_lost || size_t(address) + length > memory.size()) {
+      return false;
+    }
+    memcpy(data, &memory[address], length);
+    return true;
+  }
+
+  bool program(uint32_t address, const void* data, uint32_t length) override {
+    if (power_lost || size_t(address) + length > memory.size()) {
+      return false;
+    }
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (uint32_t i = 0; i < length; i++) {
+      if (spend() == false) {
+        memory[address + i] &= (bytes[i] | 0xF0);  // Only the low bits made it
+        return false;
+      }
+      if ((memory[address + i] & bytes[i]) != bytes[i]) {
+        overwrites++;
+      }
+      memory[address + i] &= bytes[i];
+      programmed++;
+    }
+    return true;
+  }
+
+  bool erase(uint32_t sector) override {
+    if (power_lost || sector >= erase_counts.size()) {
+      return false;
+    }
+    uint8_t* start = &memory[size_t(sector) * bytes_per_sector];
+    if (spend() == false) {
+      memset(start, 0xFF, bytes_per_sector / 2);
+      return false;
+    }
+    memset(start, 0xFF, bytes_per_sector);
+    erase_counts[sector]++;
+    return true;
+  }
+
+  bool sync() override {
+    if (power_lost) {
+      return false;
+    }
+    syncs++;
+    return true;
+  }
+
+  // Fail after «units» more bytes programmed or sectors erased, -1 for never
+  void cut_power_after(int64_t units) {
+    budget = units;
+  }
+
+  void restore_power() {
+    power_lost = false;
+    budget = -1;
+  }
+
+  bool powered() const { return !power_lost; }
+
+  uint32_t bytes_per_sector;
+  std::vector<uint8_t> memory;
+  std::vector<uint32_t> erase_counts;
+  uint64_t programmed = 0;
+  uint32_t overwrites = 0;  // Programs that tried to set a cleared bit
+  uint32_t syncs = 0;
+
+ private:
+  int64_t budget = -1;
+  bool power_lost = false;
+
+  bool spend() {
+    if (budget < 0) {
+      return true;
+    }
+    if (budget == 0) {
+      power_lost = true;
+      return false;
+    }
+    budget--;
+    return true;
+  }
+};
+
+#endif // MOCK_JOURNAL_FLASH_H
@@ -0,0 +1,122 @@
+#ifndef MOCK_LED_TRANSMITTER_H
+#define MOCK_LED_TRANSMITTER_H
+
+/**
+ * Mock LED Transmitter (host only)
+ *
+ * Stands in for the RMT/FastLED transmitter behind LedOutputDriver
+ * (src/led_output_driver.h). A worker thread "sends" the front buffers by
+ * sleeping for a configurable wire time, like a WS2812 transfer would, and
+ * signals completion through a condition variable.
+ *
+ * It also checksums the front buffers when a transfer starts and again
+ * when it ends, so any write into a buffer that's still on the wire shows
+ * up as a torn frame.
+ */
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "led_output_driver.h"
+
+class MockLedTransmitter : public LedTransmitter {
+ public:
+  // WS2812 defaults: 24 bits * 1.25us per pixel, ~300us latch
+  MockLedTransmitter(uint32_t pixels, uint32_t us_per_pixel = 30, uint32_t latch_us = 300)
+      : wire_time_us(pixels * us_per_pixel + latch_us) {
+    worker = std::thread(&MockLedTransmitter::run, this);
+  }
+
+  ~MockLedTransmitter() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      quit = true;
+    }
+    cv.notify_all();
+    worker.join();
+  }
+
+  // Buffers the transmitter reads, for the tear check
+  void watch_front(const void* front, uint32_t bytes) {
+    watched.push_back({(const uint8_t*)front, bytes});
+  }
+
+  void start_transfer() override {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (in_flight) {
+      overlapping_starts++;  // Driver didn't wait for the previous frame
+    }
+    in_flight = true;
+    requested++;
+    cv.notify_all();
+  }
+
+  void wait_transfer_done() override {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !in_flight; });
+  }
+
+  uint32_t wire_time_us;
+
+  uint32_t transfers = 0;           // Completed
+  uint32_t torn_frames = 0;         // Front buffer changed mid-transfer
+  uint32_t overlapping_starts = 0;  // start_transfer() while still busy
+
+ private:
+  struct Watched {
+    const uint8_t* data;
+    uint32_t bytes;
+  };
+
+  uint32_t checksum() const {
+    uint32_t sum = 2166136261u;  // FNV-1a
+    for (const Watched& w : watched) {
+      for (uint32_t i = 0; i < w.bytes; i++) {
+        sum = (sum ^ w.data[i]) * 16777619u;
+      }
+    }
+    return sum;
+  }
+
+  void run() {
+    uint32_t served = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this, served] { return quit || requested != served; });
+        if (quit) {
+          return;
+        }
+        served = requested;
+      }
+
+      uint32_t before = checksum();
+      std::this_thread::sleep_for(std::chrono::microseconds(wire_time_us));
+      uint32_t after = checksum();
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (before != after) {
+          torn_frames++;
+        }
+        transfers++;
+        in_flight = false;
+      }
+      cv.notify_all();
+    }
+  }
+
+  std::vector<Watched> watched;
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t requested = 0;
+  bool in_flight = false;
+  bool quit = false;
+};
+
+#endif // MOCK_LED_TRANSMITTER_H
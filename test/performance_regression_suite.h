@@ -189,22 +189,30 @@ TestResult test_audio_to_light_latency() {
         false,
         0.0f,
         TARGET_MAX_LATENCY_MS,
-        "milliseconds",
+        "milliseconds (p95, I2S chunk to last LED bit)",
         nullptr
     };
 
-    // Estimate latency from FPS
-    extern float SYSTEM_FPS;
-    extern float LED_FPS;
+    // Measured per frame by latency_probe.h, over the last 2k-4k traced frames
+    const LatencyHistogram& total = latency_stats.stages[LATENCY_TOTAL];
+    if (latency_hist_count(total) == 0) {
+        result.failure_reason = "No traced frames yet (is audio running and the strip changing?)";
+        return result;
+    }
 
-    // Latency ≈ 1/SYSTEM_FPS + 1/LED_FPS
-    float audio_frame_time = SYSTEM_FPS > 0 ? (1000.0f / SYSTEM_FPS) : 999.0f;
-    float led_frame_time = LED_FPS > 0 ? (1000.0f / LED_FPS) : 999.0f;
-    float estimated_latency = audio_frame_time + led_frame_time;
+    for (uint8_t s = 0; s < NUM_LATENCY_STAGES; s++) {
+        const LatencyHistogram& h = latency_stats.stages[s];
+        Serial.printf("    %-9s p50 %6lu us  p95 %6lu us  p99 %6lu us  max %6lu us\n",
+                      latency_stage_names[s],
+                      (unsigned long)latency_hist_percentile(h, 50),
+                      (unsigned long)latency_hist_percentile(h, 95),
+                      (unsigned long)latency_hist_percentile(h, 99),
+                      (unsigned long)latency_hist_max(h));
+    }
 
-    result.measured_value = estimated_latency;
+    result.measured_value = latency_hist_percentile(total, 95) / 1000.0f;
 
-    if (estimated_latency <= TARGET_MAX_LATENCY_MS) {
+    if (result.measured_value <= TARGET_MAX_LATENCY_MS) {
         result.passed = true;
     } else {
         result.failure_reason = "Latency exceeds target";
@@ -292,12 +300,363 @@ TestResult test_heap_fragmentation() {
     return result;
 }
 
+//=============================================================================
+// Test 8: HSV Kernel Accuracy (fixed-point hsv() vs FastLED CHSV path)
+//=============================================================================
+
+TestResult test_hsv_kernel_accuracy() {
+    TestResult result = {
+        "HSV Kernel Accuracy",
+        false,
+        0.0f,
+        3.0f,  // Max 3 LSB (8-bit) off the old CHSV output
+        "LSB (worst channel)",
+        nullptr
+    };
+
+    float max_error = 0.0f;
+
+    for (uint16_t h = 0; h < 256; h++) {
+        for (uint16_t s = 0; s <= 255; s += 15) {
+            // Compare on the exact same 8-bit hue so only kernel error shows up
+            CRGB ref = CHSV(h, s, 255);
+            CRGB16 fast = hsv16(h << 8, hsv_desat_q16(SQ15x16(s) / SQ15x16(255)), 1.0);  // led_utilities.h
+
+            float err_r = fabsf(float(fast.r) * 255.0f - ref.r);
+            float err_g = fabsf(float(fast.g) * 255.0f - ref.g);
+            float err_b = fabsf(float(fast.b) * 255.0f - ref.b);
+
+            if (err_r > max_error) max_error = err_r;
+            if (err_g > max_error) max_error = err_g;
+            if (err_b > max_error) max_error = err_b;
+        }
+    }
+
+    result.measured_value = max_error;
+
+    if (max_error <= result.target_value) {
+        result.passed = true;
+    } else {
+        result.failure_reason = "hsv() drifted from CHSV output";
+    }
+
+    return result;
+}
+
+//=============================================================================
+// Test 9: HSV Kernel Speedup (batch kernel vs CHSV path, one full frame)
+//=============================================================================
+
+TestResult test_hsv_kernel_speedup() {
+    TestResult result = {
+        "HSV Kernel Speedup",
+        false,
+        0.0f,
+        1.0f,  // Must at least not be slower
+        "x (CHSV time / kernel time)",
+        nullptr
+    };
+
+    static SQ15x16 hues[NATIVE_RESOLUTION];
+    static SQ15x16 vals[NATIVE_RESOLUTION];
+    static CRGB16 out[NATIVE_RESOLUTION];
+
+    for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+        hues[i] = SQ15x16(i) / SQ15x16(NATIVE_RESOLUTION);
+        vals[i] = SQ15x16(0.75);
+    }
+
+    const uint16_t passes = 50;
+
+    uint32_t t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+            out[i] = hsv_reference(hues[i], SQ15x16(0.9), vals[i]);
+        }
+    }
+    uint32_t t_reference = micros() - t_start;
+
+    t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        hsv_batch(out, hues, SQ15x16(0.9), vals, NATIVE_RESOLUTION);
+    }
+    uint32_t t_kernel = micros() - t_start;
+
+    float speedup = t_kernel > 0 ? (float)t_reference / t_kernel : 0.0f;
+    result.measured_value = speedup;
+
+    Serial.printf("    HSV: CHSV path %.2f us/frame, kernel %.2f us/frame\n",
+                  (float)t_reference / passes, (float)t_kernel / passes);
+
+    if (speedup >= result.target_value) {
+        result.passed = true;
+    } else {
+        result.failure_reason = "Fixed-point HSV kernel slower than CHSV";
+    }
+
+    return result;
+}
+
+//=============================================================================
+// Test 10: Render Resolution (compat 160 + scale vs native, 60-1000 LEDs)
+//=============================================================================
+
+TestResult test_render_resolution() {
+    TestResult result = {
+        "Render Resolution",
+        false,
+        0.0f,
+        1000000.0f / TARGET_LED_FPS,  // Native render at 1000 LEDs must fit a frame
+        "us (native frame @ 1000 LEDs)",
+        nullptr
+    };
+
+    const uint16_t counts[] = {60, 160, 300, 1000};
+    const uint16_t max_count = 1000;
+    const uint16_t passes = 20;
+
+    SQ15x16* hues = (SQ15x16*)malloc(sizeof(SQ15x16) * max_count);
+    SQ15x16* vals = (SQ15x16*)malloc(sizeof(SQ15x16) * max_count);
+    CRGB16* frame = (CRGB16*)malloc(sizeof(CRGB16) * max_count);
+    CRGB16* scaled = (CRGB16*)malloc(sizeof(CRGB16) * max_count);
+
+    if (hues == nullptr || vals == nullptr || frame == nullptr || scaled == nullptr) {
+        free(hues); free(vals); free(frame); free(scaled);
+        result.failure_reason = "Not enough heap for the benchmark buffers";
+        return result;
+    }
+
+    for (uint16_t count : counts) {
+        // Compatibility mode: draw 160 pixels, lerp them out to the strip
+        for (uint16_t i = 0; i < NATIVE_RESOLUTION; i++) {
+            hues[i] = SQ15x16(i) / SQ15x16(NATIVE_RESOLUTION);
+            vals[i] = SQ15x16(0.75);
+        }
+        uint32_t t_start = micros();
+        for (uint16_t p = 0; p < passes; p++) {
+            hsv_batch(frame, hues, SQ15x16(0.9), vals, NATIVE_RESOLUTION);
+            scale_led_buffer(frame, NATIVE_RESOLUTION, scaled, count);
+        }
+        uint32_t t_compat = micros() - t_start;
+
+        // Native mode: draw every pixel the strip has
+        for (uint16_t i = 0; i < count; i++) {
+            hues[i] = SQ15x16(i) / SQ15x16(count);
+            vals[i] = SQ15x16(0.75);
+        }
+        t_start = micros();
+        for (uint16_t p = 0; p < passes; p++) {
+            hsv_batch(frame, hues, SQ15x16(0.9), vals, count);
+        }
+        uint32_t t_native = micros() - t_start;
+
+        Serial.printf("    %4u LEDs: compat %.2f us/frame, native %.2f us/frame\n",
+                      count, (float)t_compat / passes, (float)t_native / passes);
+
+        if (count == max_count) {
+            result.measured_value = (float)t_native / passes;
+        }
+    }
+
+    free(hues); free(vals); free(frame); free(scaled);
+
+    if (result.measured_value <= result.target_value) {
+        result.passed = true;
+    } else {
+        result.failure_reason = "Native render too slow for long strips, use render_mode=half or compat";
+    }
+
+    return result;
+}
+
+//=============================================================================
+// Test 11: Procedural Engine (per-frame noise and trig, library vs procedural.h)
+//=============================================================================
+
+TestResult test_procedural_engine() {
+    TestResult result = {
+        "Procedural Engine",
+        false,
+        0.0f,
+        1.0f,  // Must at least not be slower
+        "x (library time / engine time)",
+        nullptr
+    };
+
+    const uint16_t pixels = render_resolution;
+    const uint16_t half = pixels / 2;
+    const uint16_t passes = 20;
+
+    uint32_t* xs = (uint32_t*)malloc(sizeof(uint32_t) * half);
+    int16_t* row = (int16_t*)malloc(sizeof(int16_t) * half);
+    int32_t* sines = (int32_t*)malloc(sizeof(int32_t) * pixels);
+
+    if (xs == nullptr || row == nullptr || sines == nullptr) {
+        free(xs); free(row); free(sines);
+        result.failure_reason = "Not enough heap for the benchmark buffers";
+        return result;
+    }
+
+    for (uint16_t i = 0; i < half; i++) {
+        uint32_t i_mapped = i + 18;
+        xs[i] = i_mapped * i_mapped * i_mapped;
+    }
+
+    volatile uint32_t sink = 0;
+
+    // Kaleidoscope: three channels of noise across half the strip. Timed the
+    // way the mode used to do it, cubing each coordinate in SQ15x16 and
+    // scaling it through double for every inoise16() call
+    uint32_t t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        uint32_t pos = p * 1000;
+        for (uint16_t i = 0; i < half; i++) {
+            SQ15x16 i_mapped = (SQ15x16)(i + 18);
+            uint32_t i_scaled = uint32_t((i_mapped * i_mapped * i_mapped) * SQ15x16(2.0));
+            SQ15x16 r_val = inoise16(i_scaled * 0.5 + pos) / 65536.0;
+            SQ15x16 g_val = inoise16(i_scaled * 1.0 + pos) / 65536.0;
+            SQ15x16 b_val = inoise16(i_scaled * 1.5 + pos) / 65536.0;
+            sink += (r_val + g_val + b_val).getInternal();
+        }
+    }
+    uint32_t t_inoise = micros() - t_start;
+
+    t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        for (uint16_t c = 1; c <= 3; c++) {
+            noise1_row_at(row, xs, c, p * 1000, half);  // procedural.h
+            sink += row[0];
+        }
+    }
+    uint32_t t_noise = micros() - t_start;
+
+    // Quantum collapse: the six per-pixel sines of the wave, diffusion and render passes
+    t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        float phase = p * 0.01f;
+        for (uint16_t i = 0; i < pixels; i++) {
+            float position = (float)i / pixels;
+            float s = sin(position * 8.0f + phase) + sin(position * 15.0f - phase) + sin(position * 5.0f + phase) +
+                      sin(position * 6.28f + phase) + sin(position * 6.28f + phase * 0.5f) + sin(i * 0.15f + phase);
+            sink += (uint32_t)(s * 1000.0f);
+        }
+    }
+    uint32_t t_sin = micros() - t_start;
+
+    t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        uint32_t phase = proc_phase(p * 0.01f);
+        proc_sin_row(sines, phase, proc_phase(8.0f / pixels), pixels);
+        proc_sin_row(sines, phase, proc_phase(15.0f / pixels), pixels);
+        proc_sin_row(sines, phase, proc_phase(5.0f / pixels), pixels);
+        proc_sin_row(sines, phase, proc_phase(6.28f / pixels), pixels);
+        proc_sin_row(sines, phase, proc_phase(6.28f / pixels), pixels);
+        proc_sin_row(sines, phase, proc_phase(0.15f), pixels);
+        sink += sines[0];
+    }
+    uint32_t t_lut = micros() - t_start;
+
+    free(xs); free(row); free(sines);
+
+    Serial.printf("    Noise @ %u px: inoise16 %.2f us/frame, noise1_row_at %.2f us/frame\n",
+                  half, (float)t_inoise / passes, (float)t_noise / passes);
+    Serial.printf("    Trig  @ %u px: sin() %.2f us/frame, proc_sin_row %.2f us/frame\n",
+                  pixels, (float)t_sin / passes, (float)t_lut / passes);
+
+    float noise_speedup = t_noise > 0 ? (float)t_inoise / t_noise : 0.0f;
+    float trig_speedup = t_lut > 0 ? (float)t_sin / t_lut : 0.0f;
+    result.measured_value = (noise_speedup < trig_speedup) ? noise_speedup : trig_speedup;
+
+    if (result.measured_value >= result.target_value) {
+        result.passed = true;
+    } else {
+        result.failure_reason = "procedural.h slower than the library calls it replaces";
+    }
+
+    return result;
+}
+
+//=============================================================================
+// Test 12: Bloom Sprite Shift
+//=============================================================================
+
+TestResult test_sprite_shift() {
+    TestResult result = {
+        "Sprite Shift",
+        false,
+        0.0f,
+        1.0f,  // Must at least not be slower
+        "x (draw_sprite time / shift_sprite time)",
+        nullptr
+    };
+
+    const uint16_t pixels = render_resolution;
+    const uint16_t passes = 50;
+    const float position = 0.25f + 1.75f * 0.4f;  // Bloom's offset at MOOD 0.4
+
+    CRGB16* sprite = (CRGB16*)malloc(sizeof(CRGB16) * pixels);
+    CRGB16* drawn = (CRGB16*)malloc(sizeof(CRGB16) * pixels);
+    CRGB16* shifted = (CRGB16*)malloc(sizeof(CRGB16) * pixels);
+
+    if (sprite == nullptr || drawn == nullptr || shifted == nullptr) {
+        free(sprite); free(drawn); free(shifted);
+        result.failure_reason = "Not enough heap for the benchmark buffers";
+        return result;
+    }
+
+    for (uint16_t i = 0; i < pixels; i++) {
+        sprite[i].r = SQ15x16(random(0, 1000) / 1000.0f);
+        sprite[i].g = SQ15x16(random(0, 1000) / 1000.0f);
+        sprite[i].b = SQ15x16(random(0, 1000) / 1000.0f);
+    }
+
+    // What bloom did before: clear, then scatter the sprite into two taps with bounds checks
+    uint32_t t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        memset(drawn, 0, sizeof(CRGB16) * pixels);
+        draw_sprite(drawn, sprite, pixels, pixels, position, 0.99);
+    }
+    uint32_t t_draw = micros() - t_start;
+
+    t_start = micros();
+    for (uint16_t p = 0; p < passes; p++) {
+        shift_sprite(shifted, sprite, pixels, position, 0.99);  // led_utilities.h
+    }
+    uint32_t t_shift = micros() - t_start;
+
+    // Same picture, give or take the rounding of one multiply instead of two
+    int32_t worst = 0;
+    for (uint16_t i = 0; i < pixels; i++) {
+        int32_t diff = abs(drawn[i].r.getInternal() - shifted[i].r.getInternal());
+        diff = max(diff, abs(drawn[i].g.getInternal() - shifted[i].g.getInternal()));
+        diff = max(diff, abs(drawn[i].b.getInternal() - shifted[i].b.getInternal()));
+        worst = max(worst, diff);
+    }
+
+    free(sprite); free(drawn); free(shifted);
+
+    Serial.printf("    Bloom shift @ %u px: draw_sprite %.2f us/frame, shift_sprite %.2f us/frame, worst diff %d/65536\n",
+                  pixels, (float)t_draw / passes, (float)t_shift / passes, worst);
+
+    result.measured_value = t_shift > 0 ? (float)t_draw / t_shift : 0.0f;
+
+    if (worst > 8) {
+        result.failure_reason = "shift_sprite() doesn't match draw_sprite()";
+    } else if (result.measured_value >= result.target_value) {
+        result.passed = true;
+    } else {
+        result.failure_reason = "shift_sprite() slower than clearing and drawing the sprite";
+    }
+
+    return result;
+}
+
 //=============================================================================
 // Master Test Runner
 //=============================================================================
 
 bool runAll(bool verbose = true) {
-    const int NUM_TESTS = 7;
+    const int NUM_TESTS = 12;
     TestResult results[NUM_TESTS];
 
     if (verbose) {
@@ -314,6 +673,11 @@ bool runAll(bool verbose = true) {
     results[4] = test_audio_to_light_latency();
     results[5] = test_stack_usage();
     results[6] = test_heap_fragmentation();
+    results[7] = test_hsv_kernel_accuracy();
+    results[8] = test_hsv_kernel_speedup();
+    results[9] = test_render_resolution();
+    results[10] = test_procedural_engine();
+    results[11] = test_sprite_shift();
 
     // Count pass/fail
     int passed = 0;
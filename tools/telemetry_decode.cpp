@@ -0,0 +1,111 @@
+/**
+ * Telemetry stream decoder
+ *
+ * Reads the binary frames the device sends for "stream=..." (see
+ * src/telemetry_frame.h) and prints one line per frame:
+ *
+ *   <type> <sequence> <time_us> <value>,<value>,...
+ *
+ * Fixed-point values (spectrogram, chromagram, fps) are printed as decimals.
+ * Anything between frames that isn't one, like the ASCII replies to other
+ * commands, is skipped. Frames that fail their CRC and gaps in a type's
+ * sequence numbers are counted and reported on stderr at the end.
+ *
+ * Reads a capture file, or a serial port as it streams (put it in raw mode
+ * first, e.g. "stty -F /dev/ttyACM0 raw"). Pass "-" to read stdin. An
+ * optional type name keeps only that stream.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc tools/telemetry_decode.cpp -o telemetry_decode
+ *   ./telemetry_decode /dev/ttyACM0 spectrogram
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "telemetry_frame.h"
+
+static uint8_t frame[TELEMETRY_MAX_FRAME];
+static TelemetryPacket packet;
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s <capture, serial port or -> [type]\n", argv[0]);
+    return 2;
+  }
+  FILE* in = (strcmp(argv[1], "-") == 0) ? stdin : fopen(argv[1], "rb");
+  if (in == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+  int only = -1;
+  if (argc == 3) {
+    for (int t = 0; t < NUM_TELEMETRY_TYPES; t++) {
+      if (strcmp(argv[2], telemetry_type_names[t]) == 0) {
+        only = t;
+      }
+    }
+    if (only < 0) {
+      fprintf(stderr, "unknown type '%s'\n", argv[2]);
+      return 2;
+    }
+  }
+
+  uint32_t good = 0, bad = 0, gaps = 0;
+  bool seen[NUM_TELEMETRY_TYPES] = {};
+  uint16_t next_sequence[NUM_TELEMETRY_TYPES] = {};
+  size_t length = 0;
+  bool overflow = false;
+
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (c != 0) {
+      if (length < sizeof(frame)) {
+        frame[length++] = uint8_t(c);
+      } else {
+        overflow = true;  // Not one of ours, skip to the next zero
+      }
+      continue;
+    }
+    if (length == 0) {
+      continue;  // Between frames
+    }
+
+    size_t decoded = overflow ? 0 : telemetry_cobs_decode(frame, length, frame);
+    length = 0;
+    overflow = false;
+    if (decoded == 0 || !telemetry_parse_packet(frame, decoded, packet)) {
+      bad++;
+      continue;
+    }
+    good++;
+
+    uint8_t type = packet.type;
+    if (seen[type] && packet.sequence != next_sequence[type]) {
+      gaps += uint16_t(packet.sequence - next_sequence[type]);
+    }
+    seen[type] = true;
+    next_sequence[type] = packet.sequence + 1;
+
+    if (only >= 0 && type != only) {
+      continue;
+    }
+    printf("%s %u %u ", telemetry_type_names[type], packet.sequence, packet.time_us);
+    bool fixed = telemetry_type_formats[type] == TELEM_FORMAT_Q16_16;
+    for (uint16_t i = 0; i < packet.count; i++) {
+      if (fixed) {
+        printf(i ? ",%.5f" : "%.5f", packet.values[i] / 65536.0);
+      } else {
+        printf(i ? ",%d" : "%d", packet.values[i]);
+      }
+    }
+    printf("\n");
+    fflush(stdout);
+  }
+
+  if (in != stdin) {
+    fclose(in);
+  }
+  fprintf(stderr, "%u frames, %u unreadable chunks, %u frames missing\n", good, bad, gaps);
+  return 0;
+}
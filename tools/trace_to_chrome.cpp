@@ -0,0 +1,109 @@
+/**
+ * Span trace to Chrome trace JSON
+ *
+ * Turns the output of the "trace_dump" serial command (src/span_trace.h,
+ * src/trace_recorder.h) into Chrome trace event JSON, which
+ * chrome://tracing and ui.perfetto.dev both open. Each core/task pair gets
+ * its own row, named like "core 1 led_tx", and every matched begin/end
+ * pair becomes one complete ("X") event. Spans cut off by the start of
+ * the ring or by the dump itself have no partner and are left out.
+ *
+ * The input can be a raw capture of the serial port, anything before the
+ * "SBTR" magic is skipped. If a capture holds several dumps, all of them
+ * are converted.
+ *
+ * Build and run from the repo root:
+ *   g++ -std=c++17 -O2 -Isrc tools/trace_to_chrome.cpp -o trace_to_chrome
+ *   ./trace_to_chrome capture.bin > trace.json
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "span_trace.h"
+
+struct ChromeWriter {
+  FILE* out;
+  const TraceDumpInfo* info;
+  double open_at[SPAN_TRACE_CORES * 256];  // Begin time per core and span
+  bool open[SPAN_TRACE_CORES * 256];
+  bool named[SPAN_TRACE_CORES * 256];     // Row has its thread_name
+  bool first;
+  uint32_t spans;
+
+  void event(const char* body) {
+    fprintf(out, "%s\n    %s", first ? "" : ",", body);
+    first = false;
+  }
+
+  void operator()(uint8_t core, uint8_t span, uint8_t kind, double time_us) {
+    if (core >= SPAN_TRACE_CORES || span >= info->num_spans) {
+      return;
+    }
+    double& begin = open_at[core * 256 + span];
+    if (kind == TRACE_BEGIN_EVENT) {
+      begin = time_us;
+      open[core * 256 + span] = true;
+    } else if (kind == TRACE_END_EVENT && open[core * 256 + span]) {
+      uint8_t track = info->span_tracks[span];
+      uint16_t tid = core * 256 + track;
+      char body[192];
+      if (named[tid] == false) {
+        named[tid] = true;
+        snprintf(body, sizeof(body),
+                 "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"core %u %s\"}}",
+                 tid, core, info->track_names[track]);
+        event(body);
+      }
+      snprintf(body, sizeof(body),
+               "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+               info->span_names[span], tid, begin, time_us - begin);
+      event(body);
+      open[core * 256 + span] = false;
+      spans++;
+    }
+  }
+};
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <capture> > trace.json\n", argv[0]);
+    return 2;
+  }
+  FILE* in = fopen(argv[1], "rb");
+  if (in == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+    data.insert(data.end(), chunk, chunk + got);
+  }
+  fclose(in);
+
+  static TraceDumpInfo info;
+  static ChromeWriter writer = { stdout, &info, {}, {}, {}, true, 0 };
+  uint32_t dumps = 0;
+
+  fprintf(stdout, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  for (size_t at = 0; at + 4 <= data.size(); at++) {
+    if (memcmp(&data[at], "SBTR", 4) != 0) {
+      continue;
+    }
+    memset(writer.open, 0, sizeof(writer.open));
+    size_t used = trace_read_dump(&data[at], data.size() - at, info, writer);
+    if (used == 0) {
+      fprintf(stderr, "skipping a truncated or unknown dump at byte %zu\n", at);
+      continue;
+    }
+    dumps++;
+    at += used - 1;
+  }
+  fprintf(stdout, "\n]}\n");
+
+  fprintf(stderr, "%u dump%s, %u spans\n", dumps, dumps == 1 ? "" : "s", writer.spans);
+  return dumps > 0 ? 0 : 1;
+}